@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include "CoreMinimal.h"
+#include "Delegate.h"
+
+namespace
+{
+	// The delegates before the inline storage, kept only as the baseline of the report
+	namespace Legacy
+	{
+		template<typename R, typename... Args>
+		class VDelegate
+		{
+		public:
+			virtual R Execute(Args... args) = 0;
+			virtual ~VDelegate() {}
+		};
+
+		template<class T, typename R, typename... Args>
+		class ObjectDelegate : public VDelegate<R, Args...>
+		{
+			using FuncPtr = R(T::*)(Args...);
+		public:
+			ObjectDelegate(T* p, FuncPtr f) : p(p), fp(f) {}
+			R Execute(Args... args) override { return (p->*fp)(args...); }
+		private:
+			T* p;
+			FuncPtr fp;
+		};
+
+		template<typename TLambda, typename R, typename... Args>
+		class LambdaDelegate : public VDelegate<R, Args...>
+		{
+		public:
+			LambdaDelegate(TLambda Lambda) : Lambda(Lambda) {}
+			R Execute(Args... args) override { return Lambda(args...); }
+		private:
+			TLambda Lambda;
+		};
+
+		template<typename... Args>
+		class MultiCastDelegate
+		{
+		public:
+			// The old delegates were shallow copies that never freed their binding, the list owns them here instead
+			~MultiCastDelegate()
+			{
+				for (auto* Listener : DelegateList)
+					delete Listener;
+			}
+
+			template<class T>
+			void AddMember(T* Object, void(T::* FuncPtr)(Args ...))
+			{
+				DelegateList.push_back(new ObjectDelegate<T, void, Args...>(Object, FuncPtr));
+			}
+
+			template<class T>
+			void AddLambda(T Lambda)
+			{
+				DelegateList.push_back(new LambdaDelegate<T, void, Args...>(Lambda));
+			}
+
+			void Broadcast(Args... args)
+			{
+				for (auto* Listener : DelegateList)
+					Listener->Execute(args...);
+			}
+
+		private:
+			TArray<VDelegate<void, Args...>*> DelegateList;
+		};
+	}
+
+	struct Listener
+	{
+		int64_t Sum = 0;
+		void OnUpdate(int Value) { Sum += Value; }
+	};
+
+	double NanosecondsSince(std::chrono::steady_clock::time_point Start)
+	{
+		return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - Start).count();
+	}
+
+	template<class TMultiCast>
+	void Measure(const char* Name, TArray<Listener>& Listeners, int Iterations)
+	{
+		const int ListenerNum = Listeners.size() + 1;
+		int64_t LambdaSum = 0;
+
+		auto Start = std::chrono::steady_clock::now();
+		for (int i = 0; i < Iterations; i++)
+		{
+			TMultiCast Multicast;
+			for (Listener& Object : Listeners)
+				Multicast.AddMember(&Object, &Listener::OnUpdate);
+			Multicast.AddLambda([&LambdaSum](int Value) { LambdaSum += Value; });
+			Multicast.Broadcast(i);
+		}
+		const double BindTime = NanosecondsSince(Start) / (static_cast<double>(Iterations) * ListenerNum);
+
+		TMultiCast Multicast;
+		for (Listener& Object : Listeners)
+			Multicast.AddMember(&Object, &Listener::OnUpdate);
+		Multicast.AddLambda([&LambdaSum](int Value) { LambdaSum += Value; });
+		Start = std::chrono::steady_clock::now();
+		for (int i = 0; i < Iterations; i++)
+			Multicast.Broadcast(i);
+		const double BroadcastTime = NanosecondsSince(Start) / (static_cast<double>(Iterations) * ListenerNum);
+
+		LOG_INFO("{}: bind + broadcast {:.2f} ns, broadcast {:.2f} ns per listener (checksum {})", Name, BindTime, BroadcastTime, LambdaSum);
+	}
+}
+
+/**
+ * Compare the inline storage delegates against the previous heap allocated, virtual dispatch ones.
+ * Logs the bind and broadcast time per listener of both.
+ * Usage: DelegateBenchmark [ListenerNum = 16] [Iterations = 100000]
+ */
+int main(int argc, char** argv)
+{
+	const int ListenerNum = std::max(argc > 1 ? std::atoi(argv[1]) : 16, 1);
+	const int Iterations = std::max(argc > 2 ? std::atoi(argv[2]) : 100000, 1);
+	TArray<Listener> Listeners(ListenerNum);
+
+	LOG_INFO("Delegate benchmark, {} member listeners and 1 lambda, {} iterations", ListenerNum, Iterations);
+	Measure<Legacy::MultiCastDelegate<int>>("Virtual heap delegate", Listeners, Iterations);
+	Measure<MultiCastDelegate<int>>("Inline delegate", Listeners, Iterations);
+	return 0;
+}
@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdlib>
+#include <numbers>
+#include "CoreMinimal.h"
+#include "Render/Core/geometry_buffer.h"
+#include "Misc/Path.h"
+
+namespace MechEngine::Rendering
+{
+namespace
+{
+	// Analytic content, so the decoded values can be checked against the written ones
+	ray_intersection synthetic_intersection(const UInt2& pixel_coord, const uint2& size)
+	{
+		ray_intersection intersection;
+		auto uv = (make_float2(pixel_coord) + 0.5f) / make_float2(size);
+		intersection.instance_id = pixel_coord.x / 64u + pixel_coord.y / 64u * 1024u;
+		intersection.primitive_id = pixel_coord.x * size.y + pixel_coord.y;
+		intersection.corner_normal_world = normalize(make_float3(uv * 2.f - 1.f, uv.x - uv.y));
+		intersection.albedo = make_float3(uv, 0.5f);
+		intersection.depth = 1.f + uv.x * 100.f;
+		intersection.motion_vector = make_float2(pixel_coord) + make_float2(0.25f + uv.x, -0.5f - uv.y);
+		return intersection;
+	}
+
+	double milliseconds_since(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+void geometry_buffer_bandwidth_report(const uint2& size, uint iterations)
+{
+	Context context{Path::BinPath().string()};
+	Device device = context.create_device("cpu");
+	Stream stream = device.create_stream();
+	const double pixel_num = static_cast<double>(size.x) * size.y;
+
+	LOG_INFO("G-Buffer bandwidth report, {}x{} on the CPU backend, {} iterations", size.x, size.y, iterations);
+	for (bool packed : {false, true})
+	{
+		geometry_buffer g_buffer;
+		g_buffer.InitBuffer(device, size, packed);
+		// Max normal error in radians, max motion vector error in pixels and id mismatches, as float bits for atomic max
+		Buffer<uint> errors = device.create_buffer<uint>(3);
+
+		auto write_shader = device.compile<2>([&]() noexcept {
+			auto pixel_coord = dispatch_id().xy();
+			auto intersection = synthetic_intersection(pixel_coord, size);
+			g_buffer.write(pixel_coord, intersection.albedo, intersection);
+		}, {.name = "GBufferBenchmarkWrite"});
+
+		// Reads what the wireframe, buffer view and temporal passes read
+		auto read_shader = device.compile<2>([&]() noexcept {
+			auto pixel_coord = dispatch_id().xy();
+			auto visibility = g_buffer.read_visibility(pixel_coord);
+			auto normal = g_buffer.read_normal(pixel_coord);
+			auto albedo = g_buffer.read_albedo(pixel_coord);
+			auto depth = g_buffer.read_depth(pixel_coord);
+			auto motion_vector = g_buffer.read_motion_vector(pixel_coord);
+
+			auto expected = synthetic_intersection(pixel_coord, size);
+			auto normal_error = acos(clamp(dot(normal, expected.corner_normal_world), -1.f, 1.f));
+			auto motion_error = length(motion_vector - expected.motion_vector);
+			auto id_error = ite(all(visibility == make_uint2(expected.instance_id, expected.primitive_id)), 0.f, 1.f);
+			errors->atomic(0u).fetch_max(as<uint>(normal_error));
+			errors->atomic(1u).fetch_max(as<uint>(motion_error));
+			errors->atomic(2u).fetch_max(as<uint>(id_error));
+			g_buffer.radiance->write(pixel_coord, make_float4(albedo + normal, depth));
+		}, {.name = "GBufferBenchmarkRead"});
+
+		std::array<uint, 3> error_bits{};
+		stream << errors.copy_from(error_bits.data()) << synchronize();
+
+		auto start = std::chrono::steady_clock::now();
+		for (uint i = 0; i < iterations; i++)
+			stream << write_shader().dispatch(size);
+		stream << synchronize();
+		const double write_time = milliseconds_since(start) / iterations;
+
+		start = std::chrono::steady_clock::now();
+		for (uint i = 0; i < iterations; i++)
+			stream << read_shader().dispatch(size);
+		stream << synchronize();
+		const double read_time = milliseconds_since(start) / iterations;
+
+		stream << errors.copy_to(error_bits.data()) << synchronize();
+
+		// Each pass touches every G-Buffer once
+		const double frame_bytes = geometry_buffer::bytes_per_pixel(packed) * pixel_num;
+		LOG_INFO("    {:>6} layout: {:>2} bytes per pixel, {:>7.1f} MB per frame, write {:>7.2f} ms, read {:>7.2f} ms, {:>5.2f} GB/s",
+			packed ? "packed" : "full", geometry_buffer::bytes_per_pixel(packed), frame_bytes / (1024. * 1024.),
+			write_time, read_time, 2. * frame_bytes / ((write_time + read_time) * 1e6));
+		LOG_INFO("            max normal error {:.4f} deg, max motion vector error {:.4f} px, id mismatch {}",
+			std::bit_cast<float>(error_bits[0]) * 180. / std::numbers::pi, std::bit_cast<float>(error_bits[1]), std::bit_cast<float>(error_bits[2]) > 0.f);
+	}
+}
+}
+
+using namespace MechEngine::Rendering;
+
+/**
+ * Compare the full and packed G-Buffer layouts on the CPU backend.
+ * A synthetic G-Buffer is written, then read back like the wireframe, buffer view and temporal passes.
+ * Logs the bytes per frame, the write / read time and the precision lost by packing of each layout.
+ * Usage: GBufferBenchmark [Width = 1920] [Height = 1080] [Iterations = 16]
+ */
+int main(int argc, char** argv)
+{
+	const uint width = std::max(argc > 1 ? std::atoi(argv[1]) : 1920, 1);
+	const uint height = std::max(argc > 2 ? std::atoi(argv[2]) : 1080, 1);
+	const uint iterations = std::max(argc > 3 ? std::atoi(argv[3]) : 16, 1);
+	geometry_buffer_bandwidth_report(make_uint2(width, height), iterations);
+	return 0;
+}
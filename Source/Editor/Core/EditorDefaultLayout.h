@@ -10,6 +10,9 @@
 #include "Widgets/WorldEditor/ObjectPanel.h"
 #include "Widgets/WorldEditor/ViewGizmo.h"
 #include "Widgets/WorldEditor/WorldSettingWidget.h"
+#include "Widgets/WorldEditor/ProfilerWidget.h"
+#include "Components/ParametricMeshComponent.h"
+#include "Render/PipeLine/PathTracingScene.h"
 
 inline void LoadDefaultEditorLayout(World* CurrentWorld)
 {
@@ -44,8 +47,26 @@ inline void LoadDefaultEditorLayout(World* CurrentWorld)
 	MainMenuBar->AddItem<SaveMeshMenuBar>("File/Export Selected Mesh", "");
 	MainMenuBar->AddItem<SaveSceneMenuBar>("File/Export Scene", "");
 
+	// Time random geodesic path queries on the selected mesh, logged with the queries per second of each method
+	auto BenchmarkGeodesics = [=](bool bWithExact) {
+		if (auto SelectedActor = CurrentWorld->GetSelectedActor())
+		{
+			if (auto MeshComponent = SelectedActor->GetComponent<ParametricMeshComponent>())
+				MeshComponent->GetGeodesics().Benchmark(256, bWithExact);
+		}
+	};
+	MainMenuBar->AddItem("Debug/Benchmark Geodesics/Heat Method", "", { [=]() { BenchmarkGeodesics(false); } });
+	MainMenuBar->AddItem("Debug/Benchmark Geodesics/Heat And Exact", "Exact paths can take minutes", { [=]() { BenchmarkGeodesics(true); } });
+
+	// Widgets are drawn on the render thread, the report runs before the next path traced frame
+	MainMenuBar->AddItem("Debug/Wavefront Throughput Report", "", { [=]() {
+		if (auto Scene = dynamic_cast<Rendering::PathTracingScene*>(CurrentWorld->GetScene()))
+			Scene->RequestWavefrontThroughputReport();
+	}});
+
 	CurrentWorld->AddWidget<WorldSettingWidget>();
 	CurrentWorld->AddWidget<WorldOutliner>();
+	CurrentWorld->AddWidget<ProfilerWidget>();
 
 	// [BETA] ActorOutliner and ObjectPanel will start to use when property become more complex
 	// CurrentWorld->AddWidget<ActorOutliner>();
@@ -6,6 +6,7 @@
 #include "Core/reflection_register.h"
 #include "Misc/Config.h"
 #include "Misc/Path.h"
+#include "Misc/Profiler.h"
 
 // Override new and delete with mi_malloc and mi_free
 // #include <mimalloc.h>
@@ -13,6 +14,7 @@
 #include "EditorDefaultLayout.h"
 #include "Render/PipeLine/RenderPipeline.h"
 #include "GlobalSymbols.h"
+#include "Render/SceneProxy/TransformProxy.h"
 
 Editor &Editor::Get() {
     static Editor Instance;
@@ -52,6 +54,11 @@ void Editor::Init(const std::string& BinPath)
 	auto Width = GConfig.Get<int>("Render", "ResolutionX");
 	auto Height = GConfig.Get<int>("Render", "ResolutionY");
 	MaxFPS = GConfig.Get<float>("Render", "MaxFPS");
+	bAsyncSimulation = GConfig.Get<bool>("Simulation", "AsyncSimulation");
+	SimulationTimeStep = GConfig.Get<double>("Simulation", "FixedTimeStep");
+	SimulationMaxSubSteps = GConfig.Get<int>("Simulation", "MaxSubSteps");
+	Profiler::Get().SetThreadName("Main");
+	Profiler::Get().SetEnabled(ENABLE_PROFILER && GConfig.Get<bool>("RenderDebug", "Profiler"));
 	Renderer = MakeUnique<RenderPipeline>(Width, Height, WindowName);
 	//--------- Reflection meta infomation register ----------
 	Reflection::TypeMetaRegister::metaRegister();
@@ -63,10 +70,16 @@ void Editor::LoadWorld(const TFunction<void(class World&)>& InitScript)
 	WorldCommandQueue.emplace( Load, InitScript );
 }
 
+void Editor::EditWorld(const TFunction<void(class World&)>& EditScript)
+{
+	WorldCommandQueue.emplace( Edit, EditScript );
+}
+
 void Editor::UnloadCurrentWorldImpl()
 {
 	if(!CurrentWorld) return;
 	LOG_INFO("Unloading map");
+	Simulation.Stop();
 	CurrentWorld->EndPlay();
 	CurrentWorld.reset();
 }
@@ -86,13 +99,23 @@ void Editor::LoadWorldImpl(const TFunction<void(class World&)>& InitScript)
 	LoadDefaultEditorLayout(CurrentWorld.get());
 
 	CurrentWorld->BeginPlay();
+	if (bAsyncSimulation)
+		Simulation.Start(CurrentWorld.get(), SimulationTimeStep, SimulationMaxSubSteps);
 	LOG_INFO("Load world map done");
 }
 
 void Editor::Tick(double DeltaTime)
 {
+	PROFILE_SCOPE("Editor::Tick");
 	// First handle the world command
-	if(CurrentWorld)
+	if(CurrentWorld && Simulation.IsRunning())
+	{
+		// The world is ticked by the simulation thread, hold it only while the frame collects its render data
+		auto WorldLock = Simulation.LockWorld();
+		CurrentWorld->GetScene()->GetTransformProxy()->SetInterpolationAlpha(Simulation.GetInterpolationAlpha());
+		Renderer->RenderFrame(WorldLock);
+	}
+	else if(CurrentWorld)
 	{
 		CurrentWorld->Tick(DeltaTime);
 		Renderer->RenderFrame();
@@ -110,6 +133,15 @@ void Editor::Tick(double DeltaTime)
 			break;
 		case Save:
 			break;
+		case Edit:
+			if(CurrentWorld && Simulation.IsRunning())
+			{
+				auto WorldLock = Simulation.LockWorld();
+				std::get<1>(Command)(*CurrentWorld);
+			}
+			else if(CurrentWorld)
+				std::get<1>(Command)(*CurrentWorld);
+			break;
 		}
 		WorldCommandQueue.pop();
 	}
@@ -124,12 +156,14 @@ void Editor::Start()
 
 	while (!Renderer->ShouldClose())
 	{
+		Profiler::Get().BeginFrame();
 		NowFrame = std::chrono::high_resolution_clock::now();
 
 		// Sleep for a while if the frame rate is too high
 		if (
 			MaxFPS > 0 && NowFrame - LastFrame < std::chrono::nanoseconds(int(1.0 / MaxFPS * 1e9)))
 		{
+			PROFILE_SCOPE("FrameLimiter");
 			std::this_thread::sleep_for(std::chrono::nanoseconds(int(1.0 / MaxFPS * 1e9)) - (NowFrame - LastFrame));
 			NowFrame = std::chrono::high_resolution_clock::now();
 		}
@@ -141,6 +175,7 @@ void Editor::Start()
 	}
 
 	LOG_INFO("Closing editor");
+	Simulation.Stop();
 	Renderer.reset();
 
 	LOG_INFO("End play");
@@ -8,6 +8,7 @@
 #include "CoreMinimal.h"
 #include "Delegate.h"
 #include "Game/World.h"
+#include "Game/SimulationThread.h"
 #include "Render/PipeLine/RenderPipeline.h"
 
 #define GEditor Editor::Get()
@@ -16,7 +17,7 @@ DECLARE_MULTICAST_DELEGATE(KeyPressedEvent);
 
 enum WorldCommandType
 {
-	Load, Unload, Save
+	Load, Unload, Save, Edit
 };
 
 typedef std::tuple<WorldCommandType, TFunction<void(class World&)>> WorldCommand;
@@ -40,6 +41,13 @@ public:
 	 */
 	void LoadWorld(const TFunction<void(class World&)>& InitScript);
 
+	/**
+	 * Edit the current world once the frame is rendered, under the world lock when the simulation thread runs.
+	 * Widgets queue their edits here, the render thread only holds the world while it collects the frame
+	 * @param EditScript The edit, skipped if no world is loaded
+	 */
+	void EditWorld(const TFunction<void(class World&)>& EditScript);
+
 	[[nodiscard]] FORCEINLINE World* GetWorld() const;
 
 	/**
@@ -50,6 +58,12 @@ public:
 
 	FORCEINLINE float GetMaxFPS() const;
 
+	/**
+	 * Whether the world is ticked on the simulation thread, decoupled from the render frame rate
+	 * Takes effect when the next world is loaded
+	 */
+	FORCEINLINE void SetAsyncSimulation(bool bInAsyncSimulation);
+
 private:
 	void Tick(double DeltaTime);
 
@@ -59,10 +73,18 @@ private:
 
 	float MaxFPS = -1;
 
+	bool bAsyncSimulation = false;
+	// Fixed time step of the simulation thread in seconds, <= 0 for variable time step
+	double SimulationTimeStep = 1. / 60.;
+	int SimulationMaxSubSteps = 4;
+
 	UniquePtr<RenderPipeline> Renderer = nullptr;
 
 	UniquePtr<World> CurrentWorld;
 
+	// Declared after the world so that it stops before the world is destroyed
+	SimulationThread Simulation;
+
 	Editor() = default;
 
 	std::queue<WorldCommand> WorldCommandQueue;
@@ -81,4 +103,9 @@ FORCEINLINE void Editor::SetMaxFPS(float InMaxFPS)
 FORCEINLINE float Editor::GetMaxFPS() const
 {
 	return MaxFPS;
+}
+
+FORCEINLINE void Editor::SetAsyncSimulation(bool bInAsyncSimulation)
+{
+	bAsyncSimulation = bInAsyncSimulation;
 }
\ No newline at end of file
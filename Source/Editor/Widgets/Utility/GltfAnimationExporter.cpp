@@ -0,0 +1,360 @@
+#include "GltfAnimationExporter.h"
+#include "Mesh/StaticMesh.h"
+#include "Misc/Path.h"
+#include "tiny_gltf.h"
+#include "json.hpp"
+#include <fstream>
+#include <numeric>
+#include <sstream>
+#include <string_view>
+
+namespace
+{
+	// Segment of the binary buffer, written in planning order
+	struct BufferSegment
+	{
+		size_t ByteOffset;
+		size_t ByteLength;
+		TFunction<void(std::ostream&)> Writer;
+	};
+
+	constexpr size_t ChunkElementNum = 1 << 12;
+	constexpr char Padding[4] = {0, 0, 0, 0};
+
+	size_t Align4(size_t Size) { return (Size + 3) & ~size_t(3); }
+
+	template <class T>
+	void WriteRaw(std::ostream& Stream, const T* Data, size_t Num)
+	{
+		Stream.write(reinterpret_cast<const char*>(Data), Num * sizeof(T));
+	}
+
+	size_t HashBytes(const void* Data, size_t Size, size_t Seed)
+	{
+		const size_t Hash = std::hash<std::string_view>{}(std::string_view(static_cast<const char*>(Data), Size));
+		return Seed ^ (Hash + 0x9e3779b97f4a7c15ull + (Seed << 6) + (Seed >> 2));
+	}
+}
+
+int GltfAnimationExporter::AddMesh(const StaticMesh& Mesh)
+{
+	const auto& verM = Mesh.verM;
+	const auto& triM = Mesh.triM;
+
+	MeshSnapshot Snapshot;
+	Snapshot.Positions.resize(verM.rows() * 3);
+	Snapshot.Indices.resize(triM.rows() * 3);
+	for (int i = 0; i < verM.rows(); i++)
+	{
+		for (int k = 0; k < 3; k++)
+		{
+			const float Value = static_cast<float>(verM(i, k));
+			Snapshot.Positions[i * 3 + k] = Value;
+			Snapshot.Min[k] = i == 0 ? Value : std::min(Snapshot.Min[k], Value);
+			Snapshot.Max[k] = i == 0 ? Value : std::max(Snapshot.Max[k], Value);
+		}
+	}
+	for (int i = 0; i < triM.rows(); i++)
+	{
+		for (int k = 0; k < 3; k++)
+			Snapshot.Indices[i * 3 + k] = static_cast<uint32_t>(triM(i, k));
+	}
+	Snapshot.Hash = HashBytes(Snapshot.Positions.data(), Snapshot.Positions.size() * sizeof(float), 0);
+	Snapshot.Hash = HashBytes(Snapshot.Indices.data(), Snapshot.Indices.size() * sizeof(uint32_t), Snapshot.Hash);
+
+	for (int i = 0; i < Meshes.size(); i++)
+	{
+		if (Meshes[i].Hash == Snapshot.Hash && Meshes[i].Positions == Snapshot.Positions && Meshes[i].Indices == Snapshot.Indices)
+			return i;
+	}
+	Meshes.push_back(std::move(Snapshot));
+	return Meshes.size() - 1;
+}
+
+void GltfAnimationExporter::AddTrack(const String& Name, int MeshIndex, TArray<FTransform> Transforms)
+{
+	Tracks.push_back({Name, MeshIndex, std::move(Transforms)});
+}
+
+bool GltfAnimationExporter::Export(const String& FilePath, const ExportOptions& Options, std::atomic<float>* Progress) const
+{
+	tinygltf::Model model;
+	tinygltf::Scene scene;
+	model.asset.version = "2.0";
+	model.asset.generator = "SimpleTransformAnimationPlayer";
+
+	TArray<BufferSegment> Segments;
+	size_t BufferLength = 0;
+	auto AddBufferView = [&](size_t ByteLength, int Target, TFunction<void(std::ostream&)> Writer) {
+		tinygltf::BufferView View;
+		View.buffer = 0;
+		View.byteOffset = BufferLength;
+		View.byteLength = ByteLength;
+		if (Target != 0)
+			View.target = Target;
+		model.bufferViews.push_back(View);
+		Segments.push_back({BufferLength, ByteLength, std::move(Writer)});
+		BufferLength = Align4(BufferLength + ByteLength);
+		return int(model.bufferViews.size() - 1);
+	};
+	auto AddAccessor = [&](int BufferView, int ComponentType, size_t Count, int Type) {
+		tinygltf::Accessor Accessor;
+		Accessor.bufferView = BufferView;
+		Accessor.byteOffset = 0;
+		Accessor.componentType = ComponentType;
+		Accessor.count = Count;
+		Accessor.type = Type;
+		model.accessors.push_back(Accessor);
+		return int(model.accessors.size() - 1);
+	};
+
+	// --- MESHES --- each unique mesh is written once and shared by every node referencing it
+	TArray<int> MeshIndices(Meshes.size(), -1);
+	for (int MeshId = 0; MeshId < Meshes.size(); MeshId++)
+	{
+		const MeshSnapshot& Mesh = Meshes[MeshId];
+		const size_t VertexNum = Mesh.Positions.size() / 3;
+
+		int PositionView = AddBufferView(Mesh.Positions.size() * sizeof(float), TINYGLTF_TARGET_ARRAY_BUFFER,
+			[&Mesh](std::ostream& Stream) { WriteRaw(Stream, Mesh.Positions.data(), Mesh.Positions.size()); });
+		int PositionAccessor = AddAccessor(PositionView, TINYGLTF_COMPONENT_TYPE_FLOAT, VertexNum, TINYGLTF_TYPE_VEC3);
+		model.accessors[PositionAccessor].minValues = {Mesh.Min[0], Mesh.Min[1], Mesh.Min[2]};
+		model.accessors[PositionAccessor].maxValues = {Mesh.Max[0], Mesh.Max[1], Mesh.Max[2]};
+
+		// Index width only depends on the vertex count, indices are narrowed chunk by chunk while streaming
+		auto WriteIndices = [&Mesh]<class IndexType>(std::ostream& Stream, IndexType) {
+			IndexType Chunk[ChunkElementNum];
+			for (size_t Begin = 0; Begin < Mesh.Indices.size(); Begin += ChunkElementNum)
+			{
+				const size_t Num = std::min(ChunkElementNum, Mesh.Indices.size() - Begin);
+				for (size_t i = 0; i < Num; i++)
+					Chunk[i] = static_cast<IndexType>(Mesh.Indices[Begin + i]);
+				WriteRaw(Stream, Chunk, Num);
+			}
+		};
+		int IndexComponentType;
+		int IndexView;
+		if (VertexNum <= 255)
+		{
+			IndexComponentType = TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE;
+			IndexView = AddBufferView(Mesh.Indices.size(), TINYGLTF_TARGET_ELEMENT_ARRAY_BUFFER,
+				[WriteIndices](std::ostream& Stream) { WriteIndices(Stream, uint8_t{}); });
+		}
+		else if (VertexNum <= 65535)
+		{
+			IndexComponentType = TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT;
+			IndexView = AddBufferView(Mesh.Indices.size() * sizeof(uint16_t), TINYGLTF_TARGET_ELEMENT_ARRAY_BUFFER,
+				[WriteIndices](std::ostream& Stream) { WriteIndices(Stream, uint16_t{}); });
+		}
+		else
+		{
+			IndexComponentType = TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT;
+			IndexView = AddBufferView(Mesh.Indices.size() * sizeof(uint32_t), TINYGLTF_TARGET_ELEMENT_ARRAY_BUFFER,
+				[&Mesh](std::ostream& Stream) { WriteRaw(Stream, Mesh.Indices.data(), Mesh.Indices.size()); });
+		}
+
+		tinygltf::Primitive primitive;
+		primitive.attributes["POSITION"] = PositionAccessor;
+		primitive.indices = AddAccessor(IndexView, IndexComponentType, Mesh.Indices.size(), TINYGLTF_TYPE_SCALAR);
+		primitive.mode = TINYGLTF_MODE_TRIANGLES;
+
+		tinygltf::Mesh mesh;
+		mesh.name = "Mesh_" + std::to_string(MeshId);
+		mesh.primitives.push_back(primitive);
+		MeshIndices[MeshId] = model.meshes.size();
+		model.meshes.push_back(mesh);
+	}
+
+	// --- ANIMATION DATA ---
+	tinygltf::Animation animation;
+	animation.name = "Animation_001";
+
+	auto AddTimeAccessor = [&](const TArray<float>& Times, const TArray<int>& Keys) {
+		int View = AddBufferView(Keys.size() * sizeof(float), 0, [&Times, Keys](std::ostream& Stream) {
+			for (int Key : Keys) WriteRaw(Stream, &Times[Key], 1);
+		});
+		int Accessor = AddAccessor(View, TINYGLTF_COMPONENT_TYPE_FLOAT, Keys.size(), TINYGLTF_TYPE_SCALAR);
+		model.accessors[Accessor].minValues = {Times[Keys.front()]};
+		model.accessors[Accessor].maxValues = {Times[Keys.back()]};
+		return Accessor;
+	};
+	auto AddChannel = [&](int NodeIndex, const String& TargetPath, int TimeAccessor, int OutputAccessor) {
+		tinygltf::AnimationChannel channel;
+		channel.sampler = animation.samplers.size();
+		channel.target_node = NodeIndex;
+		channel.target_path = TargetPath;
+		animation.channels.push_back(channel);
+
+		tinygltf::AnimationSampler sampler;
+		sampler.input = TimeAccessor;
+		sampler.output = OutputAccessor;
+		sampler.interpolation = "LINEAR";
+		animation.samplers.push_back(sampler);
+	};
+
+	// Per track key times and values are planned here, owned until the buffer is written
+	TArray<TArray<float>> TrackTimes(Tracks.size());
+	for (size_t TrackIndex = 0; TrackIndex < Tracks.size(); TrackIndex++)
+	{
+		const TrackSnapshot& Track = Tracks[TrackIndex];
+		if (Track.Transforms.empty())
+			continue;
+
+		tinygltf::Node node;
+		node.name = Track.Name + "_" + std::to_string(TrackIndex);
+		if (Track.MeshIndex >= 0)
+			node.mesh = MeshIndices[Track.MeshIndex];
+		const int NodeIndex = model.nodes.size();
+		model.nodes.push_back(node);
+		scene.nodes.push_back(NodeIndex);
+
+		const TArray<FTransform>& Transforms = Track.Transforms;
+		const size_t KeyNum = Transforms.size();
+		TArray<float>& Times = TrackTimes[TrackIndex];
+		Times.resize(KeyNum);
+		for (size_t i = 0; i < KeyNum; i++)
+			Times[i] = KeyNum > 1 ? static_cast<float>(double(i) / (KeyNum - 1) * Options.Duration) : 0.f;
+
+		TArray<int> AllKeys(KeyNum);
+		std::iota(AllKeys.begin(), AllKeys.end(), 0);
+		TArray<int> TranslationKeys = AllKeys, RotationKeys = AllKeys, ScaleKeys = AllKeys;
+		if (Options.bReduceKeyframes)
+		{
+			TArray<FVector> Translations(KeyNum), Scales(KeyNum);
+			TArray<FQuat> Rotations(KeyNum);
+			for (size_t i = 0; i < KeyNum; i++)
+			{
+				Translations[i] = Transforms[i].GetTranslation();
+				Rotations[i] = Transforms[i].GetRotation();
+				Scales[i] = Transforms[i].GetScale();
+			}
+			auto LerpVector = [](const FVector& A, const FVector& B, double Alpha) -> FVector { return A + (B - A) * Alpha; };
+			auto VectorDistance = [](const FVector& A, const FVector& B) { return (A - B).norm(); };
+			TranslationKeys = ReduceKeyframes(Translations, Times, Options.TranslationTolerance, LerpVector, VectorDistance);
+			ScaleKeys = ReduceKeyframes(Scales, Times, Options.ScaleTolerance, LerpVector, VectorDistance);
+			RotationKeys = ReduceKeyframes(Rotations, Times, Options.RotationTolerance,
+				[](const FQuat& A, const FQuat& B, double Alpha) { return A.slerp(Alpha, B); },
+				[](const FQuat& A, const FQuat& B) { return A.angularDistance(B); });
+		}
+
+		// Channels with the same key set share one time accessor
+		TMap<TArray<int>, int> TimeAccessors;
+		auto GetTimeAccessor = [&](const TArray<int>& Keys) {
+			auto It = TimeAccessors.find(Keys);
+			if (It != TimeAccessors.end())
+				return It->second;
+			return TimeAccessors[Keys] = AddTimeAccessor(Times, Keys);
+		};
+
+		int TranslationView = AddBufferView(TranslationKeys.size() * 3 * sizeof(float), 0, [&Transforms, TranslationKeys](std::ostream& Stream) {
+			for (int Key : TranslationKeys)
+			{
+				const FVector& t = Transforms[Key].GetTranslation();
+				float v[3] = {float(t.x()), float(t.y()), float(t.z())};
+				WriteRaw(Stream, v, 3);
+			}
+		});
+		AddChannel(NodeIndex, "translation", GetTimeAccessor(TranslationKeys),
+			AddAccessor(TranslationView, TINYGLTF_COMPONENT_TYPE_FLOAT, TranslationKeys.size(), TINYGLTF_TYPE_VEC3));
+
+		int RotationView = AddBufferView(RotationKeys.size() * 4 * sizeof(float), 0, [&Transforms, RotationKeys](std::ostream& Stream) {
+			for (int Key : RotationKeys)
+			{
+				const FQuat& r = Transforms[Key].GetRotation();
+				float v[4] = {float(r.x()), float(r.y()), float(r.z()), float(r.w())};
+				WriteRaw(Stream, v, 4);
+			}
+		});
+		AddChannel(NodeIndex, "rotation", GetTimeAccessor(RotationKeys),
+			AddAccessor(RotationView, TINYGLTF_COMPONENT_TYPE_FLOAT, RotationKeys.size(), TINYGLTF_TYPE_VEC4));
+
+		int ScaleView = AddBufferView(ScaleKeys.size() * 3 * sizeof(float), 0, [&Transforms, ScaleKeys](std::ostream& Stream) {
+			for (int Key : ScaleKeys)
+			{
+				const FVector& s = Transforms[Key].GetScale();
+				float v[3] = {float(s.x()), float(s.y()), float(s.z())};
+				WriteRaw(Stream, v, 3);
+			}
+		});
+		AddChannel(NodeIndex, "scale", GetTimeAccessor(ScaleKeys),
+			AddAccessor(ScaleView, TINYGLTF_COMPONENT_TYPE_FLOAT, ScaleKeys.size(), TINYGLTF_TYPE_VEC3));
+	}
+	if (!animation.channels.empty())
+		model.animations.push_back(animation);
+	model.scenes.push_back(scene);
+	model.defaultScene = 0;
+
+	// Serialize the json without buffers, then splice in the single buffer description
+	Path OutputPath(FilePath);
+	const String BinFileName = OutputPath.FileNameWithoutExtension().string() + ".bin";
+	std::ostringstream JsonStream;
+	tinygltf::TinyGLTF writer;
+	if (!writer.WriteGltfSceneToStream(&model, JsonStream, false, false))
+	{
+		LOG_ERROR("Failed to serialize glTF json for: {}", FilePath);
+		return false;
+	}
+	String Json = JsonStream.str();
+	// File names may hold quotes or backslashes, let the json writer escape the uri like tinygltf does for its own
+	nlohmann::json BufferObject = {{"byteLength", BufferLength}};
+	if (!Options.bBinary)
+		BufferObject["uri"] = BinFileName;
+	String BufferJson = "\"buffers\":[" + BufferObject.dump() + "]";
+	const size_t ObjectBegin = Json.find('{');
+	Json.insert(ObjectBegin + 1, Json[Json.find_first_not_of(" \n\r\t", ObjectBegin + 1)] == '}' ? BufferJson : BufferJson + ",");
+
+	std::ofstream File(FilePath, std::ios::binary);
+	std::ofstream BinFile;
+	if (!File.good())
+	{
+		LOG_ERROR("Open file for glTF export failed: {}", FilePath);
+		return false;
+	}
+	std::ostream* BinStream = &File;
+	if (Options.bBinary)
+	{
+		// GLB: header, json chunk padded with spaces, bin chunk padded with zeros
+		while (Json.size() % 4 != 0)
+			Json.push_back(' ');
+		const uint32_t JsonChunkLength = Json.size();
+		const uint32_t BinChunkLength = BufferLength;
+		const uint32_t TotalLength = 12 + 8 + JsonChunkLength + 8 + BinChunkLength;
+		const uint32_t Header[3] = {0x46546C67u /* glTF */, 2u, TotalLength};
+		const uint32_t JsonChunkHeader[2] = {JsonChunkLength, 0x4E4F534Au /* JSON */};
+		const uint32_t BinChunkHeader[2] = {BinChunkLength, 0x004E4942u /* BIN */};
+		WriteRaw(File, Header, 3);
+		WriteRaw(File, JsonChunkHeader, 2);
+		File.write(Json.data(), Json.size());
+		WriteRaw(File, BinChunkHeader, 2);
+	}
+	else
+	{
+		File << Json;
+		BinFile.open(OutputPath.parent_path() / BinFileName, std::ios::binary);
+		if (!BinFile.good())
+		{
+			LOG_ERROR("Open bin file for glTF export failed: {}", BinFileName);
+			return false;
+		}
+		BinStream = &BinFile;
+	}
+
+	size_t Written = 0;
+	for (const BufferSegment& Segment : Segments)
+	{
+		BinStream->write(Padding, Segment.ByteOffset - Written);
+		Segment.Writer(*BinStream);
+		Written = Segment.ByteOffset + Segment.ByteLength;
+		if (Progress)
+			Progress->store(BufferLength > 0 ? float(double(Written) / BufferLength) : 1.f);
+	}
+	BinStream->write(Padding, BufferLength - Written);
+
+	if (!BinStream->good() || !File.good())
+	{
+		LOG_ERROR("Write glTF export failed: {}", FilePath);
+		return false;
+	}
+	LOG_INFO("Successfully exported GLTF/GLB to: {}, {} unique meshes for {} tracks", FilePath, Meshes.size(), Tracks.size());
+	return true;
+}
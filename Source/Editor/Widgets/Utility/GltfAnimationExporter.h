@@ -0,0 +1,108 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Math/FTransform.h"
+#include <atomic>
+#include <ostream>
+
+class StaticMesh;
+
+/**
+ * Streaming glTF/GLB exporter for transform animations.
+ * Mesh and keyframe data are snapshotted on the calling thread by AddMesh/AddTrack, Export can then run
+ * on a background thread. The layout is planned up front so the binary chunk is streamed to disk
+ * segment by segment instead of building the whole buffer in memory.
+ */
+class GltfAnimationExporter
+{
+public:
+	struct ExportOptions
+	{
+		bool bBinary = true;
+
+		// Animation length in seconds, keyframes are evenly distributed
+		double Duration = 2.0;
+
+		// Remove keyframes that are reproduced by interpolating their neighbours within tolerance, off keeps every key
+		bool bReduceKeyframes = false;
+		double TranslationTolerance = 1e-5;
+		double RotationTolerance = 1e-5; // in radians
+		double ScaleTolerance = 1e-5;
+	};
+
+	/**
+	 * Snapshot a mesh, meshes with identical geometry are stored once and shared by their tracks.
+	 * @return index of the mesh to pass to AddTrack
+	 */
+	int AddMesh(const StaticMesh& Mesh);
+
+	/**
+	 * Snapshot an animation track
+	 * @param MeshIndex mesh returned by AddMesh, -1 for a track without mesh
+	 */
+	void AddTrack(const String& Name, int MeshIndex, TArray<FTransform> Transforms);
+
+	/**
+	 * Write the snapshot to file, thread safe with respect to the exported scene.
+	 * @param Progress optional, updated in [0, 1] by bytes written
+	 * @return true if the file is written
+	 */
+	bool Export(const String& FilePath, const ExportOptions& Options, std::atomic<float>* Progress = nullptr) const;
+
+	/**
+	 * Greedy keyframe reduction, keep the minimal set of keys such that every dropped key is within
+	 * Tolerance of the interpolation between the kept keys around it.
+	 * @return indices of the kept keyframes, always include the first and the last one
+	 */
+	template <class T, class InterpolateFunc, class DistanceFunc>
+	static TArray<int> ReduceKeyframes(const TArray<T>& Values, const TArray<float>& Times, double Tolerance,
+		InterpolateFunc&& Interpolate, DistanceFunc&& Distance);
+
+protected:
+	struct MeshSnapshot
+	{
+		TArray<float> Positions;
+		TArray<uint32_t> Indices;
+		float Min[3] = {0, 0, 0};
+		float Max[3] = {0, 0, 0};
+		size_t Hash = 0;
+	};
+
+	struct TrackSnapshot
+	{
+		String Name;
+		int MeshIndex = -1;
+		TArray<FTransform> Transforms;
+	};
+
+	TArray<MeshSnapshot> Meshes;
+	TArray<TrackSnapshot> Tracks;
+};
+
+template <class T, class InterpolateFunc, class DistanceFunc>
+TArray<int> GltfAnimationExporter::ReduceKeyframes(const TArray<T>& Values, const TArray<float>& Times, double Tolerance,
+	InterpolateFunc&& Interpolate, DistanceFunc&& Distance)
+{
+	const int Num = Values.size();
+	TArray<int> Kept;
+	if (Num == 0)
+		return Kept;
+	Kept.push_back(0);
+	int Anchor = 0;
+	for (int Candidate = 2; Candidate < Num; Candidate++)
+	{
+		bool bFits = true;
+		for (int i = Anchor + 1; i < Candidate && bFits; i++)
+		{
+			const double Alpha = (Times[i] - Times[Anchor]) / (Times[Candidate] - Times[Anchor]);
+			bFits = Distance(Interpolate(Values[Anchor], Values[Candidate], Alpha), Values[i]) <= Tolerance;
+		}
+		if (!bFits)
+		{
+			Anchor = Candidate - 1;
+			Kept.push_back(Anchor);
+		}
+	}
+	if (Num > 1)
+		Kept.push_back(Num - 1);
+	return Kept;
+}
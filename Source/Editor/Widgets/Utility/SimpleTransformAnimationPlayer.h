@@ -7,6 +7,8 @@
 #include "Math/FTransform.h"
 #include <ImguiPlus.h>
 #include "Game/Actor.h"
+#include "GltfAnimationExporter.h"
+#include <future>
 
 class SimpleTransformAnimationPlayer: public UIWidget
 {
@@ -22,7 +24,12 @@ public:
 
     virtual void Draw() override;
 
-    void ExportToGltf(std::string& Path, bool bBinary = true);
+    /* Snapshot the tracks and export them on a background thread, progress is shown by Draw.
+     * @return false if another export is still running
+    */
+    bool ExportToGltf(const std::string& Path, bool bBinary = true);
+
+    bool IsExporting() const { return ExportTask.valid(); }
 
 protected:
     struct Track {
@@ -36,9 +43,17 @@ protected:
     double lastTime = 0.0;
     bool bIsPlaying = false;
     bool bLoop = false;
+    bool bReduceKeyframes = false;
+
+    // Progress is declared before the task so the task is joined before the progress it writes is destroyed
+    std::atomic<float> ExportProgress = 0.f;
+    std::string ExportPath;
+    std::future<bool> ExportTask;
 
 private:
     void ApplyCurrentFrame();
 
+    void DrawExportStatus();
+
     static FTransform GetInterpolatedTransform(const TArray<FTransform>& Transforms, double InPercent);
 };
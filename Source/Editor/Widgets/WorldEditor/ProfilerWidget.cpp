@@ -0,0 +1,108 @@
+#include "ProfilerWidget.h"
+#include <algorithm>
+#include <cstring>
+#include "imgui.h"
+#include "OsDialogs.h"
+#include "Game/World.h"
+#include "Misc/Path.h"
+#include "Misc/Profiler.h"
+#include "Render/GpuSceneInterface.h"
+#include "UI/IconsFontAwesome6.h"
+
+namespace
+{
+	const std::vector<std::string> TraceFilesFilter = { "Chrome Trace Files (.json)", "*.json" };
+
+	struct ZoneSummary
+	{
+		uint ThreadId;
+		const char* Name;
+		double TotalMs = 0.;
+		int Calls = 0;
+	};
+}
+
+void ProfilerWidget::Draw()
+{
+	if (!ImGui::Begin(ICON_FA_CHART_BAR "  Profiler"))
+	{
+		ImGui::End();
+		return;
+	}
+
+	auto& FrameProfiler = Profiler::Get();
+#if ENABLE_PROFILER
+	bool bEnabled = FrameProfiler.IsEnabled();
+	if (ImGui::Checkbox("Record", &bEnabled))
+		FrameProfiler.SetEnabled(bEnabled);
+	ImGui::SameLine();
+	if (ImGui::Button(ICON_FA_FILE_EXPORT " Export Trace"))
+	{
+		auto SavePath = SaveFileDialog("Save Trace", (Path::ProjectLogDir() / "Trace.json").string(), TraceFilesFilter).result();
+		if (!SavePath.empty())
+			FrameProfiler.ExportChromeTrace(SavePath);
+	}
+#else
+	ImGui::TextDisabled("Profiler zones are compiled out of this build, see ME_ENABLE_PROFILER");
+#endif
+
+	const auto Frame = FrameProfiler.GetLastFrame();
+	if (!Frame.Zones.empty())
+	{
+		ImGui::Text("Frame %llu: %.2f ms", static_cast<unsigned long long>(Frame.Index), (Frame.EndNs - Frame.StartNs) * 1e-6);
+
+		// Sum the zones of the same thread and name, nested zones are listed along with their parents
+		TArray<ZoneSummary> Summaries;
+		for (const auto& Zone : Frame.Zones)
+		{
+			auto It = std::ranges::find_if(Summaries, [&](const ZoneSummary& Summary) {
+				return Summary.ThreadId == Zone.ThreadId && std::strcmp(Summary.Name, Zone.Name) == 0;
+			});
+			if (It == Summaries.end())
+				It = Summaries.insert(Summaries.end(), ZoneSummary{Zone.ThreadId, Zone.Name});
+			It->TotalMs += (Zone.EndNs - Zone.StartNs) * 1e-6;
+			It->Calls++;
+		}
+		std::ranges::sort(Summaries, [](const ZoneSummary& A, const ZoneSummary& B) {
+			return A.ThreadId != B.ThreadId ? A.ThreadId < B.ThreadId : A.TotalMs > B.TotalMs;
+		});
+
+		if (ImGui::BeginTable("ProfilerZones", 4, ImGuiTableFlags_BordersH | ImGuiTableFlags_SizingStretchProp))
+		{
+			ImGui::TableSetupColumn("Thread");
+			ImGui::TableSetupColumn("Zone");
+			ImGui::TableSetupColumn("ms");
+			ImGui::TableSetupColumn("Calls");
+			ImGui::TableHeadersRow();
+			for (const auto& [ThreadId, Name, TotalMs, Calls] : Summaries)
+			{
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(FrameProfiler.GetThreadName(ThreadId).c_str());
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(Name);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3f", TotalMs);
+				ImGui::TableNextColumn();
+				ImGui::Text("%d", Calls);
+			}
+			ImGui::EndTable();
+		}
+	}
+
+	if (!Frame.Counters.empty() && ImGui::CollapsingHeader("Counters", ImGuiTreeNodeFlags_DefaultOpen))
+	{
+		for (const auto& [Name, Value] : Frame.Counters)
+			ImGui::Text("%s: %.0f", Name, Value);
+	}
+
+	if (auto Scene = World->GetScene(); Scene && ImGui::CollapsingHeader("GPU Memory", ImGuiTreeNodeFlags_DefaultOpen))
+	{
+		const auto Stats = Scene->GetGpuMemoryStats();
+		for (const auto& [Name, Bytes] : Stats.ProxyBytes)
+			ImGui::Text("%s: %.2f MB", Name.c_str(), Bytes / 1024. / 1024.);
+		ImGui::Text("Total: %.2f MB", Stats.TotalBytes / 1024. / 1024.);
+		ImGui::Text("Pending releases: %zu", Stats.PendingReleaseNum);
+	}
+	ImGui::End();
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include "UIWidget.h"
+#include "Core/CoreMinimal.h"
+
+/**
+ * Live view of the frame profiler, the zones of the last frame are summed by thread and name.
+ * Also shows the frame counters and the GPU memory of the scene proxies, and exports the kept frames as a Chrome trace.
+ */
+class EDITOR_API ProfilerWidget : public UIWidget
+{
+public:
+	ProfilerWidget() : UIWidget("ProfilerWidget") {}
+
+	virtual void Draw() override;
+};
@@ -1,4 +1,5 @@
 #include "TransformGizmo.h"
+#include "Editor.h"
 #include "Imguizmo/Imguizmo.h"
 #include "Game/Actor.h"
 #include "UI/UIWidget.h"
@@ -55,7 +56,10 @@ void TransformGizmo::Draw()
 	// Only call if actually changed; otherwise, triggers on all mouse events
 	if (LastUsing == ThisId && diff > 1e-7)
 	{
-		SelectedActor->SetTransform(Affine3d(T.cast<double>()));
+		GEditor.EditWorld([Target = WeakObjectPtr<Actor>(SelectedActor->GetThis()), Transform = Affine3d(T.cast<double>())](class World&) {
+			if (auto Pinned = Target.lock())
+				Pinned->SetTransform(Transform);
+		});
 	}
 	if (ImGuizmo::IsUsing()) LastUsing = ThisId;
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 //
 
 #include "WorldOutliner.h"
+#include "Editor.h"
 
 #include "PrettifyName.h"
 #include "imgui.h"
@@ -57,7 +58,10 @@ void WorldOutliner::Draw()
 		{
 			if (SelectedActor)
 			{
-				World->DestroyActor(SelectedActor.get());
+				GEditor.EditWorld([ToDestroy = WeakObjectPtr<Actor>(SelectedActor)](class World& InWorld) {
+					if (auto Target = ToDestroy.lock())
+						InWorld.DestroyActor(Target.get());
+				});
 			}
 		}
 		ImGui::End();
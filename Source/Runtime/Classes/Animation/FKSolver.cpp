@@ -1,5 +1,6 @@
 #include "FKSolver.h"
 #include <queue>
+#include "IKJoint.h"
 
 FKSolver::FKSolver()
 { }
@@ -17,16 +18,121 @@ void FKSolver::Init()
     SortJoints();
     for(auto Joint: Joints)
         Joint->CalcLocal();
+	CompileTree();
 }
 
 double FKSolver::Solve()
 {
-    for(auto Joint: Joints)
-    	if(!Joint->IsRootJoint())
-    		Joint->CalcGlobal();
+	GatherDrives();
+	const VectorXd Parameter = GatherParameter();
+	TArray<FTransform> Globals;
+	Tree.Evaluate(Parameter, Globals);
+	WriteBack(Parameter, Globals);
 	return true;
 }
 
+void FKSolver::CompileTree()
+{
+	Tree.Reset();
+	const int Num = static_cast<int>(Joints.size());
+	TMap<const Joint*, int> JointIndices;
+	for (int i = 0; i < Num; i++)
+		JointIndices[Joints[i].get()] = i;
+
+	for (int i = 0; i < Num; i++)
+	{
+		const auto& Current = Joints[i];
+		int Parent = -1;
+		if (!Current->IsRootJoint())
+		{
+			auto It = JointIndices.find(Current->GetParentJoint().get());
+			if (It != JointIndices.end() && It->second < i)
+				Parent = It->second;
+			else
+				LOG_ERROR("Parent of joint {} is not sorted before it, the joint is kept as a root", i);
+		}
+		Tree.Parents.push_back(Parent);
+		Tree.LocalTransforms.push_back(Current->LocalTransform);
+
+		int Offset = -1;
+		uint8 RotationDOF = FreeNone, TranslationDOF = FreeNone;
+		if (auto IK = Cast<IKJoint>(Current.get()); IK && IK->ParameterNum() > 0)
+		{
+			Offset = Tree.ParameterNum;
+			RotationDOF = IK->GetRotationDOF();
+			TranslationDOF = IK->GetTranslationDOF();
+			Tree.ParameterNum += IK->ParameterNum();
+			Tree.SlotJoints.resize(Tree.ParameterNum, i);
+		}
+		Tree.ParameterOffsets.push_back(Offset);
+		Tree.RotationDOFs.push_back(RotationDOF);
+		Tree.TranslationDOFs.push_back(TranslationDOF);
+	}
+	Tree.DriveTransforms.resize(Num);
+	GatherDrives();
+}
+
+void FKSolver::GatherDrives()
+{
+	for (int i = 0; i < Tree.JointNum(); i++)
+	{
+		if (Tree.IsRoot(i))
+			Tree.DriveTransforms[i] = Joints[i]->GlobalTransform;
+		else if (Tree.ParameterOffsets[i] < 0)
+			Tree.DriveTransforms[i] = Joints[i]->AddTransform;
+	}
+}
+
+void FKSolver::WriteBack(const VectorXd& Parameter, const TArray<FTransform>& Globals)
+{
+	for (int i = 0; i < Tree.JointNum(); i++)
+	{
+		const auto& Current = Joints[i];
+		if (const int Offset = Tree.ParameterOffsets[i]; Offset >= 0)
+		{
+			auto IK = Cast<IKJoint>(Current.get());
+			VectorXd JointParameter = Parameter.segment(Offset, IK->ParameterNum());
+			IK->SetParameter(JointParameter);
+		}
+		if (!Tree.IsRoot(i))
+			Current->GlobalTransform = Globals[i];
+	}
+}
+
+VectorXd FKSolver::GatherParameter() const
+{
+	VectorXd Result(ParameterNum());
+	int ParameterCount = 0;
+	for(auto i : Joints)
+	{
+		if(auto IK = Cast<IKJoint>(i))
+		{
+			if(IK->ParameterNum() == 0) continue;
+			VectorXd Parameter = IK->GetParameter();
+			Result.segment(ParameterCount, Parameter.size()) = Parameter;
+			ParameterCount += Parameter.size();
+		}
+	}
+	return Result;
+}
+
+int FKSolver::ParameterNum() const
+{
+	int Num = 0;
+	for(auto i : Joints)
+		if (const auto IK = Cast<IKJoint>(i))
+			Num += IK->ParameterNum();
+	return Num;
+}
+
+int FKSolver::FindJointIndex(const Joint* InJoint) const
+{
+	for (int i = 0; i < static_cast<int>(Joints.size()); i++)
+		if (Joints[i].get() == InJoint)
+			return i;
+	return -1;
+}
+
 void FKSolver::SortJoints()
 {
 	std::queue<ObjectPtr<Joint>> Q;
@@ -1,13 +1,25 @@
 #pragma once
 #include "Core/CoreMinimal.h"
 #include "Animation/Joints.h"
+#include "Animation/KinematicTree.h"
 class ENGINE_API FKSolver : public Object
 {
 protected:
     std::set<ObjectPtr<Joint>> JointsSet;
     TArray<ObjectPtr<Joint>> Joints;
 	TArray<ObjectPtr<Joint>> Roots;
+	// Joints flattened in sorted order, compiled by Init
+	KinematicTree Tree;
     void AddJoints(){}
+
+	/// \brief Flatten the sorted joints into Tree, local transforms should be calculated first
+	void CompileTree();
+
+	/// \brief Copy root transforms and AddTransforms of joints without parameters into Tree, they are driven outside the solver
+	void GatherDrives();
+
+	/// \brief Write evaluated global transforms and parameters back to the joints, once per solve
+	void WriteBack(const VectorXd& Parameter, const TArray<FTransform>& Globals);
 public:
     FKSolver();
 	FKSolver(TArray<ObjectPtr<Joint>>&& InJoints);
@@ -50,4 +62,14 @@ public:
     }
 
     TArray<ObjectPtr<Joint>> FindRoots();
+
+	/// \brief Gather current parameter from system
+	/// \return Parmeter vector
+	VectorXd GatherParameter() const;
+	int ParameterNum() const;
+
+	/// \return Index of the joint in Tree, -1 if the joint is not in the solver
+	int FindJointIndex(const Joint* InJoint) const;
+
+	[[nodiscard]] const KinematicTree& GetKinematicTree() const { return Tree; }
 };
\ No newline at end of file
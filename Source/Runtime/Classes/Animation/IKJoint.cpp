@@ -50,12 +50,17 @@ void IKJoint::SetTargetTransform(const FTransform& InTargetTransform)
 }
 
 Matrix4d IKJoint::CalcLoss() const
+{
+	return CalcLoss(GlobalTransform);
+}
+
+Matrix4d IKJoint::CalcLoss(const FTransform& InGlobalTransform) const
 {
 	if (!Target.Enable())
 		return Matrix4d::Zero();
 
 	Matrix4d TargetTransform = Target.GetTargetMatrix();
-	Matrix4d Loss = GlobalTransform.GetMatrix() - TargetTransform;
+	Matrix4d Loss = InGlobalTransform.GetMatrix() - TargetTransform;
 	if (!Target.PositionEnabled)
 	{
 		for (int i = 0; i < 3; i++)
@@ -66,6 +66,9 @@ public:
 	/// \return Loss in Matrix4d
 	Matrix4d CalcLoss() const;
 
+	/// \brief Calc loss of a global transform evaluated outside the joint, like in a compiled KinematicTree
+	Matrix4d CalcLoss(const FTransform& InGlobalTransform) const;
+
 	/// \brief Set parameter for this joint, from ik solver
 	void SetParameter(VectorXd& InParameter);
 
@@ -90,4 +93,6 @@ public:
 
 	// Set dof for rotation and translation
 	void SetDOF(EDOF3D InRotationDOF, EDOF3D InTranslationDOF);
+	FORCEINLINE EDOF3D GetRotationDOF() const { return RoatationDOF; }
+	FORCEINLINE EDOF3D GetTranslationDOF() const { return TranslationDOF; }
 };
\ No newline at end of file
@@ -3,27 +3,19 @@
 #include <unsupported/Eigen/NonLinearOptimization>
 
 int IKLossFunction::operator()(const Eigen::VectorXd& x, Eigen::VectorXd& fvec) const
+{
+	TArray<FTransform> Globals;
+	Tree->Evaluate(x, Globals);
+	CalcLoss(Globals, fvec);
+	return 0;
+}
+
+void IKLossFunction::CalcLoss(const TArray<FTransform>& Globals, Eigen::VectorXd& fvec) const
 {
 	Matrix4d Result = Matrix4d::Zero();
 	LossHistory = 0.;
-	VectorXd Parameter = x.eval();
-
-	// Set parameter for all IK joints
-	for (auto i : Joints)
-		if (auto IKjoint = Cast<IKJoint>(i))
-			IKjoint->SetParameter(Parameter);
-
-	// Should consume all parameter dimension
-	ASSERTMSG(Parameter.size() == 0, "Parameter size not match");
-
-	// FK
-	for (auto i : Joints)
-		i->CalcGlobal();
-
-	// Calc loss
-	for (auto i : Joints)
-		if (auto IKjoint = Cast<IKJoint>(i))
-			Result += IKjoint->CalcLoss();
+	for (const auto& [Index, IKjoint] : Targets)
+		Result += IKjoint->CalcLoss(Globals[Index]);
 
 	fvec.resize(values());
 	for (int i = 0; i < 3; i++)
@@ -34,7 +26,6 @@ int IKLossFunction::operator()(const Eigen::VectorXd& x, Eigen::VectorXd& fvec)
 			LossHistory += std::pow(fvec(i * 4 + j), 2);
 		}
 	}
-	return 0;
 }
 
 int IKLossFunction::df(const VectorXd& x, MatrixXd& fjac) const
@@ -42,21 +33,37 @@ int IKLossFunction::df(const VectorXd& x, MatrixXd& fjac) const
 	fjac.resize(values(), inputs());
 	fjac.setZero();
 
-	VectorXd epc;
-	double	 tol = 0.0001;
-	epc.resize(inputs());
+	double tol = 0.0001;
+	// Columns are x + e_i, x - e_i for each parameter, evaluated in one batch
+	MatrixXd Columns = x.replicate(1, 2 * inputs());
+	for (int itr = 0; itr < inputs(); itr++)
+	{
+		Columns(itr, 2 * itr) += tol;
+		Columns(itr, 2 * itr + 1) -= tol;
+	}
+	TArray<TArray<FTransform>> Globals;
+	Tree->EvaluateBatch(Columns, Globals);
+
 	Eigen::VectorXd LossPlus, LossMinus;
 	for (int itr = 0; itr < inputs(); itr++)
 	{
-		epc.setZero();
-		epc(itr) = tol;
-		operator()(x + epc, LossPlus);
-		operator()(x - epc, LossMinus);
+		CalcLoss(Globals[2 * itr], LossPlus);
+		CalcLoss(Globals[2 * itr + 1], LossMinus);
 		fjac.col(itr) = (LossPlus - LossMinus) / (2.0 * tol);
 	}
 	return 0;
 }
 
+IKLossFunction IKSolver::MakeLossFunction() const
+{
+	IKLossFunction LossFunc(Tree.ParameterNum);
+	LossFunc.Tree = &Tree;
+	for (int i = 0; i < Tree.JointNum(); i++)
+		if (auto IKjoint = Cast<IKJoint>(Joints[i].get()); IKjoint && IKjoint->IsEnableTarget())
+			LossFunc.Targets.emplace_back(i, IKjoint);
+	return LossFunc;
+}
+
 void IKSolver::Init()
 {
 	FKSolver::Init();
@@ -66,14 +73,14 @@ void IKSolver::Init()
 double IKSolver::Solve()
 {
 	VectorXd Parameter = PreParameter; // Use parameter from previor solve as init
-	ASSERTMSG(Parameter.size() == ParameterNum(), "Parameter size not match");
+	ASSERTMSG(Parameter.size() == Tree.ParameterNum, "Parameter size not match");
 
-	IKLossFunction LossFunc(ParameterNum());
-	LossFunc.Joints = Joints;
+	GatherDrives();
+	IKLossFunction LossFunc = MakeLossFunction();
 
 	Eigen::LevenbergMarquardt<IKLossFunction, double> lm(LossFunc);
 	int ret = lm.minimize(Parameter);
-	ASSERTMSG(Parameter.size() == ParameterNum(), "Parameter size not match");
+	ASSERTMSG(Parameter.size() == Tree.ParameterNum, "Parameter size not match");
 
 	const bool Valid = ((ret == 2) && (LossFunc.LossHistory < eps));
 	if(!Valid) // Recover parameter
@@ -83,40 +90,9 @@ double IKSolver::Solve()
 	LOG_INFO("Return type: {}  Loss: {}",ret, LossFunc.LossHistory);
 
 	//Apply result parameter to system
-	for(auto i : Joints)
-		if(auto IKjoint = Cast<IKJoint>(i))
-			IKjoint->SetParameter(Parameter);
-
-	ASSERTMSG(Parameter.size() == 0, "Parameter size not match");
-	for(auto Joint: Joints)
-		if(!Joint->IsRootJoint())
-			Joint->CalcGlobal();
+	TArray<FTransform> Globals;
+	Tree.Evaluate(Parameter, Globals);
+	WriteBack(Parameter, Globals);
 
 	return Valid;
 }
-
-VectorXd IKSolver::GatherParameter() const
-{
-	VectorXd Result(ParameterNum());
-	int ParameterCount = 0;
-	for(auto i : Joints)
-	{
-		if(auto IK = Cast<IKJoint>(i))
-		{
-			if(IK->ParameterNum() == 0) continue;
-			VectorXd Parameter = IK->GetParameter();
-			Result.segment(ParameterCount, Parameter.size()) = Parameter;
-			ParameterCount += Parameter.size();
-		}
-	}
-	return Result;
-}
-
-int IKSolver::ParameterNum() const
-{
-	int Num = 0;
-	for(auto i : Joints)
-		if (const auto IK = Cast<IKJoint>(i))
-			Num += IK->ParameterNum();
-	return Num;
-}
\ No newline at end of file
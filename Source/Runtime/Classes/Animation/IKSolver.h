@@ -6,6 +6,8 @@
 
 #include <unsupported/Eigen/src/NumericalDiff/NumericalDiff.h>
 
+class IKJoint;
+
 template <typename _Scalar, int NX = Eigen::Dynamic, int NY = Eigen::Dynamic>
 struct IKBaseFunctor
 {
@@ -36,7 +38,9 @@ struct IKLossFunction : IKBaseFunctor<double>
 	IKLossFunction(int ParameterDimension)
 	: IKBaseFunctor<double>(ParameterDimension, 12), ParameterDimension(ParameterDimension) {}
 	int ParameterDimension;
-	std::vector<ObjectPtr<Joint>> Joints;
+	const KinematicTree* Tree = nullptr;
+	// Joints with an enabled target and their index in Tree
+	TArray<std::pair<int, const IKJoint*>> Targets;
 
 	/// \brief calc loss of full body ik
 	/// \param x Parameter of full body
@@ -45,6 +49,9 @@ struct IKLossFunction : IKBaseFunctor<double>
 	int operator()(const Eigen::VectorXd &x, Eigen::VectorXd &fvec) const;
 	int df(const VectorXd &x, MatrixXd &fjac) const;
 
+	/// \brief Loss of evaluated global transforms
+	void CalcLoss(const TArray<FTransform>& Globals, Eigen::VectorXd& fvec) const;
+
 
 	mutable double LossHistory;
 };
@@ -57,6 +64,9 @@ class ENGINE_API IKSolver : public FKSolver
 protected:
 	VectorXd PreParameter;
 
+	/// \brief Loss function evaluating the compiled tree, with targets gathered from the joints
+	IKLossFunction MakeLossFunction() const;
+
 public:
 	double TranslationWeight = 1.;
 	double eps = 1e-4;
@@ -64,9 +74,4 @@ public:
 
 	/// \brief Solve IK, and return if the solve is successful and one solution as parameter
     virtual double Solve() override;
-
-	/// \brief Gather current parameter from system
-	/// \return Parmeter vector
-	VectorXd GatherParameter() const;
-	int ParameterNum() const;
 };
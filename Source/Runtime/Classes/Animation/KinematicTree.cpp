@@ -0,0 +1,71 @@
+#include "KinematicTree.h"
+#include "Math/LinearAlgebra.h"
+
+void KinematicTree::Reset()
+{
+	Parents.clear();
+	LocalTransforms.clear();
+	DriveTransforms.clear();
+	ParameterOffsets.clear();
+	RotationDOFs.clear();
+	TranslationDOFs.clear();
+	SlotJoints.clear();
+	ParameterNum = 0;
+}
+
+FTransform KinematicTree::MakeAddTransform(int Index, const VectorXd& Parameter) const
+{
+	int Slot = ParameterOffsets[Index];
+	FVector RotationEuler = FVector::Zero();
+	FVector Location = FVector::Zero();
+	for (int Axis = 0; Axis < 3; Axis++)
+		if (RotationDOFs[Index] & (1 << Axis))
+			RotationEuler[Axis] = Parameter(Slot++);
+	for (int Axis = 0; Axis < 3; Axis++)
+		if (TranslationDOFs[Index] & (1 << Axis))
+			Location[Axis] = Parameter(Slot++);
+	return FTransform(Location, MMath::QuaternionFromEulerXYZ(RotationEuler));
+}
+
+void KinematicTree::Evaluate(const VectorXd& Parameter, TArray<FTransform>& Globals, int FirstJoint) const
+{
+	ASSERTMSG(Parameter.size() == ParameterNum, "Parameter size not match");
+	const int Num = JointNum();
+	Globals.resize(Num);
+	for (int i = FirstJoint; i < Num; i++)
+	{
+		const int Parent = Parents[i];
+		if (Parent < 0)
+		{
+			Globals[i] = DriveTransforms[i];
+			continue;
+		}
+		// Same composition as Joint::CalcGlobal, (Parent * Local) * Add
+		const FTransform Global = Globals[Parent] * LocalTransforms[i];
+		Globals[i] = ParameterOffsets[i] >= 0 ? Global * MakeAddTransform(i, Parameter) : Global * DriveTransforms[i];
+	}
+}
+
+void KinematicTree::EvaluateBatch(const MatrixXd& Parameters, TArray<TArray<FTransform>>& Globals) const
+{
+	ASSERTMSG(Parameters.rows() == ParameterNum, "Parameter size not match");
+	const int ColumnNum = static_cast<int>(Parameters.cols());
+	Globals.resize(ColumnNum);
+	for (int Column = 0; Column < ColumnNum; Column++)
+	{
+		const VectorXd Parameter = Parameters.col(Column);
+		if (Column == 0)
+		{
+			Evaluate(Parameter, Globals[Column]);
+			continue;
+		}
+
+		// Slots are laid out in joint order, the first changed slot gives the first joint to sweep
+		int FirstSlot = 0;
+		while (FirstSlot < ParameterNum && Parameters(FirstSlot, Column) == Parameters(FirstSlot, Column - 1))
+			FirstSlot++;
+		Globals[Column] = Globals[Column - 1];
+		if (FirstSlot < ParameterNum)
+			Evaluate(Parameter, Globals[Column], SlotJoints[FirstSlot]);
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include "Core/CoreMinimal.h"
+#include "Math/FTransform.h"
+
+/**
+ * Joint graph of a kinematic solver flattened into arrays, in the sorted order of the solver.
+ * Parents always come before their children, so one forward sweep evaluates the whole tree.
+ * Evaluation only touches these arrays, the joints are read when compiled and written back by the solver.
+ */
+struct ENGINE_API KinematicTree
+{
+	// Parent index of each joint, -1 for roots
+	TArray<int> Parents;
+
+	// Transform relative to the parent at the initial pose
+	TArray<FTransform> LocalTransforms;
+
+	// Global transform of roots and AddTransform of joints without parameters, driven outside the solver
+	TArray<FTransform> DriveTransforms;
+
+	// First parameter slot of each joint, -1 for joints without parameters
+	TArray<int> ParameterOffsets;
+
+	// Free axes of the parameters, as EDOF3D bits. Rotation slots come first, then translation
+	TArray<uint8> RotationDOFs;
+	TArray<uint8> TranslationDOFs;
+
+	// Joint owning each parameter slot
+	TArray<int> SlotJoints;
+
+	int ParameterNum = 0;
+
+	[[nodiscard]] FORCEINLINE int JointNum() const { return static_cast<int>(Parents.size()); }
+
+	[[nodiscard]] FORCEINLINE bool IsRoot(int Index) const { return Parents[Index] < 0; }
+
+	void Reset();
+
+	/**
+	 * Evaluate global transforms for one parameter vector
+	 * @param Parameter Parameters of all joints, in the layout of FKSolver::GatherParameter
+	 * @param Globals Output global transforms, entries before FirstJoint should already be valid
+	 * @param FirstJoint Joints before this index are kept, used when only later parameters changed
+	 */
+	void Evaluate(const VectorXd& Parameter, TArray<FTransform>& Globals, int FirstJoint = 0) const;
+
+	/**
+	 * Evaluate global transforms for each column of Parameters.
+	 * Each column starts from the result of the previous one and only sweeps from the first joint whose parameters differ,
+	 * so finite difference columns only re-evaluate the joints after the perturbed one.
+	 * @param Parameters One parameter vector per column
+	 * @param Globals Output global transforms of each column
+	 */
+	void EvaluateBatch(const MatrixXd& Parameters, TArray<TArray<FTransform>>& Globals) const;
+
+	/** Transform added by the parameters of a joint, same as converting its JointParameter to FTransform */
+	[[nodiscard]] FTransform MakeAddTransform(int Index, const VectorXd& Parameter) const;
+};
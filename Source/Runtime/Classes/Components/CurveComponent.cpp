@@ -7,7 +7,6 @@
 #include "Curve/Curve.h"
 #include "CoreMinimal.h"
 #include "Game/Actor.h"
-#include "Mesh/BasicShapesLibrary.h"
 
 CurveComponent::CurveComponent(ObjectPtr<Curve> NewCurve)
 {
@@ -18,8 +17,7 @@ void CurveComponent::Init()
 	StaticMeshComponent::Init();
 	if (DrawMode == AsMesh)
 	{
-		MeshData = GenerateCurveMesh();
-		MeshData->CalcNormal();
+		UpdateCurveMesh();
 		Dirty = static_cast<StaticMeshDirtyTag>(Dirty ^ DIRTY_REMESH);
 	}
 }
@@ -28,13 +26,7 @@ void CurveComponent::Remesh()
 {
 	StaticMeshComponent::Remesh();
 	if (DrawMode == AsMesh)
-	{
-		auto PreMesh = MeshData;
-		MeshData = GenerateCurveMesh();
-		MeshData->CalcNormal();
-		if(PreMesh)
-			MeshData->SetMaterial(PreMesh->GetMaterialAsset());
-	}
+		UpdateCurveMesh();
 }
 void CurveComponent::PostEdit(Reflection::FieldAccessor& Field)
 {
@@ -90,8 +82,21 @@ double CurveComponent::CalcSimilarity(ObjectPtr<T> Others)
 }
 
 
-ObjectPtr<StaticMesh> CurveComponent::GenerateCurveMesh()
+void CurveComponent::UpdateCurveMesh()
 {
-    auto CurveMeshData = BasicShapesLibrary::GenerateCurveMesh(CurveData, Radius, CurveData->IsClosed(), CSG_NUM_N, SampleNum);
-    return CurveMeshData;
+	auto Result = SweepMesh.Update(CurveData->GetCurveData(), CurveData->IsClosed(), Radius, CSG_NUM_N, SampleNum);
+	if (SweepMesh.GetVertices().rows() == 0)
+		return;
+	if (Result == SweepMeshGenerator::EUpdateResult::Topology || !MeshData || MeshData->IsEmpty())
+	{
+		auto PreMesh = MeshData;
+		MeshData = NewObject<StaticMesh>(SweepMesh.GetVertices(), SweepMesh.GetTriangles());
+		if (PreMesh)
+			MeshData->SetMaterial(PreMesh->GetMaterialAsset());
+	}
+	else if (Result == SweepMeshGenerator::EUpdateResult::Vertices)
+	{
+		// Same indices, the cached mesh topology is reused for normals
+		MeshData->SetGeometry(SweepMesh.GetVertices());
+	}
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include "Curve/Curve.h"
 #include "Mesh/StaticMesh.h"
 #include "Components/StaticMeshComponent.h"
+#include "Mesh/SweepMeshGenerator.h"
 
 enum CurveDrawMode
 {
@@ -53,6 +54,9 @@ protected:
     // Vertex num per points, in a circle
     int CSG_NUM_N = 32;
 
-    ObjectPtr<StaticMesh> GenerateCurveMesh();
+    // Cached sweep, only regenerates the parts of the tube changed since last remesh
+    SweepMeshGenerator SweepMesh;
+
+    void UpdateCurveMesh();
 
 };
@@ -0,0 +1,11 @@
+#include "ParametricMeshComponent.h"
+#include "Mesh/StaticMesh.h"
+#include "Misc/Config.h"
+
+const MeshGeodesics& ParametricMeshComponent::GetGeodesics() const
+{
+	if (!Geodesics || !Geodesics->IsBoundTo(*MeshData))
+	{
+		Geodesics = MakeShared<MeshGeodesics>(*MeshData, GConfig.Get<double>("Geometry", "GeodesicHeatTimeScale"));
+	return *Geodesics;
+}
@@ -3,9 +3,9 @@
 //
 
 #pragma once
-#include <igl/exact_geodesic.h>
 #include "StaticMeshComponent.h"
 #include "Algorithm/GeometryProcess.h"
+#include "Mesh/MeshGeodesics.h"
 #include <igl/AABB.h>
 
 /**
@@ -151,32 +151,19 @@ public:
 		return {};
 	}
 
+	/**
+	 * Geodesic path on the mesh by the heat method, or by exact window propagation when bExactGeodesic is set
+	 */
 	virtual TArray<FVector> GeodicShortestPath(const FVector& Start, const FVector& End) const
 	{
 		ASSERTMSG(!Start.hasNaN() && !End.hasNaN(), "Start or End has NaN");
-		auto FindNearestTriangle = [&](const FVector& Pos) {
-			double Distance = std::numeric_limits<double>::max();
-			int Best = 0;
-			for (int i = 0;i < MeshData->triM.rows();i ++)
-			{
-				FVector V0 = MeshData->verM.row(MeshData->triM(i, 0));
-				FVector V1 = MeshData->verM.row(MeshData->triM(i, 1));
-				FVector V2 = MeshData->verM.row(MeshData->triM(i, 2));
-				FVector Center = (V0 + V1 + V2) / 3.;
-				if (double CD = (Center - Pos).norm(); Distance > CD)
-				{
-					Distance = CD;
-					Best = i;
-				}
-			}
-			return Best;
-		};
-		int StartTriIndex = FindNearestTriangle(Start);
-		int EndTriIndex = FindNearestTriangle(End);
-		return igl::exact_geodesic_path(MeshData->verM, MeshData->triM, Start, End,
-				StartTriIndex, EndTriIndex);;
+		const auto& Geodesic = GetGeodesics();
+		return bExactGeodesic ? Geodesic.ExactPath(Start, End) : Geodesic.Path(Start, End);
 	}
 
+	/** Heat method operators of the mesh, factorized on first use and again only when the mesh changes */
+	const MeshGeodesics& GetGeodesics() const;
+
 	virtual void PostEdit(Reflection::FieldAccessor& Field) override
 	{
 		StaticMeshComponent::PostEdit(Field);
@@ -195,4 +182,9 @@ protected:
 
 	MPROPERTY()
 	double MeshThickness = 0.;
+
+	MPROPERTY()
+	bool bExactGeodesic = false;
+
+	mutable SharedPtr<MeshGeodesics> Geodesics;
 };
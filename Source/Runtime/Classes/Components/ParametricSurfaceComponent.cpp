@@ -26,13 +26,24 @@ void ParametricSurfaceComponent::Init()
 	ActorComponent::Init();
 	Remesh();
 	MarkAsDirty(DIRTY_RENDERDATA);
+	UpdateAABBMesh();
+}
 
-	AABBMesh  = TriangularSurface(RulingLineNumU, RulingLineNumV,
-	[this](double u,double v){return Sample(u, v);}, false, SurfaceData->bIsClosed);
+void ParametricSurfaceComponent::UpdateAABBMesh()
+{
+	const auto& Cache = GetSurfaceCache();
+	AABBMesh = TriangularGrid(Cache.GetNumU(), Cache.GetNumV(), MatrixX3d(Cache.GetPoints()), MatrixX2d(Cache.GetUV()), false, Cache.IsClosed());
 	AABB.clear();
 	AABB.init(AABBMesh->GetVertices(), AABBMesh->GetTriangles());
 }
 
+const ParametricSurfaceCache& ParametricSurfaceComponent::GetSurfaceCache()
+{
+	if (!SurfaceCache.IsValid(SurfaceData.get(), RulingLineNumU, RulingLineNumV))
+		SurfaceCache.Build(SurfaceData.get(), RulingLineNumU, RulingLineNumV);
+	return SurfaceCache;
+}
+
 void ParametricSurfaceComponent::PostEdit(Reflection::FieldAccessor& Field)
 {
 	StaticMeshComponent::PostEdit(Field);
@@ -41,22 +52,23 @@ void ParametricSurfaceComponent::PostEdit(Reflection::FieldAccessor& Field)
 		Remesh();
 		MarkAsDirty(DIRTY_RENDERDATA);
 	}
+	else if (Field == NAME(SurfaceData) || Field == NAME(RulingLineNumU) || Field == NAME(RulingLineNumV))
+	{
+		SurfaceCache.Invalidate();
+		Remesh();
+		UpdateAABBMesh();
+		MarkAsDirty(DIRTY_RENDERDATA);
+	}
 }
 
 ObjectPtr<StaticMesh> ParametricSurfaceComponent::TriangularSurface(int NumU, int NumV, std::function<FVector(double, double)> SampleFunc ,bool NormalInside , bool ClosedSurface)
 {
     assert(NumU >= 3 && NumV >= 2);
-    ObjectPtr<StaticMesh> Result = NewObject<StaticMesh>();
 
     bool IsClosedPolygon    = ((SampleFunc(1., 0.) - SampleFunc(0., 0.)).norm() < 0.00001) | ClosedSurface;
-    // When closed, NumU gap with NumU lines, when open minus 1
-    int  InnerTriangleNum   = IsClosedPolygon? NumU * (NumV - 1) * 2 : (NumU - 1) * (NumV - 1) * 2;
-    int  EncloseTriangleNum = (!IsClosedPolygon) * 4;
     int  VertexNum          = NumU * NumV;
-
-    Result->verM.resize(VertexNum, 3);
-    Result->triM.resize(InnerTriangleNum, 3);
-	Result->SetUV(MatrixX2d::Zero(VertexNum, 2));
+    MatrixX3d VerM(VertexNum, 3);
+    MatrixX2d UV(VertexNum, 2);
     int    VertexIndex = 0;
     double StepU        = IsClosedPolygon ? 1. / (double)NumU : 1. / (double) (NumU - 1);
     double StepV        = 1. / (double)(NumV - 1);
@@ -67,10 +79,26 @@ ObjectPtr<StaticMesh> ParametricSurfaceComponent::TriangularSurface(int NumU, in
             double u = (double)UIndex * StepU;
             double v = (double)VIndex * StepV;
             if(VIndex == NumV - 1) v = 1.;
-        	Result->SetUV(VertexIndex, {u, v});
-        	Result->verM.row(VertexIndex++) = SampleFunc(u, v);
+        	UV.row(VertexIndex) = FVector2{u, v};
+        	VerM.row(VertexIndex++) = SampleFunc(u, v);
         }
     }
+	return TriangularGrid(NumU, NumV, std::move(VerM), std::move(UV), NormalInside, IsClosedPolygon);
+}
+
+ObjectPtr<StaticMesh> ParametricSurfaceComponent::TriangularGrid(int NumU, int NumV, MatrixX3d&& Vertices, MatrixX2d&& UV, bool NormalInside, bool IsClosedPolygon)
+{
+    assert(NumU >= 3 && NumV >= 2);
+    assert(Vertices.rows() == NumU * NumV && UV.rows() == NumU * NumV);
+    ObjectPtr<StaticMesh> Result = NewObject<StaticMesh>();
+
+    // When closed, NumU gap with NumU lines, when open minus 1
+    int  InnerTriangleNum   = IsClosedPolygon? NumU * (NumV - 1) * 2 : (NumU - 1) * (NumV - 1) * 2;
+    int  VertexNum          = NumU * NumV;
+
+    Result->verM = std::move(Vertices);
+    Result->triM.resize(InnerTriangleNum, 3);
+	Result->SetUV(std::move(UV));
     int TriangleIndex = 0;
 
     for (int VIndex = 0; VIndex < NumV - 1; VIndex++) {
@@ -106,8 +134,10 @@ ObjectPtr<StaticMesh> ParametricSurfaceComponent::TriangularSurface(int NumU, in
 ObjectPtr<StaticMesh> ParametricSurfaceComponent::Triangular() {
     double ThicknessFix = MeshThickness < 1e-4 ? 1e-3 : MeshThickness; // When nearlly zero, set to 1e-3 as alternative of two-sided surface
 
-    auto Inner  = TriangularSurface(RulingLineNumU, RulingLineNumV, [this, ThicknessFix](double u,double v){return SampleThickness(u, v, -ThicknessFix*0.5);}, true, SurfaceData->bIsClosed);
-    auto Outter = TriangularSurface(RulingLineNumU, RulingLineNumV, [this, ThicknessFix](double u,double v){return SampleThickness(u, v, ThicknessFix*0.5);}, false, SurfaceData->bIsClosed);
+    // Both sides are derived from the same cached grid, so a thickness change does not evaluate the surface again
+    const auto& Cache = GetSurfaceCache();
+    auto Inner  = TriangularGrid(RulingLineNumU, RulingLineNumV, Cache.GetVertices(-ThicknessFix*0.5), MatrixX2d(Cache.GetUV()), true, Cache.IsClosed());
+    auto Outter = TriangularGrid(RulingLineNumU, RulingLineNumV, Cache.GetVertices(ThicknessFix*0.5), MatrixX2d(Cache.GetUV()), false, Cache.IsClosed());
 
     assert(Inner->GetVertexNum() == Outter->GetVertexNum());
 
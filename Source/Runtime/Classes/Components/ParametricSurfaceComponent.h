@@ -3,6 +3,7 @@
 #include "Components/StaticMeshComponent.h"
 #include "Mesh/StaticMesh.h"
 #include "Surface/ParametricSurface.h"
+#include "Surface/ParametricSurfaceCache.h"
 
 MCLASS(ParametricSurfaceComponent)
 class ENGINE_API ParametricSurfaceComponent : public ParametricMeshComponent
@@ -35,6 +36,15 @@ public:
 	
     static ObjectPtr<StaticMesh> TriangularSurface(int NumU, int NumV, std::function<FVector(double, double)> SampleFunc, bool NormalInside, bool ClosedSurface = false);
 
+	/**
+	 * Triangular a grid of sampled vertices, vertex UIndex + VIndex * NumU
+	 * @param Vertices Grid vertices
+	 * @param UV Grid parameters
+	 * @param NormalInside If the normal is head to inside
+	 * @param IsClosedPolygon If the last column connects to the first one
+	 */
+	static ObjectPtr<StaticMesh> TriangularGrid(int NumU, int NumV, MatrixX3d&& Vertices, MatrixX2d&& UV, bool NormalInside, bool IsClosedPolygon);
+
 	FORCEINLINE bool ValidUV(double u, double v) const override { return true; }
 
     //Sample at inner surface (thickness = 0)
@@ -88,6 +98,9 @@ public:
     /// Triangular this surface 
     virtual ObjectPtr<StaticMesh> Triangular();
 
+	/// Grid evaluation of SurfaceData shared by the thickness samples, rebuilt only when the surface is replaced or edited, or the grid size changes
+	const ParametricSurfaceCache& GetSurfaceCache();
+
 	virtual double GetThickness() const override { return MeshThickness; }
 
 	virtual void SetThickness(double InThickness) override;
@@ -99,6 +112,10 @@ public:
 	virtual ObjectPtr<StaticMesh> GetZeroThicknessMesh() const override { return AABBMesh; }
 
 protected:
+	/// Zero thickness mesh and its AABB, used by projection
+	void UpdateAABBMesh();
+
+	ParametricSurfaceCache SurfaceCache;
 	ObjectPtr<StaticMesh> AABBMesh;
 	ObjectPtr<StaticMesh> DisplayMesh;
 	igl::AABB<MatrixX3d, 3> AABB;
@@ -31,9 +31,6 @@ public:
 
 	virtual UVMappingSampleResult SampleHit(double U, double V) const override;
 
-	virtual TArray<FVector> GeodicShortestPath(const FVector& Start, const FVector& End) const override;
-
-
 private:
 	// BVH tree which store the UV mesh, used to fast sample UV
 	bvh::v2::Bvh<BVHNode> BVHUVMesh;
@@ -5,10 +5,10 @@
 #include "SCParametricMeshComponent.h"
 
 #include "Algorithm/GeometryProcess.h"
+#include "Mesh/MeshFairingSolver.h"
 #include "igl/barycenter.h"
 #include "igl/barycentric_interpolation.h"
-#include "igl/cotmatrix.h"
-#include "igl/grad.h"
+#include "igl/doublearea.h"
 #include "igl/point_mesh_squared_distance.h"
 
 #include <bvh/v2/default_builder.h>
@@ -31,37 +31,22 @@ SCParametricMeshComponent::SCParametricMeshComponent(const ObjectPtr<StaticMesh>
 {
 	Eigen::MatrixX3d V,U;
 	Eigen::MatrixXi F;
-	Eigen::SparseMatrix<double> L;
 
 	V = PMesh->GetVertices();
 	F = PMesh->GetTriangles();
 	Vertices = V;
 	Indices = F;
-	// Compute Laplace-Beltrami operator: #V by #V
-	igl::cotmatrix(V,F,L);
-
-	// Alternative construction of same Laplacian
-	Eigen::SparseMatrix<double> G,K;
-	// Gradient/Divergence
-	igl::grad(V, F,G);
-	// Diagonal per-triangle "mass matrix"
-	VectorXd dblA;
-	igl::doublearea(V,F,dblA);
-	// Place areas along diagonal #dim times
-	const auto & T = 1.*(dblA.replicate(3,1)*0.5).asDiagonal();
-	// Laplacian K built as discrete divergence of gradient or equivalently
-	// discrete Dirichelet energy Hessian
-	K = -G.transpose() * T * G;
+	// Laplace-Beltrami operator of the input is kept over the flow, its pattern is analyzed once
+	MeshFairingSolver Solver(PMesh->GetTopology());
+	Solver.SetCotanWeights(V);
+	Solver.SetTimeStep(0.001);
 	U = V;
 	for(int i = 0; i < Iteration; i ++){
-		// Recompute just mass matrix on each step
-		Eigen::SparseMatrix<double> M;
-		igl::massmatrix(U,F,igl::MASSMATRIX_TYPE_BARYCENTRIC,M);
+		// Recompute just mass matrix on each step, only the numeric factorization is redone
+		Solver.SetMass(U);
 		// Solve (M-delta*L) U = M*U
-		const auto & S = (M - 0.001*L);
-		Eigen::SimplicialLLT<Eigen::SparseMatrix<double > > solver(S);
-		assert(solver.info() == Eigen::Success);
-		U = solver.solve(M*U).eval();
+		[[maybe_unused]] bool bSolved = Solver.Solve(U);
+		assert(bSolved);
 		// Compute centroid and subtract (also important for numerics)
 		VectorXd dblA;
 		igl::doublearea(U,F,dblA);
@@ -112,30 +97,6 @@ SCParametricMeshComponent::SCParametricMeshComponent(const ObjectPtr<StaticMesh>
 	AABB.init(PMesh->GetVertices(), PMesh->GetTriangles());
 }
 
-TArray<FVector> SCParametricMeshComponent::GeodicShortestPath(const FVector& Start, const FVector& End) const
-{
-	auto FindNearestTriangle = [&](const FVector& Pos) {
-		double Distance = std::numeric_limits<double>::max();
-		int Best = 0;
-		for (int i = 0;i < MeshData->triM.rows();i ++)
-		{
-			FVector V0 = MeshData->verM.row(MeshData->triM(i, 0));
-			FVector V1 = MeshData->verM.row(MeshData->triM(i, 1));
-			FVector V2 = MeshData->verM.row(MeshData->triM(i, 2));
-			FVector Center = (V0 + V1 + V2) / 3.;
-			if (double CD = (Center - Pos).norm(); Distance > CD)
-			{
-				Distance = CD;
-				Best = i;
-			}
-		}
-		return Best;
-	};
-	int StartTriIndex = FindNearestTriangle(Start);
-	int EndTriIndex = FindNearestTriangle(End);
-	return igl::exact_geodesic_path(MeshData->verM, MeshData->triM, Start, End,
-			StartTriIndex, EndTriIndex);;
-}
 
 SCParametricMeshComponent::UVMappingSampleResult SCParametricMeshComponent::SampleHit(double U, double V) const
 {
@@ -21,8 +21,6 @@ class ENGINE_API SCParametricMeshComponent : public ParametricAlgorithmComponent
 
 	explicit SCParametricMeshComponent(const ObjectPtr<StaticMesh>& InDisplayMesh, const ObjectPtr<StaticMesh>& InPMesh, int Iteration = 500);
 
-	virtual TArray<FVector> GeodicShortestPath(const FVector& Start, const FVector& End) const override;
-
 protected:
 
 	UVMappingSampleResult SampleHit(double U, double V) const;
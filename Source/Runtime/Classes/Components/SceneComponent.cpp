@@ -12,12 +12,14 @@ void SceneComponent::PostEdit(Reflection::FieldAccessor& Field)
 	MarkAsDirty();
 	if (Field == NAME(LocalTransform))
 	{
+		 LocalGeneration++;
 		 GetScene()->GetTransformProxy()->UpdateTransform(this);
 	}
 }
 void SceneComponent::SetOwner(Actor* Owner)
 {
 	ActorComponent::SetOwner(Owner);
+	LocalGeneration++;
 	Owner->GetTransformUpdateDelegate().AddMember(this, &SceneComponent::UploadRenderingData);
 }
 void SceneComponent::UploadRenderingData()
@@ -43,16 +43,19 @@ public:
 	virtual void SetOwner(Actor* Owner) override;
 	virtual void SetVisible(bool bInVisible) { bVisible = bInVisible; MarkAsDirty(); }
 
-	FORCEINLINE FTransform& GetTransform() { return LocalTransform; }
-	FORCEINLINE FTransform GetWorldTransform()
-	{
-		if (GetOwner() != nullptr)
-			return LocalTransform * GetOwner()->GetFTransform();
-		return LocalTransform;
-	}
-	FORCEINLINE FMatrix4 GetWorldMatrix(){return GetWorldTransform().GetMatrix();}
-	FORCEINLINE FTransform GetLocalTransform(){return LocalTransform;}
-	FORCEINLINE FMatrix4 GetLocalMatrix(){ return GetLocalTransform().GetMatrix(); }
+	// Mutable access, the cached world transform is conservatively invalidated
+	FORCEINLINE FTransform& GetTransform() { LocalGeneration++; return LocalTransform; }
+	FORCEINLINE void SetLocalTransform(const FTransform& InTransform);
+
+	/**
+	 * World transform, matrix and inverse matrix are cached and only recomputed when
+	 * the local transform or the owner's transform generation changes.
+	 */
+	FORCEINLINE const FTransform& GetWorldTransform();
+	FORCEINLINE const FMatrix4& GetWorldMatrix();
+	FORCEINLINE const FMatrix4& GetInverseWorldMatrix();
+	FORCEINLINE const FTransform& GetLocalTransform() const { return LocalTransform; }
+	FORCEINLINE FMatrix4 GetLocalMatrix() const { return LocalTransform.GetMatrix(); }
 
 
 protected:
@@ -69,6 +72,16 @@ protected:
 
 	FORCEINLINE void MarkAsDirty();
 
+	FORCEINLINE void UpdateWorldTransformCache();
+
+private:
+	FTransform CachedWorldTransform;
+	FMatrix4 CachedWorldMatrix = FMatrix4::Identity();
+	FMatrix4 CachedInverseWorldMatrix = FMatrix4::Identity();
+	uint LocalGeneration = 0;
+	uint CachedLocalGeneration = ~0;
+	uint CachedOwnerGeneration = ~0;
+	bool bInverseValid = false;
 };
 
 FORCEINLINE void SceneComponent::TickComponent(double DeltaTime)
@@ -85,3 +98,46 @@ FORCEINLINE void SceneComponent::MarkAsDirty()
 {
 	bDirty = true;
 }
+
+FORCEINLINE void SceneComponent::SetLocalTransform(const FTransform& InTransform)
+{
+	LocalTransform = InTransform;
+	LocalGeneration++;
+	MarkAsDirty();
+}
+
+FORCEINLINE void SceneComponent::UpdateWorldTransformCache()
+{
+	const TransformComponent* OwnerTransform = GetOwner() != nullptr ? GetOwner()->GetTransformComponent() : nullptr;
+	const uint OwnerGeneration = OwnerTransform != nullptr ? OwnerTransform->GetGeneration() : 0;
+	if (CachedLocalGeneration == LocalGeneration && CachedOwnerGeneration == OwnerGeneration)
+		return;
+	CachedWorldTransform = OwnerTransform != nullptr ? LocalTransform * OwnerTransform->GetFTransform() : LocalTransform;
+	CachedWorldMatrix = CachedWorldTransform.GetMatrix();
+	CachedLocalGeneration = LocalGeneration;
+	CachedOwnerGeneration = OwnerGeneration;
+	bInverseValid = false;
+}
+
+FORCEINLINE const FTransform& SceneComponent::GetWorldTransform()
+{
+	UpdateWorldTransformCache();
+	return CachedWorldTransform;
+}
+
+FORCEINLINE const FMatrix4& SceneComponent::GetWorldMatrix()
+{
+	UpdateWorldTransformCache();
+	return CachedWorldMatrix;
+}
+
+FORCEINLINE const FMatrix4& SceneComponent::GetInverseWorldMatrix()
+{
+	UpdateWorldTransformCache();
+	if (!bInverseValid)
+	{
+		CachedInverseWorldMatrix = CachedWorldMatrix.inverse();
+		bInverseValid = true;
+	}
+	return CachedInverseWorldMatrix;
+}
@@ -10,6 +10,7 @@
 #include "Render/SceneProxy/ShapeSceneProxy.h"
 #include "Render/SceneProxy/StaticMeshSceneProxy.h"
 #include "Render/SceneProxy/TransformProxy.h"
+#include "Misc/Profiler.h"
 
 StaticMeshComponent::StaticMeshComponent()
 {
@@ -27,9 +28,15 @@ void StaticMeshComponent::TickComponent(double DeltaTime)
 	if (IsDirty())
 	{
 		if(Dirty & DIRTY_REMESH)
+		{
+			PROFILE_SCOPE_TEXT("Remesh", GetName());
 			Remesh();
+		}
 		if(Dirty & DIRTY_RENDERDATA)
+		{
+			PROFILE_SCOPE_TEXT("UploadRenderingData", GetName());
 			UploadRenderingData();
+		}
 		Dirty = DIRTY_NONE;
 	}
 }
@@ -61,6 +68,7 @@ void StaticMeshComponent::Destroy()
 		{
 			ShapeProxy->RemoveInstance(InstanceID);
 		}
+		GetWorld()->GetComponentRegistry().UnregisterInstance(InstanceID);
 		if (auto StaticMeshProxy = GetScene()->GetStaticMeshProxy())
 		{
 			StaticMeshProxy->RemoveStaticMesh(MeshID);
@@ -103,7 +111,10 @@ void StaticMeshComponent::UploadRenderingData()
 			World->GetScene()->GetStaticMeshProxy()->UpdateStaticMeshGeometry(MeshID, MeshData.get());
 
 		if (InstanceID == ~0u)
+		{
 			InstanceID = GetScene()->GetShapeProxy()->RegisterInstance();
+			GetWorld()->GetComponentRegistry().RegisterInstance(InstanceID, this);
+		}
 
 		if (InstanceID != ~0u)
 		{
@@ -26,21 +26,21 @@ void TransformComponent::TickComponent(double DeltaTime)
 void TransformComponent::MarkDirty()
 {
 	bDirty = true;
+	Generation++;
 	GetOwner()->GetTransformUpdateDelegate().Broadcast();
 }
 
 void TransformComponent::SetRotation(const FVector& InRotation)
 {
-	MarkDirty();
 	FQuat Rotation = AngleAxisd(InRotation.z(), Vector3d::UnitZ())
     * AngleAxisd(InRotation.y(), Vector3d::UnitY())
     * AngleAxisd(InRotation.x(), Vector3d::UnitX());
 	Transform.SetRotation(Rotation);
+	MarkDirty();
 }
 
 void TransformComponent::AddRotationLocal(const FVector& DeltaRotation)
 {
-	MarkDirty();
 	Quaterniond P = AngleAxisd(DeltaRotation.z(), Vector3d::UnitZ())
     * AngleAxisd(DeltaRotation.y(), Vector3d::UnitY())
     * AngleAxisd(DeltaRotation.x(), Vector3d::UnitX());
@@ -49,7 +49,6 @@ void TransformComponent::AddRotationLocal(const FVector& DeltaRotation)
 
 void TransformComponent::AddRotationGlobal(const FVector& DeltaRotation)
 {
-	MarkDirty();
 	FQuat P = AngleAxisd(DeltaRotation.z(), Vector3d::UnitZ())
     * AngleAxisd(DeltaRotation.y(), Vector3d::UnitY())
     * AngleAxisd(DeltaRotation.x(), Vector3d::UnitX());
@@ -46,11 +46,19 @@ public:
 	FORCEINLINE void SetScale(const FVector& InScale);
 	FORCEINLINE void AddScale(const FVector& DeltaScale);
 
+	/**
+	 * Generation counter of the transform, increased every time the transform changes.
+	 * Used by child components to validate their cached world transform.
+	 */
+	FORCEINLINE uint GetGeneration() const { return Generation; }
+
 protected:
 	MPROPERTY()
 	FTransform Transform;
 
 	bool bDirty = true;
+
+	uint Generation = 0;
 };
 
 FORCEINLINE Eigen::Affine3d TransformComponent::GetTransform() const
@@ -90,20 +98,20 @@ FORCEINLINE Eigen::Quaterniond TransformComponent::GetRotation() const
 
 FORCEINLINE void TransformComponent::SetRotation(const Eigen::Quaterniond &InRotation)
 {
-	MarkDirty();
 	Transform.SetRotation(InRotation);
+	MarkDirty();
 }
 
 FORCEINLINE void TransformComponent::AddRotationLocal(const Eigen::Quaterniond &DeltaRotation)
 {
-	MarkDirty();
 	Transform.AddRotationLocal(DeltaRotation);
+	MarkDirty();
 }
 
 FORCEINLINE void TransformComponent::AddRotationGlobal(const Eigen::Quaterniond &DeltaRotation)
 {
-	MarkDirty();
 	Transform.AddRotationGlobal(DeltaRotation);
+	MarkDirty();
 }
 
 FORCEINLINE Eigen::Vector3d TransformComponent::GetScale() const
@@ -113,41 +121,41 @@ FORCEINLINE Eigen::Vector3d TransformComponent::GetScale() const
 
 FORCEINLINE void TransformComponent::SetTransform(const Eigen::Affine3d& InTransform)
 {
-	MarkDirty();
 	Transform = InTransform;
+	MarkDirty();
 }
 
 FORCEINLINE void TransformComponent::SetTransform(const FTransform& InTransform)
 {
-	MarkDirty();
 	Transform = InTransform;
+	MarkDirty();
 }
 
 FORCEINLINE void TransformComponent::SetTranslation(const FVector& Translation)
 {
-	MarkDirty();
 	Transform.SetTranslation(Translation);
+	MarkDirty();
 }
 
 FORCEINLINE void TransformComponent::AddTranslationGlobal(const FVector &DeltaTranslation)
 {
-	MarkDirty();
 	Transform.AddTranslationGlobal(DeltaTranslation);
+	MarkDirty();
 }
 
 FORCEINLINE void TransformComponent::AddTranslationLocal(const FVector &DeltaTranslation)
 {
-	MarkDirty();
 	Transform.AddTranslationLocal(DeltaTranslation);
+	MarkDirty();
 }
 
 FORCEINLINE void TransformComponent::SetScale(const FVector& InScale)
 {
-	MarkDirty();
 	Transform.SetScale(InScale);
+	MarkDirty();
 }
 FORCEINLINE void TransformComponent::AddScale(const FVector &DeltaScale)
 {
-	MarkDirty();
 	Transform.AddScale(DeltaScale);
+	MarkDirty();
 }
\ No newline at end of file
@@ -3,7 +3,8 @@
 //
 #include "Curve.h"
 #include "Math/Geometry.h"
-#include "tinysplinecxx.h"
+#include "Algorithm/CurveDistance.h"
+#include "Algorithm/SplineLibrary.h"
 
 Curve::Curve(const TArray<FVector>& InLines)
 {
@@ -64,40 +65,19 @@ bool Curve::ReadFromPath(const Path& InFilePath)
 
 TArray<FVector> Curve::SampleWithEqualChordLength(const TArray<FVector>& CurveData, int Samples)
 {
-	TArray<FVector> Result;
-	TArray<double> Data(CurveData.size() * 3);
-	std::memcpy(Data.data(), CurveData.data(), CurveData.size() * 3 * sizeof(double));
-	auto Spline = tinyspline::BSpline::interpolateCatmullRom(Data, 3);
-
-	auto knots = Spline.equidistantKnotSeq(Samples);
-	auto Frames = Spline.computeRMF(knots);
+	auto Spline = SplineLibrary::CompiledSpline::InterpolateCatmullRom(CurveData);
+	TArray<double> Params;
+	Spline.EquidistantParameters(Samples, Params);
 	/***
 	 * Sample the linkage as a discrete curve
 	 * Used for collision detection in the next step
 	 */
-	Result.resize(Frames.size());
-	for (int i = 0; i < Frames.size(); i++)
-	{
-		auto Frame = Frames.at(i).position();
-		Result[i] = FVector(Frame.x(), Frame.y(), Frame.z());
-	}
+	TArray<FVector> Result;
+	Spline.Evaluate(Params, Result);
 	return Result;
 }
 
 double Curve::Distance(const Curve& Other) const
 {
-	double D = std::numeric_limits<double>::max();
-	for (int i = 0; i < Num() - 1; i++)
-	{
-		FVector P0 = SampleIndex(i);
-		FVector P1 = SampleIndex(i + 1);
-		for (int j = 0; j < Other.Num() - 1; j++)
-		{
-			FVector Q0 = Other.SampleIndex(j);
-			FVector Q1 = Other.SampleIndex(j + 1);
-			auto Result = Math::SegmentSegmentDistance(P0, P1, Q0, Q1);
-			D = std::min(D, std::get<0>(Result));
-		}
-	}
-	return D;
+	return Algorithm::PolylineMinimumDistance(Lines, Other.Lines);
 }
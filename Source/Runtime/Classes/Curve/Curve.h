@@ -99,7 +99,7 @@ public:
 
 	/**
 	 * Calculate the minimum distance between two curves
-	 * O(N*M) slow
+	 * Segments of Other are organized in a BVH, see Algorithm::PolylineMinimumDistance
 	 * @param Other
 	 * @return
 	 */
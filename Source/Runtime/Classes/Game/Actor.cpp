@@ -2,6 +2,8 @@
 #include "Core/CoreMinimal.h"
 #include "Math/FTransform.h"
 #include "Components/TransformComponent.h"
+#include "Game/World.h"
+#include "Misc/Profiler.h"
 
 Actor::Actor(const FVector& InitLocation, const FQuat& InitRotation, const FVector& InitScale)
 {
@@ -53,6 +55,7 @@ void Actor::Tick(double DeltaTime)
 	{
 		if(Component)
 		{
+			PROFILE_SCOPE_TEXT("TickComponent", Component->GetName());
 			Component->TickComponent(DeltaTime);
 		}
 	}
@@ -75,7 +78,10 @@ void Actor::Destroy()
 {
 	// Call components destroy
 	for(const auto& Component: GetAllComponents())
+	{
 		Component->Destroy();
+		UnregisterComponentFromWorld(Component.get());
+	}
 
 	// Clear ownership of all components
 	Components.clear();
@@ -107,5 +113,19 @@ WeakObjectPtr<Actor> Actor::GetRootActor()
 
 void Actor::UnregisterAllComponents()
 {
+	for (const auto& Component : Components)
+		UnregisterComponentFromWorld(Component.get());
 	Components.clear();
+}
+
+void Actor::RegisterComponentToWorld(ActorComponent* InComponent)
+{
+	if (World != nullptr)
+		World->GetComponentRegistry().Register(InComponent);
+}
+
+void Actor::UnregisterComponentFromWorld(ActorComponent* InComponent)
+{
+	if (World != nullptr)
+		World->GetComponentRegistry().Unregister(InComponent);
 }
\ No newline at end of file
@@ -96,6 +96,10 @@ public:
 
 
 protected:
+	// Add or remove the component in the world's component registry, no-op if not in a world yet
+	void RegisterComponentToWorld(ActorComponent* InComponent);
+	void UnregisterComponentFromWorld(ActorComponent* InComponent);
+
 	bool HasBeginPlay = false;
 	/**
 	 * This is a pointer to the world that this actor belongs to
@@ -265,6 +269,7 @@ template <class T, typename... Args> requires IsActorComponent<T>
 	NewComponent->World = World;
 	NewComponent->SetOwner(this);
 	Components.push_back(NewComponent);
+	RegisterComponentToWorld(NewComponent.get());
 	return NewComponent;
 }
 
@@ -0,0 +1,106 @@
+#include "ComponentRegistry.h"
+#include "Components/ActorComponent.h"
+#include <algorithm>
+
+void ComponentRegistry::ClassIndex::Add(ActorComponent* InComponent)
+{
+	if (Slots.count(InComponent))
+		return;
+	Slots[InComponent] = Components.size();
+	Components.push_back(InComponent);
+}
+
+void ComponentRegistry::ClassIndex::Remove(ActorComponent* InComponent)
+{
+	auto It = Slots.find(InComponent);
+	if (It == Slots.end())
+		return;
+	// Swap with the last one to keep the array dense
+	const size_t Slot = It->second;
+	ActorComponent* Last = Components.back();
+	Components[Slot] = Last;
+	Slots[Last] = Slot;
+	Components.pop_back();
+	Slots.erase(InComponent);
+}
+
+void ComponentRegistry::Register(ActorComponent* InComponent)
+{
+	if (!InComponent || AllComponents.Slots.count(InComponent))
+		return;
+	AllComponents.Add(InComponent);
+	for (auto& [Type, Index] : ClassIndices)
+	{
+		if (Index.IsA(InComponent))
+			Index.Add(InComponent);
+	}
+}
+
+void ComponentRegistry::Unregister(ActorComponent* InComponent)
+{
+	if (!InComponent || !AllComponents.Slots.count(InComponent))
+		return;
+	AllComponents.Remove(InComponent);
+	for (auto& [Type, Index] : ClassIndices)
+		Index.Remove(InComponent);
+	auto It = ComponentInstances.find(InComponent);
+	if (It == ComponentInstances.end())
+		return;
+	for (uint InstanceId : It->second)
+		InstanceOwners.erase(InstanceId);
+	ComponentInstances.erase(It);
+}
+
+void ComponentRegistry::RegisterInstance(uint InstanceId, ActorComponent* InComponent)
+{
+	auto [It, bInserted] = InstanceOwners.try_emplace(InstanceId, InComponent);
+	if (!bInserted)
+	{
+		if (It->second == InComponent)
+			return;
+		UnregisterInstance(InstanceId);
+		InstanceOwners[InstanceId] = InComponent;
+	}
+	ComponentInstances[InComponent].push_back(InstanceId);
+}
+
+void ComponentRegistry::UnregisterInstance(uint InstanceId)
+{
+	auto It = InstanceOwners.find(InstanceId);
+	if (It == InstanceOwners.end())
+		return;
+	auto OwnerIt = ComponentInstances.find(It->second);
+	InstanceOwners.erase(It);
+	if (OwnerIt == ComponentInstances.end())
+		return;
+	TArray<uint>& Instances = OwnerIt->second;
+	if (auto Found = std::find(Instances.begin(), Instances.end(), InstanceId); Found != Instances.end())
+	{
+		*Found = Instances.back();
+		Instances.pop_back();
+	}
+	if (Instances.empty())
+		ComponentInstances.erase(OwnerIt);
+}
+
+ActorComponent* ComponentRegistry::FindByInstanceId(uint InstanceId) const
+{
+	auto It = InstanceOwners.find(InstanceId);
+	return It == InstanceOwners.end() ? nullptr : It->second;
+}
+
+ComponentRegistry::ClassIndex& ComponentRegistry::FindOrBuildIndex(std::type_index Type, bool (*IsA)(ActorComponent*))
+{
+	auto [It, bInserted] = ClassIndices.try_emplace(Type);
+	ClassIndex& Index = It->second;
+	if (bInserted)
+	{
+		Index.IsA = IsA;
+		for (ActorComponent* Component : AllComponents.Components)
+		{
+			if (IsA(Component))
+				Index.Add(Component);
+		}
+	}
+	return Index;
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include "ContainerTypes.h"
+#include "PointerTypes.h"
+#include "Misc/Platform.h"
+#include <typeindex>
+
+class ActorComponent;
+
+/**
+ * Per world index of components by class, replacing the cast scans over all actors.
+ * Each queried class owns a dense array of components that are (subclasses of) that class,
+ * the array is built on the first query and then maintained on register and unregister.
+ * Also maps render instance ids to their owning component for O(1) picking.
+ */
+class ENGINE_API ComponentRegistry
+{
+public:
+	/**
+	 * Add a component to the registry, and to every class index it belongs to.
+	 * Registering a component twice is ignored.
+	 */
+	void Register(ActorComponent* InComponent);
+
+	/**
+	 * Remove a component from the registry and every class index, also drop its instance ids.
+	 */
+	void Unregister(ActorComponent* InComponent);
+
+	/**
+	 * Map a render instance id to the component that owns it
+	 */
+	void RegisterInstance(uint InstanceId, ActorComponent* InComponent);
+	void UnregisterInstance(uint InstanceId);
+
+	/**
+	 * Find the component owning a render instance id
+	 * @return nullptr if the instance id is not registered
+	 */
+	ActorComponent* FindByInstanceId(uint InstanceId) const;
+
+	/**
+	 * Get all registered components of class T (including subclasses), the order is not stable.
+	 * The returned array is only valid until next register or unregister.
+	 */
+	template <class T>
+	const TArray<ActorComponent*>& GetComponents();
+
+	// Get any registered component of class T, nullptr if none
+	template <class T>
+	T* GetFirst();
+
+	template <class T, class Func>
+	void ForEach(Func&& Function);
+
+	FORCEINLINE int Num() const { return AllComponents.Components.size(); }
+
+protected:
+	struct ClassIndex
+	{
+		bool (*IsA)(ActorComponent*) = nullptr;
+		TArray<ActorComponent*> Components;
+		THashMap<ActorComponent*, size_t> Slots;
+
+		void Add(ActorComponent* InComponent);
+		void Remove(ActorComponent* InComponent);
+	};
+
+	ClassIndex& FindOrBuildIndex(std::type_index Type, bool (*IsA)(ActorComponent*));
+
+	ClassIndex AllComponents;
+	THashMap<std::type_index, ClassIndex> ClassIndices;
+	THashMap<uint, ActorComponent*> InstanceOwners;
+	// Reverse of InstanceOwners, so unregistering a component only visits its own instance ids
+	THashMap<ActorComponent*, TArray<uint>> ComponentInstances;
+};
+
+template <class T>
+const TArray<ActorComponent*>& ComponentRegistry::GetComponents()
+{
+	auto It = ClassIndices.find(std::type_index(typeid(T)));
+	if (It != ClassIndices.end()) [[likely]]
+		return It->second.Components;
+	return FindOrBuildIndex(std::type_index(typeid(T)), [](ActorComponent* InComponent) {
+		return dynamic_cast<T*>(InComponent) != nullptr;
+	}).Components;
+}
+
+template <class T>
+T* ComponentRegistry::GetFirst()
+{
+	const auto& Components = GetComponents<T>();
+	return Components.empty() ? nullptr : static_cast<T*>(Components.front());
+}
+
+template <class T, class Func>
+void ComponentRegistry::ForEach(Func&& Function)
+{
+	for (ActorComponent* Component : GetComponents<T>())
+		Function(static_cast<T*>(Component));
+}
@@ -0,0 +1,114 @@
+#include "SimulationThread.h"
+#include <chrono>
+#include "World.h"
+#include "Render/GpuSceneInterface.h"
+#include "Misc/Profiler.h"
+#include "Render/SceneProxy/TransformProxy.h"
+
+using SimulationClock = std::chrono::steady_clock;
+
+namespace
+{
+	// Shortest step of the variable time step mode, keeps an idle world from spinning the thread
+	constexpr double MinVariableDeltaTime = 1e-3;
+
+	double SecondsSince(SimulationClock::time_point Start)
+	{
+		return std::chrono::duration<double>(SimulationClock::now() - Start).count();
+	}
+}
+
+SimulationThread::~SimulationThread()
+{
+	Stop();
+}
+
+void SimulationThread::Start(World* InWorld, double InFixedDeltaTime, int InMaxSubSteps)
+{
+	if (!InWorld)
+	{
+		LOG_ERROR("Trying to start the simulation thread without a world.");
+		return;
+	}
+	Stop();
+	TargetWorld = InWorld;
+	FixedDeltaTime = InFixedDeltaTime;
+	MaxSubSteps = std::max(InMaxSubSteps, 1);
+	LastStepDelta = 0.;
+	bRunning = true;
+	Thread = std::thread(&SimulationThread::Run, this);
+	LOG_INFO("Simulation thread started, time step: {}", FixedDeltaTime > 0 ? std::to_string(FixedDeltaTime) : "variable");
+}
+
+void SimulationThread::Stop()
+{
+	bRunning = false;
+	if (Thread.joinable())
+		Thread.join();
+	TargetWorld = nullptr;
+}
+
+float SimulationThread::GetInterpolationAlpha() const
+{
+	const double StepDelta = LastStepDelta;
+	if (StepDelta <= 0.)
+		return 1.f;
+	const auto Elapsed = SimulationClock::now().time_since_epoch().count() - LastPublishTime;
+	const double Seconds = std::chrono::duration<double>(SimulationClock::duration(Elapsed)).count();
+	return static_cast<float>(std::clamp(Seconds / StepDelta, 0., 1.));
+}
+
+void SimulationThread::Run()
+{
+	Profiler::Get().SetThreadName("Simulation");
+	auto LastTime = SimulationClock::now();
+	double Accumulator = 0.;
+	while (bRunning)
+	{
+		const auto Now = SimulationClock::now();
+		Accumulator += std::chrono::duration<double>(Now - LastTime).count();
+		LastTime = Now;
+
+		double Wait;
+		if (FixedDeltaTime > 0.)
+		{
+			int SubSteps = 0;
+			while (Accumulator >= FixedDeltaTime && SubSteps < MaxSubSteps && bRunning)
+			{
+				Step(FixedDeltaTime);
+				Accumulator -= FixedDeltaTime;
+				SubSteps++;
+			}
+			// Steps are slower than real time, drop the backlog instead of falling further behind
+			if (Accumulator >= FixedDeltaTime)
+				Accumulator = std::fmod(Accumulator, FixedDeltaTime);
+			Wait = FixedDeltaTime - Accumulator;
+		}
+		else
+		{
+			if (Accumulator >= MinVariableDeltaTime)
+			{
+				Step(Accumulator);
+				Accumulator = 0.;
+			}
+			Wait = MinVariableDeltaTime - Accumulator;
+		}
+		if (Wait > 0.)
+			std::this_thread::sleep_for(std::chrono::duration<double>(Wait));
+	}
+}
+
+void SimulationThread::Step(double DeltaTime)
+{
+	PROFILE_SCOPE("SimulationThread::Step");
+	const auto StepStart = SimulationClock::now();
+	{
+		auto WorldLock = LockWorld();
+		TargetWorld->Tick(DeltaTime);
+		if (auto Scene = TargetWorld->GetScene())
+			Scene->GetTransformProxy()->PublishSimulationState();
+		LastStepDelta = DeltaTime;
+		LastPublishTime = SimulationClock::now().time_since_epoch().count();
+	}
+	LastStepCost = SecondsSince(StepStart);
+}
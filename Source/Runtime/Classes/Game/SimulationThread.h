@@ -0,0 +1,69 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include "CoreMinimal.h"
+
+class World;
+
+/**
+ * Ticks a world on its own thread so that simulation and rendering run at their own rates.
+ * The world is shared under the world lock: the simulation holds it for one step,
+ * the render thread holds it while drawing widgets and collecting the render data of a frame,
+ * and uploads and renders that data after releasing it.
+ * After each step the changed transforms are published to the GPU scene,
+ * rendered frames interpolate between the last two published steps.
+ */
+class ENGINE_API SimulationThread
+{
+public:
+	SimulationThread() = default;
+
+	~SimulationThread();
+
+	SimulationThread(const SimulationThread&) = delete;
+	SimulationThread& operator=(const SimulationThread&) = delete;
+
+	/**
+	 * Start ticking the world, the world should have begun play and outlive the thread until Stop
+	 * @param InWorld World to tick
+	 * @param InFixedDeltaTime Fixed time step in seconds, <= 0 ticks with the elapsed time instead
+	 * @param InMaxSubSteps Max fixed steps to catch up in one iteration, older time is dropped
+	 */
+	void Start(World* InWorld, double InFixedDeltaTime, int InMaxSubSteps = 4);
+
+	/** Stop and join the thread, the world is not ticked after this returns */
+	void Stop();
+
+	FORCEINLINE bool IsRunning() const { return bRunning; }
+
+	/** Lock the world against the simulation step, the simulation waits until the lock is released */
+	[[nodiscard]] FORCEINLINE std::unique_lock<std::mutex> LockWorld() { return std::unique_lock(WorldMutex); }
+
+	/**
+	 * Blend factor between the last two published steps for the current time,
+	 * rendering one step behind the simulation keeps motion smooth when the rates differ
+	 */
+	[[nodiscard]] float GetInterpolationAlpha() const;
+
+	/** Wall time in seconds spent in the last world tick */
+	[[nodiscard]] FORCEINLINE double GetLastStepCost() const { return LastStepCost; }
+
+private:
+	void Run();
+
+	void Step(double DeltaTime);
+
+	World* TargetWorld = nullptr;
+	double FixedDeltaTime = 0.;
+	int MaxSubSteps = 4;
+
+	std::thread Thread;
+	std::mutex WorldMutex;
+	std::atomic<bool> bRunning = false;
+
+	// Published step timing, read by the render thread to interpolate
+	std::atomic<int64_t> LastPublishTime = 0;
+	std::atomic<double> LastStepDelta = 0.;
+	std::atomic<double> LastStepCost = 0.;
+};
@@ -10,6 +10,7 @@
 #include "Components/CameraComponent.h"
 #include "Actors/CameraActor.h"
 #include "Game/Actor.h"
+#include "Misc/Profiler.h"
 #include "Render/GpuSceneInterface.h"
 #include "TimerManager.h"
 #include "Components/LinesComponent.h"
@@ -54,29 +55,14 @@ void World::BeginPlay()
     	BeginPlayScript(*this);
 
 	// Check if contains at least one camera
-	bool HasCamera = false;
-	CameraActor* Camera = nullptr;
-	for (auto& Actor: Actors) {
-		if (Actor->GetComponent<CameraComponent>()) {
-			HasCamera = true;
-			Camera = Cast<CameraActor>(Actor).get();
-			break;
-		}
-	}
-	if (!HasCamera) {
+	CameraActor* Camera = GetCurrentCamera();
+	if (!Camera) {
 		Camera = SpawnActor<CameraActor>("Camera").get();
 		Camera->SetTranslation({-5, 0, 0});
 	}
 
 	// Add a const light along with camera if no light in the scene
-	bool HasLight = false;
-	for (auto& Actor: Actors) {
-		if (Actor->GetComponent<LightComponent>()) {
-			HasLight = true;
-			break;
-		}
-	}
-	if (!HasLight) {
+	if (!Components.GetFirst<LightComponent>()) {
 		Camera->AddComponent<PointLightComponent>();
 	}
 
@@ -86,6 +72,7 @@ void World::BeginPlay()
 
 void World::Tick(double DeltaTime)
 {
+	PROFILE_SCOPE("World::Tick");
 	for (auto& Object: Actors) {
 		if(!Object->HasBeginPlay) {
 			Object->BeginPlay();
@@ -115,6 +102,7 @@ void World::EndPlay()
 		actor->Destroy();
 
 	Actors.clear();
+	Components = ComponentRegistry();
 }
 
 void World::DestroyActor(Actor* ToDestroyActor)
@@ -148,23 +136,18 @@ void World::SelectActor(const ObjectPtr<Actor>& InActor)
 
 void World::SelectActorByInstanceId(uint InstanceId)
 {
-	for (auto& Actor: Actors) {
-		for(auto MeshComponent : Actor->GetAllComponentsOfClass<StaticMeshComponent>())
-		{
-			if(MeshComponent->GetInstanceID() == InstanceId)
-			{
-				SelectActor(Actor);
-				return;
-			}
-		}
+	if (auto Component = Components.FindByInstanceId(InstanceId))
+	{
+		if (Component->GetOwner())
+			SelectActor(Component->GetOwner()->GetThis());
 	}
 }
 
 CameraActor* World::GetCurrentCamera() const
 {
-	for (auto& Actor: Actors) {
-		if (auto Component = Actor->GetComponent<CameraComponent>()) {
-			return Cast<CameraActor>(Component->GetOwner());
+	for (ActorComponent* Component : Components.GetComponents<CameraComponent>()) {
+		if (auto Camera = Cast<CameraActor>(Component->GetOwner())) {
+			return Camera;
 		}
 	}
 	return nullptr;
@@ -198,20 +181,24 @@ void World::ExportSceneToObj(const Path& FolderPath, bool bExportGlobal)
 {
 	if (FolderPath.Existing() && FolderPath.IsDirectory())
 	{
-		for (auto& Actor : Actors)
+		// Export the first mesh component of each actor, named after the actor
+		THashSet<Actor*> ExportedActors;
+		for (ActorComponent* Component : Components.GetComponents<StaticMeshComponent>())
 		{
-			if (auto MeshComponent = Actor->GetComponent<StaticMeshComponent>())
+			auto MeshComponent = static_cast<StaticMeshComponent*>(Component);
+			Actor* Owner = MeshComponent->GetOwner();
+			if (Owner && ExportedActors.insert(Owner).second)
 			{
 				if (auto Mesh = MeshComponent->GetMeshData())
 				{
 					if (!bExportGlobal)
-						Mesh->SaveOBJ(FolderPath / (Actor->GetName() + ".obj"));
+						Mesh->SaveOBJ(FolderPath / (Owner->GetName() + ".obj"));
 					else
 					{
-						auto	   Transform = Actor->GetTransformMatrix();
+						auto	   Transform = Owner->GetTransformMatrix();
 						StaticMesh CopyMesh = *Mesh;
 						CopyMesh.TransformMesh(Transform);
-						CopyMesh.SaveOBJ(FolderPath / (Actor->GetName() + ".obj"));
+						CopyMesh.SaveOBJ(FolderPath / (Owner->GetName() + ".obj"));
 					}
 				}
 			}
@@ -8,6 +8,7 @@
 #include "Delegate.h"
 #include "Object/Object.h"
 #include "Actor.h"
+#include "ComponentRegistry.h"
 #include "Render/ViewportInterface.h"
 #include "Render/Core/ViewMode.h"
 
@@ -94,6 +95,12 @@ public:
     FORCEINLINE Rendering::GpuSceneInterface* GetScene() const { return GPUScene; }
 	FORCEINLINE class ViewportInterface* GetViewport() const { return Viewport; }
 
+	/**
+	 * Index of all components in the world by class and by render instance id.
+	 * Prefer this over iterating actors and casting their components.
+	 */
+	FORCEINLINE ComponentRegistry& GetComponentRegistry() { return Components; }
+
 	template<class T>
 	void BindKeyPressedEvent(int Key, ObjectPtr<T> Object, void(T::* FuncPtr)());
 
@@ -145,6 +152,9 @@ private:
 	TArray<ObjectPtr<Actor>> Actors;
 	WeakObjectPtr<Actor> SelectedActor;
 
+	// Class indices are built lazily on first query, even from const methods
+	mutable ComponentRegistry Components;
+
 	TArray<ObjectPtr<class UIWidget>> Widgets;
 
 	TMap<int, KeyPressedEvent> KeyEvents;
@@ -173,6 +183,7 @@ ObjectPtr<T> World::SpawnActor(const String& ActorName, Args&&... args)
 	{
 		Component->SetOwner(NewActor.get());
 		Component->World = this;
+		Components.Register(Component.get());
 	}
 	// Init all components and then actor
 	NewActor->Init();
@@ -188,6 +199,7 @@ ObjectPtr<T> World::AddActor(ObjectPtr<T> InActor)
 	{
 		Component->SetOwner(InActor.get());
 		Component->World = this;
+		Components.Register(Component.get());
 	}
 	return InActor;
 }
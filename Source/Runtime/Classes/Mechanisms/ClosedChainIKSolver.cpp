@@ -11,32 +11,16 @@
 
 int ClosedChainMechFunctor::operator()(const Eigen::VectorXd& x, Eigen::VectorXd& fvec) const
 {
-	Matrix4d Result = Matrix4d::Zero();
-	VectorXd Parameter = x.eval();
-
-	// Set parameter for all IK joints
-	for (auto i : Joints)
-	{
-		if(!i->IsRootJoint())
-			if (auto IKjoint = Cast<IKJoint>(i))
-				IKjoint->SetParameter(Parameter);
-	}
-
-	// Should consume all parameter dimension
-	ASSERTMSG(Parameter.size() == 0, "Parameter size not match");
-
-	ObjectPtr<Joint> Driven;
-	// FK
-	for (auto i : Joints)
-	{
-		if (!i->IsRootJoint()) // Driven joint use Global from fetch
-			i->CalcGlobal();
-		else
-			Driven = i;
-	}
-	ObjectPtr<Joint> Ground = Driven->GetParentJoint();
+	// Driven joint is a root, its global is gathered from the drive
+	TArray<FTransform> Globals;
+	Tree->Evaluate(x, Globals);
+	CalcLoss(Globals, fvec);
+	return 0;
+}
 
-	Result = Ground->GlobalTransform.GetMatrix() - Ground->InitTransform.GetMatrix();
+void ClosedChainMechFunctor::CalcLoss(const TArray<FTransform>& Globals, Eigen::VectorXd& fvec) const
+{
+	Matrix4d Result = Globals[GroundIndex].GetMatrix() - GroundInitMatrix;
 	fvec.resize(values());
 	for (int i = 0; i < 3; i++)
 	{
@@ -45,7 +29,6 @@ int ClosedChainMechFunctor::operator()(const Eigen::VectorXd& x, Eigen::VectorXd
 			fvec(i * 4 + j) = Result(i, j);
 		}
 	}
-	return 0;
 }
 
 int ClosedChainMechFunctor::df(const VectorXd& x, MatrixXd& fjac) const
@@ -53,28 +36,50 @@ int ClosedChainMechFunctor::df(const VectorXd& x, MatrixXd& fjac) const
 	fjac.resize(values(), inputs());
 	fjac.setZero();
 
-	VectorXd epc;
 	double	 tol = 0.0001;
-	epc.resize(inputs());
+	// Columns are x + e_i, x - e_i for each parameter, evaluated in one batch
+	MatrixXd Columns = x.replicate(1, 2 * inputs());
+	for (int itr = 0; itr < inputs(); itr++)
+	{
+		Columns(itr, 2 * itr) += tol;
+		Columns(itr, 2 * itr + 1) -= tol;
+	}
+	TArray<TArray<FTransform>> Globals;
+	Tree->EvaluateBatch(Columns, Globals);
+
 	Eigen::VectorXd LossPlus, LossMinus;
 	for (int itr = 0; itr < inputs(); itr++)
 	{
-		epc.setZero();
-		epc(itr) = tol;
-		operator()(x + epc, LossPlus);
-		operator()(x - epc, LossMinus);
+		CalcLoss(Globals[2 * itr], LossPlus);
+		CalcLoss(Globals[2 * itr + 1], LossMinus);
 		fjac.col(itr) = (LossPlus - LossMinus) / (2.0 * tol);
 	}
 	return 0;
 }
 
+ClosedChainMechFunctor ClosedChainIKSolver::MakeFunctor() const
+{
+	ClosedChainMechFunctor LossFunc(Tree.ParameterNum);
+	LossFunc.Tree = &Tree;
+	ObjectPtr<Joint> Driven;
+	for (auto i : Joints)
+		if (i->IsRootJoint())
+			Driven = i;
+	ASSERTMSG(Driven && Driven->HasParent(), "Closed chain needs a driven root joint with a ground parent");
+	ObjectPtr<Joint> Ground = Driven->GetParentJoint();
+	LossFunc.GroundIndex = FindJointIndex(Ground.get());
+	ASSERTMSG(LossFunc.GroundIndex >= 0, "Ground joint is not in the solver");
+	LossFunc.GroundInitMatrix = Ground->InitTransform.GetMatrix();
+	return LossFunc;
+}
+
 double ClosedChainIKSolver::Solve()
 {
 	VectorXd Parameter = PreParameter; // Use parameter from previor solve as init
 	ASSERTMSG(Parameter.size() == ParameterNum(), "Parameter size not match");
 	ASSERTMSG(Parameter.size() != 0, "Parameter can not be Empty");
-	ClosedChainMechFunctor LossFunc(ParameterNum());
-	LossFunc.Joints = Joints;
+	GatherDrives();
+	ClosedChainMechFunctor LossFunc = MakeFunctor();
 	Eigen::LevenbergMarquardt<ClosedChainMechFunctor, double> lm(LossFunc);
 	const auto MechanismSolveTolerance = SimulationEps;
 	lm.parameters.ftol = MechanismSolveTolerance;
@@ -91,16 +96,9 @@ double ClosedChainIKSolver::Solve()
 	PreParameter = Parameter.eval();
 
 	// Apply result parameter to system
-	for (auto i : Joints)
-		if (auto IKjoint = Cast<IKJoint>(i))
-			IKjoint->SetParameter(Parameter);
-
-	ASSERTMSG(Parameter.size() == 0, "Parameter size not match");
-	for (auto Joint : Joints)
-	{
-		if (!Joint->IsRootJoint())
-			Joint->CalcGlobal();
-	}
+	TArray<FTransform> Globals;
+	Tree.Evaluate(Parameter, Globals);
+	WriteBack(Parameter, Globals);
 	return Loss;
 }
 
@@ -113,8 +111,7 @@ void ClosedChainIKSolver::Drive(ObjectPtr<Joint> Root, double DeltaTime)
 double ClosedChainIKSolver::CalcSingularity(const VectorXd& Parameter) const
 {
 	MatrixXd jacFK;
-	ClosedChainMechFunctor LossFunc(ParameterNum());
-	LossFunc.Joints = Joints;
+	ClosedChainMechFunctor LossFunc = MakeFunctor();
 	LossFunc.df(Parameter, jacFK);
 	Eigen::JacobiSVD<MatrixXd> svd(jacFK, Eigen::ComputeThinU | Eigen::ComputeThinV);
 	return svd.singularValues().minCoeff();
@@ -9,8 +9,11 @@ struct ENGINE_API ClosedChainMechFunctor : IKBaseFunctor<double>
 {
 	ClosedChainMechFunctor(int ParameterDimension)
 		: IKBaseFunctor<double>(ParameterDimension, 12), ParameterDimension(ParameterDimension) {}
-	int							  ParameterDimension;
-	std::vector<ObjectPtr<Joint>> Joints;
+	int						ParameterDimension;
+	const KinematicTree*	Tree = nullptr;
+	// The ground closes the chain, its global should return to the initial transform
+	int						GroundIndex = -1;
+	Matrix4d				GroundInitMatrix = Matrix4d::Identity();
 
 	/// \brief calc loss of full body ik
 	/// \param x Parameter of full body
@@ -18,6 +21,9 @@ struct ENGINE_API ClosedChainMechFunctor : IKBaseFunctor<double>
 	/// \return 0 if successful
 	int operator()(const Eigen::VectorXd& x, Eigen::VectorXd& fvec) const;
 	int df(const VectorXd& x, MatrixXd& fjac) const;
+
+	/// \brief Loss of evaluated global transforms
+	void CalcLoss(const TArray<FTransform>& Globals, Eigen::VectorXd& fvec) const;
 };
 
 class ENGINE_API ClosedChainIKSolver : public IKSolver
@@ -25,6 +31,8 @@ class ENGINE_API ClosedChainIKSolver : public IKSolver
 private:
 	// Calc the min value of singularity matrix, should call solve first
 	double CalcSingularity(const VectorXd& Parameter) const;
+
+	ClosedChainMechFunctor MakeFunctor() const;
 	
 public:
 	double SimulationEps = 1e-4;
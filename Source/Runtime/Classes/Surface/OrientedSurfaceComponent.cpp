@@ -37,6 +37,8 @@ double OrientedSurfaceComponent::Distance(const FVector& Point) const
 
 void OrientedSurfaceComponent::Build(const ObjectPtr<StaticMesh>& OrientedMesh, bool bUseWindingNumber, bool bInverse)
 {
+	// The grid samples the previous mesh
+	ClearDistanceGrid();
 	bWindingNumber = bUseWindingNumber;
 	Sign = bInverse ? -1. : 1.;
 	if (bUseWindingNumber)
@@ -52,4 +54,210 @@ void OrientedSurfaceComponent::Build(const ObjectPtr<StaticMesh>& OrientedMesh,
 	{
 		sdf = MakeUnique<sdf::SDF>(OrientedMesh->GetVertices().cast<float>(), OrientedMesh->GetTriangles().cast<uint32_t>(), true, true);
 	}
-}
\ No newline at end of file
+}
+
+Eigen::Matrix<bool, Eigen::Dynamic, 1> OrientedSurfaceComponent::Inside(const MatrixX3d& Points) const
+{
+	if (HasDistanceGrid())
+		return (GridSignedDistance(Points, true).array() < 0.).matrix();
+	return ExactInside(Points);
+}
+
+VectorXd OrientedSurfaceComponent::Distance(const MatrixX3d& Points) const
+{
+	if (HasDistanceGrid())
+		return GridSignedDistance(Points, false).cwiseAbs();
+	if (bWindingNumber)
+	{
+		VectorXd SquaredDistance; VectorXi I; MatrixXd C;
+		AABB.squared_distance(V, F, MatrixXd(Points), SquaredDistance, I, C);
+		return SquaredDistance.cwiseSqrt();
+	}
+	return (*sdf)(Points.cast<float>(), false).cast<double>().cwiseAbs();
+}
+
+VectorXd OrientedSurfaceComponent::SignedDistance(const MatrixX3d& Points) const
+{
+	if (HasDistanceGrid())
+		return GridSignedDistance(Points, false);
+	return ExactSignedDistance(Points);
+}
+
+VectorXd OrientedSurfaceComponent::ExactSignedDistance(const MatrixX3d& Points) const
+{
+	if (bWindingNumber)
+	{
+		VectorXd SquaredDistance; VectorXi I; MatrixXd C;
+		AABB.squared_distance(V, F, MatrixXd(Points), SquaredDistance, I, C);
+		const auto In = ExactInside(Points);
+		VectorXd Result(Points.rows());
+		ParallelFor(Points.rows(), [&](int i) { Result[i] = In[i] ? -sqrt(SquaredDistance[i]) : sqrt(SquaredDistance[i]); });
+		return Result;
+	}
+	return -(*sdf)(Points.cast<float>(), false).cast<double>();
+}
+
+Eigen::Matrix<bool, Eigen::Dynamic, 1> OrientedSurfaceComponent::ExactInside(const MatrixX3d& Points) const
+{
+	if (bWindingNumber)
+	{
+		Eigen::VectorXf W;
+		igl::fast_winding_number(fwn_bvh, 2, Points.cast<float>(), W);
+		return ((1. - 2. * W.cast<double>().array().abs()) * Sign < 0.).matrix();
+	}
+	return sdf->contains(Points.cast<float>());
+}
+
+void OrientedSurfaceComponent::BuildDistanceGrid(double CellSize, double RefineDistance)
+{
+	ASSERTMSG(CellSize > 0., "Distance grid cell size should be positive");
+	const MatrixX3d Vertices = bWindingNumber ? MatrixX3d(V) : MatrixX3d(sdf->verts().cast<double>());
+	const MatrixX3i Triangles = bWindingNumber ? MatrixX3i(F) : MatrixX3i(sdf->faces().cast<int>());
+
+	GridCellSize = CellSize;
+	GridRefineDistance = RefineDistance < 0. ? CellSize * sqrt(3.) : RefineDistance;
+	const double BlockLength = CellSize * GridBlockSize;
+	// Pad by the refine distance so every point that needs refinement lies in a near block
+	const double Padding = GridRefineDistance + CellSize;
+	GridOrigin = Vertices.colwise().minCoeff().transpose() - FVector::Constant(Padding);
+	const FVector Extent = Vertices.colwise().maxCoeff().transpose() + FVector::Constant(Padding) - GridOrigin;
+	GridBlockNum = (Extent / BlockLength).array().ceil().cast<int>().max(1);
+	const int BlockNum = GridBlockNum.prod();
+
+	auto BlockIndex = [this](int X, int Y, int Z) { return X + GridBlockNum.x() * (Y + GridBlockNum.y() * Z); };
+	auto BlockCoord = [this](int Index) { return Vector3i(Index % GridBlockNum.x(), Index / GridBlockNum.x() % GridBlockNum.y(), Index / (GridBlockNum.x() * GridBlockNum.y())); };
+
+	// Blocks overlapped by the bound of a triangle grown by the refine distance are near the surface
+	TArray<uint8_t> bNear(BlockNum, 0);
+	for (int i = 0; i < Triangles.rows(); i++)
+	{
+		FVector Min = Vertices.row(Triangles(i, 0)), Max = Min;
+		for (int k = 1; k < 3; k++)
+		{
+			Min = Min.cwiseMin(FVector(Vertices.row(Triangles(i, k))));
+			Max = Max.cwiseMax(FVector(Vertices.row(Triangles(i, k))));
+		}
+		const Vector3i Begin = (((Min - GridOrigin).array() - GridRefineDistance) / BlockLength).floor().max(0.).cast<int>();
+		const Vector3i End = (((Max - GridOrigin).array() + GridRefineDistance) / BlockLength).floor().cast<int>().min(GridBlockNum.array() - 1);
+		for (int Z = Begin.z(); Z <= End.z(); Z++)
+			for (int Y = Begin.y(); Y <= End.y(); Y++)
+				for (int X = Begin.x(); X <= End.x(); X++)
+					bNear[BlockIndex(X, Y, Z)] = 1;
+	}
+
+	constexpr int NodeAxis = GridBlockSize + 1;
+	constexpr int BlockNodeNum = NodeAxis * NodeAxis * NodeAxis;
+	GridBlockNodes.assign(BlockNum, -1);
+	int NearNum = 0;
+	for (int i = 0; i < BlockNum; i++)
+		if (bNear[i])
+			GridBlockNodes[i] = BlockNodeNum * NearNum++;
+
+	// All nodes of the near blocks and the corners of all blocks in one exact batch
+	const Vector3i CornerAxis = GridBlockNum.array() + 1;
+	const int CornerNum = CornerAxis.prod();
+	const int NearNodeNum = NearNum * BlockNodeNum;
+	MatrixX3d Samples(NearNodeNum + CornerNum, 3);
+	ParallelFor(CornerNum, [&](int i)
+	{
+		const Vector3i Corner(i % CornerAxis.x(), i / CornerAxis.x() % CornerAxis.y(), i / (CornerAxis.x() * CornerAxis.y()));
+		Samples.row(NearNodeNum + i) = GridOrigin + Corner.cast<double>() * BlockLength;
+	});
+	ParallelFor(BlockNum, [&](int i)
+	{
+		if (GridBlockNodes[i] < 0) return;
+		const FVector BlockOrigin = GridOrigin + BlockCoord(i).cast<double>() * BlockLength;
+		for (int Node = 0; Node < BlockNodeNum; Node++)
+		{
+			const Vector3i Local(Node % NodeAxis, Node / NodeAxis % NodeAxis, Node / (NodeAxis * NodeAxis));
+			Samples.row(GridBlockNodes[i] + Node) = BlockOrigin + Local.cast<double>() * CellSize;
+		}
+	});
+	const VectorXd SampleDistance = ExactSignedDistance(Samples);
+
+	GridNodes.resize(NearNodeNum);
+	GridBlockCorners.resize(CornerNum);
+	ParallelFor(NearNodeNum, [&](int i) { GridNodes[i] = SampleDistance[i]; });
+	ParallelFor(CornerNum, [&](int i) { GridBlockCorners[i] = SampleDistance[NearNodeNum + i]; });
+
+	LOG_INFO("Distance grid, {}x{}x{} blocks of {} cells of size {}, {} near the surface, {:.1f} MB",
+		GridBlockNum.x(), GridBlockNum.y(), GridBlockNum.z(), GridBlockSize, CellSize, NearNum,
+		(GridNodes.size() + GridBlockCorners.size()) * sizeof(float) / 1024. / 1024.);
+}
+
+void OrientedSurfaceComponent::ClearDistanceGrid()
+{
+	GridBlockNodes.clear();
+	GridBlockCorners.clear();
+	GridNodes.clear();
+}
+
+bool OrientedSurfaceComponent::GridSignedDistance(const FVector& Point, double& Distance) const
+{
+	const FVector Cell = (Point - GridOrigin) / GridCellSize;
+	const Vector3i BlockNumCells = GridBlockNum * GridBlockSize;
+	if ((Cell.array() < 0.).any() || (Cell.array() >= BlockNumCells.cast<double>().array()).any())
+		return false;
+
+	auto Trilinear = [](const FVector& T, auto&& Node) {
+		const double X00 = Node(0, 0, 0) * (1. - T.x()) + Node(1, 0, 0) * T.x();
+		const double X10 = Node(0, 1, 0) * (1. - T.x()) + Node(1, 1, 0) * T.x();
+		const double X01 = Node(0, 0, 1) * (1. - T.x()) + Node(1, 0, 1) * T.x();
+		const double X11 = Node(0, 1, 1) * (1. - T.x()) + Node(1, 1, 1) * T.x();
+		const double Y0 = X00 * (1. - T.y()) + X10 * T.y();
+		const double Y1 = X01 * (1. - T.y()) + X11 * T.y();
+		return Y0 * (1. - T.z()) + Y1 * T.z();
+	};
+
+	const Vector3i CellIndex = Cell.cast<int>();
+	const Vector3i Block = CellIndex / GridBlockSize;
+	const int Nodes = GridBlockNodes[Block.x() + GridBlockNum.x() * (Block.y() + GridBlockNum.y() * Block.z())];
+	if (Nodes < 0)
+	{
+		// Far from the surface, all corners share the sign and the interpolation keeps it
+		const Vector3i CornerAxis = GridBlockNum.array() + 1;
+		Distance = Trilinear(Cell / GridBlockSize - Block.cast<double>(), [&](int X, int Y, int Z) {
+			return (double)GridBlockCorners[(Block.x() + X) + CornerAxis.x() * ((Block.y() + Y) + CornerAxis.y() * (Block.z() + Z))];
+		});
+		return true;
+	}
+
+	constexpr int NodeAxis = GridBlockSize + 1;
+	const Vector3i Local = CellIndex - Block * GridBlockSize;
+	Distance = Trilinear(Cell - CellIndex.cast<double>(), [&](int X, int Y, int Z) {
+		return (double)GridNodes[Nodes + (Local.x() + X) + NodeAxis * ((Local.y() + Y) + NodeAxis * (Local.z() + Z))];
+	});
+	return std::abs(Distance) >= GridRefineDistance;
+}
+
+VectorXd OrientedSurfaceComponent::GridSignedDistance(const MatrixX3d& Points, bool bExactInsideOnly) const
+{
+	VectorXd Result(Points.rows());
+	TArray<uint8_t> bRefine(Points.rows());
+	ParallelFor(Points.rows(), [&](int i) { bRefine[i] = !GridSignedDistance(FVector(Points.row(i)), Result[i]); });
+
+	TArray<int> Refine;
+	for (int i = 0; i < Points.rows(); i++)
+		if (bRefine[i])
+			Refine.push_back(i);
+	if (Refine.empty())
+		return Result;
+
+	MatrixX3d RefinePoints(Refine.size(), 3);
+	for (int i = 0; i < (int)Refine.size(); i++)
+		RefinePoints.row(i) = Points.row(Refine[i]);
+	if (bExactInsideOnly)
+	{
+		// Only the sign is read, skip the exact distance
+		const auto In = ExactInside(RefinePoints);
+		for (int i = 0; i < (int)Refine.size(); i++)
+			Result[Refine[i]] = In[i] ? -1. : 1.;
+	}
+	else
+	{
+		const VectorXd Exact = ExactSignedDistance(RefinePoints);
+		for (int i = 0; i < (int)Refine.size(); i++)
+			Result[Refine[i]] = Exact[i];
+	}
+	return Result;
+}
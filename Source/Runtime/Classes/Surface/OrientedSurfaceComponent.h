@@ -64,9 +64,45 @@ public:
 			return -sdf->operator()(Point.cast<float>().transpose(), false, 1)[0];
 	}
 
+	/**
+	 * Batched queries over the rows of Points, in parallel.
+	 * Use the distance grid when it is built, exact queries otherwise.
+	 */
+	Eigen::Matrix<bool, Eigen::Dynamic, 1> Inside(const MatrixX3d& Points) const;
+
+	VectorXd Distance(const MatrixX3d& Points) const;
+
+	VectorXd SignedDistance(const MatrixX3d& Points) const;
+
+	/**
+	 * Sample signed distances on a sparse grid of blocks of 8^3 cells, only blocks near the surface store their nodes.
+	 * Batched queries then use trilinear lookup, and only run exact queries within RefineDistance of the surface.
+	 * Points in far blocks interpolate the distances at the block corners, the surface does not cross them so the sign stays exact.
+	 * @param CellSize Grid spacing, smaller is more accurate and uses more memory
+	 * @param RefineDistance Queries nearer to the surface are exact, negative for one cell diagonal
+	 */
+	void BuildDistanceGrid(double CellSize, double RefineDistance = -1.);
+
+	void ClearDistanceGrid();
+
+	FORCEINLINE bool HasDistanceGrid() const { return !GridBlockNodes.empty(); }
+
 protected:
 	OrientedSurfaceComponent() = default;
 
+	VectorXd ExactSignedDistance(const MatrixX3d& Points) const;
+
+	Eigen::Matrix<bool, Eigen::Dynamic, 1> ExactInside(const MatrixX3d& Points) const;
+
+	/**
+	 * Signed distance from the grid
+	 * @return false if the point is outside the grid or within the refine distance, and needs an exact query
+	 */
+	bool GridSignedDistance(const FVector& Point, double& Distance) const;
+
+	/** Grid lookup of each point, exact queries for the rest in one batch */
+	VectorXd GridSignedDistance(const MatrixX3d& Points, bool bExactInsideOnly) const;
+
 	Eigen::MatrixXd V;
 	Eigen::MatrixXi F;
 	void Build(const ObjectPtr<StaticMesh>& OrientedMesh, bool bUseWindingNumber = true, bool bInverse = false);
@@ -82,4 +118,15 @@ protected:
 	igl::AABB<MatrixXd, 3> AABB;
 
 	UniquePtr<sdf::SDF> sdf = nullptr;
+
+	static constexpr int GridBlockSize = 8;
+	FVector GridOrigin = FVector::Zero();
+	Vector3i GridBlockNum = Vector3i::Zero();
+	double GridCellSize = 0.;
+	double GridRefineDistance = 0.;
+	// Offset of the (GridBlockSize + 1)^3 nodes of each block in GridNodes, -1 for blocks far from the surface
+	TArray<int> GridBlockNodes;
+	// Signed distance at the corners of the blocks, (GridBlockNum + 1)^3 nodes
+	TArray<float> GridBlockCorners;
+	TArray<float> GridNodes;
 };
@@ -3,52 +3,187 @@
 //
 
 #include "CurveDistance.h"
+#include "Math/Geometry.h"
 
+#include <atomic>
+#include <bvh/v2/default_builder.h>
+#include <bvh/v2/bbox.h>
+#include <bvh/v2/node.h>
+#include <bvh/v2/vec.h>
 
-double MechEngine::Algorithm::DiscreteFrechetDistance(const TArray<FVector>& CurveA, const TArray<FVector>& CurveB)
+namespace
 {
-	ASSERTMSG(!CurveA.empty() && !CurveB.empty(), "CurveA or CurveB is empty");
-	auto Dist = [](const FVector& A, const FVector& B) { return (A - B).norm(); };
-	const int m = CurveA.size();
-	const int n = CurveB.size();
-	TArray<TArray<double>> C(m, TArray<double>(n));
-
-	C[0][0] = Dist(CurveA[0], CurveB[0]);
-	for (int i = 1; i < m; i++)
-		C[i][0] = std::max( Dist(CurveA[i], CurveB[0]), C[i - 1][0]);
-	for (int j = 1; j < n; j++)
-		C[0][j] = std::max( Dist(CurveA[0], CurveB[j]), C[0][j - 1]);
-	for (int i = 1; i < m; i++)
+	/**
+	 * Warping distance over the m x n coupling matrix keeping only two rows.
+	 * The inner dimension is always the shorter curve, both distances are symmetric.
+	 * Cells outside the band are treated as +inf, guarded by range checks instead of clearing the rows.
+	 */
+	template <bool bFrechet>
+	double WarpingDistance(const TArray<FVector>& CurveA, const TArray<FVector>& CurveB, int Band, double Threshold)
 	{
-		for (int j = 1; j < n; j++)
+		ASSERTMSG(!CurveA.empty() && !CurveB.empty(), "CurveA or CurveB is empty");
+		const bool bSwap = CurveA.size() < CurveB.size();
+		const TArray<FVector>& Rows = bSwap ? CurveB : CurveA;
+		const TArray<FVector>& Cols = bSwap ? CurveA : CurveB;
+		const int m = Rows.size();
+		const int n = Cols.size();
+		constexpr double Inf = std::numeric_limits<double>::infinity();
+
+		auto Combine = [](double Best, double D) { return bFrechet ? std::max(Best, D) : Best + D; };
+		// Band is centered on the diagonal scaled to the aspect ratio, slope <= 1 keeps consecutive rows connected
+		const double Slope = m > 1 ? double(n - 1) / double(m - 1) : 0.;
+		auto RowRange = [&](int i) -> std::pair<int, int> {
+			if (Band < 0) return {0, n - 1};
+			const double Center = i * Slope;
+			return {std::max(0, int(std::floor(Center)) - Band), std::min(n - 1, int(std::ceil(Center)) + Band)};
+		};
+
+		TArray<double> Prev(n, Inf), Curr(n, Inf);
+		auto [PrevLo, PrevHi] = RowRange(0);
+		double RowMin = Inf;
+		for (int j = PrevLo; j <= PrevHi; j++)
+		{
+			const double D = (Rows[0] - Cols[j]).norm();
+			Prev[j] = j == 0 ? D : Combine(Prev[j - 1], D);
+			RowMin = std::min(RowMin, Prev[j]);
+		}
+		if (RowMin > Threshold) return Inf;
+
+		for (int i = 1; i < m; i++)
 		{
-			C[i][j] = std::min({C[i - 1][j], C[i][j - 1], C[i - 1][j - 1]});
-			C[i][j] = std::max(C[i][j], Dist(CurveA[i], CurveB[j]));
+			auto [Lo, Hi] = RowRange(i);
+			RowMin = Inf;
+			for (int j = Lo; j <= Hi; j++)
+			{
+				double Best = (j >= PrevLo && j <= PrevHi) ? Prev[j] : Inf;
+				if (j > Lo)
+					Best = std::min(Best, Curr[j - 1]);
+				if (j - 1 >= PrevLo && j - 1 <= PrevHi)
+					Best = std::min(Best, Prev[j - 1]);
+				Curr[j] = Combine(Best, (Rows[i] - Cols[j]).norm());
+				RowMin = std::min(RowMin, Curr[j]);
+			}
+			// Both costs are monotone along any warping path, so the row minimum bounds the final result
+			if (RowMin > Threshold) return Inf;
+			std::swap(Prev, Curr);
+			PrevLo = Lo, PrevHi = Hi;
 		}
+		return PrevHi == n - 1 ? Prev[n - 1] : Inf;
+	}
+
+	/**
+	 * Warping distance of every candidate to the target.
+	 * Without bNearestOnly every candidate is exact. Otherwise each one is abandoned against the nearest distance found so far,
+	 * shared by the workers, so most losing candidates stop after a few rows.
+	 */
+	template <bool bFrechet>
+	TArray<double> BatchWarpingDistance(const TArray<FVector>& Target, const TArray<TArray<FVector>>& Candidates, int Band, bool bNearestOnly)
+	{
+		constexpr double Inf = std::numeric_limits<double>::infinity();
+		TArray<double> Result(Candidates.size(), Inf);
+		std::atomic<double> Nearest = Inf;
+		ParallelFor(Candidates.size(), [&](int i) {
+			const double Threshold = bNearestOnly ? Nearest.load(std::memory_order_relaxed) : Inf;
+			const double D = WarpingDistance<bFrechet>(Target, Candidates[i], Band, Threshold);
+			Result[i] = D;
+			if (bNearestOnly)
+			{
+				double Current = Nearest.load(std::memory_order_relaxed);
+				while (D < Current && !Nearest.compare_exchange_weak(Current, D, std::memory_order_relaxed)) {}
+			}
+		});
+		return Result;
 	}
-	return C[m - 1][n - 1];
 }
 
-double MechEngine::Algorithm::DTWDistance(const TArray<FVector>& CurveA, const TArray<FVector>& CurveB)
+double MechEngine::Algorithm::DiscreteFrechetDistance(const TArray<FVector>& CurveA, const TArray<FVector>& CurveB, int Band, double Threshold)
 {
-	auto Dist = [](const FVector& A, const FVector& B) { return (A - B).norm(); };
-	const int m = CurveA.size();
-	const int n = CurveB.size();
-	TArray<TArray<double>> C(m, TArray<double>(n));
-
-	C[0][0] = Dist(CurveA[0], CurveB[0]);
-	for (int i = 1; i < m; i++)
-		C[i][0] = Dist(CurveA[i], CurveB[0]) + C[i - 1][0];
-	for (int j = 1; j < n; j++)
-		C[0][j] = Dist(CurveA[0], CurveB[j]) + C[0][j - 1];
-
-	for (int i = 1; i < m; i++)
+	return WarpingDistance<true>(CurveA, CurveB, Band, Threshold);
+}
+
+double MechEngine::Algorithm::DTWDistance(const TArray<FVector>& CurveA, const TArray<FVector>& CurveB, int Band, double Threshold)
+{
+	return WarpingDistance<false>(CurveA, CurveB, Band, Threshold);
+}
+
+TArray<double> MechEngine::Algorithm::BatchDiscreteFrechetDistance(const TArray<FVector>& Target, const TArray<TArray<FVector>>& Candidates,
+	int Band, bool bNearestOnly)
+{
+	return BatchWarpingDistance<true>(Target, Candidates, Band, bNearestOnly);
+}
+
+TArray<double> MechEngine::Algorithm::BatchDTWDistance(const TArray<FVector>& Target, const TArray<TArray<FVector>>& Candidates,
+	int Band, bool bNearestOnly)
+{
+	return BatchWarpingDistance<false>(Target, Candidates, Band, bNearestOnly);
+}
+
+double MechEngine::Algorithm::PolylineMinimumDistance(const TArray<FVector>& CurveA, const TArray<FVector>& CurveB)
+{
+	using Vec3 = bvh::v2::Vec<double, 3>;
+	using BBox = bvh::v2::BBox<double, 3>;
+	using Node = bvh::v2::Node<double, 3>;
+	using Bvh  = bvh::v2::Bvh<Node>;
+
+	if (CurveA.size() < 2 || CurveB.size() < 2)
+		return std::numeric_limits<double>::max();
+
+	auto ToVec3 = [](const FVector& T) { return Vec3(T.x(), T.y(), T.z()); };
+	auto SegmentBox = [&](const FVector& P0, const FVector& P1) {
+		BBox Box = BBox::make_empty();
+		Box.extend(ToVec3(P0));
+		Box.extend(ToVec3(P1));
+		return Box;
+	};
+	auto BoxDistance = [](const BBox& A, const BBox& B) {
+		double D = 0.;
+		for (int k = 0; k < 3; k++)
+		{
+			const double Gap = std::max({0., A.min[k] - B.max[k], B.min[k] - A.max[k]});
+			D += Gap * Gap;
+		}
+		return std::sqrt(D);
+	};
+
+	const int SegNum = CurveB.size() - 1;
+	TArray<BBox> BBoxes(SegNum);
+	TArray<Vec3> Centers(SegNum);
+	for (int i = 0; i < SegNum; i++)
 	{
-		for (int j = 1; j < n; j++)
+		BBoxes[i] = SegmentBox(CurveB[i], CurveB[i + 1]);
+		Centers[i] = BBoxes[i].get_center();
+	}
+	Bvh SegmentBvh = bvh::v2::DefaultBuilder<Node>::build(BBoxes, Centers);
+
+	double D = std::numeric_limits<double>::max();
+	TArray<size_t> Stack;
+	for (int i = 0; i + 1 < CurveA.size(); i++)
+	{
+		const FVector& P0 = CurveA[i];
+		const FVector& P1 = CurveA[i + 1];
+		const BBox QueryBox = SegmentBox(P0, P1);
+		Stack.clear();
+		Stack.push_back(0);
+		while (!Stack.empty())
 		{
-			C[i][j] = std::min({C[i - 1][j], C[i][j - 1], C[i - 1][j - 1]});
-			C[i][j] += Dist(CurveA[i], CurveB[j]);
+			const Node& Current = SegmentBvh.nodes[Stack.back()];
+			Stack.pop_back();
+			if (BoxDistance(QueryBox, Current.get_bbox()) >= D)
+				continue;
+			if (Current.is_leaf())
+			{
+				for (size_t k = 0; k < Current.index.prim_count; k++)
+				{
+					const size_t Seg = SegmentBvh.prim_ids[Current.index.first_id + k];
+					D = std::min(D, std::get<0>(Math::SegmentSegmentDistance(P0, P1, CurveB[Seg], CurveB[Seg + 1])));
+				}
+			}
+			else
+			{
+				Stack.push_back(Current.index.first_id);
+				Stack.push_back(Current.index.first_id + 1);
+			}
 		}
 	}
-	return C[m - 1][n - 1];
-}
\ No newline at end of file
+	return D;
+}
@@ -11,11 +11,40 @@ namespace MechEngine::Algorithm
 
 	//WARNING: Not test yet
 
-	// Discrete Frechet Distance
-	// Math : https://en.wikipedia.org/wiki/Fr%C3%A9chet_distance
-	ENGINE_API double DiscreteFrechetDistance(const TArray<FVector> &CurveA, const TArray<FVector> &CurveB);
+	/**
+	 * Discrete Frechet Distance, computed with two rows of O(min(m, n)) memory.
+	 * Math : https://en.wikipedia.org/wiki/Fr%C3%A9chet_distance
+	 * @param Band Sakoe-Chiba band radius in samples around the (scaled) diagonal, negative means unconstrained
+	 * @param Threshold early abandon bound, returns +inf as soon as the distance is known to exceed it
+	 */
+	ENGINE_API double DiscreteFrechetDistance(const TArray<FVector> &CurveA, const TArray<FVector> &CurveB,
+		int Band = -1, double Threshold = std::numeric_limits<double>::infinity());
 
-	// @see https://en.wikipedia.org/wiki/Dynamic_time_warping
-	ENGINE_API double DTWDistance(const TArray<FVector>& CurveA, const TArray<FVector>& CurveB);
+	/**
+	 * Dynamic time warping distance, computed with two rows of O(min(m, n)) memory.
+	 * @see https://en.wikipedia.org/wiki/Dynamic_time_warping
+	 * @param Band Sakoe-Chiba band radius in samples around the (scaled) diagonal, negative means unconstrained
+	 * @param Threshold early abandon bound, returns +inf as soon as the distance is known to exceed it
+	 */
+	ENGINE_API double DTWDistance(const TArray<FVector>& CurveA, const TArray<FVector>& CurveB,
+		int Band = -1, double Threshold = std::numeric_limits<double>::infinity());
 
-}
\ No newline at end of file
+	/**
+	 * Compare one target curve against many candidates in parallel.
+	 * @param bNearestOnly Abandon each candidate as soon as it is known to be farther than the nearest one found so far,
+	 * the nearest candidate keeps its exact distance and abandoned ones get +inf
+	 * @return distance of each candidate to the target, in the same order as Candidates
+	 */
+	ENGINE_API TArray<double> BatchDiscreteFrechetDistance(const TArray<FVector>& Target, const TArray<TArray<FVector>>& Candidates,
+		int Band = -1, bool bNearestOnly = false);
+
+	ENGINE_API TArray<double> BatchDTWDistance(const TArray<FVector>& Target, const TArray<TArray<FVector>>& Candidates,
+		int Band = -1, bool bNearestOnly = false);
+
+	/**
+	 * Minimum distance between two polylines, segments of CurveB are organized in a BVH
+	 * and pruned by box distance against the best distance found so far.
+	 */
+	ENGINE_API double PolylineMinimumDistance(const TArray<FVector>& CurveA, const TArray<FVector>& CurveB);
+
+}
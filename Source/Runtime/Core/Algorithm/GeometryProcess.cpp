@@ -7,7 +7,7 @@
 #include "igl/swept_volume.h"
 #include "Math/FTransform.h"
 #include "Mesh/MeshBoolean.h"
-#include "igl/vertex_components.h"
+#include "Mesh/MeshFairingSolver.h"
 
 #include <CGAL/Exact_predicates_exact_constructions_kernel.h>
 #include <CGAL/Polygon_mesh_processing/polygon_soup_to_polygon_mesh.h>
@@ -134,7 +134,8 @@ namespace MechEngine::Algorithm::GeometryProcess
 
 	void SmoothMesh(Eigen::MatrixX3d& verM, Eigen::MatrixX3i& triM, int Iteration, bool UseUniformLaplacian)
 	{
-
+		MeshFairingSolver Solver(MakeShared<MeshTopology>(triM, verM.rows()));
+		Solver.Smooth(verM, Iteration, UseUniformLaplacian);
 	}
 
 
@@ -156,24 +157,24 @@ namespace MechEngine::Algorithm::GeometryProcess
 
 	TArray<ObjectPtr<StaticMesh>> DivideMeshIntoComponents(const ObjectPtr<StaticMesh>& Mesh)
 	{
-		Eigen::ArrayXi VertexComponent;
-		igl::vertex_components(Mesh->triM, VertexComponent);
-		int ComponentCount = VertexComponent.maxCoeff() + 1;
+		auto Topology = Mesh->GetTopology();
+		const TArray<int>& VertexComponent = Topology->GetVertexComponents();
+		int ComponentCount = Topology->GetComponentNum();
 		if (ComponentCount == 1)
 			return { NewObject<StaticMesh>(*Mesh) };
-		TMap<int, int>	  VertexMap; // Map from old vertex index to new vertex index
+		TArray<int> VertexMap(Mesh->verM.rows()); // Map from old vertex index to new vertex index
 		TArray<TArray<FVector>>  verM(ComponentCount);
 		TArray<TArray<Vector3i>> Indicies(ComponentCount);
 		for (int i = 0; i < Mesh->verM.rows(); ++i)
 		{
-			int ComponentIndex = VertexComponent(i);
+			int ComponentIndex = VertexComponent[i];
 			VertexMap[i] = verM[ComponentIndex].size();
 			verM[ComponentIndex].emplace_back(Mesh->verM.row(i));
 		}
 		for (int i = 0; i < Mesh->triM.rows(); ++i)
 		{
 			Vector3i Tri = Mesh->triM.row(i);
-			int		 ComponentIndex = VertexComponent(Tri(0));
+			int		 ComponentIndex = VertexComponent[Tri(0)];
 			for (int j = 0; j < 3; ++j)
 				Tri(j) = VertexMap[Tri(j)];
 			Indicies[ComponentIndex].emplace_back(Tri);
@@ -188,9 +189,7 @@ namespace MechEngine::Algorithm::GeometryProcess
 
 	int MeshComponentsCount(const ObjectPtr<StaticMesh>& Mesh)
 	{
-		Eigen::ArrayXi VertexComponent;
-		igl::vertex_components(Mesh->triM, VertexComponent);
-		return VertexComponent.maxCoeff() + 1;
+		return Mesh->GetTopology()->GetComponentNum();
 	}
 
 
@@ -20,7 +20,7 @@ namespace MechEngine::Algorithm::GeometryProcess
 	// Fill all holes in the mesh, return false if there is no hole
 	ENGINE_API bool FillAllHoles(Eigen::MatrixX3d& Vertices, Eigen::MatrixX3i& Triangles);
 
-	// Explicit smooth the mesh cotan Laplacian
+	// Implicit smooth the mesh with cotan Laplacian, use MeshFairingSolver to keep the factorization over calls
 	ENGINE_API void SmoothMesh(Eigen::MatrixX3d& Vertices, Eigen::MatrixX3i& Triangles, int Iteration = 5, bool UseUniformLaplacian = false);
 
 	/**
@@ -6,7 +6,6 @@
 #include "tinysplinecxx.h"
 #include <cmath>
 #include <algorithm>
-#include <array>
 #include <stdexcept>
 #include <vector>
 
@@ -22,61 +21,328 @@ double SplineCurvature(const tinyspline::BSpline& spline, double u, int Dimensio
 	// Clamp u to [0, 1]
 	u = std::clamp(u, 0.0, 1.0);
 
-	// Evaluate the first derivative
-	tinyspline::BSpline firstDeriv;
-	std::vector<tinyspline::real> r1;
-	try
+	CompiledSpline Compiled(spline, 0);
+	if (!Compiled.IsValid())
+		return 0.;
+	if (Dimension == 3)
+		return Compiled.Curvature(u);
+
+	// Compute curvature for 2D, ignore other components
+	FVector r1 = Compiled.Derivative(u, 1), r2 = Compiled.Derivative(u, 2);
+	double normR1 = r1.head<2>().norm();
+	if (normR1 == 0.)
+		return 0.;
+	return std::abs(r1[0] * r2[1] - r1[1] * r2[0]) / (normR1 * normR1 * normR1);
+}
+
+namespace
+{
+	// 5 point Gauss-Legendre on [0, 1]
+	constexpr double GaussNodes[5] = { 0.04691007703066800, 0.23076534494715845, 0.5, 0.76923465505284155, 0.95308992296933200 };
+	constexpr double GaussWeights[5] = { 0.11846344252809454, 0.23931433524968324, 0.28444444444444444, 0.23931433524968324, 0.11846344252809454 };
+}
+
+CompiledSpline::CompiledSpline(const tinyspline::BSpline& Spline, int InArcLengthSubdivision)
+{
+	const int Dimension = Spline.dimension();
+	if (Dimension < 1 || Dimension > 3)
+	{
+		LOG_ERROR("CompiledSpline only supports dimension 1 to 3, got {}", Dimension);
+		return;
+	}
+
+	// Bezier segments, each with Degree + 1 own control points and knots repeated Degree + 1 times
+	tinyspline::BSpline Beziers = Spline.toBeziers();
+	Degree = Beziers.degree();
+	const int Order = Degree + 1;
+	const std::vector<tinyspline::real> ControlPoints = Beziers.controlPoints();
+	const std::vector<tinyspline::real> Knots = Beziers.knots();
+	const int SegmentNum = Beziers.numControlPoints() / Order;
+
+	// Binomial coefficients up to Degree
+	TArray<TArray<double>> Binomial(Order, TArray<double>(Order, 0.));
+	for (int n = 0; n < Order; n++)
 	{
-		firstDeriv = spline.derive(1);
-		r1 = firstDeriv.eval(u).result();
+		Binomial[n][0] = 1.;
+		for (int k = 1; k <= n; k++)
+			Binomial[n][k] = Binomial[n - 1][k - 1] + (k < n ? Binomial[n - 1][k] : 0.);
 	}
-	catch (const std::runtime_error& e)
+
+	for (int Segment = 0; Segment < SegmentNum; Segment++)
 	{
-		return 0.;
+		const double Begin = Knots[Segment * Order], End = Knots[(Segment + 1) * Order];
+		if (End <= Begin)
+			continue;
+		if (Breaks.empty())
+			Breaks.push_back(Begin);
+		Breaks.push_back(End);
+
+		auto Point = [&](int i) {
+			FVector P = FVector::Zero();
+			for (int d = 0; d < Dimension; d++)
+				P[d] = ControlPoints[(Segment * Order + i) * Dimension + d];
+			return P;
+		};
+		// Bezier to power basis: a_j = C(p, j) * sum_i (-1)^(j - i) C(j, i) P_i
+		for (int j = 0; j <= Degree; j++)
+		{
+			FVector Coeff = FVector::Zero();
+			for (int i = 0; i <= j; i++)
+				Coeff += ((j - i) % 2 ? -1. : 1.) * Binomial[j][i] * Point(i);
+			Coeffs.push_back(Binomial[Degree][j] * Coeff);
+		}
 	}
 
-	tinyspline::BSpline secondDeriv;
-	std::vector<tinyspline::real> r2;
+	if (IsValid() && InArcLengthSubdivision > 0)
+		BuildArcLengthTable(InArcLengthSubdivision);
+}
+
+CompiledSpline CompiledSpline::InterpolateCatmullRom(const TArray<FVector>& Points, int ArcLengthSubdivision)
+{
+	std::vector<tinyspline::real> Data(Points.size() * 3);
+	for (int i = 0; i < Points.size(); i++)
+		for (int d = 0; d < 3; d++)
+			Data[i * 3 + d] = Points[i][d];
+	return CompiledSpline(tinyspline::BSpline::interpolateCatmullRom(Data, 3), ArcLengthSubdivision);
+}
 
-	try
+int CompiledSpline::FindSpan(double u, int Hint) const
+{
+	const int SpanNum = GetSpanNum();
+	if (Hint >= 0 && Hint < SpanNum)
 	{
-		secondDeriv = spline.derive(2);
-		r2 = secondDeriv.eval(u).result();
+		if (Breaks[Hint] <= u && (u < Breaks[Hint + 1] || Hint == SpanNum - 1))
+			return Hint;
+		if (Hint + 1 < SpanNum && Breaks[Hint + 1] <= u && (u < Breaks[Hint + 2] || Hint + 1 == SpanNum - 1))
+			return Hint + 1;
 	}
-	catch (const std::runtime_error& e)
+	const int Span = std::upper_bound(Breaks.begin(), Breaks.end(), u) - Breaks.begin() - 1;
+	return std::clamp(Span, 0, SpanNum - 1);
+}
+
+void CompiledSpline::EvaluateSpan(int Span, double u, int MaxOrder, FVector* Out) const
+{
+	const double Begin = Breaks[Span], Length = Breaks[Span + 1] - Begin;
+	const double t = (u - Begin) / Length;
+	const FVector* C = &Coeffs[Span * (Degree + 1)];
+	double Scale = 1.;
+	for (int k = 0; k <= MaxOrder; k++)
 	{
-		return 0.;
+		// k-th derivative: sum_j c_j * j! / (j - k)! * t^(j - k), Horner from the highest term
+		FVector Value = FVector::Zero();
+		for (int j = Degree; j >= k; j--)
+		{
+			double Falling = 1.;
+			for (int m = 0; m < k; m++)
+				Falling *= j - m;
+			Value = Value * t + Falling * C[j];
+		}
+		Out[k] = Value * Scale;
+		Scale /= Length;
 	}
+}
 
-	// Compute norm of the first derivativew
-	double normR1 = 0.0;
-	for (int i = 0; i < Dimension; ++i) {
-		normR1 += r1[i] * r1[i];
+FVector CompiledSpline::Evaluate(double u) const
+{
+	u = std::clamp(u, GetDomainMin(), GetDomainMax());
+	FVector Result;
+	EvaluateSpan(FindSpan(u), u, 0, &Result);
+	return Result;
+}
+
+FVector CompiledSpline::Derivative(double u, int Order) const
+{
+	if (Order > Degree)
+		return FVector::Zero();
+	u = std::clamp(u, GetDomainMin(), GetDomainMax());
+	FVector Result[3];
+	if (Order <= 2)
+	{
+		EvaluateSpan(FindSpan(u), u, Order, Result);
+		return Result[Order];
+	}
+	// Rare high order, evaluate term by term
+	const int Span = FindSpan(u);
+	const double Length = Breaks[Span + 1] - Breaks[Span], t = (u - Breaks[Span]) / Length;
+	FVector Value = FVector::Zero();
+	for (int j = Degree; j >= Order; j--)
+	{
+		double Falling = 1.;
+		for (int m = 0; m < Order; m++)
+			Falling *= j - m;
+		Value = Value * t + Falling * Coeffs[Span * (Degree + 1) + j];
 	}
-	normR1 = std::sqrt(normR1);
+	return Value / std::pow(Length, Order);
+}
 
-	if (normR1 == 0) {
-		throw std::runtime_error("First derivative norm is zero; curvature is undefined.");
+double CompiledSpline::Curvature(double u) const
+{
+	u = std::clamp(u, GetDomainMin(), GetDomainMax());
+	FVector D[3];
+	EvaluateSpan(FindSpan(u), u, 2, D);
+	const double Speed = D[1].norm();
+	if (Speed == 0.)
+		return 0.;
+	return D[1].cross(D[2]).norm() / (Speed * Speed * Speed);
+}
+
+double CompiledSpline::SpanArcLength(int Span, double From, double To) const
+{
+	double Result = 0.;
+	for (int i = 0; i < 5; i++)
+	{
+		FVector D[2];
+		EvaluateSpan(Span, From + (To - From) * GaussNodes[i], 1, D);
+		Result += GaussWeights[i] * D[1].norm();
 	}
+	return Result * (To - From);
+}
 
-	if (Dimension == 2) {
-		// Compute curvature for 2D
-		double crossProduct = r1[0] * r2[1] - r1[1] * r2[0];
-		return std::abs(crossProduct) / (normR1 * normR1 * normR1);
-	} else if (Dimension == 3) {
-		// Compute curvature for 3D
-		std::array<double, 3> crossProduct = {
-			r1[1] * r2[2] - r1[2] * r2[1],
-			r1[2] * r2[0] - r1[0] * r2[2],
-			r1[0] * r2[1] - r1[1] * r2[0]
-		};
-		double normCross = 0.0;
-		for (double val : crossProduct) {
-			normCross += val * val;
+void CompiledSpline::BuildArcLengthTable(int Subdivision)
+{
+	ArcLengthSubdivision = Subdivision;
+	const int SpanNum = GetSpanNum();
+	ArcLengthParams.resize(SpanNum * Subdivision + 1);
+	ArcLength.resize(SpanNum * Subdivision + 1);
+	ArcLengthParams[0] = Breaks[0];
+	ArcLength[0] = 0.;
+	for (int Span = 0; Span < SpanNum; Span++)
+	{
+		const double Begin = Breaks[Span], Step = (Breaks[Span + 1] - Begin) / Subdivision;
+		for (int k = 0; k < Subdivision; k++)
+		{
+			const int Index = Span * Subdivision + k;
+			const double From = Begin + k * Step;
+			const double To = k + 1 == Subdivision ? Breaks[Span + 1] : From + Step;
+			ArcLengthParams[Index + 1] = To;
+			ArcLength[Index + 1] = ArcLength[Index] + SpanArcLength(Span, From, To);
 		}
-		normCross = std::sqrt(normCross);
+	}
+}
+
+double CompiledSpline::ParameterToArcLength(double u) const
+{
+	if (ArcLength.empty())
+		return 0.;
+	u = std::clamp(u, GetDomainMin(), GetDomainMax());
+	const int Span = FindSpan(u);
+	const double Begin = Breaks[Span], Length = Breaks[Span + 1] - Begin;
+	const int k = std::min(static_cast<int>((u - Begin) / Length * ArcLengthSubdivision), ArcLengthSubdivision - 1);
+	const int Index = Span * ArcLengthSubdivision + k;
+	return ArcLength[Index] + SpanArcLength(Span, ArcLengthParams[Index], u);
+}
+
+double CompiledSpline::ArcLengthToParameter(double s) const
+{
+	int Hint = 0;
+	return ArcLengthToParameter(s, Hint);
+}
+
+double CompiledSpline::ArcLengthToParameter(double s, int& Hint) const
+{
+	if (ArcLength.empty())
+		return IsValid() ? GetDomainMin() : 0.;
+	const int EntryNum = ArcLength.size();
+	s = std::clamp(s, 0., GetLength());
 
-		return normCross / (normR1 * normR1);
+	// Ascending queries walk forward from the hint, otherwise binary search
+	int Index = std::clamp(Hint, 0, EntryNum - 2);
+	if (!(ArcLength[Index] <= s && s <= ArcLength[Index + 1]))
+	{
+		if (Index + 2 < EntryNum && ArcLength[Index + 1] <= s && s <= ArcLength[Index + 2])
+			Index++;
+		else
+			Index = std::clamp(int(std::upper_bound(ArcLength.begin(), ArcLength.end(), s) - ArcLength.begin() - 1), 0, EntryNum - 2);
 	}
+	Hint = Index;
+
+	double Lo = ArcLengthParams[Index], Hi = ArcLengthParams[Index + 1];
+	const double EntryLength = ArcLength[Index + 1] - ArcLength[Index];
+	const double Target = s - ArcLength[Index];
+	if (EntryLength <= 0.)
+		return Lo;
+
+	// Newton on the arc length inside one table entry, bisection keeps it in the bracket
+	const int Span = Index / ArcLengthSubdivision;
+	const double Start = Lo;
+	double u = Lo + (Hi - Lo) * Target / EntryLength;
+	for (int Iteration = 0; Iteration < 8; Iteration++)
+	{
+		const double Error = SpanArcLength(Span, Start, u) - Target;
+		if (std::abs(Error) < 1e-12 * std::max(1., GetLength()))
+			break;
+		Error > 0. ? Hi = u : Lo = u;
+		FVector D[2];
+		EvaluateSpan(Span, u, 1, D);
+		const double Speed = D[1].norm();
+		double Next = Speed > 0. ? u - Error / Speed : 0.5 * (Lo + Hi);
+		if (Next <= Lo || Next >= Hi)
+			Next = 0.5 * (Lo + Hi);
+		u = Next;
+	}
+	return u;
+}
+
+void CompiledSpline::ArcLengthToParameter(const TArray<double>& Lengths, TArray<double>& Out) const
+{
+	Out.resize(Lengths.size());
+	int Hint = 0;
+	for (int i = 0; i < Lengths.size(); i++)
+		Out[i] = ArcLengthToParameter(Lengths[i], Hint);
+}
+
+void CompiledSpline::Evaluate(const TArray<double>& Params, TArray<FVector>& Out) const
+{
+	Out.resize(Params.size());
+	int Span = 0;
+	for (int i = 0; i < Params.size(); i++)
+	{
+		const double u = std::clamp(Params[i], GetDomainMin(), GetDomainMax());
+		Span = FindSpan(u, Span);
+		EvaluateSpan(Span, u, 0, &Out[i]);
+	}
+}
+
+void CompiledSpline::Derivative(const TArray<double>& Params, TArray<FVector>& Out, int Order) const
+{
+	Out.resize(Params.size());
+	if (Order > 2)
+	{
+		for (int i = 0; i < Params.size(); i++)
+			Out[i] = Derivative(Params[i], Order);
+		return;
+	}
+	int Span = 0;
+	FVector D[3];
+	for (int i = 0; i < Params.size(); i++)
+	{
+		const double u = std::clamp(Params[i], GetDomainMin(), GetDomainMax());
+		Span = FindSpan(u, Span);
+		EvaluateSpan(Span, u, Order, D);
+		Out[i] = D[Order];
+	}
+}
+
+void CompiledSpline::Curvature(const TArray<double>& Params, TArray<double>& Out) const
+{
+	Out.resize(Params.size());
+	int Span = 0;
+	FVector D[3];
+	for (int i = 0; i < Params.size(); i++)
+	{
+		const double u = std::clamp(Params[i], GetDomainMin(), GetDomainMax());
+		Span = FindSpan(u, Span);
+		EvaluateSpan(Span, u, 2, D);
+		const double Speed = D[1].norm();
+		Out[i] = Speed == 0. ? 0. : D[1].cross(D[2]).norm() / (Speed * Speed * Speed);
+	}
+}
+
+void CompiledSpline::EquidistantParameters(int Num, TArray<double>& Out) const
+{
+	Out.resize(Num);
+	int Hint = 0;
+	for (int i = 0; i < Num; i++)
+		Out[i] = ArcLengthToParameter(Num > 1 ? GetLength() * i / (Num - 1) : 0., Hint);
+}
 }
-}
\ No newline at end of file
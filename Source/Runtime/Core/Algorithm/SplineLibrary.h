@@ -3,6 +3,8 @@
 //
 
 #pragma once
+#include "CoreMinimal.h"
+
 namespace tinyspline
 {
 	class BSpline;
@@ -11,11 +13,80 @@ namespace SplineLibrary
 {
 /**
  * Calculate the curvature of a spline at a given parameter in terms of parameter u.(Not length)
+ * For repeated evaluation on the same spline use CompiledSpline, which does not rebuild derivatives.
  * @param spline The spline to calculate the curvature of.
  * @param u The parameter at which to calculate the curvature.
  * @param Dimension The dimension of the spline (2D or 3D).
  * @return The curvature of the spline at the given parameter. When discontinuity occurs, return 0.
  */
-double SplineCurvature(const tinyspline::BSpline& spline, double u, int Dimension = 3);
+ENGINE_API double SplineCurvature(const tinyspline::BSpline& spline, double u, int Dimension = 3);
+
+/**
+ * A B-spline (up to 3D) converted once into per span polynomials, with an arc length lookup table.
+ * Evaluation does not allocate and never throws, derivatives at span boundaries are taken from the span
+ * on the right, so discontinuous derivatives are well defined.
+ * Batch calls are fastest with ascending parameters, the last span is reused as a search hint.
+ */
+class ENGINE_API CompiledSpline
+{
+public:
+	CompiledSpline() = default;
+
+	/**
+	 * @param Spline spline to compile, dimension must be 1 to 3
+	 * @param ArcLengthSubdivision arc length table entries per span, 0 to skip building the table
+	 */
+	explicit CompiledSpline(const tinyspline::BSpline& Spline, int ArcLengthSubdivision = 16);
+
+	/** Centripetal Catmull-Rom spline interpolating the points, same as tinyspline::BSpline::interpolateCatmullRom */
+	static CompiledSpline InterpolateCatmullRom(const TArray<FVector>& Points, int ArcLengthSubdivision = 16);
+
+	FORCEINLINE bool IsValid() const { return !Breaks.empty(); }
+	FORCEINLINE double GetDomainMin() const { return Breaks.front(); }
+	FORCEINLINE double GetDomainMax() const { return Breaks.back(); }
+	FORCEINLINE int GetSpanNum() const { return Breaks.size() - 1; }
+
+	/** Total length, 0 if the arc length table is not built */
+	FORCEINLINE double GetLength() const { return ArcLength.empty() ? 0. : ArcLength.back(); }
+
+	FVector Evaluate(double u) const;
+	FVector Derivative(double u, int Order = 1) const;
+	double Curvature(double u) const;
+
+	/** Parameter where the arc length from the start reaches s, s is clamped to [0, Length] */
+	double ArcLengthToParameter(double s) const;
+	double ParameterToArcLength(double u) const;
 
-};
\ No newline at end of file
+	void Evaluate(const TArray<double>& Params, TArray<FVector>& Out) const;
+	void Derivative(const TArray<double>& Params, TArray<FVector>& Out, int Order = 1) const;
+	void Curvature(const TArray<double>& Params, TArray<double>& Out) const;
+	void ArcLengthToParameter(const TArray<double>& Lengths, TArray<double>& Out) const;
+
+	/** Parameters of Num points with equal arc length spacing along the whole spline */
+	void EquidistantParameters(int Num, TArray<double>& Out) const;
+
+protected:
+	/** Span containing u, starting the search from Hint */
+	int FindSpan(double u, int Hint = -1) const;
+
+	/** Value and derivatives up to MaxOrder (at most 2) of span at parameter u */
+	void EvaluateSpan(int Span, double u, int MaxOrder, FVector* Out) const;
+
+	double SpanArcLength(int Span, double From, double To) const;
+
+	/** Arc length lookup starting from table entry Hint, Hint is updated to the entry found */
+	double ArcLengthToParameter(double s, int& Hint) const;
+
+	void BuildArcLengthTable(int Subdivision);
+
+	int Degree = 0;
+	TArray<double> Breaks;  // Span boundaries, GetSpanNum() + 1 entries
+	TArray<FVector> Coeffs; // Power basis coefficients in local parameter [0, 1], (Degree + 1) per span
+
+	// Arc length at uniformly subdivided parameters of each span
+	int ArcLengthSubdivision = 0;
+	TArray<double> ArcLengthParams;
+	TArray<double> ArcLength;
+};
+
+};
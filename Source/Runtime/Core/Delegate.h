@@ -1,26 +1,25 @@
 #pragma once
 #include "ContainerTypes.h"
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 // Ref: https://zhuanlan.zhihu.com/p/663942977
-template<typename R, typename... Args>
-class VDelegate
-{
-public:
-	virtual R Execute(Args... args) = 0;
-	virtual ~VDelegate() {}
-};
-
+// Callables are stored inline in the delegate (small buffer), only large lambdas fall back to the heap.
+// Dispatch goes through a plain function pointer instead of a virtual call.
 
 template<class T, typename R, typename... Args>
-class ObjectDelegate : public VDelegate<R, Args...>
+class ObjectDelegate
 {
 	using FuncPtr = R(T::*)(Args...);
 public:
 	ObjectDelegate(T* p, FuncPtr f) : p(p), fp(f) {}
 
-	R Execute(Args... args)
+	R operator()(Args... args)
 	{
-		return (p->*fp)(args...);
+		return (p->*fp)(std::forward<Args>(args)...);
 	}
 private:
 	T* p;
@@ -28,14 +27,14 @@ private:
 };
 
 template<typename TLambda, typename R, typename... Args>
-class LambdaDelegate : public VDelegate<R, Args...>
+class LambdaDelegate
 {
 public:
-	LambdaDelegate(TLambda Lambda) : Lambda(Lambda) {}
+	LambdaDelegate(TLambda Lambda) : Lambda(std::move(Lambda)) {}
 
-	R Execute(Args... args)
+	R operator()(Args... args)
 	{
-		return Lambda(args...);
+		return Lambda(std::forward<Args>(args)...);
 	}
 private:
 	TLambda Lambda;
@@ -45,48 +44,180 @@ template<typename R, typename... Args>
 class Delegate
 {
 public:
+	// Enough for a member function pointer with its object, or a lambda capturing a few pointers
+	static constexpr size_t InlineSize = 4 * sizeof(void*);
+
 	Delegate() {}
 
 	template<typename T>
 	Delegate(T* P, R(T::* fp)(Args...)) {BindMember(P, fp);}
 
-	template<typename TLambda>
-	Delegate(TLambda Lambda) { BindLambda(Lambda); }
+	template<typename TLambda> requires (!std::is_same_v<std::decay_t<TLambda>, Delegate>)
+	Delegate(TLambda Lambda) { BindLambda(std::move(Lambda)); }
+
+	Delegate(const Delegate& Other) { CopyFrom(Other); }
+	Delegate(Delegate&& Other) noexcept { MoveFrom(Other); }
+
+	Delegate& operator=(const Delegate& Other)
+	{
+		if (this != &Other)
+		{
+			Unbind();
+			CopyFrom(Other);
+		}
+		return *this;
+	}
+
+	Delegate& operator=(Delegate&& Other) noexcept
+	{
+		if (this != &Other)
+		{
+			Unbind();
+			MoveFrom(Other);
+		}
+		return *this;
+	}
+
+	~Delegate() { Unbind(); }
 
 	template<typename T>
 	void BindMember(T* P, R(T::* fp)(Args...))
 	{
-        delete del;
-		del = new ObjectDelegate<T, R, Args...>(P, fp);
+		Emplace<ObjectDelegate<T, R, Args...>>(P, fp);
 	}
-	
+
     template<typename TLambda>
     void BindLambda(TLambda Lambda)
     {
-        delete del;
-        del = new LambdaDelegate<TLambda, R, Args...>(Lambda);
+        Emplace<LambdaDelegate<TLambda, R, Args...>>(std::move(Lambda));
     }
 
-	bool IsBound()
+	void Unbind()
 	{
-		return del != nullptr;
+		if (Manager)
+			Manager(EOperation::Destroy, Storage, nullptr);
+		Invoker = nullptr;
+		Manager = nullptr;
+	}
+
+	bool IsBound() const
+	{
+		return Invoker != nullptr;
 	}
 
 	R Execute(Args... args)
 	{
 		ASSERTMSG(IsBound(), "Delegate not bound");
-		return del->Execute(args...);
+		return Invoker(Storage, std::forward<Args>(args)...);
 	}
 
 	R ExecuteIfBound(Args...args)
 	{
 		if(IsBound())
-			return del->Execute(args...);
+			return Invoker(Storage, std::forward<Args>(args)...);
+		if constexpr (!std::is_void_v<R>)
+			return R();
 	}
+
 private:
-	VDelegate<R, Args...>* del = nullptr;
+	enum class EOperation { Copy, Move, Destroy };
+
+	template<class TCallable>
+	static constexpr bool IsInline = sizeof(TCallable) <= InlineSize
+		&& alignof(TCallable) <= alignof(std::max_align_t)
+		&& std::is_nothrow_move_constructible_v<TCallable>;
+
+	template<class TCallable>
+	static TCallable* Get(void* InStorage)
+	{
+		if constexpr (IsInline<TCallable>)
+			return std::launder(reinterpret_cast<TCallable*>(InStorage));
+		else
+			return *reinterpret_cast<TCallable**>(InStorage);
+	}
+
+	template<class TCallable>
+	static R Invoke(void* InStorage, Args... args)
+	{
+		return (*Get<TCallable>(InStorage))(std::forward<Args>(args)...);
+	}
+
+	template<class TCallable>
+	static void Manage(EOperation Operation, void* Dst, void* Src)
+	{
+		switch (Operation)
+		{
+			case EOperation::Copy:
+				if constexpr (IsInline<TCallable>)
+					new (Dst) TCallable(*Get<TCallable>(Src));
+				else
+					*reinterpret_cast<TCallable**>(Dst) = new TCallable(*Get<TCallable>(Src));
+				break;
+			case EOperation::Move:
+				if constexpr (IsInline<TCallable>)
+				{
+					new (Dst) TCallable(std::move(*Get<TCallable>(Src)));
+					Get<TCallable>(Src)->~TCallable();
+				}
+				else
+					*reinterpret_cast<TCallable**>(Dst) = Get<TCallable>(Src);
+				break;
+			case EOperation::Destroy:
+				if constexpr (IsInline<TCallable>)
+					Get<TCallable>(Dst)->~TCallable();
+				else
+					delete Get<TCallable>(Dst);
+				break;
+		}
+	}
+
+	template<class TCallable, typename... CallableArgs>
+	void Emplace(CallableArgs&&... InArgs)
+	{
+		static_assert(std::is_copy_constructible_v<TCallable>, "Delegate requires a copyable callable");
+		Unbind();
+		if constexpr (IsInline<TCallable>)
+			new (Storage) TCallable(std::forward<CallableArgs>(InArgs)...);
+		else
+			*reinterpret_cast<TCallable**>(Storage) = new TCallable(std::forward<CallableArgs>(InArgs)...);
+		Invoker = &Invoke<TCallable>;
+		Manager = &Manage<TCallable>;
+	}
+
+	void CopyFrom(const Delegate& Other)
+	{
+		if (Other.Manager)
+			Other.Manager(EOperation::Copy, Storage, const_cast<std::byte*>(Other.Storage));
+		Invoker = Other.Invoker;
+		Manager = Other.Manager;
+	}
+
+	void MoveFrom(Delegate& Other)
+	{
+		if (Other.Manager)
+			Other.Manager(EOperation::Move, Storage, Other.Storage);
+		Invoker = Other.Invoker;
+		Manager = Other.Manager;
+		Other.Invoker = nullptr;
+		Other.Manager = nullptr;
+	}
+
+	R (*Invoker)(void*, Args...) = nullptr;
+	void (*Manager)(EOperation, void*, void*) = nullptr;
+	alignas(std::max_align_t) std::byte Storage[InlineSize];
 };
 
+/**
+ * Handle returned when adding to a multicast delegate, used to remove the listener later.
+ * Stays valid when other listeners are added or removed.
+ */
+struct FDelegateHandle
+{
+	uint64_t Id = 0;
+
+	bool IsValid() const { return Id != 0; }
+	bool operator==(const FDelegateHandle& Other) const { return Id == Other.Id; }
+};
 
 template<typename... Args>
 class MultiCastDelegate
@@ -96,39 +227,145 @@ public:
 	~MultiCastDelegate(){}
 
 	template<class T>
-	void AddMember(T* Object, void(T::* FuncPtr)(Args ...))
+	FDelegateHandle AddMember(T* Object, void(T::* FuncPtr)(Args ...))
 	{
-		Delegate<void, Args...> delegate;
-		delegate.BindMember(Object, FuncPtr);
-		DelegateList.push_back(delegate);
+		return Add(Delegate<void, Args...>(Object, FuncPtr));
 	}
 
 	template<class T> requires std::is_invocable_v<T, Args...>
-	void AddLambda(T Lambda)
+	FDelegateHandle AddLambda(T Lambda)
 	{
 		Delegate<void, Args...> delegate;
-		delegate.BindLambda(Lambda);
-		DelegateList.push_back(delegate);
+		delegate.BindLambda(std::move(Lambda));
+		return Add(std::move(delegate));
 	}
 
 	template<class T>
-	void AddObjectFunction(T* Ptr, void(T::* fp)(Args...))
+	FDelegateHandle AddObjectFunction(T* Ptr, void(T::* fp)(Args...))
 	{
-		Delegate<void, Args...> delegate;
-		delegate.BindMember(Ptr, fp);
-		DelegateList.push_back(delegate);
+		return Add(Delegate<void, Args...>(Ptr, fp));
+	}
+
+	/**
+	 * Remove a listener by the handle returned when adding it, safe to call during broadcast.
+	 * During a broadcast the listener is only marked removed, its callable is destroyed once the outermost broadcast returns.
+	 * @return true if the listener was found
+	 */
+	bool Remove(FDelegateHandle Handle)
+	{
+		if (!Handle.IsValid())
+			return false;
+		for (size_t i = 0; i < Handles.size(); i++)
+		{
+			if (Handles[i] == Handle)
+			{
+				if (BroadcastDepth > 0)
+				{
+					// The callable may be running, keep it alive and compact after the broadcast
+					Handles[i] = {};
+					bHasRemoved = true;
+				}
+				else
+				{
+					DelegateList.erase(DelegateList.begin() + i);
+					Handles.erase(Handles.begin() + i);
+				}
+				return true;
+			}
+		}
+		for (size_t i = 0; i < PendingList.size(); i++)
+		{
+			if (PendingList[i].first == Handle)
+			{
+				PendingList.erase(PendingList.begin() + i);
+				return true;
+			}
+		}
+		return false;
 	}
 
+	void Clear()
+	{
+		if (BroadcastDepth > 0)
+		{
+			for (FDelegateHandle& Handle : Handles)
+				Handle = {};
+			bHasRemoved = !Handles.empty();
+		}
+		else
+		{
+			DelegateList.clear();
+			Handles.clear();
+		}
+		PendingList.clear();
+	}
+
+	bool IsBound() const { return !DelegateList.empty() || !PendingList.empty(); }
+
 	inline void Broadcast(Args... args)
 	{
-		for(auto delegate : DelegateList)
+		// Listeners added during broadcast are deferred, so the array never reallocates under a running callback
+		BroadcastDepth++;
+		const size_t Count = DelegateList.size();
+		for (size_t i = 0; i < Count; i++)
 		{
-			delegate.ExecuteIfBound(args...);
+			// Listeners removed during this broadcast are skipped
+			if (Handles[i].IsValid())
+				DelegateList[i].ExecuteIfBound(args...);
 		}
+		if (--BroadcastDepth == 0)
+			FlushPending();
 	}
 
 protected:
+	FDelegateHandle Add(Delegate<void, Args...>&& InDelegate)
+	{
+		FDelegateHandle Handle{++HandleCounter};
+		if (BroadcastDepth > 0)
+			PendingList.emplace_back(Handle, std::move(InDelegate));
+		else
+		{
+			DelegateList.push_back(std::move(InDelegate));
+			Handles.push_back(Handle);
+		}
+		return Handle;
+	}
+
+	// Destroy the listeners removed during broadcast and append the ones added, only at broadcast depth 0
+	void FlushPending()
+	{
+		if (bHasRemoved)
+		{
+			size_t Dst = 0;
+			for (size_t i = 0; i < Handles.size(); i++)
+			{
+				if (!Handles[i].IsValid()) continue;
+				if (Dst != i)
+				{
+					DelegateList[Dst] = std::move(DelegateList[i]);
+					Handles[Dst] = Handles[i];
+				}
+				Dst++;
+			}
+			DelegateList.resize(Dst);
+			Handles.resize(Dst);
+			bHasRemoved = false;
+		}
+		for (auto& [Handle, PendingDelegate] : PendingList)
+		{
+			DelegateList.push_back(std::move(PendingDelegate));
+			Handles.push_back(Handle);
+		}
+		PendingList.clear();
+	}
+
+	// Listeners and their handles are kept in two parallel contiguous arrays
 	TArray<Delegate<void, Args...>> DelegateList;
+	TArray<FDelegateHandle> Handles;
+	TArray<std::pair<FDelegateHandle, Delegate<void, Args...>>> PendingList;
+	uint64_t HandleCounter = 0;
+	uint32_t BroadcastDepth = 0;
+	bool bHasRemoved = false;
 };
 #define DECLARE_DELEGATE(DelegateName) typedef Delegate<void> DelegateName;
 
@@ -0,0 +1,220 @@
+#include "MeshEdit.h"
+#include "StaticMesh.h"
+#include "Log/Log.h"
+
+MeshEdit::MeshEdit(StaticMesh& InMesh)
+	: Mesh(InMesh) {}
+
+bool MeshEdit::IsValidVertex(int VertexIndex) const
+{
+	if (VertexIndex < 0 || VertexIndex >= Mesh.verM.rows() + AddedVertices.size())
+	{
+		LOG_WARNING("Mesh edit with vertex index out of range: {0}", VertexIndex);
+		return false;
+	}
+	return true;
+}
+
+bool MeshEdit::IsValidFace(int FaceIndex) const
+{
+	if (FaceIndex < 0 || FaceIndex >= Mesh.triM.rows() + AddedFaces.size())
+	{
+		LOG_WARNING("Mesh edit with face index out of range: {0}", FaceIndex);
+		return false;
+	}
+	return true;
+}
+
+MeshEdit& MeshEdit::RemoveVertex(int VertexIndex)
+{
+	if (IsValidVertex(VertexIndex))
+		RemovedVertices.push_back(VertexIndex);
+	return *this;
+}
+
+MeshEdit& MeshEdit::RemoveVertices(const TArray<int>& VertexIndices)
+{
+	RemovedVertices.reserve(RemovedVertices.size() + VertexIndices.size());
+	for (int VertexIndex : VertexIndices)
+		RemoveVertex(VertexIndex);
+	return *this;
+}
+
+MeshEdit& MeshEdit::RemoveFace(int FaceIndex)
+{
+	if (IsValidFace(FaceIndex))
+		RemovedFaces.push_back(FaceIndex);
+	return *this;
+}
+
+MeshEdit& MeshEdit::RemoveFaces(const TArray<int>& FaceIndices)
+{
+	RemovedFaces.reserve(RemovedFaces.size() + FaceIndices.size());
+	for (int FaceIndex : FaceIndices)
+		RemoveFace(FaceIndex);
+	return *this;
+}
+
+MeshEdit& MeshEdit::KeepFaces(const TArray<int>& FaceIndices)
+{
+	bKeepFaces = true;
+	KeptFaces.reserve(KeptFaces.size() + FaceIndices.size());
+	for (int FaceIndex : FaceIndices)
+	{
+		if (IsValidFace(FaceIndex))
+			KeptFaces.push_back(FaceIndex);
+	}
+	return *this;
+}
+
+int MeshEdit::AddVertex(const FVector& Position)
+{
+	return AddVertex(Position, FVector2::Zero());
+}
+
+int MeshEdit::AddVertex(const FVector& Position, const FVector2& InUV)
+{
+	AddedVertices.push_back(Position);
+	AddedUVs.push_back(InUV);
+	return Mesh.verM.rows() + AddedVertices.size() - 1;
+}
+
+int MeshEdit::AddFace(const Vector3i& Face)
+{
+	for (int i = 0; i < 3; i++)
+	{
+		if (!IsValidVertex(Face[i]))
+			return -1;
+	}
+	AddedFaces.push_back(Face);
+	return Mesh.triM.rows() + AddedFaces.size() - 1;
+}
+
+MeshEdit& MeshEdit::SetVertex(int VertexIndex, const FVector& Position)
+{
+	if (IsValidVertex(VertexIndex))
+		VertexChanges.emplace_back(VertexIndex, Position);
+	return *this;
+}
+
+MeshEdit& MeshEdit::SetUV(int VertexIndex, const FVector2& InUV)
+{
+	if (IsValidVertex(VertexIndex))
+		UVChanges.emplace_back(VertexIndex, InUV);
+	return *this;
+}
+
+MeshEdit& MeshEdit::SetMaterial(ObjectPtr<Material> InMaterial)
+{
+	NewMaterial = std::move(InMaterial);
+	bMaterialChanged = true;
+	return *this;
+}
+
+bool MeshEdit::HasChanges() const
+{
+	return !RemovedVertices.empty() || !RemovedFaces.empty() || bKeepFaces || !AddedVertices.empty() || !AddedFaces.empty()
+		|| !VertexChanges.empty() || !UVChanges.empty() || bMaterialChanged;
+}
+
+StaticMesh* MeshEdit::Commit()
+{
+	const int OldVertexNum = Mesh.verM.rows();
+	const int OldFaceNum = Mesh.triM.rows();
+	const int VertexNum = OldVertexNum + AddedVertices.size();
+	const int FaceNum = OldFaceNum + AddedFaces.size();
+	const bool bHasUV = Mesh.HasValidUV() || !UVChanges.empty();
+
+	if (bMaterialChanged)
+		Mesh.SetMaterial(std::move(NewMaterial));
+
+	auto FaceAt = [&](int i) -> Vector3i {
+		return i < OldFaceNum ? Vector3i(Mesh.triM.row(i)) : AddedFaces[i - OldFaceNum];
+	};
+
+	// Alive masks, a face dies with any of its vertices
+	TArray<uint8> VertexAlive(VertexNum, 1);
+	for (int VertexIndex : RemovedVertices)
+		VertexAlive[VertexIndex] = 0;
+	TArray<uint8> FaceAlive(FaceNum, bKeepFaces ? 0 : 1);
+	for (int FaceIndex : KeptFaces)
+		FaceAlive[FaceIndex] = 1;
+	for (int FaceIndex : RemovedFaces)
+		FaceAlive[FaceIndex] = 0;
+	if (!RemovedVertices.empty())
+	{
+		ParallelFor(FaceNum, [&](int i) {
+			const Vector3i Face = FaceAt(i);
+			FaceAlive[i] &= VertexAlive[Face[0]] & VertexAlive[Face[1]] & VertexAlive[Face[2]];
+		});
+	}
+	if (bRemoveIsolatedVertices)
+	{
+		TArray<uint8> VertexUsed(VertexNum, 0);
+		for (int i = 0; i < FaceNum; i++)
+		{
+			if (!FaceAlive[i]) continue;
+			const Vector3i Face = FaceAt(i);
+			VertexUsed[Face[0]] = VertexUsed[Face[1]] = VertexUsed[Face[2]] = 1;
+		}
+		for (int i = 0; i < VertexNum; i++)
+			VertexAlive[i] &= VertexUsed[i];
+	}
+
+	// Exclusive prefix sums give the new index of every surviving element
+	TArray<int> VertexRemap(VertexNum, -1);
+	int NewVertexNum = 0;
+	for (int i = 0; i < VertexNum; i++)
+		if (VertexAlive[i]) VertexRemap[i] = NewVertexNum++;
+	TArray<int> FaceRemap(FaceNum, -1);
+	int NewFaceNum = 0;
+	for (int i = 0; i < FaceNum; i++)
+		if (FaceAlive[i]) FaceRemap[i] = NewFaceNum++;
+
+	// Attribute changes are applied in the edit index space before compaction, last write wins
+	THashMap<int, FVector> PositionOverride(VertexChanges.begin(), VertexChanges.end());
+	THashMap<int, FVector2> UVOverride(UVChanges.begin(), UVChanges.end());
+
+	MatrixX3d NewVerM(NewVertexNum, 3);
+	MatrixX2d NewUV(bHasUV ? NewVertexNum : 0, 2);
+	ParallelFor(VertexNum, [&](int i) {
+		const int Target = VertexRemap[i];
+		if (Target < 0) return;
+		NewVerM.row(Target) = i < OldVertexNum ? FVector(Mesh.verM.row(i)) : AddedVertices[i - OldVertexNum];
+		if (bHasUV)
+			NewUV.row(Target) = i < OldVertexNum ? (Mesh.HasValidUV() ? FVector2(Mesh.UV.row(i)) : FVector2::Zero()) : AddedUVs[i - OldVertexNum];
+	});
+	for (auto& [VertexIndex, Position] : PositionOverride)
+		if (VertexRemap[VertexIndex] >= 0) NewVerM.row(VertexRemap[VertexIndex]) = Position;
+	for (auto& [VertexIndex, Value] : UVOverride)
+		if (VertexRemap[VertexIndex] >= 0) NewUV.row(VertexRemap[VertexIndex]) = Value;
+
+	MatrixX3i NewTriM(NewFaceNum, 3);
+	ParallelFor(FaceNum, [&](int i) {
+		const int Target = FaceRemap[i];
+		if (Target < 0) return;
+		const Vector3i Face = FaceAt(i);
+		NewTriM.row(Target) = Vector3i(VertexRemap[Face[0]], VertexRemap[Face[1]], VertexRemap[Face[2]]);
+	});
+
+	Mesh.verM = std::move(NewVerM);
+	Mesh.triM = std::move(NewTriM);
+	if (bHasUV)
+		Mesh.UV = std::move(NewUV);
+
+	RemovedVertices.clear(); RemovedFaces.clear(); KeptFaces.clear(); bKeepFaces = false;
+	AddedVertices.clear(); AddedUVs.clear(); AddedFaces.clear();
+	VertexChanges.clear(); UVChanges.clear();
+	bMaterialChanged = false;
+
+	if (Mesh.IsEmpty())
+	{
+		Mesh.VertexNormal.resize(0, 3);
+		Mesh.CornerNormal.resize(0, 3);
+		Mesh.BoundingBox = Math::FBox();
+		Mesh.OnGeometryUpdateDelegate.Broadcast();
+	}
+	else
+		Mesh.OnGeometryUpdate();
+	return &Mesh;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include "CoreMinimal.h"
+
+class StaticMesh;
+class Material;
+
+/**
+ * Batched edit of a StaticMesh, obtained by StaticMesh::BeginEdit.
+ * Deletions, insertions and attribute changes are only recorded, Commit applies all of them in a single
+ * compaction pass with prefix sum remap tables and broadcasts exactly one geometry update.
+ * Nothing is applied if the edit is destroyed without Commit.
+ *
+ * Index space during an edit: vertices [0, V) and faces [0, F) are the existing ones, AddVertex/AddFace
+ * return indices continuing after them, so new faces may reference new vertices.
+ */
+class ENGINE_API MeshEdit
+{
+public:
+	explicit MeshEdit(StaticMesh& InMesh);
+
+	/** Remove a vertex and every face using it */
+	MeshEdit& RemoveVertex(int VertexIndex);
+	MeshEdit& RemoveVertices(const TArray<int>& VertexIndices);
+
+	MeshEdit& RemoveFace(int FaceIndex);
+	MeshEdit& RemoveFaces(const TArray<int>& FaceIndices);
+
+	/** Keep only the given faces */
+	MeshEdit& KeepFaces(const TArray<int>& FaceIndices);
+
+	/** @return index of the new vertex, valid in this edit */
+	int AddVertex(const FVector& Position);
+	int AddVertex(const FVector& Position, const FVector2& InUV);
+
+	/** @return index of the new face, valid in this edit */
+	int AddFace(const Vector3i& Face);
+
+	MeshEdit& SetVertex(int VertexIndex, const FVector& Position);
+	MeshEdit& SetUV(int VertexIndex, const FVector2& InUV);
+	MeshEdit& SetMaterial(ObjectPtr<Material> InMaterial);
+
+	/** If vertices not used by any face are removed on commit, default true */
+	MeshEdit& SetRemoveIsolatedVertices(bool bRemove) { bRemoveIsolatedVertices = bRemove; return *this; }
+
+	/** If the edit recorded any change */
+	bool HasChanges() const;
+
+	/**
+	 * Apply all recorded changes to the mesh, then reset the edit.
+	 * @return the edited mesh
+	 */
+	StaticMesh* Commit();
+
+protected:
+	bool IsValidVertex(int VertexIndex) const;
+	bool IsValidFace(int FaceIndex) const;
+
+	StaticMesh& Mesh;
+
+	TArray<int> RemovedVertices;
+	TArray<int> RemovedFaces;
+	TArray<int> KeptFaces;
+	bool bKeepFaces = false;
+
+	TArray<FVector> AddedVertices;
+	TArray<FVector2> AddedUVs;
+	TArray<Vector3i> AddedFaces;
+
+	TArray<std::pair<int, FVector>> VertexChanges;
+	TArray<std::pair<int, FVector2>> UVChanges;
+
+	ObjectPtr<Material> NewMaterial;
+	bool bMaterialChanged = false;
+
+	bool bRemoveIsolatedVertices = true;
+};
@@ -0,0 +1,172 @@
+#include "MeshFairingSolver.h"
+
+MeshFairingSolver::MeshFairingSolver(const SharedPtr<const MeshTopology>& InTopology)
+	: Topology(InTopology)
+{
+	const int VertexNum = Topology->GetVertexNum();
+	const auto& Edges = Topology->GetEdges();
+
+	// Full symmetric pattern, SimplicialLLT only reads the lower triangle
+	TArray<Eigen::Triplet<double>> Triplets;
+	Triplets.reserve(VertexNum + Edges.size() * 2);
+	for (int i = 0; i < VertexNum; i++)
+		Triplets.emplace_back(i, i, 1.);
+	for (const auto& Edge : Edges)
+	{
+		Triplets.emplace_back(Edge[0], Edge[1], 0.);
+		Triplets.emplace_back(Edge[1], Edge[0], 0.);
+	}
+	System.resize(VertexNum, VertexNum);
+	System.setFromTriplets(Triplets.begin(), Triplets.end());
+	System.makeCompressed();
+
+	auto Slot = [this](int Row, int Col) {
+		const int* Begin = System.innerIndexPtr() + System.outerIndexPtr()[Col];
+		const int* End = System.innerIndexPtr() + System.outerIndexPtr()[Col + 1];
+		return int(std::lower_bound(Begin, End, Row) - System.innerIndexPtr());
+	};
+	DiagonalSlots.resize(VertexNum);
+	EdgeSlots.resize(Edges.size());
+	ParallelFor(VertexNum, [&](int i) { DiagonalSlots[i] = Slot(i, i); });
+	ParallelFor(Edges.size(), [&](int i) { EdgeSlots[i] = { Slot(Edges[i][0], Edges[i][1]), Slot(Edges[i][1], Edges[i][0]) }; });
+
+	Solver.analyzePattern(System);
+	EdgeWeights.setZero(Edges.size());
+	Mass.setOnes(VertexNum);
+}
+
+void MeshFairingSolver::SetUniformWeights()
+{
+	if (bUniform) return;
+	EdgeWeights.setOnes(Topology->GetEdgeNum());
+	Mass.setOnes(Topology->GetVertexNum());
+	bUniform = true;
+	bDirty = true;
+}
+
+void MeshFairingSolver::SetCotanWeights(const MatrixX3d& Vertices)
+{
+	ASSERTMSG(Vertices.rows() == Topology->GetVertexNum(), "Vertex number does not match the topology");
+	const auto& Faces = Topology->GetFaces();
+	const auto& FaceEdges = Topology->GetFaceEdges();
+	const int FaceNum = Faces.rows();
+
+	// Half cotangent of each corner, scattered to the opposite edge
+	MatrixX3d HalfCot(FaceNum, 3);
+	ParallelFor(FaceNum, [&](int i)
+	{
+		for (int j = 0; j < 3; j++)
+		{
+			const FVector P = Vertices.row(Faces(i, j));
+			const FVector E1 = FVector(Vertices.row(Faces(i, (j + 1) % 3))) - P;
+			const FVector E2 = FVector(Vertices.row(Faces(i, (j + 2) % 3))) - P;
+			HalfCot(i, j) = 0.5 * E1.dot(E2) / std::max(E1.cross(E2).norm(), 1e-12);
+		}
+	});
+	EdgeWeights.setZero(Topology->GetEdgeNum());
+	for (int i = 0; i < FaceNum; i++)
+		for (int j = 0; j < 3; j++)
+			EdgeWeights[FaceEdges(i, (j + 1) % 3)] += HalfCot(i, j);
+
+	SetMass(Vertices);
+}
+
+void MeshFairingSolver::SetMass(const MatrixX3d& Vertices)
+{
+	ASSERTMSG(Vertices.rows() == Topology->GetVertexNum(), "Vertex number does not match the topology");
+	const VectorXd DoubleArea = FaceDoubleArea(Vertices);
+	const auto& Offsets = Topology->GetVertexFaceOffsets();
+	const auto& VertexFaces = Topology->GetVertexFaces();
+	Mass.resize(Topology->GetVertexNum());
+	ParallelFor(Topology->GetVertexNum(), [&](int i)
+	{
+		double Area = 0.;
+		for (int k = Offsets[i]; k < Offsets[i + 1]; k++)
+			Area += DoubleArea[VertexFaces[k]];
+		// Isolated vertices keep a unit mass to stay solvable
+		Mass[i] = Area > 0. ? Area / 6. : 1.;
+	});
+	bUniform = false;
+	bDirty = true;
+}
+
+void MeshFairingSolver::SetTimeStep(double InDelta)
+{
+	if (Delta == InDelta) return;
+	Delta = InDelta;
+	bDirty = true;
+}
+
+bool MeshFairingSolver::Factorize()
+{
+	if (!bDirty)
+		return Solver.info() == Eigen::Success;
+	double* Values = System.valuePtr();
+	const auto& Edges = Topology->GetEdges();
+	ParallelFor(Topology->GetVertexNum(), [&](int i) { Values[DiagonalSlots[i]] = Mass[i]; });
+	// Diagonal accumulation races on shared vertices, kept serial
+	for (int i = 0; i < (int)Edges.size(); i++)
+	{
+		const double Weight = Delta * EdgeWeights[i];
+		Values[EdgeSlots[i][0]] = -Weight;
+		Values[EdgeSlots[i][1]] = -Weight;
+		Values[DiagonalSlots[Edges[i][0]]] += Weight;
+		Values[DiagonalSlots[Edges[i][1]]] += Weight;
+	}
+	Solver.factorize(System);
+	bDirty = false;
+	return Solver.info() == Eigen::Success;
+}
+
+void MeshFairingSolver::SolveFactorized(MatrixXd& B) const
+{
+	ASSERTMSG(!bDirty, "Mesh fairing solver is not factorized");
+	ParallelFor(B.cols(), [&](int Col) { B.col(Col) = Solver.solve(B.col(Col)); });
+}
+
+bool MeshFairingSolver::Solve(MatrixX3d& Vertices)
+{
+	ASSERTMSG(Vertices.rows() == Topology->GetVertexNum(), "Vertex number does not match the topology");
+	if (!Factorize())
+	{
+		LOG_WARNING("Mesh fairing factorization failed, the mesh is kept unchanged");
+		return false;
+	}
+	MatrixXd B = Mass.asDiagonal() * Vertices;
+	SolveFactorized(B);
+	Vertices = B;
+	return true;
+}
+
+bool MeshFairingSolver::Smooth(MatrixX3d& Vertices, int Iteration, bool UseUniformLaplacian)
+{
+	if (UseUniformLaplacian)
+	{
+		SetUniformWeights();
+		SetTimeStep(1.);
+	}
+	else
+	{
+		SetCotanWeights(Vertices);
+		// One ring of diffusion per step whatever the mesh scale
+		SetTimeStep(Mass.mean());
+	}
+	for (int i = 0; i < Iteration; i++)
+		if (!Solve(Vertices))
+			return false;
+	return true;
+}
+
+VectorXd MeshFairingSolver::FaceDoubleArea(const MatrixX3d& Vertices) const
+{
+	const auto& Faces = Topology->GetFaces();
+	VectorXd DoubleArea(Faces.rows());
+	ParallelFor(Faces.rows(), [&](int i)
+	{
+		const FVector P0 = Vertices.row(Faces(i, 0));
+		const FVector P1 = Vertices.row(Faces(i, 1));
+		const FVector P2 = Vertices.row(Faces(i, 2));
+		DoubleArea[i] = (P1 - P0).cross(P2 - P0).norm();
+	});
+	return DoubleArea;
+}
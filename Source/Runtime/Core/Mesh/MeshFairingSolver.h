@@ -0,0 +1,72 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "MeshTopology.h"
+
+/**
+ * Implicit Laplacian smoothing bound to one mesh topology, solves (M - Delta * L) V' = M * V.
+ * The sparsity pattern of the system only depends on the edges, so it is built and analyzed once.
+ * Weights are written in place into the cached matrix, and the numeric factorization is only redone when the
+ * weights, the mass or the time step changed, repeated steps with the same weights reuse it.
+ */
+class ENGINE_API MeshFairingSolver
+{
+public:
+	explicit MeshFairingSolver(const SharedPtr<const MeshTopology>& InTopology);
+
+	FORCEINLINE const SharedPtr<const MeshTopology>& GetTopology() const { return Topology; }
+
+	/** Umbrella weights and unit mass, only depend on the topology */
+	void SetUniformWeights();
+
+	/** Cotan Laplacian and barycentric mass of the given geometry */
+	void SetCotanWeights(const MatrixX3d& Vertices);
+
+	/** Barycentric mass of the given geometry, keep the Laplacian, used by mean curvature flow */
+	void SetMass(const MatrixX3d& Vertices);
+
+	void SetTimeStep(double InDelta);
+
+	/**
+	 * One implicit step, x, y and z are solved in parallel with the same factorization
+	 * @return false if the factorization failed
+	 */
+	bool Solve(MatrixX3d& Vertices);
+
+	/**
+	 * Refactorize if the weights, the mass or the time step changed since the last factorization
+	 * @return false if the factorization failed
+	 */
+	bool Factorize();
+
+	/** Solve (M - Delta * L) X = B for each column of B in place and in parallel, Factorize has to be called before */
+	void SolveFactorized(MatrixXd& B) const;
+
+	/**
+	 * Smooth the mesh with Iteration implicit steps, weights are taken from the input geometry and kept over the steps
+	 * @param UseUniformLaplacian Uniform weights keep the factorization of the previous call
+	 */
+	bool Smooth(MatrixX3d& Vertices, int Iteration, bool UseUniformLaplacian);
+
+	[[nodiscard]] FORCEINLINE const VectorXd& GetMass() const { return Mass; }
+
+	[[nodiscard]] FORCEINLINE const VectorXd& GetEdgeWeights() const { return EdgeWeights; }
+
+protected:
+	/** Per face double area, in parallel */
+	VectorXd FaceDoubleArea(const MatrixX3d& Vertices) const;
+
+	SharedPtr<const MeshTopology> Topology;
+
+	// Symmetric Laplacian weight of each edge of the topology, half the sum of the opposite cotangents
+	VectorXd EdgeWeights;
+	VectorXd Mass;
+	double Delta = 1.;
+	bool bUniform = false;
+	bool bDirty = true;
+
+	Eigen::SparseMatrix<double> System;
+	// Position of the diagonal of each vertex, and of both entries of each edge in the values of System
+	TArray<int> DiagonalSlots;
+	TArray<Vector2i> EdgeSlots;
+	Eigen::SimplicialLLT<Eigen::SparseMatrix<double>> Solver;
+};
@@ -0,0 +1,369 @@
+#include "MeshGeodesics.h"
+#include "StaticMesh.h"
+#include <igl/exact_geodesic.h>
+#include <chrono>
+#include <random>
+
+MeshGeodesics::MeshGeodesics(const StaticMesh& Mesh, double TimeScale)
+	: Topology(Mesh.GetTopology()), Vertices(Mesh.GetVertices()), HeatSolver(Topology)
+{
+	const auto& Faces = Topology->GetFaces();
+	const int FaceNum = Faces.rows();
+
+	BarycentricGradients.resize(FaceNum * 3, 3);
+	FaceArea.resize(FaceNum);
+	ParallelFor(FaceNum, [&](int i)
+	{
+		const FVector P0 = Vertices.row(Faces(i, 0));
+		const FVector P1 = Vertices.row(Faces(i, 1));
+		const FVector P2 = Vertices.row(Faces(i, 2));
+		const FVector Normal = (P1 - P0).cross(P2 - P0);
+		const double DoubleArea = std::max(Normal.norm(), 1e-12);
+		const FVector UnitNormal = Normal / DoubleArea;
+		FaceArea[i] = DoubleArea * 0.5;
+		// Gradient of corner k is the opposite edge turned inward, over the double area
+		for (int k = 0; k < 3; k++)
+		{
+			const FVector Opposite = FVector(Vertices.row(Faces(i, (k + 2) % 3))) - FVector(Vertices.row(Faces(i, (k + 1) % 3)));
+			BarycentricGradients.row(i * 3 + k) = UnitNormal.cross(Opposite) / DoubleArea;
+		}
+	});
+
+	double EdgeLength = 0.;
+	for (const auto& Edge : Topology->GetEdges())
+		EdgeLength += (Vertices.row(Edge[0]) - Vertices.row(Edge[1])).norm();
+	EdgeLength /= std::max<size_t>(Topology->GetEdges().size(), 1);
+
+	HeatSolver.SetCotanWeights(Vertices);
+	HeatSolver.SetTimeStep(TimeScale * EdgeLength * EdgeLength);
+	if (!HeatSolver.Factorize())
+		LOG_ERROR("Heat flow factorization failed, geodesic distances are invalid");
+
+	// Cotan Laplacian, slightly regularized to remove the constant null space
+	const auto& Weights = HeatSolver.GetEdgeWeights();
+	TArray<Eigen::Triplet<double>> Triplets;
+	Triplets.reserve(Topology->GetVertexNum() + Weights.size() * 4);
+	for (int i = 0; i < Topology->GetVertexNum(); i++)
+		Triplets.emplace_back(i, i, 1e-8);
+	for (int i = 0; i < (int)Weights.size(); i++)
+	{
+		const auto& Edge = Topology->GetEdges()[i];
+		Triplets.emplace_back(Edge[0], Edge[1], -Weights[i]);
+		Triplets.emplace_back(Edge[1], Edge[0], -Weights[i]);
+		Triplets.emplace_back(Edge[0], Edge[0], Weights[i]);
+		Triplets.emplace_back(Edge[1], Edge[1], Weights[i]);
+	}
+	Eigen::SparseMatrix<double> Laplacian(Topology->GetVertexNum(), Topology->GetVertexNum());
+	Laplacian.setFromTriplets(Triplets.begin(), Triplets.end());
+	PoissonSolver.compute(Laplacian);
+	if (PoissonSolver.info() != Eigen::Success)
+		LOG_ERROR("Geodesic Poisson factorization failed, geodesic distances are invalid");
+
+	Tree.init(Vertices, Faces);
+}
+
+bool MeshGeodesics::IsBoundTo(const StaticMesh& Mesh) const
+{
+	return Mesh.GetTopology() == Topology && Mesh.GetVertices() == Vertices;
+}
+
+VectorXd MeshGeodesics::Distance(const TArray<int>& SourceVertices) const
+{
+	return Distances({ SourceVertices }).col(0);
+}
+
+VectorXd MeshGeodesics::Distance(const TArray<FVector>& SourcePoints) const
+{
+	const auto& Faces = Topology->GetFaces();
+	MatrixXd Heat = MatrixXd::Zero(Topology->GetVertexNum(), 1);
+	for (const auto& Point : SourcePoints)
+	{
+		FVector Barycentric;
+		const int Face = ClosestFace(Point, Barycentric);
+		for (int k = 0; k < 3; k++)
+			Heat(Faces(Face, k), 0) += Barycentric[k];
+	}
+	return Solve(std::move(Heat)).col(0);
+}
+
+MatrixXd MeshGeodesics::Distances(const TArray<TArray<int>>& Queries) const
+{
+	MatrixXd Heat = MatrixXd::Zero(Topology->GetVertexNum(), Queries.size());
+	for (int i = 0; i < (int)Queries.size(); i++)
+		for (int Vertex : Queries[i])
+			Heat(Vertex, i) = 1.;
+	return Solve(std::move(Heat));
+}
+
+MatrixXd MeshGeodesics::Solve(MatrixXd&& Heat) const
+{
+	const auto& Faces = Topology->GetFaces();
+	const int FaceNum = Faces.rows();
+	const int QueryNum = Heat.cols();
+
+	// Heat flow for a short time, (M - t * L) u = delta
+	HeatSolver.SolveFactorized(Heat);
+
+	// Normalized heat gradient per face, integrated against the gradient of each corner
+	MatrixXd CornerDivergence(FaceNum * 3, QueryNum);
+	ParallelFor(FaceNum, [&](int i)
+	{
+		for (int q = 0; q < QueryNum; q++)
+		{
+			FVector Gradient = FVector::Zero();
+			for (int k = 0; k < 3; k++)
+				Gradient += Heat(Faces(i, k), q) * FVector(BarycentricGradients.row(i * 3 + k));
+			const double Norm = Gradient.norm();
+			const FVector X = Norm > 0. ? FVector(-Gradient / Norm) : FVector::Zero();
+			for (int k = 0; k < 3; k++)
+				CornerDivergence(i * 3 + k, q) = FaceArea[i] * BarycentricGradients.row(i * 3 + k).dot(X);
+		}
+	});
+
+	// The Laplacian is stored positive, so the right hand side is the negated divergence
+	const auto& Offsets = Topology->GetVertexFaceOffsets();
+	const auto& VertexFaces = Topology->GetVertexFaces();
+	const auto& VertexFaceCorners = Topology->GetVertexFaceCorners();
+	MatrixXd Distance = MatrixXd::Zero(Topology->GetVertexNum(), QueryNum);
+	ParallelFor(Topology->GetVertexNum(), [&](int v)
+	{
+		for (int k = Offsets[v]; k < Offsets[v + 1]; k++)
+			Distance.row(v) += CornerDivergence.row(VertexFaces[k] * 3 + VertexFaceCorners[k]);
+	});
+
+	ParallelFor(QueryNum, [&](int q)
+	{
+		Distance.col(q) = PoissonSolver.solve(Distance.col(q));
+		Distance.col(q).array() -= Distance.col(q).minCoeff();
+	});
+	return Distance;
+}
+
+TArray<FVector> MeshGeodesics::Path(const FVector& Start, const FVector& End) const
+{
+	return Paths({ { Start, End } })[0];
+}
+
+TArray<TArray<FVector>> MeshGeodesics::Paths(const TArray<std::pair<FVector, FVector>>& Pairs) const
+{
+	const auto& Faces = Topology->GetFaces();
+	TArray<int> StartFaces(Pairs.size()), EndFaces(Pairs.size());
+	TArray<FVector> EndBarycentrics(Pairs.size());
+	MatrixXd Heat = MatrixXd::Zero(Topology->GetVertexNum(), Pairs.size());
+	for (int i = 0; i < (int)Pairs.size(); i++)
+	{
+		FVector Barycentric;
+		StartFaces[i] = ClosestFace(Pairs[i].first, Barycentric);
+		for (int k = 0; k < 3; k++)
+			Heat(Faces(StartFaces[i], k), i) += Barycentric[k];
+		EndFaces[i] = ClosestFace(Pairs[i].second, EndBarycentrics[i]);
+	}
+	const MatrixXd Distance = Solve(std::move(Heat));
+
+	TArray<TArray<FVector>> Result(Pairs.size());
+	ParallelFor(Pairs.size(), [&](int i)
+	{
+		Result[i] = TraceDown(Distance.col(i), StartFaces[i], Pairs[i].first, EndFaces[i], EndBarycentrics[i]);
+	});
+	return Result;
+}
+
+TArray<FVector> MeshGeodesics::ExactPath(const FVector& Start, const FVector& End) const
+{
+	FVector Barycentric;
+	const int StartFace = ClosestFace(Start, Barycentric);
+	const int EndFace = ClosestFace(End, Barycentric);
+	return igl::exact_geodesic_path(Vertices, Topology->GetFaces(), Start, End, StartFace, EndFace);
+}
+
+int MeshGeodesics::ClosestFace(const FVector& Point, FVector& Barycentric) const
+{
+	int Face = 0;
+	RowVector3d Closest;
+	Tree.squared_distance(Vertices, Topology->GetFaces(), Point.transpose(), Face, Closest);
+
+	// Barycentric coordinates from the corner gradients, exact in the plane of the face
+	const FVector P0 = Vertices.row(Topology->GetFaces()(Face, 0));
+	const FVector Offset = Closest.transpose() - P0;
+	Barycentric[1] = BarycentricGradients.row(Face * 3 + 1).dot(Offset);
+	Barycentric[2] = BarycentricGradients.row(Face * 3 + 2).dot(Offset);
+	Barycentric[0] = 1. - Barycentric[1] - Barycentric[2];
+	Barycentric = Barycentric.cwiseMax(0.);
+	Barycentric /= Barycentric.sum();
+	return Face;
+}
+
+FVector MeshGeodesics::FaceGradient(int Face, const VectorXd& Field) const
+{
+	const auto& Faces = Topology->GetFaces();
+	FVector Gradient = FVector::Zero();
+	for (int k = 0; k < 3; k++)
+		Gradient += Field[Faces(Face, k)] * FVector(BarycentricGradients.row(Face * 3 + k));
+	return Gradient;
+}
+
+FVector MeshGeodesics::FacePoint(int Face, const FVector& Barycentric) const
+{
+	const auto& Faces = Topology->GetFaces();
+	FVector Point = FVector::Zero();
+	for (int k = 0; k < 3; k++)
+		Point += Barycentric[k] * FVector(Vertices.row(Faces(Face, k)));
+	return Point;
+}
+
+TArray<FVector> MeshGeodesics::TraceDown(const VectorXd& Distance, int SourceFace, const FVector& Source, int Face, FVector Barycentric) const
+{
+	const auto& Faces = Topology->GetFaces();
+	const auto& FaceFaces = Topology->GetFaceFaces();
+	TArray<FVector> Path = { FacePoint(Face, Barycentric) };
+	int PreviousFace = -1;
+
+	// Each step leaves a face or a vertex, a descent path crosses each face at most a few times
+	const int MaxSteps = Faces.rows() * 4 + 16;
+	for (int Step = 0; Step < MaxSteps && Face != SourceFace; Step++)
+	{
+		int Corner;
+		if (Barycentric.maxCoeff(&Corner) > 1. - 1e-9)
+		{
+			if (!StepFromVertex(Distance, Faces(Face, Corner), Face, Barycentric))
+				break;
+			PreviousFace = -1;
+			if (Barycentric.maxCoeff() > 1. - 1e-9)
+				Path.push_back(FacePoint(Face, Barycentric));
+			continue;
+		}
+
+		// Walk down the face gradient to the first edge it crosses
+		const FVector Direction = -FaceGradient(Face, Distance);
+		FVector Rate;
+		for (int k = 0; k < 3; k++)
+			Rate[k] = BarycentricGradients.row(Face * 3 + k).dot(Direction);
+		double Exit = std::numeric_limits<double>::max();
+		int ExitCorner = -1;
+		for (int k = 0; k < 3; k++)
+		{
+			if (Rate[k] < 0. && -Barycentric[k] / Rate[k] < Exit)
+			{
+				Exit = -Barycentric[k] / Rate[k];
+				ExitCorner = k;
+			}
+		}
+		if (ExitCorner < 0)
+			break;
+
+		const int EdgeCorner = (ExitCorner + 1) % 3;
+		const int NextFace = FaceFaces(Face, EdgeCorner);
+		// A boundary, or a valley along the edge we just crossed, slide along the edge to its lower end
+		if (NextFace < 0 || (NextFace == PreviousFace && Exit < 1e-12))
+		{
+			const int Lower = Distance[Faces(Face, EdgeCorner)] < Distance[Faces(Face, (EdgeCorner + 1) % 3)] ? EdgeCorner : (EdgeCorner + 1) % 3;
+			Barycentric = FVector::Unit(Lower);
+			Path.push_back(FacePoint(Face, Barycentric));
+			continue;
+		}
+
+		Barycentric = (Barycentric + Rate * Exit).cwiseMax(0.);
+		Barycentric[ExitCorner] = 0.;
+		Barycentric /= Barycentric.sum();
+		if (Exit > 0.)
+			Path.push_back(FacePoint(Face, Barycentric));
+
+		FVector NextBarycentric = FVector::Zero();
+		for (int k = 0; k < 3; k++)
+			for (int m = 0; m < 3; m++)
+				if (Faces(NextFace, m) == Faces(Face, k))
+					NextBarycentric[m] = Barycentric[k];
+		PreviousFace = Face;
+		Face = NextFace;
+		Barycentric = NextBarycentric;
+	}
+
+	Path.push_back(Source);
+	std::reverse(Path.begin(), Path.end());
+	return Path;
+}
+
+bool MeshGeodesics::StepFromVertex(const VectorXd& Distance, int Vertex, int& Face, FVector& Barycentric) const
+{
+	const auto& Faces = Topology->GetFaces();
+	const auto& Offsets = Topology->GetVertexFaceOffsets();
+	const auto& VertexFaces = Topology->GetVertexFaces();
+	const auto& VertexFaceCorners = Topology->GetVertexFaceCorners();
+
+	// The steepest face whose descent direction points into the face from the vertex
+	double BestSlope = 0.;
+	int BestFace = -1, BestCorner = -1;
+	for (int k = Offsets[Vertex]; k < Offsets[Vertex + 1]; k++)
+	{
+		const int F = VertexFaces[k], C = VertexFaceCorners[k];
+		const FVector Direction = -FaceGradient(F, Distance);
+		const double RateNext = BarycentricGradients.row(F * 3 + (C + 1) % 3).dot(Direction);
+		const double RatePrev = BarycentricGradients.row(F * 3 + (C + 2) % 3).dot(Direction);
+		if (RateNext >= 0. && RatePrev >= 0. && Direction.norm() > BestSlope)
+		{
+			BestSlope = Direction.norm();
+			BestFace = F;
+			BestCorner = C;
+		}
+	}
+	if (BestFace >= 0)
+	{
+		// Nudge inside so the face walk does not leave through the vertex again
+		Face = BestFace;
+		Barycentric = FVector::Unit(BestCorner) * (1. - 2e-9);
+		Barycentric[(BestCorner + 1) % 3] = 1e-9;
+		Barycentric[(BestCorner + 2) % 3] = 1e-9;
+		return true;
+	}
+
+	// Otherwise follow the lowest edge, none lower means a minimum of the field
+	double Lowest = Distance[Vertex];
+	for (int k = Offsets[Vertex]; k < Offsets[Vertex + 1]; k++)
+	{
+		const int F = VertexFaces[k];
+		for (int m = 0; m < 3; m++)
+		{
+			if (Distance[Faces(F, m)] < Lowest)
+			{
+				Lowest = Distance[Faces(F, m)];
+				Face = F;
+				Barycentric = FVector::Unit(m);
+			}
+		}
+	}
+	return Lowest < Distance[Vertex];
+}
+
+void MeshGeodesics::Benchmark(int QueryNum, bool bWithExact) const
+{
+	using Clock = std::chrono::steady_clock;
+	std::mt19937 Random(0);
+	std::uniform_int_distribution<int> VertexDistribution(0, Topology->GetVertexNum() - 1);
+	TArray<std::pair<FVector, FVector>> Pairs(QueryNum);
+	for (auto& [Start, End] : Pairs)
+	{
+		Start = Vertices.row(VertexDistribution(Random));
+		End = Vertices.row(VertexDistribution(Random));
+	}
+
+	auto Begin = Clock::now();
+	for (const auto& [Start, End] : Pairs)
+		Path(Start, End);
+	const double HeatTime = std::chrono::duration<double>(Clock::now() - Begin).count();
+
+	Begin = Clock::now();
+	Paths(Pairs);
+	const double BatchTime = std::chrono::duration<double>(Clock::now() - Begin).count();
+
+	LOG_INFO("Geodesic path queries, {} vertices {} faces, {} random pairs", Topology->GetVertexNum(), Topology->GetFaceNum(), QueryNum);
+	LOG_INFO("    heat method:         {:>10.1f} queries/s", QueryNum / HeatTime);
+	LOG_INFO("    heat method batched: {:>10.1f} queries/s", QueryNum / BatchTime);
+	if (bWithExact)
+	{
+		Begin = Clock::now();
+		for (const auto& [Start, End] : Pairs)
+			ExactPath(Start, End);
+		const double ExactTime = std::chrono::duration<double>(Clock::now() - Begin).count();
+		LOG_INFO("    exact:               {:>10.1f} queries/s", QueryNum / ExactTime);
+	}
+}
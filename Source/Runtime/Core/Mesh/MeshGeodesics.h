@@ -0,0 +1,84 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "MeshFairingSolver.h"
+#include "MeshTopology.h"
+#include <igl/AABB.h>
+
+class StaticMesh;
+
+/**
+ * Geodesic distances and paths on a static mesh by the heat method, Crane et al. 2013.
+ * The heat flow (M - t * L) and the Poisson system L are factorized once when bound to the mesh,
+ * so a distance query is two back substitutions and a path query adds a gradient descent over the faces.
+ * Exact geodesics are kept as an opt-in refinement, see ExactPath.
+ */
+class ENGINE_API MeshGeodesics
+{
+public:
+	/**
+	 * Factorize the heat method operators of the mesh geometry
+	 * @param TimeScale Heat flow time over the squared mean edge length, larger is smoother
+	 */
+	explicit MeshGeodesics(const StaticMesh& Mesh, double TimeScale = 1.);
+
+	/** If the vertices and the indices of the mesh are still the ones factorized */
+	bool IsBoundTo(const StaticMesh& Mesh) const;
+
+	/** Distance of every vertex to the nearest source vertex */
+	VectorXd Distance(const TArray<int>& SourceVertices) const;
+
+	/** Distance of every vertex to the nearest source point, each point heats the vertices of its closest face */
+	VectorXd Distance(const TArray<FVector>& SourcePoints) const;
+
+	/** One distance column per query of source vertices, all queries share the back substitutions in parallel */
+	MatrixXd Distances(const TArray<TArray<int>>& Queries) const;
+
+	/** Geodesic path from Start to End, traced from End down the distance field of Start */
+	TArray<FVector> Path(const FVector& Start, const FVector& End) const;
+
+	/** Paths between many point pairs, the distance fields of all starts are solved as one batch */
+	TArray<TArray<FVector>> Paths(const TArray<std::pair<FVector, FVector>>& Pairs) const;
+
+	/** Exact geodesic path by window propagation over the whole mesh, slow */
+	TArray<FVector> ExactPath(const FVector& Start, const FVector& End) const;
+
+	/**
+	 * Time path queries between random vertex pairs, logged as queries per second
+	 * @param bWithExact Also time ExactPath on the same pairs
+	 */
+	void Benchmark(int QueryNum, bool bWithExact) const;
+
+	/**
+	 * Closest point on the mesh
+	 * @param Barycentric Barycentric coordinates of the closest point in the returned face
+	 * @return Face of the closest point
+	 */
+	int ClosestFace(const FVector& Point, FVector& Barycentric) const;
+
+protected:
+	/** Heat method from heat sources, one column per query */
+	MatrixXd Solve(MatrixXd&& Heat) const;
+
+	/** Gradient of a per vertex field in a face */
+	FVector FaceGradient(int Face, const VectorXd& Field) const;
+
+	FVector FacePoint(int Face, const FVector& Barycentric) const;
+
+	/** Descend the distance field from a point until the face of the source */
+	TArray<FVector> TraceDown(const VectorXd& Distance, int SourceFace, const FVector& Source, int Face, FVector Barycentric) const;
+
+	/** Leave a vertex along the steepest descent, through a face or along an edge, false at a local minimum */
+	bool StepFromVertex(const VectorXd& Distance, int Vertex, int& Face, FVector& Barycentric) const;
+
+	SharedPtr<const MeshTopology> Topology;
+	MatrixX3d Vertices;
+
+	// Gradient of the barycentric coordinate of each corner, row Face * 3 + Corner
+	MatrixX3d BarycentricGradients;
+	VectorXd FaceArea;
+
+	MeshFairingSolver HeatSolver;
+	Eigen::SimplicialLLT<Eigen::SparseMatrix<double>> PoissonSolver;
+
+	igl::AABB<MatrixX3d, 3> Tree;
+};
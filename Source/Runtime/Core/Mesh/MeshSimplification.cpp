@@ -0,0 +1,300 @@
+#include "MeshSimplification.h"
+#include <algorithm>
+#include <iterator>
+#include <queue>
+
+namespace MeshSimplification
+{
+namespace
+{
+	using Quadric = Eigen::Matrix4d;
+
+	Quadric PlaneQuadric(const FVector& Normal, const FVector& Point, double Weight)
+	{
+		const Eigen::Vector4d Plane(Normal.x(), Normal.y(), Normal.z(), -Normal.dot(Point));
+		return Weight * Plane * Plane.transpose();
+	}
+
+	double QuadricError(const Quadric& Q, const FVector& Point)
+	{
+		const Eigen::Vector4d P(Point.x(), Point.y(), Point.z(), 1.);
+		return P.dot(Q * P);
+	}
+
+	struct Collapse
+	{
+		double Cost;
+		int V0, V1;
+		int Version0, Version1;
+		FVector Target;
+
+		bool operator>(const Collapse& Other) const { return Cost > Other.Cost; }
+	};
+
+	class QuadricSimplifier
+	{
+	public:
+		QuadricSimplifier(const MatrixX3d& InV, const MatrixX3i& InF, const MatrixX2d& InUV)
+		: Positions(InV), Faces(InF), UV(InUV)
+		{
+			const int VertexNum = static_cast<int>(Positions.rows());
+			const int FaceNum = static_cast<int>(Faces.rows());
+			Quadrics.assign(VertexNum, Quadric::Zero());
+			VertexFaces.resize(VertexNum);
+			Versions.assign(VertexNum, 0);
+			bVertexAlive.assign(VertexNum, true);
+			bFaceAlive.assign(FaceNum, true);
+			AliveFaceNum = FaceNum;
+
+			// Area weighted face planes, the longest edge scales the boundary constraints
+			double MaxEdgeLength = 0.;
+			for (int Face = 0; Face < FaceNum; Face++)
+			{
+				const FVector P0 = Positions.row(Faces(Face, 0)), P1 = Positions.row(Faces(Face, 1)), P2 = Positions.row(Faces(Face, 2));
+				const FVector Cross = (P1 - P0).cross(P2 - P0);
+				const double Area = Cross.norm() * 0.5;
+				if (Area > 0.)
+				{
+					const Quadric Q = PlaneQuadric(Cross.normalized(), P0, Area);
+					for (int Corner = 0; Corner < 3; Corner++)
+						Quadrics[Faces(Face, Corner)] += Q;
+				}
+				for (int Corner = 0; Corner < 3; Corner++)
+				{
+					VertexFaces[Faces(Face, Corner)].push_back(Face);
+					MaxEdgeLength = std::max(MaxEdgeLength, (Positions.row(Faces(Face, Corner)) - Positions.row(Faces(Face, (Corner + 1) % 3))).norm());
+				}
+			}
+
+			// Boundary edges belong to one face, a plane through the edge perpendicular to the face keeps the outline
+			THashMap<int64_t, int> EdgeFaceCount;
+			for (int Face = 0; Face < FaceNum; Face++)
+				for (int Corner = 0; Corner < 3; Corner++)
+					EdgeFaceCount[EdgeKey(Faces(Face, Corner), Faces(Face, (Corner + 1) % 3))]++;
+			bBoundaryVertex.assign(VertexNum, false);
+			for (int Face = 0; Face < FaceNum; Face++)
+			{
+				const FVector P0 = Positions.row(Faces(Face, 0)), P1 = Positions.row(Faces(Face, 1)), P2 = Positions.row(Faces(Face, 2));
+				const FVector FaceNormal = (P1 - P0).cross(P2 - P0);
+				for (int Corner = 0; Corner < 3; Corner++)
+				{
+					const int A = Faces(Face, Corner), B = Faces(Face, (Corner + 1) % 3);
+					if (EdgeFaceCount[EdgeKey(A, B)] != 1)
+						continue;
+					bBoundaryVertex[A] = bBoundaryVertex[B] = true;
+					const FVector Edge = Positions.row(B) - Positions.row(A);
+					const FVector Normal = Edge.cross(FaceNormal);
+					if (Normal.norm() > 0.)
+					{
+						const Quadric Q = PlaneQuadric(Normal.normalized(), Positions.row(A), MaxEdgeLength * MaxEdgeLength * 1e3);
+						Quadrics[A] += Q;
+						Quadrics[B] += Q;
+					}
+				}
+			}
+
+			for (int Face = 0; Face < FaceNum; Face++)
+				for (int Corner = 0; Corner < 3; Corner++)
+				{
+					const int A = Faces(Face, Corner), B = Faces(Face, (Corner + 1) % 3);
+					// Each interior edge is seen from both faces, push it once
+					if (A < B || EdgeFaceCount[EdgeKey(A, B)] == 1)
+						PushCollapse(A, B);
+				}
+		}
+
+		bool Run(int TargetFaceNum)
+		{
+			bool bCollapsed = false;
+			while (AliveFaceNum > TargetFaceNum && !Queue.empty())
+			{
+				const Collapse Candidate = Queue.top();
+				Queue.pop();
+				if (!bVertexAlive[Candidate.V0] || !bVertexAlive[Candidate.V1]
+					|| Versions[Candidate.V0] != Candidate.Version0 || Versions[Candidate.V1] != Candidate.Version1)
+					continue;
+				if (!IsCollapseValid(Candidate.V0, Candidate.V1, Candidate.Target))
+					continue;
+				ApplyCollapse(Candidate.V0, Candidate.V1, Candidate.Target);
+				bCollapsed = true;
+			}
+			return bCollapsed;
+		}
+
+		void Compact(MatrixX3d& OutV, MatrixX3i& OutF, MatrixX2d& OutUV) const
+		{
+			TArray<int> Remap(Positions.rows(), -1);
+			int VertexNum = 0;
+			for (int Face = 0; Face < Faces.rows(); Face++)
+				if (bFaceAlive[Face])
+					for (int Corner = 0; Corner < 3; Corner++)
+						if (Remap[Faces(Face, Corner)] < 0)
+							Remap[Faces(Face, Corner)] = VertexNum++;
+
+			OutV.resize(VertexNum, 3);
+			OutUV.resize(UV.rows() > 0 ? VertexNum : 0, 2);
+			for (int Vertex = 0; Vertex < Positions.rows(); Vertex++)
+			{
+				if (Remap[Vertex] < 0)
+					continue;
+				OutV.row(Remap[Vertex]) = Positions.row(Vertex);
+				if (UV.rows() > 0)
+					OutUV.row(Remap[Vertex]) = UV.row(Vertex);
+			}
+			OutF.resize(AliveFaceNum, 3);
+			int FaceNum = 0;
+			for (int Face = 0; Face < Faces.rows(); Face++)
+				if (bFaceAlive[Face])
+					OutF.row(FaceNum++) << Remap[Faces(Face, 0)], Remap[Faces(Face, 1)], Remap[Faces(Face, 2)];
+		}
+
+	private:
+		static int64_t EdgeKey(int A, int B)
+		{
+			return (static_cast<int64_t>(std::min(A, B)) << 32) | static_cast<uint32_t>(std::max(A, B));
+		}
+
+		/** Minimizer of the summed quadric, or the best of the endpoints and midpoint if it is singular */
+		FVector OptimalPosition(const Quadric& Q, int V0, int V1) const
+		{
+			Eigen::Matrix3d A = Q.topLeftCorner<3, 3>();
+			if (std::abs(A.determinant()) > 1e-12)
+			{
+				const FVector Position = A.ldlt().solve(-Q.topRightCorner<3, 1>());
+				if (Position.allFinite())
+					return Position;
+			}
+			const FVector P0 = Positions.row(V0), P1 = Positions.row(V1);
+			FVector Best = P0;
+			for (const FVector& Point : {P1, FVector((P0 + P1) * 0.5)})
+				if (QuadricError(Q, Point) < QuadricError(Q, Best))
+					Best = Point;
+			return Best;
+		}
+
+		void PushCollapse(int V0, int V1)
+		{
+			const Quadric Q = Quadrics[V0] + Quadrics[V1];
+			const FVector Target = OptimalPosition(Q, V0, V1);
+			Queue.push({QuadricError(Q, Target), V0, V1, Versions[V0], Versions[V1], Target});
+		}
+
+		TArray<int> Neighbors(int Vertex) const
+		{
+			TArray<int> Result;
+			for (int Face : VertexFaces[Vertex])
+				for (int Corner = 0; Corner < 3; Corner++)
+					if (Faces(Face, Corner) != Vertex)
+						Result.push_back(Faces(Face, Corner));
+			std::sort(Result.begin(), Result.end());
+			Result.erase(std::unique(Result.begin(), Result.end()), Result.end());
+			return Result;
+		}
+
+		bool IsCollapseValid(int V0, int V1, const FVector& Target) const
+		{
+			int SharedFaceNum = 0;
+			for (int Face : VertexFaces[V0])
+				if (Faces(Face, 0) == V1 || Faces(Face, 1) == V1 || Faces(Face, 2) == V1)
+					SharedFaceNum++;
+			if (SharedFaceNum == 0)
+				return false;
+			// Two boundary vertices joined by an interior edge would pinch the surface
+			if (SharedFaceNum == 2 && bBoundaryVertex[V0] && bBoundaryVertex[V1])
+				return false;
+
+			// Link condition, the endpoints may only share the opposite vertices of the edge faces
+			const TArray<int> N0 = Neighbors(V0), N1 = Neighbors(V1);
+			TArray<int> Shared;
+			std::set_intersection(N0.begin(), N0.end(), N1.begin(), N1.end(), std::back_inserter(Shared));
+			if (static_cast<int>(Shared.size()) != SharedFaceNum)
+				return false;
+
+			// Reject faces flipping or degenerating after moving to the target
+			for (int Vertex : {V0, V1})
+				for (int Face : VertexFaces[Vertex])
+				{
+					FVector Before[3], After[3];
+					bool bRemoved = false;
+					for (int Corner = 0; Corner < 3; Corner++)
+					{
+						const int Index = Faces(Face, Corner);
+						bRemoved |= Index == (Vertex == V0 ? V1 : V0);
+						Before[Corner] = Positions.row(Index);
+						After[Corner] = Index == Vertex ? Target : Before[Corner];
+					}
+					if (bRemoved)
+						continue;
+					const FVector NormalBefore = (Before[1] - Before[0]).cross(Before[2] - Before[0]);
+					const FVector NormalAfter = (After[1] - After[0]).cross(After[2] - After[0]);
+					if (NormalAfter.norm() <= 1e-12 * NormalBefore.norm()
+						|| NormalBefore.normalized().dot(NormalAfter.normalized()) < 0.2)
+						return false;
+				}
+			return true;
+		}
+
+		void ApplyCollapse(int V0, int V1, const FVector& Target)
+		{
+			if (UV.rows() > 0 && (Target - FVector(Positions.row(V1))).squaredNorm() < (Target - FVector(Positions.row(V0))).squaredNorm())
+				UV.row(V0) = UV.row(V1);
+			Positions.row(V0) = Target;
+			Quadrics[V0] += Quadrics[V1];
+			bBoundaryVertex[V0] = bBoundaryVertex[V0] || bBoundaryVertex[V1];
+
+			for (int Face : VertexFaces[V1])
+			{
+				bool bHasV0 = false;
+				for (int Corner = 0; Corner < 3; Corner++)
+					bHasV0 |= Faces(Face, Corner) == V0;
+				if (bHasV0)
+				{
+					bFaceAlive[Face] = false;
+					AliveFaceNum--;
+					continue;
+				}
+				for (int Corner = 0; Corner < 3; Corner++)
+					if (Faces(Face, Corner) == V1)
+						Faces(Face, Corner) = V0;
+				VertexFaces[V0].push_back(Face);
+			}
+			bVertexAlive[V1] = false;
+			VertexFaces[V1].clear();
+
+			// Drop removed faces from the neighbors
+			for (int Vertex : Neighbors(V0))
+				std::erase_if(VertexFaces[Vertex], [this](int Face) { return !bFaceAlive[Face]; });
+			std::erase_if(VertexFaces[V0], [this](int Face) { return !bFaceAlive[Face]; });
+
+			// Only the edges of V0 changed cost, the queued ones are stale by the version
+			Versions[V0]++;
+			for (int Vertex : Neighbors(V0))
+				PushCollapse(V0, Vertex);
+		}
+
+		MatrixX3d Positions;
+		MatrixX3i Faces;
+		MatrixX2d UV;
+		TArray<Quadric> Quadrics;
+		TArray<TArray<int>> VertexFaces;
+		TArray<int> Versions;
+		TArray<bool> bVertexAlive;
+		TArray<bool> bFaceAlive;
+		TArray<bool> bBoundaryVertex;
+		int AliveFaceNum = 0;
+		std::priority_queue<Collapse, TArray<Collapse>, std::greater<>> Queue;
+	};
+}
+
+bool Simplify(const MatrixX3d& V, const MatrixX3i& F, const MatrixX2d& UV, int TargetFaceNum,
+	MatrixX3d& OutV, MatrixX3i& OutF, MatrixX2d& OutUV)
+{
+	if (F.rows() <= TargetFaceNum)
+		return false;
+	QuadricSimplifier Simplifier(V, F, UV);
+	if (!Simplifier.Run(TargetFaceNum))
+		return false;
+	Simplifier.Compact(OutV, OutF, OutUV);
+	return true;
+}
+};
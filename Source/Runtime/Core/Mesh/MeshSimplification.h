@@ -0,0 +1,21 @@
+#pragma once
+#include "CoreMinimal.h"
+
+namespace MeshSimplification
+{
+	/**
+	 * Quadric error metric edge collapse, Garland and Heckbert 1997.
+	 * Open boundaries are kept by constraint planes, collapses that flip a face or pinch the surface are rejected.
+	 * Only touches the given matrices, safe to run on worker threads.
+	 * @param V Vertices
+	 * @param F Faces
+	 * @param UV Per vertex UV, may be empty. A collapsed vertex keeps the UV of the nearer endpoint
+	 * @param TargetFaceNum Stop once the face number is not above it
+	 * @param OutV Simplified vertices, unused ones removed
+	 * @param OutF Simplified faces
+	 * @param OutUV Simplified UV, empty if UV is empty
+	 * @return If any edge was collapsed
+	 */
+	ENGINE_API bool Simplify(const MatrixX3d& V, const MatrixX3i& F, const MatrixX2d& UV, int TargetFaceNum,
+		MatrixX3d& OutV, MatrixX3i& OutF, MatrixX2d& OutUV);
+};
@@ -0,0 +1,178 @@
+#include "MeshTopology.h"
+#include <cstring>
+#include <numeric>
+
+MeshTopology::MeshTopology(const MatrixX3i& InTriM, int InVertexNum)
+	: Faces(InTriM), VertexNum(InVertexNum)
+{
+	const int FaceNum = Faces.rows();
+
+	// Vertex to face adjacency, counting sort by vertex keeps the faces of each vertex in order
+	VertexFaceOffsets.assign(VertexNum + 1, 0);
+	for (int i = 0; i < FaceNum; i++)
+		for (int j = 0; j < 3; j++)
+			VertexFaceOffsets[Faces(i, j) + 1]++;
+	std::partial_sum(VertexFaceOffsets.begin(), VertexFaceOffsets.end(), VertexFaceOffsets.begin());
+	VertexFaces.resize(FaceNum * 3);
+	VertexFaceCorners.resize(FaceNum * 3);
+	{
+		TArray<int> Cursor(VertexFaceOffsets.begin(), VertexFaceOffsets.end() - 1);
+		for (int i = 0; i < FaceNum; i++)
+		{
+			for (int j = 0; j < 3; j++)
+			{
+				const int Slot = Cursor[Faces(i, j)]++;
+				VertexFaces[Slot] = i;
+				VertexFaceCorners[Slot] = j;
+			}
+		}
+	}
+
+	// Unique edges by sorting half edges on their undirected key
+	TArray<std::pair<uint64_t, int>> HalfEdges(FaceNum * 3);
+	for (int i = 0; i < FaceNum; i++)
+	{
+		for (int j = 0; j < 3; j++)
+		{
+			const uint64_t A = Faces(i, j), B = Faces(i, (j + 1) % 3);
+			HalfEdges[i * 3 + j] = { std::min(A, B) << 32 | std::max(A, B), i * 3 + j };
+		}
+	}
+	std::sort(HalfEdges.begin(), HalfEdges.end());
+
+	FaceEdges.resize(FaceNum, 3);
+	FaceFaces.setConstant(FaceNum, 3, -1);
+	TArray<int> BoundaryHalfEdges;
+	for (size_t Begin = 0; Begin < HalfEdges.size();)
+	{
+		size_t End = Begin + 1;
+		while (End < HalfEdges.size() && HalfEdges[End].first == HalfEdges[Begin].first)
+			End++;
+
+		const int EdgeIndex = Edges.size();
+		Edges.emplace_back(int(HalfEdges[Begin].first >> 32), int(HalfEdges[Begin].first & 0xffffffffu));
+		for (size_t k = Begin; k < End; k++)
+			FaceEdges(HalfEdges[k].second / 3, HalfEdges[k].second % 3) = EdgeIndex;
+
+		if (End - Begin == 1)
+			BoundaryHalfEdges.push_back(HalfEdges[Begin].second);
+		else if (End - Begin == 2)
+		{
+			const int H0 = HalfEdges[Begin].second, H1 = HalfEdges[Begin + 1].second;
+			FaceFaces(H0 / 3, H0 % 3) = H1 / 3;
+			FaceFaces(H1 / 3, H1 % 3) = H0 / 3;
+		}
+		Begin = End;
+	}
+
+	// Boundary loops, walk boundary half edges along the face orientation
+	if (!BoundaryHalfEdges.empty())
+	{
+		THashMap<int, TArray<int>> OutgoingBoundary;
+		for (int HalfEdge : BoundaryHalfEdges)
+			OutgoingBoundary[Faces(HalfEdge / 3, HalfEdge % 3)].push_back(HalfEdge);
+
+		THashSet<int> Visited;
+		for (int Start : BoundaryHalfEdges)
+		{
+			if (Visited.contains(Start))
+				continue;
+			TArray<int> Loop;
+			int HalfEdge = Start;
+			while (HalfEdge != -1 && Visited.insert(HalfEdge).second)
+			{
+				Loop.push_back(Faces(HalfEdge / 3, HalfEdge % 3));
+				const int Next = Faces(HalfEdge / 3, (HalfEdge % 3 + 1) % 3);
+				HalfEdge = -1;
+				for (int Candidate : OutgoingBoundary[Next])
+				{
+					if (!Visited.contains(Candidate))
+					{
+						HalfEdge = Candidate;
+						break;
+					}
+				}
+			}
+			BoundaryLoops.push_back(std::move(Loop));
+		}
+		std::stable_sort(BoundaryLoops.begin(), BoundaryLoops.end(),
+			[](const TArray<int>& A, const TArray<int>& B) { return A.size() > B.size(); });
+	}
+
+	// Connected components by union find over the unique edges
+	TArray<int> Parent(VertexNum);
+	std::iota(Parent.begin(), Parent.end(), 0);
+	auto Find = [&Parent](int V) {
+		while (Parent[V] != V)
+			V = Parent[V] = Parent[Parent[V]];
+		return V;
+	};
+	for (const Vector2i& Edge : Edges)
+	{
+		const int A = Find(Edge.x()), B = Find(Edge.y());
+		if (A != B)
+			Parent[std::max(A, B)] = std::min(A, B);
+	}
+	VertexComponents.assign(VertexNum, -1);
+	TArray<int> RootComponent(VertexNum, -1);
+	for (int V = 0; V < VertexNum; V++)
+	{
+		int& Component = RootComponent[Find(V)];
+		if (Component == -1)
+			Component = ComponentNum++;
+		VertexComponents[V] = Component;
+	}
+}
+
+bool MeshTopology::Matches(const MatrixX3i& InTriM, int InVertexNum) const
+{
+	return InVertexNum == VertexNum && InTriM.rows() == Faces.rows()
+		&& std::memcmp(InTriM.data(), Faces.data(), sizeof(int) * Faces.size()) == 0;
+}
+
+void MeshTopology::ComputeNormals(const MatrixX3d& Vertices, double CornerThresholdDegree, MatrixX3d& VertexNormal, MatrixX3d& CornerNormal) const
+{
+	const int FaceNum = Faces.rows();
+	MatrixX3d FaceNormal(FaceNum, 3);
+	MatrixX3d CornerAngle(FaceNum, 3);
+	ParallelFor(FaceNum, [&](int i) {
+		FVector P[3];
+		for (int j = 0; j < 3; j++)
+			P[j] = Vertices.row(Faces(i, j));
+		const FVector N = (P[1] - P[0]).cross(P[2] - P[0]);
+		const double Norm = N.norm();
+		FaceNormal.row(i) = Norm > 0. ? FVector(N / Norm) : FVector::Zero();
+		for (int j = 0; j < 3; j++)
+		{
+			const FVector A = P[(j + 1) % 3] - P[j], B = P[(j + 2) % 3] - P[j];
+			CornerAngle(i, j) = std::atan2(A.cross(B).norm(), A.dot(B));
+		}
+	});
+
+	// Gather per vertex, no write conflicts between threads
+	VertexNormal.resize(VertexNum, 3);
+	ParallelFor(VertexNum, [&](int V) {
+		FVector N = FVector::Zero();
+		for (int k = VertexFaceOffsets[V]; k < VertexFaceOffsets[V + 1]; k++)
+			N += CornerAngle(VertexFaces[k], VertexFaceCorners[k]) * FVector(FaceNormal.row(VertexFaces[k]));
+		VertexNormal.row(V) = N.normalized();
+	});
+
+	const double CosThreshold = std::cos(CornerThresholdDegree * M_PI / 180.);
+	CornerNormal.resize(FaceNum * 3, 3);
+	ParallelFor(FaceNum, [&](int i) {
+		const FVector N = FaceNormal.row(i);
+		for (int j = 0; j < 3; j++)
+		{
+			const int V = Faces(i, j);
+			FVector Sum = FVector::Zero();
+			for (int k = VertexFaceOffsets[V]; k < VertexFaceOffsets[V + 1]; k++)
+			{
+				const FVector Other = FaceNormal.row(VertexFaces[k]);
+				if (N.dot(Other) > CosThreshold)
+					Sum += Other;
+			}
+			CornerNormal.row(i * 3 + j) = Sum.normalized();
+		}
+	});
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include "CoreMinimal.h"
+
+/**
+ * Immutable connectivity of a triangle mesh, only depends on the triangle indices.
+ * Built lazily by StaticMesh::GetTopology and shared until the indices change,
+ * so meshes that only move their vertices never rebuild it.
+ */
+class ENGINE_API MeshTopology
+{
+public:
+	MeshTopology(const MatrixX3i& InTriM, int InVertexNum);
+
+	/** If this topology is built from exactly these indices */
+	bool Matches(const MatrixX3i& InTriM, int InVertexNum) const;
+
+	FORCEINLINE const MatrixX3i& GetFaces() const { return Faces; }
+	FORCEINLINE int GetVertexNum() const { return VertexNum; }
+	FORCEINLINE int GetFaceNum() const { return Faces.rows(); }
+	FORCEINLINE int GetEdgeNum() const { return Edges.size(); }
+
+	/** Faces around vertex V, in CSR layout: [VertexFaceOffsets[V], VertexFaceOffsets[V + 1]) */
+	FORCEINLINE const TArray<int>& GetVertexFaceOffsets() const { return VertexFaceOffsets; }
+	FORCEINLINE const TArray<int>& GetVertexFaces() const { return VertexFaces; }
+	FORCEINLINE const TArray<int>& GetVertexFaceCorners() const { return VertexFaceCorners; } // Corner of V in the face, 0-2
+	FORCEINLINE int GetVertexValence(int V) const { return VertexFaceOffsets[V + 1] - VertexFaceOffsets[V]; }
+
+	/** Unique undirected edges, each stored as (min, max) */
+	FORCEINLINE const TArray<Vector2i>& GetEdges() const { return Edges; }
+
+	/** Edge index of half edge (Corner, Corner + 1) for each face */
+	FORCEINLINE const MatrixX3i& GetFaceEdges() const { return FaceEdges; }
+
+	/**
+	 * Face across half edge (Corner, Corner + 1) for each face.
+	 * -1 for boundary edges, and for non-manifold edges which have more than two faces.
+	 */
+	FORCEINLINE const MatrixX3i& GetFaceFaces() const { return FaceFaces; }
+
+	/** Boundary loops ordered along the face orientation, the longest loop first */
+	FORCEINLINE const TArray<TArray<int>>& GetBoundaryLoops() const { return BoundaryLoops; }
+
+	/** Connected component of each vertex, isolated vertices form their own component */
+	FORCEINLINE const TArray<int>& GetVertexComponents() const { return VertexComponents; }
+	FORCEINLINE int GetComponentNum() const { return ComponentNum; }
+
+	/**
+	 * Compute vertex and corner normals with the cached adjacency, one parallel pass per output.
+	 * Vertex normals are angle weighted, corner normals average the faces around the corner whose normal
+	 * is within CornerThresholdDegree of the face normal.
+	 */
+	void ComputeNormals(const MatrixX3d& Vertices, double CornerThresholdDegree, MatrixX3d& VertexNormal, MatrixX3d& CornerNormal) const;
+
+protected:
+	MatrixX3i Faces;
+	int VertexNum = 0;
+
+	TArray<int> VertexFaceOffsets;
+	TArray<int> VertexFaces;
+	TArray<int> VertexFaceCorners;
+
+	TArray<Vector2i> Edges;
+	MatrixX3i FaceEdges;
+	MatrixX3i FaceFaces;
+
+	TArray<TArray<int>> BoundaryLoops;
+
+	TArray<int> VertexComponents;
+	int ComponentNum = 0;
+};
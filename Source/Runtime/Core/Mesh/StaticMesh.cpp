@@ -5,18 +5,13 @@
 #include <fstream>
 #include "Log/Log.h"
 #include "StaticMesh.h"
+#include "MeshFairingSolver.h"
 #include "Math/LinearAlgebra.h"
-#include "igl/per_face_normals.h"
-#include "igl/per_vertex_normals.h"
-#include "igl/per_corner_normals.h"
 #include "igl/readOBJ.h"
 #include "igl/fast_find_self_intersections.h"
 #include "Algorithm/GeometryProcess.h"
 #include "Materials/Material.h"
 #include "Misc/Path.h"
-#include "igl/boundary_loop.h"
-#include "igl/edge_topology.h"
-#include "igl/edges.h"
 
 StaticMesh::StaticMesh()
 {
@@ -72,6 +67,7 @@ StaticMesh::StaticMesh(StaticMesh&& Other) noexcept
 	CornerNormal = std::move(Other.CornerNormal);
 	BoundingBox = Other.BoundingBox;
 	MaterialData = std::move(Other.MaterialData);
+	Topology = std::move(Other.Topology);
 	OnGeometryUpdateDelegate.Broadcast();
 }
 
@@ -83,6 +79,10 @@ StaticMesh::StaticMesh(const StaticMesh& Other)
 	CornerNormal = Other.CornerNormal;
 	BoundingBox = Other.BoundingBox;
 	MaterialData = NewObject<Material>(*Other.MaterialData);
+	{
+		std::lock_guard Lock(Other.TopologyMutex);
+		Topology = Other.Topology;
+	}
 	OnGeometryUpdateDelegate.Broadcast();
 }
 void StaticMesh::PostEdit(Reflection::FieldAccessor& Field)
@@ -103,6 +103,10 @@ StaticMesh& StaticMesh::operator=(const StaticMesh& Other) noexcept
 	CornerNormal = Other.CornerNormal;
 	BoundingBox = Other.BoundingBox;
 	MaterialData = NewObject<Material>(*Other.MaterialData);
+	{
+		std::lock_guard Lock(Other.TopologyMutex);
+		Topology = Other.Topology;
+	}
 	OnGeometryUpdateDelegate.Broadcast();
 	return *this;
 }
@@ -115,6 +119,7 @@ StaticMesh& StaticMesh::operator=(StaticMesh&& Other) noexcept
 	CornerNormal = std::move(Other.CornerNormal);
 	BoundingBox = Other.BoundingBox;
 	MaterialData = std::move(Other.MaterialData);
+	Topology = std::move(Other.Topology);
 	OnGeometryUpdateDelegate.Broadcast();
 	return *this;
 }
@@ -254,9 +259,8 @@ bool StaticMesh::IsSelfIntersect() const
 
 TArray<int> StaticMesh::BoundaryVertices() const
 {
-	TArray<int> Result;
-	igl::boundary_loop(triM, Result);
-	return Result;
+	const auto& Loops = GetTopology()->GetBoundaryLoops();
+	return Loops.empty() ? TArray<int>{} : Loops.front();
 }
 
 TArray<int> StaticMesh::BoundaryTriangles() const
@@ -285,7 +289,10 @@ StaticMesh* StaticMesh::FillHoles()
 
 StaticMesh* StaticMesh::SmoothMesh(int Iteration, bool UseUniform)
 {
-	Algorithm::GeometryProcess::SmoothMesh(verM, triM, Iteration, UseUniform);
+	auto CurrentTopology = GetTopology();
+	if (!FairingSolver || FairingSolver->GetTopology() != CurrentTopology)
+		FairingSolver = MakeShared<MeshFairingSolver>(CurrentTopology);
+	FairingSolver->Smooth(verM, Iteration, UseUniform);
 	OnGeometryUpdate();
 	return this;
 }
@@ -305,49 +312,17 @@ StaticMesh* StaticMesh::Clean()
 
 StaticMesh* StaticMesh::RemoveIsolatedVertices()
 {
-	THashSet<int> VertexSet;
-	for (int i = 0; i < triM.rows(); i++)
-	{
-		VertexSet.insert(triM(i, 0));
-		VertexSet.insert(triM(i, 1));
-		VertexSet.insert(triM(i, 2));
-	}
-	if (VertexSet.size() == verM.rows())
+	if (!HasIsolatedVertices())
 		return this;
-
-	THashMap<int, int> VertexMap;
-	int Index = 0;
-	for (int VertexIndex : VertexSet)
-	{
-		VertexMap[VertexIndex] = Index;
-		Index++;
-	}
-	MatrixX3d NewVerM(VertexSet.size(), 3);
-	for (auto& [VertexIndex, NewIndex] : VertexMap)
-	{
-		NewVerM.row(NewIndex) = verM.row(VertexIndex);
-	}
-	for (int i = 0; i < triM.rows(); i++)
-	{
-		triM(i, 0) = VertexMap[triM(i, 0)];
-		triM(i, 1) = VertexMap[triM(i, 1)];
-		triM(i, 2) = VertexMap[triM(i, 2)];
-	}
-	verM = NewVerM;
-	OnGeometryUpdate();
-	return this;
+	return BeginEdit().Commit();
 }
 
 bool StaticMesh::HasIsolatedVertices() const
 {
-	THashSet<int> VertexSet;
-	for (int i = 0; i < triM.rows(); i++)
-	{
-		VertexSet.insert(triM(i, 0));
-		VertexSet.insert(triM(i, 1));
-		VertexSet.insert(triM(i, 2));
-	}
-	return VertexSet.size() != verM.rows();
+	TArray<uint8> VertexUsed(verM.rows(), 0);
+	for (int i = 0; i < triM.size(); i++)
+		VertexUsed[triM.data()[i]] = 1;
+	return std::find(VertexUsed.begin(), VertexUsed.end(), 0) != VertexUsed.end();
 }
 
 StaticMesh* StaticMesh::Normalize()
@@ -392,9 +367,7 @@ ObjectPtr<StaticMesh> StaticMesh::LoadObj(const Path& FileName)
 
 TArray<TArray<int>> StaticMesh::GetBoundaryVertices() const
 {
-	TArray<TArray<int>> Result;
-	igl::boundary_loop(triM, Result);
-	return Result;
+	return GetTopology()->GetBoundaryLoops();
 }
 
 int StaticMesh::GetGenus()
@@ -481,15 +454,23 @@ int StaticMesh::GetFaceNum() const
 
 int StaticMesh::GetEdgeNum() const
 {
-	MatrixX2d E;
-	igl::edges(triM, E);
-	return E.rows();
+	return GetTopology()->GetEdgeNum();
+}
+
+SharedPtr<const MeshTopology> StaticMesh::GetTopology() const
+{
+	std::lock_guard Lock(TopologyMutex);
+	if (!Topology || !Topology->Matches(triM, verM.rows()))
+	{
+		ASSERTMSG(triM.size() == 0 || (triM.minCoeff() >= 0 && triM.maxCoeff() < verM.rows()), "Invalid triangle index");
+		Topology = MakeShared<MeshTopology>(triM, verM.rows());
+	}
+	return Topology;
 }
 
 void StaticMesh::CalcNormal()
 {
-	igl::per_vertex_normals(verM, triM, VertexNormal);
-	igl::per_corner_normals(verM, triM, CornelThresholdDegree, CornerNormal);
+	GetTopology()->ComputeNormals(verM, CornelThresholdDegree, VertexNormal, CornerNormal);
 }
 
 bool StaticMesh::CheckNormalValid() const
@@ -513,97 +494,45 @@ StaticMesh* StaticMesh::ReverseNormal()
 
 StaticMesh* StaticMesh::RemoveVertex(int VertexIndex)
 {
-	for (int i = 0;i < triM.rows();i ++)
-	{
-		if (triM(i, 0) == VertexIndex || triM(i, 1) == VertexIndex || triM(i, 2) == VertexIndex)
-		{
-			triM.row(i) = triM.row(triM.rows() - 1);
-			triM.conservativeResize(triM.rows() - 1, 3);
-			i--;
-		}
-	}
-	RemoveIsolatedVertices();
-	return this;
+	return BeginEdit().RemoveVertex(VertexIndex).Commit();
 }
 
 StaticMesh* StaticMesh::RemoveVertices(const TArray<int>& VertexIndices)
 {
-	THashSet<int> VertexSet;
-	for (int VertexIndice : VertexIndices) VertexSet.insert(VertexIndice);
-	for (int i = 0;i < triM.rows();i ++)
-	{
-		if (VertexSet.contains(triM(i, 0)) || VertexSet.contains(triM(i, 1)) || VertexSet.contains(triM(i, 2)))
-		{
-			triM.row(i) = triM.row(triM.rows() - 1);
-			triM.conservativeResize(triM.rows() - 1, 3);
-			i--;
-		}
-	}
-	RemoveIsolatedVertices();
-	return this;
+	return BeginEdit().RemoveVertices(VertexIndices).Commit();
 }
 
 StaticMesh* StaticMesh::RemoveFace(int FaceIndex)
 {
-	if (FaceIndex < 0 || FaceIndex >= triM.rows())
-	{
-		LOG_WARNING("Try to remove face with index out of range: {0}", FaceIndex);
-	}
-	MatrixX3i NewTriM(triM.rows() - 1, 3);
-	NewTriM.topRows(FaceIndex) = triM.topRows(FaceIndex);
-	NewTriM.bottomRows(triM.rows() - FaceIndex - 1) = triM.bottomRows(triM.rows() - FaceIndex - 1);
-	RemoveIsolatedVertices();
-	return this;
+	return BeginEdit().RemoveFace(FaceIndex).Commit();
 }
 
 StaticMesh* StaticMesh::RemoveFaces(const TArray<int>& FaceIndices)
 {
-	THashSet<int> FaceSet;
-	for (int FaceIndex : FaceIndices) FaceSet.insert(FaceIndex);
-	MatrixX3i NewTriM(triM.rows() - FaceSet.size(), 3);
-	int Index = 0;
-	for (int i = 0; i < triM.rows(); i++)
-	{
-		if (FaceSet.contains(i)) continue;
-		NewTriM.row(Index) = triM.row(i);
-		Index++;
-	}
-	triM = NewTriM;
-	RemoveIsolatedVertices();
-	return this;
+	return BeginEdit().RemoveFaces(FaceIndices).Commit();
 }
 
 ObjectPtr<StaticMesh> StaticMesh::SubMesh(const TArray<int>& FaceIndices)
 {
-	MatrixX3d NewVerM;
-	MatrixX3i NewTriM;
-	THashSet<int> VertexSet;
+	// Only the referenced vertices are remapped, no copy of the whole mesh
+	TArray<int> VertexRemap(verM.rows(), -1);
 	for (int FaceIndex : FaceIndices)
-	{
-		VertexSet.insert(triM(FaceIndex, 0));
-		VertexSet.insert(triM(FaceIndex, 1));
-		VertexSet.insert(triM(FaceIndex, 2));
-	}
-	THashMap<int, int> VertexMap;
-	int Index = 0;
-	for (int VertexIndex : VertexSet)
-	{
-		VertexMap[VertexIndex] = Index;
-		Index++;
-	}
-	NewVerM.resize(VertexSet.size(), 3);
-	for (auto& [VertexIndex, NewIndex] : VertexMap)
-	{
-		NewVerM.row(NewIndex) = verM.row(VertexIndex);
-	}
-	NewTriM.resize(FaceIndices.size(), 3);
-	for (int i = 0; i < FaceIndices.size(); i++)
-	{
-		NewTriM(i, 0) = VertexMap[triM(FaceIndices[i], 0)];
-		NewTriM(i, 1) = VertexMap[triM(FaceIndices[i], 1)];
-		NewTriM(i, 2) = VertexMap[triM(FaceIndices[i], 2)];
-	}
-	return NewObject<StaticMesh>(NewVerM, NewTriM);
+		for (int j = 0; j < 3; j++)
+			VertexRemap[triM(FaceIndex, j)] = 0;
+	int NewVertexNum = 0;
+	for (int& NewIndex : VertexRemap)
+		if (NewIndex == 0) NewIndex = NewVertexNum++;
+
+	MatrixX3d NewVerM(NewVertexNum, 3);
+	ParallelFor(verM.rows(), [&](int i) {
+		if (VertexRemap[i] >= 0) NewVerM.row(VertexRemap[i]) = verM.row(i);
+	});
+	MatrixX3i NewTriM(FaceIndices.size(), 3);
+	ParallelFor(FaceIndices.size(), [&](int i) {
+		for (int j = 0; j < 3; j++)
+			NewTriM(i, j) = VertexRemap[triM(FaceIndices[i], j)];
+	});
+	return NewObject<StaticMesh>(std::move(NewVerM), std::move(NewTriM));
 }
 
 StaticMesh* StaticMesh::Clear()
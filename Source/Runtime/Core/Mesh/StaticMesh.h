@@ -5,6 +5,9 @@
 #pragma once
 #include "CoreMinimal.h"
 #include "Math/Box.h"
+#include "MeshTopology.h"
+#include "MeshEdit.h"
+#include <mutex>
 
 // Material property update
 DECLARE_MULTICAST_DELEGATE(FOnMaterialUpdate);
@@ -14,6 +17,7 @@ DECLARE_MULTICAST_DELEGATE(FOnMaterialChange);
 DECLARE_MULTICAST_DELEGATE(FOnGeometryUpdate);
 
 class Material;
+class MeshFairingSolver;
 /**
  * StaticMesh is a data container of geometry, which stored in model space.
  */
@@ -21,6 +25,7 @@ MCLASS(StaticMesh)
 class ENGINE_API StaticMesh : public Object
 {
 	REFLECTION_BODY(StaticMesh)
+	friend class MeshEdit;
 public:
 	StaticMesh();
 	StaticMesh(const MatrixX3d& InVerM, const MatrixX3i& InTriM);
@@ -121,6 +126,13 @@ public:
 	 */
 	int GetEdgeNum() const;
 
+	/**
+	 * Get the cached topology of the mesh, rebuilt only when the triangle indices or vertex number changed.
+	 * Moving vertices keeps the cache valid. Thread safe.
+	 * @return topology matching current triM
+	 */
+	SharedPtr<const MeshTopology> GetTopology() const;
+
 	/**
 	 * Explict calculate the normal of the mesh
 	 * Should called when the mesh is modified
@@ -139,6 +151,12 @@ public:
 	 */
 	StaticMesh* ReverseNormal();
 
+	/**
+	 * Begin a batched edit, changes are applied in one pass by MeshEdit::Commit
+	 * @return edit transaction of this mesh
+	 */
+	MeshEdit BeginEdit() { return MeshEdit(*this); }
+
 	/**
 	 * Delete one vertex of the mesh
 	 * @param VertexIndex Index of the vertex to be deleted
@@ -251,7 +269,8 @@ public:
 	StaticMesh* FillHoles();
 
 	/**
-	 * Explicit smooth the mesh cotan Laplacian
+	 * Implicit smooth the mesh with cotan Laplacian.
+	 * The fairing solver is kept while the topology does not change, so repeated smoothing only refactorizes the new weights
 	 * @param Iteration iterations of smoothing
 	 * @param UseUniform use uniform Laplacian or cotan Laplacian
 	 */
@@ -326,6 +345,11 @@ protected:
 	FOnGeometryUpdate OnGeometryUpdateDelegate;
 
 	FBox BoundingBox; // Bounding box of the mesh
+
+	mutable SharedPtr<const MeshTopology> Topology; // Immutable, shared between copies with the same indices
+	mutable std::mutex TopologyMutex;
+
+	SharedPtr<MeshFairingSolver> FairingSolver; // Bound to Topology, not shared between copies
 };
 
 FORCEINLINE Material* StaticMesh::GetMaterial() const
@@ -0,0 +1,242 @@
+#include "SweepMeshGenerator.h"
+#include "Log/Log.h"
+
+SweepMeshGenerator::EUpdateResult SweepMeshGenerator::Update(const TArray<FVector>& ControlPoints, bool bClosed, double Radius, int RingSample, int SampleNum)
+{
+	if (ControlPoints.size() < 2 || RingSample < 3 || SampleNum < 2)
+	{
+		LOG_WARNING("Sweep mesh needs at least 2 control points, 3 ring samples and 2 curve samples");
+		return EUpdateResult::None;
+	}
+
+	const bool bStructureChanged = ControlPoints.size() != CachedPoints.size() || bClosed != bCachedClosed
+		|| RingSample != CachedRingSample || SampleNum != CachedSampleNum;
+	const bool bRadiusChanged = Radius != CachedRadius;
+	CachedRadius = Radius;
+	if (bStructureChanged)
+	{
+		CachedPoints = ControlPoints;
+		bCachedClosed = bClosed;
+		CachedRingSample = RingSample;
+		CachedSampleNum = SampleNum;
+
+		BuildSampling();
+		EvaluateSamples(0, SampleNum);
+		PropagateFrames(0, SampleNum, false);
+		RingDirections.resize(SampleNum * RingSample, 3);
+		Vertices.resize(SampleNum * RingSample + (bClosed ? 0 : 2), 3);
+		GenerateRings(0, SampleNum);
+		BuildTriangles();
+		return EUpdateResult::Topology;
+	}
+
+	int Lo = ControlPoints.size(), Hi = -1;
+	for (int i = 0; i < ControlPoints.size(); i++)
+	{
+		if (ControlPoints[i] != CachedPoints[i])
+		{
+			Lo = std::min(Lo, i);
+			Hi = i;
+		}
+	}
+	if (Hi < 0)
+	{
+		if (!bRadiusChanged)
+			return EUpdateResult::None;
+		ScaleRings();
+		return EUpdateResult::Vertices;
+	}
+	for (int i = Lo; i <= Hi; i++)
+		CachedPoints[i] = ControlPoints[i];
+
+	// A control point is used by the two spans before and after it
+	int FirstSpan = Lo - 2, LastSpan = Hi + 1;
+	if (bClosed && (FirstSpan < 0 || LastSpan >= SpanNum))
+		FirstSpan = 0, LastSpan = SpanNum - 1;
+	FirstSpan = std::max(FirstSpan, 0);
+	LastSpan = std::min(LastSpan, SpanNum - 1);
+	const int Begin = SpanFirstSample[FirstSpan], End = SpanFirstSample[LastSpan + 1];
+
+	EvaluateSamples(Begin, End);
+	PropagateFrames(Begin, End, true);
+	GenerateRings(Begin, End);
+	if (bRadiusChanged)
+		ScaleRings();
+	return EUpdateResult::Vertices;
+}
+
+FVector SweepMeshGenerator::ControlPoint(int Index) const
+{
+	const int Num = CachedPoints.size();
+	if (bCachedClosed)
+		return CachedPoints[(Index % Num + Num) % Num];
+	// Reflect the end points to get phantom control points
+	if (Index < 0)
+		return 2. * CachedPoints[0] - CachedPoints[1];
+	if (Index >= Num)
+		return 2. * CachedPoints[Num - 1] - CachedPoints[Num - 2];
+	return CachedPoints[Index];
+}
+
+void SweepMeshGenerator::BuildSampling()
+{
+	const int SampleNum = CachedSampleNum;
+	SpanNum = bCachedClosed ? CachedPoints.size() : CachedPoints.size() - 1;
+	SampleSpan.resize(SampleNum);
+	SampleParam.resize(SampleNum);
+	SpanFirstSample.assign(SpanNum + 1, SampleNum);
+	for (int i = SampleNum - 1; i >= 0; i--)
+	{
+		const double u = bCachedClosed ? double(i) * SpanNum / SampleNum : double(i) * SpanNum / (SampleNum - 1);
+		SampleSpan[i] = std::min(static_cast<int>(u), SpanNum - 1);
+		SampleParam[i] = u - SampleSpan[i];
+		SpanFirstSample[SampleSpan[i]] = i;
+	}
+	// Spans without samples start where the next span starts
+	for (int s = SpanNum - 1; s >= 0; s--)
+		SpanFirstSample[s] = std::min(SpanFirstSample[s], SpanFirstSample[s + 1]);
+
+	const int RingSample = CachedRingSample;
+	RingCos.resize(RingSample);
+	RingSin.resize(RingSample);
+	for (int j = 0; j < RingSample; j++)
+	{
+		RingCos[j] = std::cos(j * 2. * M_PI / RingSample);
+		RingSin[j] = std::sin(j * 2. * M_PI / RingSample);
+	}
+	Positions.resize(SampleNum);
+	Tangents.resize(SampleNum);
+	Normals.resize(SampleNum);
+	Binormals.resize(SampleNum);
+}
+
+void SweepMeshGenerator::EvaluateSamples(int Begin, int End)
+{
+	ParallelFor(End - Begin, [&](int k) {
+		const int i = Begin + k;
+		const int Span = SampleSpan[i];
+		const FVector P0 = ControlPoint(Span - 1), P1 = ControlPoint(Span), P2 = ControlPoint(Span + 1), P3 = ControlPoint(Span + 2);
+
+		// Centripetal Catmull-Rom in Hermite form
+		constexpr double Eps = 1e-12;
+		const double D01 = std::max(std::sqrt((P1 - P0).norm()), Eps);
+		const double D12 = std::max(std::sqrt((P2 - P1).norm()), Eps);
+		const double D23 = std::max(std::sqrt((P3 - P2).norm()), Eps);
+		const FVector M1 = ((P1 - P0) / D01 - (P2 - P0) / (D01 + D12) + (P2 - P1) / D12) * D12;
+		const FVector M2 = ((P2 - P1) / D12 - (P3 - P1) / (D12 + D23) + (P3 - P2) / D23) * D12;
+
+		const double t = SampleParam[i], t2 = t * t, t3 = t2 * t;
+		Positions[i] = (2 * t3 - 3 * t2 + 1) * P1 + (t3 - 2 * t2 + t) * M1 + (-2 * t3 + 3 * t2) * P2 + (t3 - t2) * M2;
+		const FVector Derivative = (6 * t2 - 6 * t) * P1 + (3 * t2 - 4 * t + 1) * M1 + (-6 * t2 + 6 * t) * P2 + (3 * t2 - 2 * t) * M2;
+		Tangents[i] = Derivative.squaredNorm() > Eps ? Derivative.normalized() : (P2 - P1).normalized();
+	});
+}
+
+void SweepMeshGenerator::PropagateFrames(int Begin, int End, bool bKeepTail)
+{
+	// Double reflection, Wang et al. 2008
+	auto Transport = [this](int From, int To, FVector& OutNormal) {
+		const FVector V1 = Positions[To] - Positions[From];
+		const double C1 = V1.squaredNorm();
+		FVector NormalL = Normals[From], TangentL = Tangents[From];
+		if (C1 > 1e-20)
+		{
+			NormalL -= (2. / C1) * V1.dot(NormalL) * V1;
+			TangentL -= (2. / C1) * V1.dot(TangentL) * V1;
+		}
+		const FVector V2 = Tangents[To] - TangentL;
+		const double C2 = V2.squaredNorm();
+		if (C2 > 1e-20)
+			NormalL -= (2. / C2) * V2.dot(NormalL) * V2;
+		// Remove the drift of floating point error
+		OutNormal = (NormalL - NormalL.dot(Tangents[To]) * Tangents[To]).normalized();
+	};
+
+	if (Begin == 0)
+	{
+		const FVector& T = Tangents[0];
+		int MinAxis;
+		T.cwiseAbs().minCoeff(&MinAxis);
+		Normals[0] = T.cross(FVector::Unit(MinAxis)).normalized();
+		Binormals[0] = T.cross(Normals[0]);
+	}
+	for (int i = std::max(Begin, 1); i < End; i++)
+	{
+		Transport(i - 1, i, Normals[i]);
+		Binormals[i] = Tangents[i].cross(Normals[i]);
+	}
+
+	if (!bKeepTail || End >= CachedSampleNum || End <= Begin)
+		return;
+
+	// Blend the twist between the new frames and the kept tail over the edited samples
+	FVector Transported;
+	Transport(End - 1, End, Transported);
+	const FVector& Kept = Normals[End];
+	const double Twist = std::atan2(Transported.cross(Kept).dot(Tangents[End]), Transported.dot(Kept));
+	const int Num = End - Begin + 1;
+	for (int i = Begin; i < End; i++)
+	{
+		const double Angle = Twist * (i - Begin + 1) / Num;
+		Normals[i] = std::cos(Angle) * Normals[i] + std::sin(Angle) * Binormals[i];
+		Binormals[i] = Tangents[i].cross(Normals[i]);
+	}
+}
+
+void SweepMeshGenerator::GenerateRings(int Begin, int End)
+{
+	const int RingSample = CachedRingSample;
+	ParallelFor(End - Begin, [&](int k) {
+		const int i = Begin + k;
+		for (int j = 0; j < RingSample; j++)
+		{
+			const FVector Direction = RingCos[j] * Normals[i] + RingSin[j] * Binormals[i];
+			RingDirections.row(i * RingSample + j) = Direction;
+			Vertices.row(i * RingSample + j) = Positions[i] + CachedRadius * Direction;
+		}
+	});
+	if (!bCachedClosed)
+	{
+		Vertices.row(CachedSampleNum * RingSample) = CachedPoints.front();
+		Vertices.row(CachedSampleNum * RingSample + 1) = CachedPoints.back();
+	}
+}
+
+void SweepMeshGenerator::ScaleRings()
+{
+	const int RingSample = CachedRingSample;
+	ParallelFor(CachedSampleNum, [&](int i) {
+		for (int j = 0; j < RingSample; j++)
+			Vertices.row(i * RingSample + j) = Positions[i] + CachedRadius * FVector(RingDirections.row(i * RingSample + j));
+	});
+}
+
+void SweepMeshGenerator::BuildTriangles()
+{
+	const int RingSample = CachedRingSample, SampleNum = CachedSampleNum;
+	const int TubeFaceNum = (bCachedClosed ? SampleNum : SampleNum - 1) * RingSample * 2;
+	Triangles.resize(TubeFaceNum + (bCachedClosed ? 0 : RingSample * 2), 3);
+
+	// Tube, ring i to ring i + 1, the last ring connects to the first one for closed curve
+	ParallelFor(TubeFaceNum / (RingSample * 2), [&](int i) {
+		const int Start = i * RingSample, Next = (i + 1) % SampleNum * RingSample;
+		for (int j = 0; j < RingSample; j++)
+		{
+			const int jn = (j + 1) % RingSample;
+			Triangles.row((Start + j) * 2) = Vector3i(Start + j, Next + jn, Next + j);
+			Triangles.row((Start + j) * 2 + 1) = Vector3i(Start + j, Start + jn, Next + jn);
+		}
+	});
+
+	if (!bCachedClosed)
+	{
+		const int StartCenter = SampleNum * RingSample, EndCenter = StartCenter + 1;
+		const int EndRing = (SampleNum - 1) * RingSample;
+		for (int j = 0; j < RingSample; j++)
+		{
+			const int jn = (j + 1) % RingSample;
+			Triangles.row(TubeFaceNum + j) = Vector3i(j, StartCenter, jn);
+			Triangles.row(TubeFaceNum + RingSample + j) = Vector3i(EndRing + j, EndRing + jn, EndCenter);
+		}
+	}
+}
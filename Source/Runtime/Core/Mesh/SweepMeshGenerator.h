@@ -0,0 +1,77 @@
+#pragma once
+#include "CoreMinimal.h"
+
+/**
+ * Incremental tube mesh swept along a centripetal Catmull-Rom spline through control points.
+ * Samples are distributed uniformly in each span, so a control point only influences the samples of the
+ * four spans around it. Positions, rotation minimizing frames, ring directions and triangles are cached:
+ *  - radius change rescales the rings only
+ *  - local control point edits regenerate the affected spans, the frame twist is blended inside the
+ *    edited region so every frame after it is kept untouched
+ *  - triangles are only rebuilt when the control point number, sample numbers or closeness change
+ */
+class ENGINE_API SweepMeshGenerator
+{
+public:
+	enum class EUpdateResult : uint8
+	{
+		None,		// Nothing changed
+		Vertices,	// Vertices changed, triangles are the same as before
+		Topology	// Triangles rebuilt
+	};
+
+	/**
+	 * Update the sweep mesh to the given curve, only regenerate what changed since the last update
+	 * @param ControlPoints Points the spline interpolates, at least 2
+	 * @param bClosed If the curve is closed, the last point connects to the first one
+	 * @param Radius Tube radius
+	 * @param RingSample Vertex number per ring
+	 * @param SampleNum Ring number along the curve
+	 */
+	EUpdateResult Update(const TArray<FVector>& ControlPoints, bool bClosed, double Radius, int RingSample, int SampleNum);
+
+	FORCEINLINE const MatrixX3d& GetVertices() const { return Vertices; }
+	FORCEINLINE const MatrixX3i& GetTriangles() const { return Triangles; }
+
+	/** Force a full rebuild on next update */
+	void Reset() { CachedPoints.clear(); }
+
+protected:
+	void BuildSampling();
+	void BuildTriangles();
+
+	/** Evaluate position and tangent of samples in [Begin, End) */
+	void EvaluateSamples(int Begin, int End);
+
+	/** Propagate rotation minimizing frames through [Begin, End), keeping frames after End if bKeepTail */
+	void PropagateFrames(int Begin, int End, bool bKeepTail);
+
+	/** Regenerate ring directions and vertices of samples in [Begin, End) */
+	void GenerateRings(int Begin, int End);
+
+	/** Rescale every ring with current radius */
+	void ScaleRings();
+
+	FVector ControlPoint(int Index) const;
+
+	TArray<FVector> CachedPoints;
+	bool bCachedClosed = false;
+	double CachedRadius = 0.;
+	int CachedRingSample = 0;
+	int CachedSampleNum = 0;
+
+	int SpanNum = 0;
+	TArray<int> SampleSpan; // Span of each sample
+	TArray<double> SampleParam; // Local parameter in [0, 1] of each sample
+	TArray<int> SpanFirstSample; // First sample of each span, SpanNum + 1 entries
+
+	TArray<FVector> Positions;
+	TArray<FVector> Tangents;
+	TArray<FVector> Normals;
+	TArray<FVector> Binormals;
+	TArray<double> RingCos, RingSin;
+
+	MatrixX3d RingDirections; // Unit offset of every ring vertex from its sample
+	MatrixX3d Vertices;
+	MatrixX3i Triangles;
+};
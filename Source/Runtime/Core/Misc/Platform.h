@@ -31,6 +31,14 @@
 
 
 
+// Profiler zones are compiled out unless the build defines ME_ENABLE_PROFILER
+#if defined(ME_ENABLE_PROFILER)
+	#define ENABLE_PROFILER 1
+#else
+	#define ENABLE_PROFILER 0
+#endif
+
+
 #include <sstream>
 
 
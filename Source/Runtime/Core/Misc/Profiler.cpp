@@ -0,0 +1,187 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include "Log/Log.h"
+
+namespace MechEngine
+{
+namespace
+{
+	void WriteJsonString(std::ofstream& Out, const String& Text)
+	{
+		Out << '"';
+		for (char c : Text)
+		{
+			if (c == '"' || c == '\\')
+				Out << '\\' << c;
+			else if (static_cast<unsigned char>(c) < 0x20)
+				Out << ' ';
+			else
+				Out << c;
+		}
+		Out << '"';
+	}
+
+	// Chrome trace timestamps are in microseconds
+	double ToMicroseconds(int64_t Ns, int64_t OriginNs)
+	{
+		return static_cast<double>(Ns - OriginNs) * 1e-3;
+	}
+}
+
+Profiler& Profiler::Get()
+{
+	static Profiler Instance;
+	return Instance;
+}
+
+void Profiler::SetEnabled(bool bInEnabled)
+{
+	std::lock_guard Lock(Mutex);
+	bEnabled = bInEnabled;
+	CurrentFrame = {};
+	CurrentFrame.Index = FrameIndex;
+	CurrentFrame.StartNs = Now();
+	LastGpuMark = CurrentFrame.StartNs;
+}
+
+void Profiler::BeginFrame()
+{
+	if (!IsEnabled())
+		return;
+	std::lock_guard Lock(Mutex);
+	const int64_t FrameStart = Now();
+	CurrentFrame.EndNs = FrameStart;
+	Frames.push_back(std::move(CurrentFrame));
+	while (Frames.size() > MaxFrames)
+		Frames.pop_front();
+	CurrentFrame = {};
+	CurrentFrame.Index = ++FrameIndex;
+	CurrentFrame.StartNs = FrameStart;
+}
+
+void Profiler::AddZone(const char* Name, String Text, int64_t StartNs, int64_t EndNs)
+{
+	const uint ThreadId = GetThreadId();
+	std::lock_guard Lock(Mutex);
+	CurrentFrame.Zones.push_back({Name, std::move(Text), ThreadId, StartNs, EndNs});
+}
+
+void Profiler::AddCounter(const char* Name, double Value)
+{
+	std::lock_guard Lock(Mutex);
+	for (auto& Counter : CurrentFrame.Counters)
+	{
+		if (Counter.Name == Name)
+		{
+			Counter.Value += Value;
+			return;
+		}
+	}
+	CurrentFrame.Counters.push_back({Name, Value});
+}
+
+void Profiler::MarkGpu(const char* Name, int64_t SubmitNs)
+{
+	if (!IsEnabled())
+		return;
+	std::lock_guard Lock(Mutex);
+	const int64_t Mark = Now();
+	// GPU work lands in the frame being recorded when it completes, which may be a later frame than its submission
+	CurrentFrame.Zones.push_back({Name, {}, GpuThreadId, std::max(LastGpuMark, SubmitNs), Mark});
+	LastGpuMark = Mark;
+}
+
+Profiler::Frame Profiler::GetLastFrame() const
+{
+	std::lock_guard Lock(Mutex);
+	return Frames.empty() ? Frame{} : Frames.back();
+}
+
+void Profiler::SetThreadName(const String& Name)
+{
+	const uint ThreadId = GetThreadId();
+	std::lock_guard Lock(Mutex);
+	ThreadNames[ThreadId] = Name;
+}
+
+String Profiler::GetThreadName(uint ThreadId) const
+{
+	if (ThreadId == GpuThreadId)
+		return "GPU";
+	std::lock_guard Lock(Mutex);
+	auto It = ThreadNames.find(ThreadId);
+	return It != ThreadNames.end() ? It->second : "Thread " + std::to_string(ThreadId);
+}
+
+uint Profiler::GetThreadId()
+{
+	static std::atomic<uint> ThreadCounter = GpuThreadId + 1;
+	thread_local const uint ThreadId = ThreadCounter++;
+	return ThreadId;
+}
+
+bool Profiler::ExportChromeTrace(const String& FilePath) const
+{
+	std::ofstream Out(FilePath);
+	if (!Out.is_open())
+	{
+		LOG_ERROR("Failed to open profiler trace file: {}", FilePath);
+		return false;
+	}
+
+	std::lock_guard Lock(Mutex);
+	if (Frames.empty())
+	{
+		LOG_WARNING("No profiled frames to export, enable the profiler first.");
+		return false;
+	}
+	const int64_t Origin = Frames.front().StartNs;
+	size_t EventNum = 0;
+	Out << std::fixed << std::setprecision(3) << "{\"traceEvents\":[\n";
+	auto Separator = [&]() { if (EventNum++ > 0) Out << ",\n"; };
+
+	Separator();
+	Out << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << GpuThreadId << R"(,"args":{"name":"GPU"}})";
+	for (const auto& [ThreadId, Name] : ThreadNames)
+	{
+		Separator();
+		Out << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << ThreadId << R"(,"args":{"name":)";
+		WriteJsonString(Out, Name);
+		Out << "}}";
+	}
+
+	for (const auto& Frame : Frames)
+	{
+		for (const auto& Zone : Frame.Zones)
+		{
+			Separator();
+			Out << "{\"name\":";
+			WriteJsonString(Out, Zone.Name);
+			Out << ",\"cat\":\"" << (Zone.ThreadId == GpuThreadId ? "gpu" : "cpu") << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << Zone.ThreadId
+				<< ",\"ts\":" << ToMicroseconds(Zone.StartNs, Origin) << ",\"dur\":" << (Zone.EndNs - Zone.StartNs) * 1e-3;
+			if (!Zone.Text.empty())
+			{
+				Out << ",\"args\":{\"text\":";
+				WriteJsonString(Out, Zone.Text);
+				Out << "}";
+			}
+			Out << "}";
+		}
+		for (const auto& [Name, Value] : Frame.Counters)
+		{
+			Separator();
+			Out << "{\"name\":";
+			WriteJsonString(Out, Name);
+			Out << ",\"ph\":\"C\",\"pid\":1,\"ts\":" << ToMicroseconds(Frame.StartNs, Origin) << ",\"args\":{\"value\":" << Value << "}}";
+		}
+		Separator();
+		Out << "{\"name\":\"Frame " << Frame.Index << "\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":"
+			<< ToMicroseconds(Frame.StartNs, Origin) << "}";
+	}
+	Out << "\n]}\n";
+	LOG_INFO("Exported {} profiled frames to {}", Frames.size(), FilePath);
+	return true;
+}
+}
@@ -0,0 +1,155 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include "Core/ContainerTypes.h"
+#include "Platform.h"
+
+namespace MechEngine
+{
+/**
+ * Frame profiler collecting CPU zones, GPU segments and counters.
+ * Zones are recorded only while the profiler is enabled, the last frames are kept for the editor panel
+ * and can be exported in the Chrome trace format, viewable in chrome://tracing or Perfetto.
+ * Zone names should be string literals, they are stored by pointer.
+ */
+class ENGINE_API Profiler
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	// Thread id of the GPU track in the trace
+	static constexpr uint GpuThreadId = 0;
+
+	struct Zone
+	{
+		const char* Name;
+		// Optional per call text, like the component name
+		String Text;
+		uint ThreadId;
+		int64_t StartNs;
+		int64_t EndNs;
+	};
+
+	struct Counter
+	{
+		const char* Name;
+		double Value;
+	};
+
+	struct Frame
+	{
+		uint64_t Index = 0;
+		int64_t StartNs = 0;
+		int64_t EndNs = 0;
+		TArray<Zone> Zones;
+		TArray<Counter> Counters;
+	};
+
+	Profiler(const Profiler&) = delete;
+	Profiler& operator=(const Profiler&) = delete;
+
+	static Profiler& Get();
+
+	FORCEINLINE bool IsEnabled() const { return bEnabled.load(std::memory_order_relaxed); }
+
+	void SetEnabled(bool bInEnabled);
+
+	/** Close the current frame and start a new one, called once per frame by the main loop */
+	void BeginFrame();
+
+	void AddZone(const char* Name, String Text, int64_t StartNs, int64_t EndNs);
+
+	/** Add to a counter of the current frame, counters with the same name are summed */
+	void AddCounter(const char* Name, double Value);
+
+	/**
+	 * Close a GPU segment at the current time, called from a command list callback once its commands are completed.
+	 * The segment starts at the end of the previous segment, or at submission if the GPU was idle
+	 * @param SubmitNs Time the commands of the segment are submitted
+	 */
+	void MarkGpu(const char* Name, int64_t SubmitNs);
+
+	/** Copy of the last finished frame */
+	[[nodiscard]] Frame GetLastFrame() const;
+
+	/**
+	 * Write the kept frames as Chrome trace events
+	 * @param FilePath Output json file
+	 * @return Whether the file is written
+	 */
+	bool ExportChromeTrace(const String& FilePath) const;
+
+	/** Name the track of the calling thread in the exported trace */
+	void SetThreadName(const String& Name);
+
+	[[nodiscard]] String GetThreadName(uint ThreadId) const;
+
+	/** Small stable id of the calling thread, 0 is the GPU track */
+	static uint GetThreadId();
+
+	FORCEINLINE static int64_t Now()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+	}
+
+private:
+	Profiler() = default;
+
+	// Frames kept for the panel and the trace export, 10 seconds at 30 fps
+	static constexpr size_t MaxFrames = 300;
+
+	std::atomic<bool> bEnabled = false;
+
+	mutable std::mutex Mutex;
+	Frame CurrentFrame;
+	std::deque<Frame> Frames;
+	uint64_t FrameIndex = 0;
+	int64_t LastGpuMark = 0;
+	TMap<uint, String> ThreadNames;
+};
+
+/** Records a CPU zone from construction to destruction */
+class ProfileZone
+{
+public:
+	FORCEINLINE explicit ProfileZone(const char* InName)
+		: Name(Profiler::Get().IsEnabled() ? InName : nullptr), StartNs(Name ? Profiler::Now() : 0) {}
+
+	FORCEINLINE ~ProfileZone()
+	{
+		if (Name)
+			Profiler::Get().AddZone(Name, std::move(Text), StartNs, Profiler::Now());
+	}
+
+	ProfileZone(const ProfileZone&) = delete;
+	ProfileZone& operator=(const ProfileZone&) = delete;
+
+	FORCEINLINE bool IsActive() const { return Name != nullptr; }
+
+	FORCEINLINE void SetText(String InText) { Text = std::move(InText); }
+
+private:
+	const char* Name;
+	int64_t StartNs;
+	String Text;
+};
+}
+
+#define PROFILE_CONCAT_INNER(A, B) A##B
+#define PROFILE_CONCAT(A, B) PROFILE_CONCAT_INNER(A, B)
+
+#if ENABLE_PROFILER
+	#define PROFILE_SCOPE(Name) MechEngine::ProfileZone PROFILE_CONCAT(ProfileZone_, __LINE__)(Name)
+	// Text is evaluated only while the profiler is enabled
+	#define PROFILE_SCOPE_TEXT(Name, Text) \
+		MechEngine::ProfileZone PROFILE_CONCAT(ProfileZone_, __LINE__)(Name); \
+		if (PROFILE_CONCAT(ProfileZone_, __LINE__).IsActive()) PROFILE_CONCAT(ProfileZone_, __LINE__).SetText(Text)
+	#define PROFILE_COUNTER(Name, Value) \
+		do { if (MechEngine::Profiler::Get().IsEnabled()) MechEngine::Profiler::Get().AddCounter(Name, static_cast<double>(Value)); } while (0)
+#else
+	#define PROFILE_SCOPE(Name)
+	#define PROFILE_SCOPE_TEXT(Name, Text)
+	#define PROFILE_COUNTER(Name, Value)
+#endif
@@ -4,6 +4,14 @@
 #include "ParametricSurface.h"
 #include "CoreMinimal.h"
 #include "Algorithm/GeometryProcess.h"
+#include <atomic>
+
+uint64_t ParametricSurface::NextRevision()
+{
+	// Surfaces may be created and edited from any thread
+	static std::atomic<uint64_t> RevisionCounter = 0;
+	return ++RevisionCounter;
+}
 
 Vector2d ParametricSurface::Projection(const FVector& Pos) const
 {
@@ -8,6 +8,18 @@ public:
 
 	explicit ParametricSurface(bool bInIsClosed) : bIsClosed(bInIsClosed) {}
 
+	/// Call after changing any parameter of the surface, grids sampled from it are rebuilt
+	void MarkAsEdited() { Revision = NextRevision(); }
+
+	/// Unique among all surfaces and their edits, a grid sampled at this revision matches the current parameters
+	uint64_t GetRevision() const { return Revision; }
+
+	void PostEdit(Reflection::FieldAccessor& Field) override
+	{
+		MarkAsEdited();
+		Object::PostEdit(Field);
+	}
+
     virtual FVector Sample(double u, double v) const = 0;
 
     virtual Vector3d SampleThickness(double u, double v, double Thickness) const
@@ -17,6 +29,9 @@ public:
         return Sample(u, v) + SampleNormal(u, v) * Thickness;
     }
 
+	/// If SampleThickness offsets Sample along SampleNormal, thickness samples can be derived from cached base points and normals
+	virtual bool IsThicknessAlongNormal() const { return true; }
+
     /// Return normalized vertex normal
     /// @math (Sample(u + 0.01, v) - Sample(u - 0.01, v)) X (Sample(u, v + 0.01) - Sample(u, v - 0.01)) norm
     virtual FVector SampleNormal(double u, double v) const
@@ -75,6 +90,11 @@ public:
     	ASSERTMSG(false, "Not Implemented");
     	return {};
     }
+
+protected:
+	static uint64_t NextRevision();
+
+	uint64_t Revision = NextRevision();
 };
 
 
@@ -142,6 +162,7 @@ public:
 		v *= Height;
 		return {A * sinh(u), B * cosh(u) + Thickness, v};
 	}
+	bool IsThicknessAlongNormal() const override { return false; }
 	// virtual Vector2d Projection(const FVector& Pos) const override
 	// {
 	// 	double U = asinh(Pos.x() / A) / 2. + 0.5;
@@ -189,6 +210,7 @@ public:
 		v = 1. - v;
 		return {(Radius + Thickness) * cos(u * M_PI * 2.0) * v, (Radius + Thickness) * sin(u * M_PI * 2.0) * v, (1. - v) * (Height + Thickness)};
 	}
+	bool IsThicknessAlongNormal() const override { return false; }
 	Vector2d Projection(const FVector& Pos) const override
 	{
     	Vector2d UV;
@@ -239,6 +261,7 @@ public:
 		XY += XY.normalized() * Thickness;
 		return {XY.x(), XY.y(), v * h};
 	}
+	bool IsThicknessAlongNormal() const override { return false; }
 };
 
 
@@ -264,6 +287,7 @@ public:
 		Pos -= Pos.normalized() * Thickness;
 		return Pos;
 	}
+	bool IsThicknessAlongNormal() const override { return false; }
 };
 
 
@@ -299,6 +323,7 @@ public:
 	{
 		return Sample(u, v) + FVector{0, 0, Thickness};
 	}
+	bool IsThicknessAlongNormal() const override { return false; }
 };
 
 class ENGINE_API HorseSaddleSurface : public ParametricSurface
@@ -318,6 +343,7 @@ public:
 	{
 		return Sample(u, v) + FVector{0, 0, Thickness};
 	}
+	bool IsThicknessAlongNormal() const override { return false; }
 };
 
 // @see https://mathcurve.com/surfaces.gb/cylindreparabolic/cylindreparabolic.shtml
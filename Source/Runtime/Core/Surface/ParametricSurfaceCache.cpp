@@ -0,0 +1,99 @@
+#include "ParametricSurfaceCache.h"
+#include "ParametricSurface.h"
+
+void ParametricSurfaceCache::Build(const ParametricSurface* InSurface, int InNumU, int InNumV)
+{
+	ASSERTMSG(InSurface != nullptr, "Build surface cache without a surface");
+	assert(InNumU >= 3 && InNumV >= 2);
+	Surface = InSurface;
+	Revision = Surface->GetRevision();
+	NumU = InNumU;
+	NumV = InNumV;
+	// Same rule as TriangularSurface, a closed polygon has NumU gaps for NumU lines
+	bClosed = Surface->bIsClosed || (Surface->Sample(1., 0.) - Surface->Sample(0., 0.)).norm() < 0.00001;
+
+	int VertexNum = NumU * NumV;
+	double StepU = bClosed ? 1. / (double)NumU : 1. / (double)(NumU - 1);
+	double StepV = 1. / (double)(NumV - 1);
+	UV.resize(VertexNum, 2);
+	Points.resize(VertexNum, 3);
+	Normals.resize(VertexNum, 3);
+	TangentsU.resize(0, 3);
+	TangentsV.resize(0, 3);
+
+	ParallelFor(VertexNum, [&](int Index)
+	{
+		int UIndex = Index % NumU;
+		int VIndex = Index / NumU;
+		double u = (double)UIndex * StepU;
+		double v = VIndex == NumV - 1 ? 1. : (double)VIndex * StepV;
+		UV.row(Index) = FVector2{u, v};
+		Points.row(Index) = Surface->Sample(u, v);
+		Normals.row(Index) = Surface->SampleNormal(u, v);
+	});
+}
+
+const MatrixX3d& ParametricSurfaceCache::GetTangentsU() const
+{
+	BuildTangents();
+	return TangentsU;
+}
+
+const MatrixX3d& ParametricSurfaceCache::GetTangentsV() const
+{
+	BuildTangents();
+	return TangentsV;
+}
+
+void ParametricSurfaceCache::BuildTangents() const
+{
+	ASSERTMSG(Surface != nullptr, "Surface cache is not built");
+	if (TangentsU.rows() == Points.rows())
+		return;
+	TangentsU.resize(Points.rows(), 3);
+	TangentsV.resize(Points.rows(), 3);
+	ParallelFor(Points.rows(), [&](int Index)
+	{
+		int UIndex = Index % NumU;
+		int VIndex = Index / NumU;
+		int Left = UIndex > 0 ? Index - 1 : bClosed ? Index + NumU - 1 : Index;
+		int Right = UIndex < NumU - 1 ? Index + 1 : bClosed ? Index - NumU + 1 : Index;
+		int Bottom = VIndex > 0 ? Index - NumU : Index;
+		int Top = VIndex < NumV - 1 ? Index + NumU : Index;
+		TangentsU.row(Index) = (Points.row(Right) - Points.row(Left)).normalized();
+		TangentsV.row(Index) = (Points.row(Top) - Points.row(Bottom)).normalized();
+	});
+}
+
+bool ParametricSurfaceCache::IsValid(const ParametricSurface* InSurface, int InNumU, int InNumV) const
+{
+	return Surface != nullptr && Surface == InSurface && Revision == InSurface->GetRevision() && NumU == InNumU && NumV == InNumV;
+}
+
+void ParametricSurfaceCache::Invalidate()
+{
+	Surface = nullptr;
+	Revision = 0;
+	NumU = NumV = 0;
+	UV.resize(0, 2);
+	Points.resize(0, 3);
+	Normals.resize(0, 3);
+	TangentsU.resize(0, 3);
+	TangentsV.resize(0, 3);
+}
+
+MatrixX3d ParametricSurfaceCache::GetVertices(double Thickness) const
+{
+	ASSERTMSG(Surface != nullptr, "Surface cache is not built");
+	if (Thickness == 0.)
+		return Points;
+	if (Surface->IsThicknessAlongNormal())
+		return Points + Normals * Thickness;
+
+	MatrixX3d Vertices(Points.rows(), 3);
+	ParallelFor(Points.rows(), [&](int Index)
+	{
+		Vertices.row(Index) = Surface->SampleThickness(UV(Index, 0), UV(Index, 1), Thickness);
+	});
+	return Vertices;
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include "CoreMinimal.h"
+
+class ParametricSurface;
+
+/**
+ * Base points and normals of a parametric surface evaluated once on a (U, V) grid, tangents are derived on demand.
+ * Vertex UIndex + VIndex * NumU samples the same (u, v) as ParametricSurfaceComponent::TriangularSurface,
+ * so surfaces of any thickness, the AABB mesh and the display mesh are derived from it without sampling again.
+ */
+class ENGINE_API ParametricSurfaceCache
+{
+public:
+	/**
+	 * Evaluate the surface on the grid, in parallel over the vertices.
+	 * @param InSurface Surface to evaluate, has to outlive the cache
+	 * @param InNumU How many samples in U direction
+	 * @param InNumV How many samples in V direction
+	 */
+	void Build(const ParametricSurface* InSurface, int InNumU, int InNumV);
+
+	/** Whether the grid was built from this surface, at its current revision and at this resolution */
+	[[nodiscard]] bool IsValid(const ParametricSurface* InSurface, int InNumU, int InNumV) const;
+
+	/** Drop the grid, call when the parameters of the surface change */
+	void Invalidate();
+
+	/**
+	 * Grid vertices at a thickness sample, offset along the cached normals.
+	 * Surfaces with their own SampleThickness fall back to sampling it, reusing the grid parameters.
+	 */
+	[[nodiscard]] MatrixX3d GetVertices(double Thickness) const;
+
+	[[nodiscard]] FORCEINLINE const MatrixX3d& GetPoints() const { return Points; }
+
+	[[nodiscard]] FORCEINLINE const MatrixX3d& GetNormals() const { return Normals; }
+
+	/** Tangents are differenced from the grid points on first access, not on every build */
+	[[nodiscard]] const MatrixX3d& GetTangentsU() const;
+
+	[[nodiscard]] const MatrixX3d& GetTangentsV() const;
+
+	[[nodiscard]] FORCEINLINE const MatrixX2d& GetUV() const { return UV; }
+
+	[[nodiscard]] FORCEINLINE int GetNumU() const { return NumU; }
+
+	[[nodiscard]] FORCEINLINE int GetNumV() const { return NumV; }
+
+	/** If the grid wraps around in U direction, the last column connects to the first one */
+	[[nodiscard]] FORCEINLINE bool IsClosed() const { return bClosed; }
+
+protected:
+	const ParametricSurface* Surface = nullptr;
+	// Revision of the surface the grid was sampled at, a new surface at a reused address never matches
+	uint64_t Revision = 0;
+	int NumU = 0;
+	int NumV = 0;
+	bool bClosed = false;
+
+	MatrixX2d UV;
+	MatrixX3d Points;
+	MatrixX3d Normals;
+	/** Fill the tangents if the grid was built since they were */
+	void BuildTangents() const;
+
+	// Normalized central differences of the grid points, empty until first accessed
+	mutable MatrixX3d TangentsU;
+	mutable MatrixX3d TangentsV;
+};
@@ -0,0 +1,72 @@
+#include "ShaderCompiler.h"
+#include <thread>
+
+namespace MechEngine::Rendering
+{
+ShaderCompiler::ShaderCompiler(Device& InDevice, bool bInDebugInfo, bool bInParallel)
+	: device(InDevice), bDebugInfo(bInDebugInfo), bParallel(bInParallel),
+	Workers(std::max<std::ptrdiff_t>(std::thread::hardware_concurrency(), 1))
+{}
+
+ShaderCompiler::~ShaderCompiler()
+{
+	for (auto& Task : Tasks)
+		if (Task.valid()) Task.wait();
+}
+
+void ShaderCompiler::Enqueue(TFunction<void()>&& Task)
+{
+	if (!bParallel)
+	{
+		Task();
+		return;
+	}
+	Tasks.push_back(std::async(std::launch::async, [this, Task = std::move(Task)] {
+		// Give the permit back even if the compile throws, the exception reaches Wait through the future
+		struct PermitGuard
+		{
+			std::counting_semaphore<>& Semaphore;
+			explicit PermitGuard(std::counting_semaphore<>& InSemaphore) : Semaphore(InSemaphore) { Semaphore.acquire(); }
+			~PermitGuard() { Semaphore.release(); }
+		} Permit(Workers);
+		Task();
+	}));
+}
+
+void ShaderCompiler::Record(const luisa::string& Name, double TraceTime, double CompileTime)
+{
+	std::lock_guard Lock(RecordMutex);
+	Records.push_back({String(Name.c_str()), TraceTime, CompileTime});
+}
+
+double ShaderCompiler::MillisecondsSince(Clock::time_point Start)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - Start).count();
+}
+
+void ShaderCompiler::Wait()
+{
+	// Rethrow the compile errors on the calling thread
+	for (auto& Task : Tasks)
+		Task.get();
+	Tasks.clear();
+	bQueueStarted = false;
+	if (Records.empty())
+		return;
+
+	std::ranges::sort(Records, [](const KernelRecord& A, const KernelRecord& B) {
+		return A.TraceTime + A.CompileTime > B.TraceTime + B.CompileTime;
+	});
+	double TotalTrace = 0., TotalCompile = 0.;
+	for (const auto& [Name, TraceTime, CompileTime] : Records)
+	{
+		TotalTrace += TraceTime;
+		TotalCompile += CompileTime;
+	}
+	LOG_INFO("Compiled {} kernels in {:.1f} ms, trace {:.1f} ms, backend compile {:.1f} ms{}",
+		Records.size(), MillisecondsSince(FirstQueueTime), TotalTrace, TotalCompile, bParallel ? " in parallel" : "");
+	for (const auto& [Name, TraceTime, CompileTime] : Records)
+		LOG_INFO("    {:>8.1f} ms  trace {:>7.1f} ms  compile {:>8.1f} ms  {}", TraceTime + CompileTime, TraceTime, CompileTime, Name);
+	Records.clear();
+}
+}
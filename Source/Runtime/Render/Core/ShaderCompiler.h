@@ -0,0 +1,101 @@
+#pragma once
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <semaphore>
+#include <luisa/luisa-compute.h>
+#include "CoreMinimal.h"
+
+namespace MechEngine::Rendering
+{
+using namespace luisa;
+using namespace luisa::compute;
+
+/**
+ * Compile the kernels of a scene concurrently.
+ * Kernels are traced on the calling thread, since passes and samplers keep DSL state while tracing,
+ * then compiled by the backend on worker threads.
+ * Compiled binaries are cached on disk by the backend, keyed by the hash of the generated source and shader options.
+ * Render settings are baked into the source while tracing, so a settings change is a cache miss as well.
+ */
+class ENGINE_API ShaderCompiler
+{
+public:
+	ShaderCompiler(Device& InDevice, bool bInDebugInfo, bool bInParallel);
+
+	~ShaderCompiler();
+
+	/**
+	 * Trace a kernel and queue its compilation, the shader is valid after Wait returns
+	 * @param Target Shader to be written, should outlive the compilation
+	 * @param Definition Kernel function
+	 * @param Name Kernel name in the shader cache and the compile report
+	 */
+	template<size_t N, typename... Args, typename Def>
+	void Compile(luisa::unique_ptr<Shader<N, Args...>>& Target, Def&& Definition, const luisa::string& Name);
+
+	/** Wait for all queued kernels and log the compile time of each kernel */
+	void Wait();
+
+	[[nodiscard]] FORCEINLINE Device& GetDevice() noexcept { return device; }
+	[[nodiscard]] FORCEINLINE bool IsDebugInfo() const noexcept { return bDebugInfo; }
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	template<size_t N, typename... Args>
+	struct KernelType;
+	template<typename... Args>
+	struct KernelType<1, Args...> { using Type = Kernel1D<void(Args...)>; };
+	template<typename... Args>
+	struct KernelType<2, Args...> { using Type = Kernel2D<void(Args...)>; };
+	template<typename... Args>
+	struct KernelType<3, Args...> { using Type = Kernel3D<void(Args...)>; };
+
+	struct KernelRecord
+	{
+		String Name;
+		double TraceTime;
+		double CompileTime;
+	};
+
+	void Enqueue(TFunction<void()>&& Task);
+
+	void Record(const luisa::string& Name, double TraceTime, double CompileTime);
+
+	static double MillisecondsSince(Clock::time_point Start);
+
+	Device& device;
+	bool bDebugInfo;
+	bool bParallel;
+
+	// Backend compilation is CPU bound, limit the workers to the hardware threads
+	std::counting_semaphore<> Workers;
+	TArray<std::future<void>> Tasks;
+
+	std::mutex RecordMutex;
+	TArray<KernelRecord> Records;
+	Clock::time_point FirstQueueTime;
+	bool bQueueStarted = false;
+};
+
+template<size_t N, typename... Args, typename Def>
+void ShaderCompiler::Compile(luisa::unique_ptr<Shader<N, Args...>>& Target, Def&& Definition, const luisa::string& Name)
+{
+	if (!bQueueStarted)
+	{
+		FirstQueueTime = Clock::now();
+		bQueueStarted = true;
+	}
+	const auto TraceStart = Clock::now();
+	auto Kernel = luisa::make_shared<typename KernelType<N, Args...>::Type>(std::forward<Def>(Definition));
+	const double TraceTime = MillisecondsSince(TraceStart);
+
+	ShaderOption Option{.enable_cache = true, .enable_debug_info = bDebugInfo, .name = Name};
+	Enqueue([this, &Target, Kernel = std::move(Kernel), Option = std::move(Option), TraceTime] {
+		const auto CompileStart = Clock::now();
+		Target = luisa::make_unique<Shader<N, Args...>>(device.compile(*Kernel, Option));
+		Record(Option.name, TraceTime, MillisecondsSince(CompileStart));
+	});
+}
+}
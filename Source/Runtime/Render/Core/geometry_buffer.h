@@ -4,32 +4,60 @@
 
 #pragma once
 #include <luisa/luisa-compute.h>
+#include "Render/Core/math_function.h"
 #include "Render/material/shader_base.h"
 
 namespace MechEngine::Rendering
 {
+/**
+ * Per pixel geometry of the first intersection.
+ * The packed layout stores octahedral normals in unorm16x2, half albedo, half motion offsets
+ * and instance / primitive ids in one 64 bit visibility word, 44 bytes per pixel instead of 76.
+ * Fields should be accessed with the read / write functions, which decode either layout.
+ */
 struct geometry_buffer
 {
-	Image<uint> instance_id;
-	Image<uint> primitive_id;
+	bool packed = false;
 
 	Image<float> radiance; // color of the rendering, not include UI
-    Image<float> albedo;
-    Image<float> normal;
+	Image<float> albedo; // FLOAT4, packed: HALF4
+	Image<float> normal; // FLOAT4 world normal, packed: SHORT2 octahedral normal
 	Buffer<float> depth; // For atomic operation
-	Image<float> motion_vector;
+	Image<float> motion_vector; // FLOAT4 previous pixel position, packed: HALF2 offset to the previous position
 
-	void InitBuffer(Device& device, const uint2& size)
+	Image<uint> instance_id; // unpacked only
+	Image<uint> primitive_id; // unpacked only
+	Image<uint> visibility; // packed only, instance id x and primitive id y
+
+	void InitBuffer(Device& device, const uint2& size, bool bPacked)
 	{
 		LOG_DEBUG("GBuffer initial size: {} {}", size.x, size.y);
+		packed = bPacked;
 		radiance = device.create_image<float>(PixelStorage::FLOAT4, size.x, size.y);
-		albedo = device.create_image<float>(PixelStorage::FLOAT4, size.x, size.y);
-		normal = device.create_image<float>(PixelStorage::FLOAT4, size.x, size.y);
 		depth = device.create_buffer<float>(size.x * size.y);
-		instance_id = device.create_image<uint>(PixelStorage::INT1, size.x, size.y);
-		primitive_id = device.create_image<uint>(PixelStorage::INT1, size.x, size.y);
-		motion_vector = device.create_image<float>(PixelStorage::FLOAT4, size.x, size.y);
-		LOG_INFO("Init render frame buffer: {} {}", size.x, size.y);
+		if (packed)
+		{
+			albedo = device.create_image<float>(PixelStorage::HALF4, size.x, size.y);
+			normal = device.create_image<float>(PixelStorage::SHORT2, size.x, size.y);
+			motion_vector = device.create_image<float>(PixelStorage::HALF2, size.x, size.y);
+			visibility = device.create_image<uint>(PixelStorage::INT2, size.x, size.y);
+		}
+		else
+		{
+			albedo = device.create_image<float>(PixelStorage::FLOAT4, size.x, size.y);
+			normal = device.create_image<float>(PixelStorage::FLOAT4, size.x, size.y);
+			motion_vector = device.create_image<float>(PixelStorage::FLOAT4, size.x, size.y);
+			instance_id = device.create_image<uint>(PixelStorage::INT1, size.x, size.y);
+			primitive_id = device.create_image<uint>(PixelStorage::INT1, size.x, size.y);
+		}
+		LOG_INFO("Init render frame buffer: {} {}, {} layout {} bytes per pixel", size.x, size.y, packed ? "packed" : "full", bytes_per_pixel(packed));
+	}
+
+	/** Bytes of one pixel over all G-Buffers */
+	static constexpr size_t bytes_per_pixel(bool bPacked) noexcept
+	{
+		// radiance and depth are the same in both layouts
+		return bPacked ? 16 + 4 + 8 + 4 + 4 + 8 : 16 + 4 + 16 + 16 + 16 + 4 + 4;
 	}
 
     void set_default(const UInt2& pixel_coord,
@@ -37,11 +65,20 @@ struct geometry_buffer
     {
 		radiance->write(pixel_coord, background_color);
         albedo->write(pixel_coord, background_color);
-        normal->write(pixel_coord, background_color);
         depth->write(flattend_index(pixel_coord), 1e6f);
-        instance_id->write(pixel_coord, make_uint4(~0u));
-    	primitive_id->write(pixel_coord, make_uint4(~0u));
-    	motion_vector->write(pixel_coord, make_float4(0.f));
+    	if (packed)
+    	{
+    		normal->write(pixel_coord, make_float4(octahedral_encode(normalize(background_color.xyz())), 0.f, 0.f));
+    		motion_vector->write(pixel_coord, make_float4(0.f));
+    		visibility->write(pixel_coord, make_uint4(~0u));
+    	}
+    	else
+    	{
+    		normal->write(pixel_coord, background_color);
+    		instance_id->write(pixel_coord, make_uint4(~0u));
+    		primitive_id->write(pixel_coord, make_uint4(~0u));
+    		motion_vector->write(pixel_coord, make_float4(0.f));
+    	}
     }
 
 	void write(const UInt2& pixel_coord,
@@ -50,20 +87,75 @@ struct geometry_buffer
     {
 		radiance->write(pixel_coord, make_float4(pixel_radiance, 1.f));
 		albedo->write(pixel_coord, make_float4(intersection.albedo, 1.f));
-    	instance_id->write(pixel_coord, make_uint4(intersection.instance_id));
-    	primitive_id->write(pixel_coord, make_uint4(intersection.primitive_id));
-    	normal->write(pixel_coord, make_float4(intersection.corner_normal_world, 1.f));
     	depth->write(flattend_index(pixel_coord), intersection.depth);
-    	motion_vector->write(pixel_coord, make_float4(intersection.motion_vector, 0.f, 0.f));
+    	if (packed)
+    	{
+    		normal->write(pixel_coord, make_float4(octahedral_encode(intersection.corner_normal_world), 0.f, 0.f));
+    		// Offsets are small, absolute positions would lose whole pixels in half precision
+    		motion_vector->write(pixel_coord, make_float4(intersection.motion_vector - make_float2(pixel_coord), 0.f, 0.f));
+    		visibility->write(pixel_coord, make_uint4(intersection.instance_id, intersection.primitive_id, 0u, 0u));
+    	}
+    	else
+    	{
+    		normal->write(pixel_coord, make_float4(intersection.corner_normal_world, 1.f));
+    		instance_id->write(pixel_coord, make_uint4(intersection.instance_id));
+    		primitive_id->write(pixel_coord, make_uint4(intersection.primitive_id));
+    		motion_vector->write(pixel_coord, make_float4(intersection.motion_vector, 0.f, 0.f));
+    	}
     }
 
+	[[nodiscard]] Float3 read_albedo(const UInt2& pixel_coord) const noexcept
+	{
+		return albedo->read(pixel_coord).xyz();
+	}
+
+	[[nodiscard]] Float3 read_normal(const UInt2& pixel_coord) const noexcept
+	{
+		if (packed)
+			return octahedral_decode(normal->read(pixel_coord).xy());
+		return normal->read(pixel_coord).xyz();
+	}
+
+	/** Previous pixel position of the pixel, same as the motion vector of the intersection */
+	[[nodiscard]] Float2 read_motion_vector(const UInt2& pixel_coord) const noexcept
+	{
+		if (packed)
+			return make_float2(pixel_coord) + motion_vector->read(pixel_coord).xy();
+		return motion_vector->read(pixel_coord).xy();
+	}
+
+	[[nodiscard]] UInt read_instance_id(const UInt2& pixel_coord) const noexcept
+	{
+		if (packed)
+			return visibility->read(pixel_coord).x;
+		return instance_id->read(pixel_coord).x;
+	}
+
+	[[nodiscard]] UInt read_primitive_id(const UInt2& pixel_coord) const noexcept
+	{
+		if (packed)
+			return visibility->read(pixel_coord).y;
+		return primitive_id->read(pixel_coord).x;
+	}
+
+	/**
+	 * Read instance and primitive id in one fetch in the packed layout.
+	 * @return instance id x and primitive id y
+	 */
+	[[nodiscard]] UInt2 read_visibility(const UInt2& pixel_coord) const noexcept
+	{
+		if (packed)
+			return visibility->read(pixel_coord).xy();
+		return make_uint2(instance_id->read(pixel_coord).x, primitive_id->read(pixel_coord).x);
+	}
+
 	/**
 	 * Get the size of the G-Buffers. The size should be equal to the size of the frame buffer.
 	 * @return The size of the G-Buffers.
 	 */
 	[[nodiscard]] UInt2 get_size() const noexcept
 	{
-	    return instance_id.size();
+	    return radiance.size();
 	}
 
 	/**
@@ -97,4 +189,4 @@ struct geometry_buffer
 	    return make_uint2(index / size_y, index % size_y);
 	}
 };
-};
\ No newline at end of file
+};
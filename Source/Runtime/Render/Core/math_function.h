@@ -242,4 +242,32 @@ namespace MechEngine::Rendering
 		return c.x * 0.2126f + c.y * 0.7152f + c.z * 0.0722f;
 	}
 
+	/**
+	 * Encode a unit vector with the octahedral mapping.
+	 * @see https://jcgt.org/published/0003/02/01/
+	 * @param n normalized vector
+	 * @return the encoded vector in [0, 1], fits unorm storage
+	 */
+	FORCEINLINE Float2 octahedral_encode(const Float3& n)
+	{
+		auto p = n.xy() / max(abs(n.x) + abs(n.y) + abs(n.z), 1e-8f);
+		auto sign_not_zero = ite(p >= 0.f, make_float2(1.f), make_float2(-1.f));
+		auto folded = (1.f - abs(p.yx())) * sign_not_zero;
+		return ite(make_bool2(n.z < 0.f), folded, p) * 0.5f + 0.5f;
+	}
+
+	/**
+	 * Decode a unit vector encoded by octahedral_encode.
+	 * @param e the encoded vector in [0, 1]
+	 * @return the normalized vector
+	 */
+	FORCEINLINE Float3 octahedral_decode(const Float2& e)
+	{
+		auto p = e * 2.f - 1.f;
+		auto z = 1.f - abs(p.x) - abs(p.y);
+		auto t = max(-z, 0.f);
+		auto xy = p + ite(p >= 0.f, make_float2(-t), make_float2(t));
+		return normalize(make_float3(xy, z));
+	}
+
 }
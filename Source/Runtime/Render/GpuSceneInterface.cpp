@@ -7,6 +7,7 @@
 #include "Core/VertexData.h"
 #include "Core/view.h"
 #include "Misc/Config.h"
+#include "Misc/Profiler.h"
 #include "Render/SceneProxy/StaticMeshSceneProxy.h"
 #include "Render/SceneProxy/TransformProxy.h"
 #include "Render/SceneProxy/CameraSceneProxy.h"
@@ -23,6 +24,7 @@ namespace MechEngine::Rendering
     {
         rtAccel = device.create_accel({});
         bindlessArray = device.create_bindless_array(bindless_array_capacity);
+        FrameFence = device.create_timeline_event();
         // !Proxies should be created in the derived class, case the proxies may be polymorphic for different renderers
     }
 
@@ -34,12 +36,79 @@ namespace MechEngine::Rendering
     	FrameCounter = 0;
 	}
 
+	bool GpuSceneInterface::DeferredDestroyHandle(uint64_t handle)
+	{
+		for (auto iter = Resources.begin(); iter != Resources.end(); ++iter)
+		{
+			if ((*iter)->handle() == handle)
+			{
+				// Commands recorded before the next signal may still use the resource
+				PendingReleases.push_back({std::move(*iter), FrameFenceValue + 1});
+				Resources.erase(iter);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void GpuSceneInterface::ReclaimResources()
+	{
+		if (PendingReleases.empty())
+			return;
+		// Fence values are signaled in order, the completed releases are at the front
+		auto iter = PendingReleases.begin();
+		while (iter != PendingReleases.end() && FrameFence.is_completed(iter->FenceValue))
+			++iter;
+		PendingReleases.erase(PendingReleases.begin(), iter);
+	}
+
+	void GpuSceneInterface::SignalFrameFence()
+	{
+		stream << FrameFence.signal(++FrameFenceValue);
+	}
+
+	void GpuSceneInterface::ProfileGpuSegment(CommandList& CmdList, const char* Name)
+	{
+#if ENABLE_PROFILER
+		if (!Profiler::Get().IsEnabled())
+			return;
+		const int64_t SubmitNs = Profiler::Now();
+		CmdList.add_callback([Name, SubmitNs]() { Profiler::Get().MarkGpu(Name, SubmitNs); });
+		stream << CmdList.commit();
+#endif
+	}
+
+	GpuSceneInterface::GpuMemoryStats GpuSceneInterface::GetGpuMemoryStats() const
+	{
+		GpuMemoryStats Stats;
+		auto AddProxy = [&](const char* Name, const SceneProxy* Proxy) {
+			if (!Proxy)
+				return;
+			const size_t Bytes = Proxy->GetGpuMemoryBytes();
+			Stats.ProxyBytes.emplace_back(Name, Bytes);
+			Stats.TotalBytes += Bytes;
+		};
+		AddProxy("StaticMesh", StaticMeshProxy.get());
+		AddProxy("Shape", ShapeProxy.get());
+		AddProxy("Transform", TransformProxy.get());
+		AddProxy("Light", LightProxy.get());
+		AddProxy("Camera", CameraProxy.get());
+		AddProxy("Material", MaterialProxy.get());
+		AddProxy("Line", LineProxy.get());
+		Stats.PendingReleaseNum = PendingReleases.size();
+		return Stats;
+	}
+
 	void GpuSceneInterface::LoadRenderSettings()
 	{
     	bShadowRayOffset = GConfig.Get<bool>("Render", "ShadowRayOffset");
     	SamplePerPixel = GConfig.Get<int>("Render", "SamplePerPixel");
 		bHDR = GConfig.Get<bool>("Render", "HDR");
 		bShaderDebugInfo = GConfig.Get<bool>("RenderDebug", "ShaderDebugInfo");
+		bParallelShaderCompile = GConfig.Get<bool>("RenderDebug", "ParallelShaderCompile");
 		bUseRasterizer = GConfig.Get<bool>("DeferredShading", "UseRasterizer");
+		bMeshLOD = bUseRasterizer && GConfig.Get<bool>("DeferredShading", "MeshLOD");
+		bPackedGBuffer = GConfig.Get<bool>("Render", "PackedGBuffer");
+		bFusedPostProcess = GConfig.Get<bool>("RenderDebug", "FusedPostProcess");
 	}
 }
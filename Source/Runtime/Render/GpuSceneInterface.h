@@ -6,6 +6,7 @@
 #include "Core/geometry_buffer.h"
 #include "Core/VertexData.h"
 #include "Core/ViewMode.h"
+#include "Core/ShaderCompiler.h"
 #include "Core/view.h"
 #include "luisa/luisa-compute.h"
 #include "Misc/Platform.h"
@@ -96,6 +97,44 @@ namespace MechEngine::Rendering
 		requires std::is_base_of_v<luisa::compute::Resource, T>
 		bool destroy(T* resource);
 
+		/**
+		 * Destroy a resource once the GPU has finished the frames submitted so far,
+		 * use this instead of destroy for resources that commands in flight may still read
+		 * @param resource Resource pointer to destroy
+		 * @return Whether the resource is owned by the scene
+		 */
+		template<typename T>
+		requires std::is_base_of_v<luisa::compute::Resource, T>
+		bool DeferredDestroy(T* resource) { return DeferredDestroyHandle(resource->handle()); }
+
+		/** Deferred destroy the buffer which the view is created from */
+		template<typename T>
+		bool DeferredDestroy(BufferView<T> view) { return DeferredDestroyHandle(view.handle()); }
+
+		/** Destroy the deferred resources whose frames are completed on the GPU, called before uploading a frame */
+		void ReclaimResources();
+
+		/** Signal the frame fence after the scene data of a frame is submitted */
+		void SignalFrameFence();
+
+		/** GPU memory held by the scene proxies */
+		struct GpuMemoryStats
+		{
+			// Proxy name and bytes of its buffers
+			TArray<std::pair<String, size_t>> ProxyBytes;
+			size_t TotalBytes = 0;
+			// Resources waiting for the GPU to finish before being destroyed
+			size_t PendingReleaseNum = 0;
+		};
+
+		[[nodiscard]] GpuMemoryStats GetGpuMemoryStats() const;
+
+		/**
+		 * Submit the recorded commands as a GPU profiler segment, the segment ends when the commands are completed.
+		 * Does nothing while the profiler is disabled, the commands are then submitted with the rest of the frame
+		 */
+		void ProfileGpuSegment(CommandList& CmdList, const char* Name);
+
 
 		/***********************************************************************************************
 		* 								  Bindless resource create								       *
@@ -127,11 +166,8 @@ namespace MechEngine::Rendering
 			return std::make_pair(view, buffer_id);
 		}
 
-		template<uint dim, typename Def>
-		auto RegisterShader(Def &&def, const luisa::string name = "") noexcept {
-			static_assert(dim == 1u || dim == 2u || dim == 3u);
-			return device.compile<dim>(std::forward<Def>(def), {.enable_debug_info = bShaderDebugInfo, .name = name});
-		}
+		/** Kernel compiler of the scene, kernels queued during CompileShader are compiled concurrently */
+		[[nodiscard]] FORCEINLINE ShaderCompiler& GetShaderCompiler() noexcept { return *Compiler; }
 
 		[[nodiscard]] virtual ImageView<float> frame_buffer() noexcept = 0;
 
@@ -207,15 +243,27 @@ namespace MechEngine::Rendering
 		/** Whether to use software rasterizer */
 		bool bUseRasterizer = false;
 
+		/** Whether to generate simplified meshes, only the rasterizer draws them */
+		bool bMeshLOD = false;
+
 		/** Whether to use HDR rendering */
 		bool bHDR;
 
+		/** Whether to use the packed G-Buffer layout */
+		bool bPackedGBuffer;
+
 		/** Whether to use shadow ray offset by HACKING THE SHADOW TERMINATOR*/
 		bool bShadowRayOffset;
 
 		/** Whether to compile shader with debug info */
 		bool bShaderDebugInfo;
 
+		/** Whether to compile kernels on worker threads */
+		bool bParallelShaderCompile;
+
+		/** Whether to run tone mapping and the editor overlays in one fused kernel */
+		bool bFusedPostProcess = true;
+
 		float3 BackgroundColor = float3(0.1f, 0.12f, 0.15f);
 
 		// Frame counter, start from 0, increase by 1 each frame, refresh when the scene is updated
@@ -238,8 +286,21 @@ namespace MechEngine::Rendering
 		size_t _bindless_tex3d_count{0u};
 		Stream& stream;
 		Device& device;
+		unique_ptr<ShaderCompiler> Compiler;
 
 		luisa::vector<luisa::unique_ptr<luisa::compute::Resource>> Resources;
+
+		struct PendingRelease
+		{
+			luisa::unique_ptr<luisa::compute::Resource> Resource;
+			// Frame fence value to wait before destroying
+			uint64_t FenceValue;
+		};
+		luisa::vector<PendingRelease> PendingReleases;
+		TimelineEvent FrameFence;
+		uint64_t FrameFenceValue = 0;
+
+		bool DeferredDestroyHandle(uint64_t handle);
 		static constexpr auto bindless_array_capacity = 500'000u;// limitation of Metal
 		static constexpr auto constant_buffer_size = 256u * 1024u;
 
@@ -39,20 +39,9 @@ void DeferredShadingScene::PrePass(CommandList& CmdList)
 
 	if(bUseRasterizer)
 	{
-		auto MeshSceneProxy = StaticMeshProxy.get();
-
 		Rasterizer->ClearPass(CmdList);
-
-		// Iterate all the mesh in the scene
-		for(auto [MeshId, Mesh] : MeshSceneProxy->MeshIdToPtr)
-		{
-			ASSERT(Mesh != nullptr);
-			for(auto instance_id : MeshSceneProxy->MeshInstances[MeshId])
-			{
-				Rasterizer->VisibilityPass(CmdList, instance_id, MeshId,
-					Mesh->GetVertexNum(), Mesh->GetFaceNum(), Mesh->IsBackFaceCulling());
-			}
-		}
+		Rasterizer->VisibilityPass(CmdList);
+		ProfileGpuSegment(CmdList, "Visibility");
 		stream << CmdList.commit();
 	}
 }
@@ -205,9 +194,9 @@ Float3 DeferredShadingScene::render_pixel(Var<Ray> ray, const UInt2& pixel_coord
 	if(bUseRasterizer)
 	{
 		auto instance_id = Rasterizer->vbuffer.instance_id->read(pixel_coord).x;
-		auto triangle_id = Rasterizer->vbuffer.triangle_id->read(pixel_coord).x;
+		auto triangle_id = Rasterizer->read_triangle_id(pixel_coord);
 		auto bary = Rasterizer->vbuffer.bary->read(pixel_coord).xy();
-		intersection = intersect({instance_id, triangle_id, bary}, ray);
+		intersection = intersect({instance_id, triangle_id.x, bary}, ray, triangle_id.y);
 	}
 	else
 	{
@@ -22,6 +22,8 @@
 #include "Render/PipeLine/ground_grid/ground_pass.h"
 #include "RenderPass/buffer_view_pass.h"
 #include "wireframe/wireframe_pass.h"
+#include "RenderPass/post_process_pass.h"
+#include "Misc/Profiler.h"
 namespace MechEngine::Rendering
 {
 
@@ -40,6 +42,23 @@ GpuScene::GpuScene(Stream& stream, Device& device, ImGuiWindow* InWindow, Viewpo
 
 GpuScene::~GpuScene() {}
 
+void GpuScene::CollectRenderData()
+{
+	PROFILE_SCOPE("GpuScene::CollectRenderData");
+	// Content changes invalidate the integrated frames, the camera proxy resets the counter on its own
+	// Lines are drawn over the frame and do not count
+	bRenderDataChanged |= ShapeProxy->IsDirty() || StaticMeshProxy->IsDirty() || MaterialProxy->IsDirty() || LightProxy->IsDirty() || TransformProxy->IsDirty();
+
+	// Meshes add their materials, collect them before the material proxy
+	ShapeProxy->CollectDirtyData();
+	StaticMeshProxy->CollectDirtyData();
+	CameraProxy->CollectDirtyData();
+	MaterialProxy->CollectDirtyData();
+	LightProxy->CollectDirtyData();
+	TransformProxy->CollectDirtyData();
+	LineProxy->CollectDirtyData();
+}
+
 void GpuScene::UploadRenderData()
 {
 	auto UpdateBindlessArrayIfDirty = [&]() {
@@ -49,45 +68,89 @@ void GpuScene::UploadRenderData()
 		}
 	};
 
-	// Make sure static mesh data is uploaded before transform data
-	// Because need to allocate instance id from accel
-	ShapeProxy->UploadDirtyData(stream);
-	UpdateBindlessArrayIfDirty();
-
-	StaticMeshProxy->UploadDirtyData(stream);
-	UpdateBindlessArrayIfDirty();
+	PROFILE_SCOPE("GpuScene::UploadRenderData");
+	ReclaimResources();
 
-	CameraProxy->UploadDirtyData(stream);
-	UpdateBindlessArrayIfDirty();
+	if (bRenderDataChanged)
+		ResetFrameCounter();
+	bRenderDataChanged = false;
 
-	MaterialProxy->UploadDirtyData(stream);
-	UpdateBindlessArrayIfDirty();
-
-	LightProxy->UploadDirtyData(stream);
-	UpdateBindlessArrayIfDirty();
-
-	// This may also update transform in accel
-	TransformProxy->UploadDirtyData(stream);
-	UpdateBindlessArrayIfDirty();
-
-	LineProxy->UploadDirtyData(stream);
-	UpdateBindlessArrayIfDirty();
+	// Make sure static mesh data is uploaded before transform data
+	// Because need to allocate instance id from accel
+	{
+		PROFILE_SCOPE("ShapeProxy::UploadDirtyData");
+		ShapeProxy->UploadDirtyData(stream);
+		UpdateBindlessArrayIfDirty();
+	}
+	{
+		PROFILE_SCOPE("StaticMeshProxy::UploadDirtyData");
+		StaticMeshProxy->UploadDirtyData(stream);
+		UpdateBindlessArrayIfDirty();
+	}
+	{
+		PROFILE_SCOPE("CameraProxy::UploadDirtyData");
+		CameraProxy->UploadDirtyData(stream);
+		UpdateBindlessArrayIfDirty();
+	}
+	{
+		PROFILE_SCOPE("MaterialProxy::UploadDirtyData");
+		MaterialProxy->UploadDirtyData(stream);
+		UpdateBindlessArrayIfDirty();
+	}
+	{
+		PROFILE_SCOPE("LightProxy::UploadDirtyData");
+		LightProxy->UploadDirtyData(stream);
+		UpdateBindlessArrayIfDirty();
+	}
+	{
+		// This may also update transform in accel
+		PROFILE_SCOPE("TransformProxy::UploadDirtyData");
+		TransformProxy->UploadDirtyData(stream);
+		UpdateBindlessArrayIfDirty();
+	}
+	{
+		PROFILE_SCOPE("LineProxy::UploadDirtyData");
+		LineProxy->UploadDirtyData(stream);
+		UpdateBindlessArrayIfDirty();
+	}
 
 	if (rtAccel.dirty())
+	{
+		PROFILE_SCOPE("BuildAccel");
+		PROFILE_COUNTER("TLASBuilds", 1);
 		stream << rtAccel.build() << synchronize();
+	}
+
+	// Resources released above are unbound from here on, frames after the fence no longer read them
+	SignalFrameFence();
 }
 
 void GpuScene::Render()
 {
+	PROFILE_SCOPE("GpuScene::Render");
 	CommandList CmdList{};
 	PrePass(CmdList);
+	ProfileGpuSegment(CmdList, "PrePass");
 	CmdList << (*MainShader)(FrameCounter++, TimeCounter++).dispatch(GetWindosSize());
+	ProfileGpuSegment(CmdList, "MainKernel");
 	PostPass(CmdList);
 	stream << CmdList.commit();
 }
 
 void GpuScene::PostPass(CommandList& CmdList)
 {
+	if (bFusedPostProcess)
+	{
+		// Lines are scattered, they can't be fused into the per pixel kernel
+		if (ViewMode == ViewMode::FrameBuffer) [[likely]]
+			LineProxy->PostRenderPass(CmdList);
+		PostProcessPass->PostPass(CmdList);
+		PROFILE_COUNTER("PostProcessDispatches", 1);
+		ProfileGpuSegment(CmdList, "PostProcess");
+		stream << CmdList.commit();
+		return;
+	}
+
 	if (ViewMode != ViewMode::FrameBuffer) [[unlikely]]
 		BufferViewPass->PostPass(CmdList);
 	else
@@ -96,9 +159,13 @@ void GpuScene::PostPass(CommandList& CmdList)
 		if (!bHDR)
 			CmdList << (*ToneMappingPass)().dispatch(GetWindosSize());
 	}
+	ProfileGpuSegment(CmdList, "PostProcess");
 	WireFramePass->PostPass(CmdList);
 	BufferViewPass->PostPass(CmdList);
 	GroundPass->PostPass(CmdList);
+	// Lines are not counted, same as the fused path
+	PROFILE_COUNTER("PostProcessDispatches", ViewMode == ViewMode::FrameBuffer && bHDR ? 3 : 4);
+	ProfileGpuSegment(CmdList, "EditorOverlays");
 	stream << CmdList.commit();
 }
 
@@ -130,13 +197,18 @@ ray_intersection GpuScene::intersect(Var<Ray> ray) const noexcept
 }
 
 ray_intersection GpuScene::intersect(Var<RayCastHit> hit, Var<Ray> ray) const noexcept
+{
+	return intersect(hit, ray, 0u);
+}
+
+ray_intersection GpuScene::intersect(Var<RayCastHit> hit, Var<Ray> ray, const UInt& lod) const noexcept
 {
 	ray_intersection it;
 	$if(!hit->miss())
 	{
 		it.instance_id = hit.instance_id;
 		it.shape = ShapeProxy->get_instance_shape(hit.instance_id);
-		auto mesh_id = it.shape->mesh_id;
+		auto mesh_id = StaticMeshProxy->get_lod_mesh_id(it.shape->mesh_id, lod);
 		auto TriangleId = hit.primitive_id;
 		auto object_transform = get_instance_transform(it.instance_id);
 		auto Tri = StaticMeshProxy->get_triangle(mesh_id, TriangleId);
@@ -243,31 +315,30 @@ void GpuScene::CompileShader()
 {
 	LineProxy->CompileShader();
 
-	BufferViewPass->CompileShader(device, bShaderDebugInfo);
+	if (!bFusedPostProcess)
+		BufferViewPass->CompileShader(*Compiler);
 
 	Rasterizer = make_unique<scanline_rasterizer>(this);
-	Rasterizer->CompileShader(device, bShaderDebugInfo);
+	Rasterizer->CompileShader(*Compiler);
 
 	// Main pass shader
-	MainShader = luisa::make_unique<Shader2D<uint, uint>>(device.compile<2>(
+	Compiler->Compile(MainShader,
 		[&](UInt frame_index, UInt time) noexcept {
 			render_main_view(frame_index, time);
-		}, ShaderOption{.enable_debug_info = bShaderDebugInfo, .name = "MainShader"}));
+		}, "MainShader");
 
-	ToneMappingPass = luisa::make_unique<Shader2D<>>(device.compile<2>(
-		[&]() noexcept {
-			auto pixel_coord = dispatch_id().xy();
-			auto color = frame_buffer()->read(pixel_coord);
-			if (bHDR)
-				frame_buffer()->write(pixel_coord, make_float4(acescg_to_srgb(color.xyz()), 1.f)); // Still need fix
-			else
-				frame_buffer()->write(pixel_coord, make_float4(linear_to_srgb(acescg_to_srgb(tone_mapping_aces(color.xyz()))), 1.f));
-		}, ShaderOption{.enable_debug_info = bShaderDebugInfo, .name = "ToneMappingShader"}));
+	if (!bFusedPostProcess)
+		Compiler->Compile(ToneMappingPass,
+			[&]() noexcept {
+				auto pixel_coord = dispatch_id().xy();
+				auto color = frame_buffer()->read(pixel_coord);
+				frame_buffer()->write(pixel_coord, make_float4(tone_mapping(color.xyz()), 1.f));
+			}, "ToneMappingShader");
 
 	// Ray cast query shader
 	RayCastQueryBuffer = RegisterBuffer<uint2>(MaxQueryCount);
 	RayCastHitBuffer = RegisterBuffer<RayCastHit>(MaxQueryCount);
-	RayCastQueryShader = luisa::make_unique<decltype(RayCastQueryShader)::element_type>(device.compile<1>(
+	Compiler->Compile(RayCastQueryShader,
 		[&]() noexcept {
 			auto view = CameraProxy->get_main_view();
 			auto query_id = dispatch_id().x;
@@ -276,13 +347,27 @@ void GpuScene::CompileShader()
 			auto ray = view->generate_ray(pixel_pos);
 			auto hit = trace_closest(ray);
 			RayCastHitBuffer->write(query_id, hit);
-		}, ShaderOption{.enable_debug_info = bShaderDebugInfo, .name = "RayCastQueryShader"}));
+		}, "RayCastQueryShader");
 
 	GroundPass = make_unique<ground_pass>(this, GetWindosSize(), frame_buffer());
-	GroundPass->CompileShader(device, bShaderDebugInfo);
-
 	WireFramePass = make_unique<wireframe_pass>(*this);
-	WireFramePass->CompileShader(device, bShaderDebugInfo);
+	if (bFusedPostProcess)
+	{
+		PostProcessPass = make_unique<post_process_pass>(*this, *BufferViewPass, *WireFramePass, *GroundPass);
+		PostProcessPass->CompileShader(*Compiler);
+	}
+	else
+	{
+		GroundPass->CompileShader(*Compiler);
+		WireFramePass->CompileShader(*Compiler);
+	}
+}
+
+Float3 GpuScene::tone_mapping(const Float3& color) const noexcept
+{
+	if (bHDR)
+		return acescg_to_srgb(color); // Still need fix
+	return linear_to_srgb(acescg_to_srgb(tone_mapping_aces(color)));
 }
 
 void GpuScene::Init()
@@ -295,7 +380,9 @@ void GpuScene::Init()
 	InitPass(CmdList);
 	stream << CmdList.commit() << synchronize();
 
+	Compiler = make_unique<ShaderCompiler>(device, bShaderDebugInfo, bParallelShaderCompile);
 	CompileShader();
+	Compiler->Wait();
 }
 
 
@@ -306,7 +393,7 @@ void GpuScene::InitPass(CommandList& CmdList)
 	stream << synchronize();
 
 	// Compile base shaders
-	g_buffer.InitBuffer(device, GetWindosSize());
+	g_buffer.InitBuffer(device, GetWindosSize(), bPackedGBuffer);
 
 	BufferViewPass = make_unique<buffer_view_pass>(*this);
 	BufferViewPass->InitPass(device, CmdList);
@@ -13,6 +13,7 @@ class buffer_view_pass;
 namespace MechEngine::Rendering
 {
 class wireframe_pass;
+class post_process_pass;
 }
 class ViewportInterface;
 class CameraComponent;
@@ -56,7 +57,13 @@ public:
 	 * Compile shader
 	 */
 	void Init() override;
-	
+
+	/**
+	 * Copy the render data changed by the world into the scene proxies, called under the world lock.
+	 * UploadRenderData and Render only read the collected data, so the world can tick while they run
+	 */
+	void CollectRenderData();
+
 	void UploadRenderData();
 
 	virtual void PrePass(CommandList& CmdList) {};
@@ -105,6 +112,9 @@ public:
 	ray_intersection intersect(Var<Ray> ray) const noexcept;
 	ray_intersection intersect(Var<RayCastHit> hit, Var<Ray> ray) const noexcept;
 
+	/** Intersection on a simplified mesh of the instance, the primitive id is a triangle of that LOD */
+	ray_intersection intersect(Var<RayCastHit> hit, Var<Ray> ray, const UInt& lod) const noexcept;
+
 	/**
 	 * Cast a ray in the scene and return the instance id of the hit object and return the hit to the CPU
 	 * @return RayCastHit in CPU
@@ -165,6 +175,15 @@ public:
 		return (color * (a * color + b)) / (color * (c * color + d) + e);
 	}
 
+	/** Map the linear ACEScg frame color to the display, tone mapped and gamma corrected for LDR */
+	[[nodiscard]] Float3 tone_mapping(const Float3& color) const noexcept;
+
+	[[nodiscard]] FORCEINLINE bool IsHDR() const noexcept { return bHDR; }
+
+	[[nodiscard]] FORCEINLINE bool UseMeshLOD() const noexcept { return bMeshLOD; }
+
+	[[nodiscard]] FORCEINLINE bool UseRasterizer() const noexcept { return bUseRasterizer; }
+
 protected:
 
 	/**
@@ -186,9 +205,13 @@ protected:
 	unique_ptr<ground_pass> GroundPass;
 	unique_ptr<wireframe_pass>  WireFramePass;
 	unique_ptr<buffer_view_pass> BufferViewPass;
+	unique_ptr<post_process_pass> PostProcessPass;
 
 	luisa::compute::ImGuiWindow* Window;
 	ViewportInterface* Viewport;
 
+	// Whether the collected data changes the scene content, the integrated frames are then restarted
+	bool bRenderDataChanged = false;
+
 };
 }
@@ -4,9 +4,12 @@
 
 #include "PathTracingScene.h"
 
+#include <chrono>
 #include "Mesh/StaticMesh.h"
 #include "Misc/Config.h"
+#include "Misc/Profiler.h"
 #include "Render/Core/frame.h"
+#include "Render/Core/math_function.h"
 #include "Render/Core/shadow_terminator.h"
 #include "Render/SceneProxy/CameraSceneProxy.h"
 #include "Render/SceneProxy/LightSceneProxy.h"
@@ -27,6 +30,11 @@ void PathTracingScene::LoadRenderSettings()
 {
 	GpuScene::LoadRenderSettings();
 	bUseDenoiser = GConfig.Get<bool>("PathTracing", "Denoiser");
+	bProgressiveAccumulation = GConfig.Get<bool>("PathTracing", "ProgressiveAccumulation");
+	AccumulationTargetSamples = GConfig.Get<int>("PathTracing", "AccumulationTargetSamples");
+	AccumulationVarianceThreshold = GConfig.Get<float>("PathTracing", "AccumulationVarianceThreshold");
+	AccumulationSlices = std::max(GConfig.Get<int>("PathTracing", "AccumulationSlices"), 1);
+	bWavefrontPathTracing = GConfig.Get<bool>("PathTracing", "WavefrontPathTracing");
 }
 void PathTracingScene::InitPass(CommandList& CmdList)
 {
@@ -36,6 +44,13 @@ void PathTracingScene::InitPass(CommandList& CmdList)
 		denoiser_ext = std::make_unique<denoiser>(this);
 		denoiser_ext->InitPass(device, CmdList);
 	}
+	if (bProgressiveAccumulation)
+	{
+		const uint2 Size = GetWindosSize();
+		accumulation = RegisterBuffer<float4>(Size.x * Size.y);
+		accumulation_luminance_sq = RegisterBuffer<float>(Size.x * Size.y);
+		active_pixels = RegisterBuffer<uint>(1u);
+	}
 }
 
 void PathTracingScene::CompileShader()
@@ -43,7 +58,42 @@ void PathTracingScene::CompileShader()
 	GpuScene::CompileShader();
 
 	if (denoiser_ext)
-		denoiser_ext->CompileShader(device, bShaderDebugInfo);
+		denoiser_ext->CompileShader(*Compiler);
+
+	if (bWavefrontPathTracing)
+	{
+		WavefrontPathTracer = make_unique<wavefront_path_tracer>(this);
+		WavefrontPathTracer->LoadRenderSettings();
+		WavefrontPathTracer->CompileShader(*Compiler);
+	}
+
+	if (bProgressiveAccumulation)
+	{
+		Compiler->Compile(AccumulateShader,
+			[&](UInt time, UInt row_offset, UInt target_samples, Float variance_threshold) noexcept {
+				accumulate_main_view(time, row_offset, target_samples, variance_threshold);
+			}, "AccumulateShader");
+
+		Compiler->Compile(ResolveAccumulationShader,
+			[&]() noexcept {
+				auto pixel_coord = dispatch_id().xy();
+				auto sum = accumulation->read(pixel_coord.x + pixel_coord.y * GetWindosSize().x);
+				frame_buffer()->write(pixel_coord, make_float4(sum.xyz() / max(sum.w, 1.f), 1.f));
+			}, "ResolveAccumulationShader");
+
+		Compiler->Compile(ClearAccumulationShader,
+			[&]() noexcept {
+				auto pixel_coord = dispatch_id().xy();
+				auto index = pixel_coord.x + pixel_coord.y * GetWindosSize().x;
+				accumulation->write(index, make_float4(0.f));
+				accumulation_luminance_sq->write(index, 0.f);
+			}, "ClearAccumulationShader");
+
+		Compiler->Compile(ResetActivePixelsShader,
+			[&]() noexcept {
+				active_pixels->write(0u, 0u);
+			}, "ResetActivePixelsShader");
+	}
 }
 
 void PathTracingScene::PrePass(CommandList& CmdList)
@@ -51,31 +101,49 @@ void PathTracingScene::PrePass(CommandList& CmdList)
 	GpuScene::PrePass(CmdList);
 	if (bUseRasterizer)
 	{
-		auto MeshSceneProxy = StaticMeshProxy.get();
-
 		Rasterizer->ClearPass(CmdList);
-
-		// Iterate all the mesh in the scene
-		for (auto [MeshId, Mesh] : MeshSceneProxy->MeshIdToPtr)
-		{
-			ASSERT(Mesh != nullptr);
-			for (auto instance_id : MeshSceneProxy->MeshInstances[MeshId])
-			{
-				Rasterizer->VisibilityPass(CmdList, instance_id, MeshId,
-					Mesh->GetVertexNum(), Mesh->GetFaceNum(), Mesh->IsBackFaceCulling());
-			}
-		}
+		Rasterizer->VisibilityPass(CmdList);
 	}
 }
 void PathTracingScene::Render()
 {
+	PROFILE_SCOPE("PathTracingScene::Render");
+	if (bWavefrontThroughputReport)
+	{
+		bWavefrontThroughputReport = false;
+		WavefrontThroughputReport(16);
+	}
 	CommandList CmdList{};
+	// The frame counter is reset by any change of the camera or scene, such frames are traced interactively
+	if (bProgressiveAccumulation)
+	{
+		if (FrameCounter == 0)
+			ResetAccumulation(CmdList);
+		else if (ViewMode == ViewMode::FrameBuffer)
+		{
+			FrameCounter++;
+			RenderAccumulation(CmdList);
+			PostPass(CmdList);
+			stream << CmdList.commit();
+			return;
+		}
+	}
+
 	PrePass(CmdList);
-	CmdList << (*MainShader)(FrameCounter++, TimeCounter++).dispatch(GetWindosSize());
+	ProfileGpuSegment(CmdList, "PrePass");
+	if (bWavefrontPathTracing)
+	{
+		FrameCounter++;
+		WavefrontPathTracer->TracePass(CmdList, TimeCounter++);
+	}
+	else
+		CmdList << (*MainShader)(FrameCounter++, TimeCounter++).dispatch(GetWindosSize());
+	ProfileGpuSegment(CmdList, "MainKernel");
 
 	if(denoiser_ext)
 	{
 		denoiser_ext->PostPass(CmdList);
+		ProfileGpuSegment(CmdList, "Denoiser");
 		stream << CmdList.commit();
 	}
 
@@ -83,6 +151,133 @@ void PathTracingScene::Render()
 	stream << CmdList.commit();
 }
 
+void PathTracingScene::WavefrontThroughputReport(uint Iterations)
+{
+	if (!WavefrontPathTracer)
+	{
+		WavefrontPathTracer = make_unique<wavefront_path_tracer>(this);
+		WavefrontPathTracer->LoadRenderSettings();
+		WavefrontPathTracer->CompileShader(*Compiler);
+		Compiler->Wait();
+	}
+	auto TimeFrames = [&](auto&& Trace) {
+		stream << synchronize();
+		const auto Start = std::chrono::steady_clock::now();
+		for (uint i = 0; i < Iterations; i++)
+		{
+			CommandList CmdList{};
+			PrePass(CmdList);
+			Trace(CmdList);
+			stream << CmdList.commit();
+		}
+		stream << synchronize();
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - Start).count() / Iterations;
+	};
+	const double MegakernelTime = TimeFrames([&](CommandList& CmdList) {
+		CmdList << (*MainShader)(FrameCounter, TimeCounter++).dispatch(GetWindosSize());
+	});
+	const double WavefrontTime = TimeFrames([&](CommandList& CmdList) {
+		WavefrontPathTracer->TracePass(CmdList, TimeCounter++);
+	});
+
+	const uint2 Size = GetWindosSize();
+	const double PathNum = static_cast<double>(Size.x) * Size.y * SamplePerPixel;
+	LOG_INFO("Path tracing throughput, {}x{} at {} spp, {} frames each", Size.x, Size.y, SamplePerPixel, Iterations);
+	LOG_INFO("    megakernel: {:>7.2f} ms, {:>7.1f} M paths/s, 2 bounces", MegakernelTime, PathNum / (MegakernelTime * 1e3));
+	LOG_INFO("    wavefront:  {:>7.2f} ms, {:>7.1f} M paths/s, {} bounces", WavefrontTime, PathNum / (WavefrontTime * 1e3),
+		WavefrontPathTracer->GetMaxDepth());
+}
+
+bool PathTracingScene::IsAccumulationFinished() const noexcept
+{
+	return GetAccumulatedSamples() >= AccumulationTargetSamples || LastActivePixels == 0;
+}
+
+void PathTracingScene::ResetAccumulation(CommandList& CmdList)
+{
+	AccumulatedPasses = 0;
+	AccumulationSlice = 0;
+	// Readbacks of the previous accumulation still in flight are dropped
+	AccumulationGeneration++;
+	LastActivePixels = ~0u;
+	CmdList << (*ClearAccumulationShader)().dispatch(GetWindosSize());
+}
+
+void PathTracingScene::RenderAccumulation(CommandList& CmdList)
+{
+	if (!IsAccumulationFinished())
+	{
+		PrePass(CmdList);
+		// The first pass covers the whole frame, so there is always something to show
+		const uint Slices = AccumulatedPasses == 0 ? 1u : AccumulationSlices;
+		const uint2 Size = GetWindosSize();
+		const uint BandHeight = (Size.y + Slices - 1) / Slices;
+		if (AccumulationSlice == 0)
+			CmdList << (*ResetActivePixelsShader)().dispatch(1u);
+		CmdList << (*AccumulateShader)(TimeCounter++, AccumulationSlice * BandHeight, AccumulationTargetSamples, AccumulationVarianceThreshold)
+					   .dispatch(Size.x, BandHeight);
+		if (++AccumulationSlice >= Slices)
+		{
+			AccumulationSlice = 0;
+			AccumulatedPasses++;
+			CmdList << active_pixels.copy_to(&ActivePixelReadback);
+			CmdList.add_callback([this, Generation = AccumulationGeneration.load()]() {
+				if (Generation == AccumulationGeneration)
+					LastActivePixels = ActivePixelReadback;
+			});
+		}
+		ProfileGpuSegment(CmdList, "Accumulate");
+	}
+	CmdList << (*ResolveAccumulationShader)().dispatch(GetWindosSize());
+	if (denoiser_ext)
+	{
+		denoiser_ext->PostPass(CmdList);
+		stream << CmdList.commit();
+	}
+}
+
+Bool PathTracingScene::accumulation_converged(const Float4& sum, const Float& luminance_sq, const Float& variance_threshold) const
+{
+	auto n = max(sum.w, 1.f);
+	auto mean = luminance(sum.xyz()) / n;
+	auto variance = max(luminance_sq / n - mean * mean, 0.f);
+	// Standard error of the mean relative to the mean, dark pixels are compared against a small floor
+	return variance_threshold > 0.f & sum.w >= static_cast<float>(AccumulationMinSamples)
+		& sqrt(variance / n) <= variance_threshold * max(mean, 1e-3f);
+}
+
+void PathTracingScene::accumulate_main_view(const UInt& time, const UInt& row_offset, const UInt& target_samples, const Float& variance_threshold)
+{
+	auto pixel_coord = dispatch_id().xy() + make_uint2(0u, row_offset);
+	auto size = GetWindosSize();
+	$if(pixel_coord.y < size.y)
+	{
+		auto index = pixel_coord.x + pixel_coord.y * size.x;
+		auto sum = accumulation->read(index);
+		auto luminance_sq = accumulation_luminance_sq->read(index);
+		$if(sum.w < cast<float>(target_samples) & !accumulation_converged(sum, luminance_sq, variance_threshold))
+		{
+			auto view = CameraProxy->get_main_view();
+			get_sampler()->init(pixel_coord, time);
+			$for(Sample, 0u, def(SamplePerPixel))
+			{
+				// Jitter inside the pixel for anti-aliasing, the rasterized first hit is only valid at the pixel center
+				auto pixel_pos = make_float2(pixel_coord) + (bUseRasterizer ? make_float2(0.5f) : get_sampler()->generate_2d());
+				auto color = mis_path_tracing(view->generate_ray(pixel_pos), pixel_pos, pixel_coord, 1.f, false);
+				auto color_luminance = luminance(color);
+				sum += make_float4(color, 1.f);
+				luminance_sq += color_luminance * color_luminance;
+			};
+			accumulation->write(index, sum);
+			accumulation_luminance_sq->write(index, luminance_sq);
+			$if(sum.w < cast<float>(target_samples) & !accumulation_converged(sum, luminance_sq, variance_threshold))
+			{
+				active_pixels->atomic(0u).fetch_add(1u);
+			};
+		};
+	};
+}
+
 void PathTracingScene::render_main_view(const UInt& frame_index, const UInt& time)
 {
 	auto view = CameraProxy->get_main_view();
@@ -110,9 +305,9 @@ ray_intersection PathTracingScene::intersect_bias(const UInt2& pixel_coord, Expr
 		$if(first_intersect)
 		{
 			auto instance_id = Rasterizer->vbuffer.instance_id->read(pixel_coord).x;
-			auto triangle_id = Rasterizer->vbuffer.triangle_id->read(pixel_coord).x;
+			auto triangle_id = Rasterizer->read_triangle_id(pixel_coord);
 			auto bary = Rasterizer->vbuffer.bary->read(pixel_coord).xy();
-			intersection = intersect({instance_id, triangle_id, bary}, ray);
+			intersection = intersect({instance_id, triangle_id.x, bary}, ray, triangle_id.y);
 
 			// Restore the world position from depth buffer
 			auto depth = g_buffer.read_depth(pixel_coord);
@@ -133,7 +328,7 @@ ray_intersection PathTracingScene::intersect_bias(const UInt2& pixel_coord, Expr
 	return intersection;
 }
 
-Float3 PathTracingScene::mis_path_tracing(Var<Ray> ray, const Float2& pixel_pos, const UInt2& pixel_coord, const Float& weight)
+Float3 PathTracingScene::mis_path_tracing(Var<Ray> ray, const Float2& pixel_pos, const UInt2& pixel_coord, const Float& weight, bool b_temporal_filter)
 {
 	ray_intersection first_intersection;
 	Float3			 pixel_radiance = make_float3(0.f);
@@ -215,17 +410,23 @@ Float3 PathTracingScene::mis_path_tracing(Var<Ray> ray, const Float2& pixel_pos,
 		};
 	};
 
+	return resolve_path(pixel_coord, first_intersection, pixel_radiance, b_temporal_filter);
+}
+
+Float3 PathTracingScene::resolve_path(const UInt2& pixel_coord, const ray_intersection& first_intersection, const Float3& pixel_radiance, bool b_temporal_filter)
+{
+	auto color = def(pixel_radiance);
 	$if(first_intersection.valid())
 	{
 		// Write g_buffer after temporal denoising, as the g_buffer is used for temporal reprojection
-		if (denoiser_ext)
-			pixel_radiance = denoiser_ext->temporal_filter(pixel_coord, first_intersection, pixel_radiance, g_buffer);
-		g_buffer.write(pixel_coord, pixel_radiance, first_intersection);
+		if (denoiser_ext && b_temporal_filter)
+			color = denoiser_ext->temporal_filter(pixel_coord, first_intersection, color, g_buffer);
+		g_buffer.write(pixel_coord, color, first_intersection);
 	}$else{
 		g_buffer.set_default(pixel_coord);
-		pixel_radiance = BackgroundColor;
+		color = BackgroundColor;
 	};
-	return pixel_radiance;
+	return color;
 }
 
 
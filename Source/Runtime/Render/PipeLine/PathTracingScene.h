@@ -3,10 +3,12 @@
 //
 
 #pragma once
+#include <atomic>
 #include "GpuScene.h"
 #include "ris_reservoir.h"
 #include "denoiser/svgf.h"
 #include "denoiser/denoiser.h"
+#include "wavefront/wavefront_path_tracer.h"
 
 namespace MechEngine::Rendering
 {
@@ -29,15 +31,43 @@ public:
 
 	virtual void render_main_view(const UInt& frame_index, const UInt& time) override;
 
+	/**
+	 * Trace one accumulation pass of a band of rows and add the samples to the accumulation buffer
+	 * @param time the sampler seed of the pass
+	 * @param row_offset the first row of the band
+	 * @param target_samples pixels with this many samples are skipped
+	 * @param variance_threshold pixels whose relative standard error is below this are skipped
+	 */
+	void accumulate_main_view(const UInt& time, const UInt& row_offset, const UInt& target_samples, const Float& variance_threshold);
+
+	/** Number of samples per pixel accumulated since the last scene change, on the CPU side */
+	[[nodiscard]] FORCEINLINE uint GetAccumulatedSamples() const noexcept { return AccumulatedPasses * SamplePerPixel; }
+
+	/** Whether the accumulation has reached the target sample count or every pixel has converged */
+	[[nodiscard]] bool IsAccumulationFinished() const noexcept;
+
+	/** Log the throughput of the megakernel and the wavefront path tracer before the next frame, called from the render thread */
+	FORCEINLINE void RequestWavefrontThroughputReport() noexcept { bWavefrontThroughputReport = true; }
+
 	ray_intersection intersect_bias(const UInt2& pixel_coord, Expr<Ray> ray, Bool first_intersect);
 	/**
 	 * multi important sampling path tracing
 	 * @param ray the ray to calculate
 	 * @param pixel_pos the position of the pixel
 	 * @param weight the weight of the pixel
+	 * @param b_temporal_filter whether to blend with the denoiser history, off when accumulating
 	 * @return pixel color
 	 */
-	Float3 mis_path_tracing(Var<Ray> ray, const Float2& pixel_pos, const UInt2& pixel_coord, const Float& weight = 1.f);
+	Float3 mis_path_tracing(Var<Ray> ray, const Float2& pixel_pos, const UInt2& pixel_coord, const Float& weight = 1.f, bool b_temporal_filter = true);
+
+	/**
+	 * Finish the path of a pixel, write the G-Buffer of the first hit
+	 * @param first_intersection the first hit of the path, invalid for a miss
+	 * @param pixel_radiance the radiance gathered along the path
+	 * @param b_temporal_filter whether to blend with the denoiser history
+	 * @return pixel color, the background for a miss
+	 */
+	Float3 resolve_path(const UInt2& pixel_coord, const ray_intersection& first_intersection, const Float3& pixel_radiance, bool b_temporal_filter);
 
 	/**
 	 * resampling important sampling path tracing
@@ -60,8 +90,52 @@ public:
 	}
 
 protected:
+	/** Start accumulating from the next frame, called whenever the frame counter was reset */
+	void ResetAccumulation(CommandList& CmdList);
+
+	/** Trace the next accumulation band if unfinished, and write the accumulated mean to the frame buffer */
+	void RenderAccumulation(CommandList& CmdList);
+
+	/** Whether a pixel has enough samples for the variance threshold */
+	Bool accumulation_converged(const Float4& sum, const Float& luminance_sq, const Float& variance_threshold) const;
+
+	/** Time the megakernel and the wavefront path tracer over the same frames and log their throughput, compiles the wavefront tracer if unused */
+	void WavefrontThroughputReport(uint Iterations);
+
 	bool bUseDenoiser = true;
 
+	// Split the megakernel into queued stages for the interactive frames
+	bool bWavefrontPathTracing = false;
+	bool bWavefrontThroughputReport = false;
+	unique_ptr<wavefront_path_tracer> WavefrontPathTracer;
+
+	// ---------------------Progressive accumulation-------------------------------
+	bool bProgressiveAccumulation = true;
+	uint AccumulationTargetSamples = 4096;
+	float AccumulationVarianceThreshold = 0.01f;
+	uint AccumulationSlices = 1;
+
+	// Fewer samples give an unreliable variance estimate
+	static constexpr uint AccumulationMinSamples = 16;
+
+	// Sum of radiance in xyz and sample count in w
+	BufferView<float4> accumulation;
+	BufferView<float> accumulation_luminance_sq;
+	// Pixels still unconverged in the current pass
+	BufferView<uint> active_pixels;
+
+	uint AccumulatedPasses = 0;
+	uint AccumulationSlice = 0;
+	// Readback target of active_pixels, published by a command list callback of the same generation
+	uint ActivePixelReadback = 0;
+	std::atomic<uint> LastActivePixels = ~0u;
+	std::atomic<uint> AccumulationGeneration = 0;
+
+	unique_ptr<Shader2D<uint, uint, uint, float>> AccumulateShader;
+	unique_ptr<Shader2D<>> ResolveAccumulationShader;
+	unique_ptr<Shader2D<>> ClearAccumulationShader;
+	unique_ptr<Shader1D<>> ResetActivePixelsShader;
+
 	BufferView<ris_reservoir> reservoirs;
 
 	std::unique_ptr<denoiser> denoiser_ext;
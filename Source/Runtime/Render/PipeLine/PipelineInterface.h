@@ -3,6 +3,7 @@
 //
 
 #pragma once
+#include <mutex>
 #include "../ViewportInterface.h"
 #include "../../Core/Misc/Platform.h"
 #include "../../Core/PointerTypes.h"
@@ -41,12 +42,30 @@ public:
 
 	FORCEINLINE virtual void RenderFrame()
 	{
+		BeginFrame();
+		PreRender();
+		Render();
+		PostRender();
+	}
+
+	/**
+	 * Render a frame of a world ticked on another thread
+	 * @param WorldLock Lock of the world, released once the frame has collected the render data it needs from the world
+	 */
+	FORCEINLINE virtual void RenderFrame(std::unique_lock<std::mutex>& WorldLock)
+	{
+		BeginFrame();
+		WorldLock.unlock();
 		PreRender();
 		Render();
 		PostRender();
 	}
 
 protected:
+	/** Everything of a frame that reads or edits the world: widgets, input and collecting the render data */
+	virtual void BeginFrame() = 0;
+
+	/** Upload the collected render data, must not read the world */
 	virtual void PreRender() = 0;
 
 	virtual void Render() = 0;
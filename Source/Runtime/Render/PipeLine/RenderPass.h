@@ -4,6 +4,7 @@
 
 #pragma once
 #include <luisa/luisa-compute.h>
+#include "Render/Core/ShaderCompiler.h"
 
 /**
  * Interface for a render pass
@@ -18,8 +19,9 @@ public:
 	virtual void LoadRenderSettings() {}
 	/**
 	 * Compile the shader for this pass and initialize the buffers.
+	 * Kernels are queued to the compiler and valid once the scene finishes compiling.
 	 */
-	virtual void CompileShader(luisa::compute::Device& Device, bool bDebugInfo) = 0;
+	virtual void CompileShader(MechEngine::Rendering::ShaderCompiler& Compiler) = 0;
 
 	/**
 	 * This will be called once when the scene is initialized
@@ -20,36 +20,44 @@ Float3 id_to_color(UInt id)
 	return {r, g, b};
 }
 
-void buffer_view_pass::CompileShader(Device& Device, bool bDebugInfo)
+Float4 buffer_view_pass::buffer_color(const UInt& view_mode, const UInt2& pixel_coord) const
 {
-	BufferViewShader = make_unique<Shader2D<uint>>(Device.compile<2>([&](UInt ViewMode) {
-		auto pixel_coord = dispatch_id().xy();
-		$switch(ViewMode)
+	auto color = def(make_float4(0.f));
+	$switch(view_mode)
+	{
+		$case(static_cast<uint>(ViewMode::DepthBuffer))
+		{
+			color = make_float4(Scene.get_gbuffer().read_depth(pixel_coord));
+		};
+		$case(static_cast<uint>(ViewMode::NormalWorldBuffer))
+		{
+			auto normal = Scene.get_gbuffer().read_normal(pixel_coord);
+			// Map from [-1, 1] to [0, 1]
+			normal = normal * 0.5f + 0.5f;
+			color = make_float4(normal, 1.f);
+		};
+		$case(static_cast<uint>(ViewMode::BaseColorBuffer))
+		{
+			color = make_float4(Scene.get_gbuffer().read_albedo(pixel_coord), 1.f);
+		};
+		$case(static_cast<uint>(ViewMode::InstanceIDBuffer))
 		{
-			$case(static_cast<uint>(ViewMode::DepthBuffer))
-			{
-				Scene.frame_buffer()->write(pixel_coord, make_float4(Scene.get_gbuffer().read_depth(pixel_coord)));
-			};
-			$case(static_cast<uint>(ViewMode::NormalWorldBuffer))
-			{
-				auto normal = Scene.get_gbuffer().normal->read(pixel_coord);
-				// Map from [-1, 1] to [0, 1]
-				normal = normal * 0.5f + 0.5f;
-				Scene.frame_buffer()->write(pixel_coord, normal);
-			};
-			$case(static_cast<uint>(ViewMode::BaseColorBuffer))
-			{
-				Scene.frame_buffer()->write(pixel_coord, Scene.get_gbuffer().albedo->read(pixel_coord));
-			};
-			$case(static_cast<uint>(ViewMode::InstanceIDBuffer))
-			{
-				auto instance_id = Scene.get_gbuffer().instance_id->read(pixel_coord).x;
-				auto color = ite(instance_id == ~0u, make_float3(0.f, 0.f, 0.f), id_to_color(instance_id));
-				Scene.frame_buffer()->write(pixel_coord, make_float4(color, 1.f));
-			};
+			auto instance_id = Scene.get_gbuffer().read_instance_id(pixel_coord);
+			color = make_float4(ite(instance_id == ~0u, make_float3(0.f, 0.f, 0.f), id_to_color(instance_id)), 1.f);
+		};
+	};
+	return color;
+}
 
+void buffer_view_pass::CompileShader(ShaderCompiler& Compiler)
+{
+	Compiler.Compile(BufferViewShader, [&](UInt ViewMode) {
+		auto pixel_coord = dispatch_id().xy();
+		$if(ViewMode != static_cast<uint>(ViewMode::FrameBuffer))
+		{
+			Scene.frame_buffer()->write(pixel_coord, buffer_color(ViewMode, pixel_coord));
 		};
-	}, {.enable_debug_info = bDebugInfo, .name = "BufferViewShader"}));
+	}, "BufferViewShader");
 }
 
 void buffer_view_pass::PostPass(CommandList& command_list) const
@@ -18,10 +18,17 @@ class buffer_view_pass : public RenderPass
 public:
 	buffer_view_pass(GpuScene& InScene);
 
-	virtual void CompileShader(Device& Device, bool bDebugInfo) override;
+	virtual void CompileShader(ShaderCompiler& Compiler) override;
 	virtual void PostPass(CommandList& command_list) const override;
 	virtual void InitPass(luisa::compute::Device& Device, luisa::compute::CommandList& command_list) override;
 
+	/**
+	 * Color of a G-Buffer in the given view mode
+	 * @param view_mode ViewMode other than FrameBuffer
+	 * @param pixel_coord the coordination of the pixel
+	 */
+	[[nodiscard]] Float4 buffer_color(const UInt& view_mode, const UInt2& pixel_coord) const;
+
 protected:
 	GpuScene& Scene;
 	unique_ptr<Shader2D<uint>> BufferViewShader;
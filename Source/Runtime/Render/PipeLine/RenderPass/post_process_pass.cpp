@@ -0,0 +1,60 @@
+#include "post_process_pass.h"
+#include "buffer_view_pass.h"
+#include "Render/PipeLine/GpuScene.h"
+#include "Render/PipeLine/ground_grid/ground_pass.h"
+#include "Render/PipeLine/wireframe/wireframe_pass.h"
+#include "Render/SceneProxy/MaterialSceneProxy.h"
+
+namespace MechEngine::Rendering
+{
+post_process_pass::post_process_pass(GpuScene& InScene, const buffer_view_pass& InBufferView, const wireframe_pass& InWireframe, const ground_pass& InGround)
+: Scene(InScene), BufferView(InBufferView), Wireframe(InWireframe), Ground(InGround) {}
+
+void post_process_pass::CompileShader(ShaderCompiler& Compiler)
+{
+	// HDR is fixed after startup, the other stages depend on the view mode and materials
+	const uint base = Scene.IsHDR() ? ground : ground | tone_mapping;
+	compile_stages(Compiler, base);
+	compile_stages(Compiler, base | wireframe);
+	compile_stages(Compiler, buffer_view | ground);
+}
+
+void post_process_pass::compile_stages(ShaderCompiler& Compiler, uint stages)
+{
+	Compiler.Compile(PostProcessShaders[stages], [this, stages](UInt view_mode) noexcept {
+		auto pixel_coord = dispatch_id().xy();
+		Float3 color;
+		if (stages & buffer_view)
+			color = BufferView.buffer_color(view_mode, pixel_coord).xyz();
+		else
+			color = Scene.frame_buffer()->read(pixel_coord).xyz();
+		if (stages & tone_mapping)
+			color = Scene.tone_mapping(color);
+		if (stages & wireframe)
+			color = Wireframe.blend(pixel_coord, color);
+		if (stages & ground)
+			color = Ground.grid(pixel_coord, color);
+		Scene.frame_buffer()->write(pixel_coord, make_float4(color, 1.f));
+	}, luisa::format("PostProcessShader_{}", stages));
+}
+
+uint post_process_pass::active_stages() const
+{
+	if (Scene.GetViewMode() != ViewMode::FrameBuffer)
+		return buffer_view | ground;
+	uint stages = ground;
+	if (!Scene.IsHDR())
+		stages |= tone_mapping;
+	if (Scene.GetMaterialProxy()->HasWireframeMaterial())
+		stages |= wireframe;
+	return stages;
+}
+
+void post_process_pass::PostPass(CommandList& command_list) const
+{
+	auto stages = active_stages();
+	ASSERTMSG(PostProcessShaders[stages] != nullptr, "Post process stages {} not compiled", stages);
+	command_list << (*PostProcessShaders[stages])
+		(static_cast<uint>(Scene.GetViewMode())).dispatch(Scene.GetWindosSize());
+}
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <array>
+#include "Render/PipeLine/RenderPass.h"
+
+namespace MechEngine::Rendering
+{
+class GpuScene;
+class buffer_view_pass;
+class wireframe_pass;
+class ground_pass;
+}
+namespace MechEngine::Rendering
+{
+using namespace luisa::compute;
+
+/**
+ * Tone mapping, wireframe, buffer view and ground grid in one kernel,
+ * the frame buffer is read once and written once instead of once per pass.
+ * One kernel is compiled for each set of stages that can be active, so skipped stages cost nothing.
+ * Lines are scattered by LineSceneProxy and still run as their own pass before this one.
+ */
+class post_process_pass : public RenderPass
+{
+public:
+	enum stage : uint
+	{
+		tone_mapping = 1u << 0,
+		wireframe = 1u << 1,
+		buffer_view = 1u << 2,
+		ground = 1u << 3,
+	};
+
+	post_process_pass(GpuScene& InScene, const buffer_view_pass& InBufferView, const wireframe_pass& InWireframe, const ground_pass& InGround);
+
+	virtual void CompileShader(ShaderCompiler& Compiler) override;
+	virtual void PostPass(CommandList& command_list) const override;
+
+	/** Stages needed by the current view mode and materials */
+	[[nodiscard]] uint active_stages() const;
+
+protected:
+	void compile_stages(ShaderCompiler& Compiler, uint stages);
+
+	GpuScene& Scene;
+	const buffer_view_pass& BufferView;
+	const wireframe_pass& Wireframe;
+	const ground_pass& Ground;
+
+	// Indexed by the stage bits, only the reachable sets are compiled
+	std::array<unique_ptr<Shader2D<uint>>, 16> PostProcessShaders;
+};
+}
@@ -7,6 +7,7 @@
 #include "DeferredShadingScene.h"
 #include "GpuScene.h"
 #include "Misc/Path.h"
+#include "Misc/Profiler.h"
 #include "luisa/gui/imgui_window.h"
 #include "Render/Core/LuisaViewport.h"
 #include "Render/PipeLine/PathTracingScene.h"
@@ -77,6 +78,7 @@ void RenderPipeline::Init()
 			LOG_TEMP(str);
 		});
 	}
+
 	Viewport = MakeUnique<LuisaViewport>(Width, Height, this, MainWindow.get(), Stream, Device);
 	Viewport->LoadViewportStyle();
 	MainWindow->prepare_frame();
@@ -88,34 +90,45 @@ bool RenderPipeline::ShouldClose()
 	return MainWindow->should_close();
 }
 
-void RenderPipeline::PreRender()
+void RenderPipeline::BeginFrame()
 {
+	PROFILE_SCOPE("RenderPipeline::BeginFrame");
 	// Prepare frame
 	MainWindow->prepare_frame();
 
-
 	//Reload font if needed
 	Viewport->PreFrame();
 
+	// Widgets and input handlers read and edit the world, draw them before the scene takes its snapshot
+	if (MainWindow->framebuffer())
+	{
+		Viewport->DrawWidgets();
+		Viewport->HandleInput();
+	}
+
+	Scene->CollectRenderData();
+}
 
+void RenderPipeline::PreRender()
+{
+	PROFILE_SCOPE("RenderPipeline::PreRender");
 	// Upload data to GPU
 	Scene->UploadRenderData();
 }
 
 void RenderPipeline::Render()
 {
+	PROFILE_SCOPE("RenderPipeline::Render");
 	using namespace luisa::compute;
 
 	if (!MainWindow->framebuffer()) return;
 
 	Scene->Render();
-
-	Viewport->DrawWidgets();
-	Viewport->HandleInput();
 }
 
 void RenderPipeline::PostRender()
 {
+	PROFILE_SCOPE("RenderPipeline::PostRender");
 	MainWindow->render_frame();
 	Viewport->PostFrame();
 }
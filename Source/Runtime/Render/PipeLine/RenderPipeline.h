@@ -31,6 +31,8 @@ protected:
 
 	UniquePtr<Rendering::GpuScene> Scene;
 
+	virtual void BeginFrame() override;
+
 	virtual void PreRender() override;
 
 	virtual void Render() override;
@@ -23,8 +23,8 @@ Bool denoiser::is_reproject_valid(const UInt2& pixel_coord, const UInt2& pre_coo
 	Bool is_valid = false;
 	$if(all(pre_coord > make_uint2(0, 0)) & all(pre_coord < WinSize))
 	{
-		auto pre_instance = g_buffer.instance_id->read(pre_coord).x;
-		auto pre_normal = g_buffer.normal->read(pre_coord).xyz();
+		auto pre_instance = g_buffer.read_instance_id(pre_coord);
+		auto pre_normal = g_buffer.read_normal(pre_coord);
 		is_valid = (pre_instance == intersection.instance_id) & distance_squared(pre_normal, intersection.corner_normal_world) < NORMAL_TOLERANCE;
 		auto pre_depth = g_buffer.read_depth(pre_coord);
 		is_valid = is_valid & abs(pre_depth - intersection.depth) < DEPTH_TOLERANCE;
@@ -88,7 +88,8 @@ Float3 denoiser::temporal_filter(const UInt2& pixel_coord, const ray_intersectio
 void denoiser::InitPass(Device& Device, luisa::compute::CommandList& command_list)
 {
 	RenderPass::InitPass(Device, command_list);
-	history_length = Device.create_image<uint>(PixelStorage::INT1, WinSize.x, WinSize.y);
+	// History length is at most MAX_HISTORY_LENGTH, one byte is enough
+	history_length = Device.create_image<uint>(PixelStorage::BYTE1, WinSize.x, WinSize.y);
 	static auto ClearHistoryLength = Device.compile<2>(
 	[=]() noexcept {
 		auto pixel_coord = dispatch_id().xy();
@@ -96,8 +97,9 @@ void denoiser::InitPass(Device& Device, luisa::compute::CommandList& command_lis
 	}, { .enable_debug_info = false, .name = "ClearHistoryLength" });
 	command_list << ClearHistoryLength().dispatch(WinSize.x, WinSize.y);
 }
-void denoiser::CompileShader(Device& Device, bool bDebugInfo)
+void denoiser::CompileShader(ShaderCompiler& Compiler)
 {
+	auto& Device = Compiler.GetDevice();
 	auto resolution = scene->GetWindosSize();
 
 	if (bUseOIDN)
@@ -121,33 +123,33 @@ void denoiser::CompileShader(Device& Device, bool bDebugInfo)
 			}
 		}
 
-		copy_frame_buffer_shader = luisa::make_unique<Shader2D<>>(Device.compile<2>(
+		Compiler.Compile(copy_frame_buffer_shader,
 			[&]() noexcept {
 				auto pixel_coord = dispatch_id().xy();
-				auto color = scene->get_gbuffer().radiance->read(pixel_coord);
+				auto& g_buffer = scene->get_gbuffer();
+				auto color = g_buffer.radiance->read(pixel_coord);
 				auto index = pixel_coord.x + pixel_coord.y * resolution.x;
 				noisy_image->write(index, make_float4(color.xyz(), 1.f));
-			}, { .enable_debug_info = bDebugInfo, .name = "CopyFrameBufferShader" }));
+				// Features are decoded here, the packed G-Buffer can not be copied to the denoiser directly
+				albedo->write(index, make_float4(g_buffer.read_albedo(pixel_coord), 1.f));
+				normal->write(index, make_float4(g_buffer.read_normal(pixel_coord), 1.f));
+			}, "CopyFrameBufferShader");
 
-		write_frame_buffer_shader = luisa::make_unique<Shader2D<>>(Device.compile<2>(
+		Compiler.Compile(write_frame_buffer_shader,
 			[&]() noexcept {
 				auto pixel_coord = dispatch_id().xy();
 				auto index = pixel_coord.x + pixel_coord.y * resolution.x;
 				auto color = output_image->read(index);
 				scene->get_gbuffer().radiance->write(pixel_coord, make_float4(color.xyz(), 1.f));
 				scene->frame_buffer()->write(pixel_coord, make_float4(color.xyz(), 1.f));
-			}, { .enable_debug_info = bDebugInfo, .name = "WriteFrameBufferShader" }));
+			}, "WriteFrameBufferShader");
 	}
 }
 void denoiser::PostPass(luisa::compute::CommandList& command_list) const
 {
 	if (bUseOIDN && denoiser_ext) {
 		RenderPass::PostPass(command_list);
-		auto& g_buffer = scene->get_gbuffer();
-		command_list
-		<< g_buffer.albedo.copy_to(albedo)
-		<< g_buffer.normal.copy_to(normal)
-		<< (*copy_frame_buffer_shader)().dispatch(scene->GetWindosSize());
+		command_list << (*copy_frame_buffer_shader)().dispatch(scene->GetWindosSize());
 		scene->get_stream() << command_list.commit();
 		denoiser_ext->execute(true);
 		scene->get_stream() << (*write_frame_buffer_shader)().dispatch(scene->GetWindosSize());
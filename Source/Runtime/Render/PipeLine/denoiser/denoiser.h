@@ -42,7 +42,7 @@ public:
 
 	virtual void InitPass(Device& Device, luisa::compute::CommandList& command_list) override;
 
-	virtual void CompileShader(Device& Device, bool bDebugInfo) override;
+	virtual void CompileShader(ShaderCompiler& Compiler) override;
 
 	virtual void PostPass(luisa::compute::CommandList& command_list) const override;
 
@@ -9,8 +9,9 @@ namespace MechEngine::Rendering
 {
 denoiser_ext::denoiser_ext(class GpuScene* InScene) : scene(InScene)
 {}
-void denoiser_ext::CompileShader(luisa::compute::Device& Device, bool bDebugInfo)
+void denoiser_ext::CompileShader(ShaderCompiler& Compiler)
 {
+	auto& Device = Compiler.GetDevice();
 	auto resolution = scene->GetWindosSize();
 	albedo = Device.create_buffer<float4>(resolution.x * resolution.y);
 	normal = Device.create_buffer<float4>(resolution.x * resolution.y);
@@ -29,32 +30,32 @@ void denoiser_ext::CompileShader(luisa::compute::Device& Device, bool bDebugInfo
 		denoiser->init(input);
 	}
 
-	copy_frame_buffer_shader = luisa::make_unique<Shader2D<>>(Device.compile<2>(
+	Compiler.Compile(copy_frame_buffer_shader,
 		[&]() noexcept {
 			auto pixel_coord = dispatch_id().xy();
 			auto color = scene->frame_buffer()->read(pixel_coord);
 
 			auto index = pixel_coord.x + pixel_coord.y * resolution.x;
 			noisy_image->write(index, make_float4(color.xyz(), 1.f));
-		}, { .enable_debug_info = bDebugInfo, .name = "CopyFrameBufferShader" }));
+			// Features are decoded here, the packed G-Buffer can not be copied to the denoiser directly
+			auto& g_buffer = scene->get_gbuffer();
+			albedo->write(index, make_float4(g_buffer.read_albedo(pixel_coord), 1.f));
+			normal->write(index, make_float4(g_buffer.read_normal(pixel_coord), 1.f));
+		}, "CopyFrameBufferShader");
 
-	write_frame_buffer_shader = luisa::make_unique<Shader2D<>>(Device.compile<2>(
+	Compiler.Compile(write_frame_buffer_shader,
 		[&]() noexcept {
 			auto pixel_coord = dispatch_id().xy();
 			auto index = pixel_coord.x + pixel_coord.y * resolution.x;
 			auto color = output_image->read(index);
 			scene->frame_buffer()->write(pixel_coord, make_float4(color.xyz(), 1.f));
-		}, { .enable_debug_info = bDebugInfo, .name = "WriteFrameBufferShader" }));
+		}, "WriteFrameBufferShader");
 }
 
 void denoiser_ext::PostPass(luisa::compute::CommandList& command_list) const
 {
 	RenderPass::PostPass(command_list);
-	auto& g_buffer = scene->get_gbuffer();
-	command_list
-	<< g_buffer.albedo.copy_to(albedo)
-	<< g_buffer.normal.copy_to(normal)
-	<< (*copy_frame_buffer_shader)().dispatch(scene->GetWindosSize());
+	command_list << (*copy_frame_buffer_shader)().dispatch(scene->GetWindosSize());
 	scene->get_stream() << command_list.commit();
 	denoiser->execute(true);
 	scene->get_stream() << (*write_frame_buffer_shader)().dispatch(scene->GetWindosSize());
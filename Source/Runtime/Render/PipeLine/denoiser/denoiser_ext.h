@@ -14,7 +14,7 @@ class denoiser_ext : public RenderPass
 {
 public:
 	denoiser_ext(class GpuScene* InScene);
-	virtual void CompileShader(Device& Device, bool bDebugInfo) override;
+	virtual void CompileShader(ShaderCompiler& Compiler) override;
 	virtual void PostPass(CommandList& command_list) const override;
 protected:
 	GpuScene* scene;
@@ -36,7 +36,7 @@ Float3 svgf::temporal_filter(const UInt2& pixel_coord, const ray_intersection& i
 			$if(all(p > make_uint2(0, 0)) & all(p < WinSize))
 			{
 				auto pre_instance = buffer.instance_id->read(p).x;
-				auto pre_normal = buffer.normal->read(p).xyz();
+				auto pre_normal = buffer.read_normal(p);
 				$if(pre_instance == intersection.instance_id & distance_squared(pre_normal, intersection.corner_normal_world) < NORMAL_TOLERANCE)
 				{
 					auto pre_color = buffer.color->read(p);
@@ -61,7 +61,7 @@ Float3 svgf::temporal_filter(const UInt2& pixel_coord, const ray_intersection& i
 
 	buffer.instance_id->write(pixel_coord, make_uint4(intersection.instance_id));
 	buffer.color->write(pixel_coord, make_float4(new_color, sum_spp + 1.f));
-	buffer.normal->write(pixel_coord, make_float4(intersection.corner_normal_world, intersection.depth));
+	buffer.write_normal_depth(pixel_coord, intersection.corner_normal_world, intersection.depth);
 	buffer.moment->write(pixel_coord, make_float4(new_moment));
 	return new_color;
 }
@@ -77,10 +77,10 @@ Float3 svgf::atrous_filter(const UInt2& pixel_coord, const UInt& step_size) cons
 
 
 	// First fetch current information
-	auto normal = buffer.normal->read(pixel_coord).xyz();
+	auto normal = buffer.read_normal(pixel_coord);
 	auto color = buffer.color_1->read(pixel_coord).xyz();
 	auto moment = buffer.moment->read(pixel_coord).x;
-	auto depth = buffer.normal->read(pixel_coord).w;
+	auto depth = buffer.read_depth(pixel_coord);
 	auto l = luminance(color);
 
 	Float3 new_color = make_float3(0.f);
@@ -94,14 +94,14 @@ Float3 svgf::atrous_filter(const UInt2& pixel_coord, const UInt& step_size) cons
 			$if (p.x < 0 | p.y < 0 | p.x >= WinSize.x | p.y >= WinSize.y){$continue;};
 			$if (buffer.instance_id->read(p_coord).x != buffer.instance_id->read(pixel_coord).x){$continue;};
 			auto kernel_weight = kernel_weights[Int(abs(dx))] * kernel_weights[Int(abs(dy))];
-			auto p_normal = buffer.normal->read(p_coord).xyz();
+			auto p_normal = buffer.read_normal(p_coord);
 			auto p_color = buffer.color_1->read(p_coord).xyz();
 			auto p_l = luminance(p_color);
 			auto p_moment = buffer.moment->read(p_coord).x;
-			auto p_depth = buffer.normal->read(p_coord).w;
+			auto p_depth = buffer.read_depth(p_coord);
 
-			auto dxdz = buffer.normal->read(UInt2(p + sign(Float(dx)) * make_float2(1.f, 0.f))).w - depth;
-			auto dydz = buffer.normal->read(UInt2(p + sign(Float(dy)) * make_float2(0.f, 1.f))).w - depth;
+			auto dxdz = buffer.read_depth(UInt2(p + sign(Float(dx)) * make_float2(1.f, 0.f))) - depth;
+			auto dydz = buffer.read_depth(UInt2(p + sign(Float(dy)) * make_float2(0.f, 1.f))) - depth;
 
 			auto w_normal = pow(saturate(dot(normal, p_normal)), NORMAL_PHI);
 			auto w_z = exp(-abs(depth - p_depth) / (abs(dxdz*dx + dydz*dy) * DEPTH_PHI + 0.0001f));
@@ -121,11 +121,12 @@ Float3 svgf::atrous_filter(const UInt2& pixel_coord, const UInt& step_size) cons
 	return ite(sum_weight > 0.f, new_color / sum_weight, color);
 }
 
-void svgf::CompileShader(Device& device, bool bDebugInfo)
+void svgf::CompileShader(ShaderCompiler& Compiler)
 {
+	auto& device = Compiler.GetDevice();
 	buffer = svgf_buffer(device, WinSize);
 
-	spacial_filter_shader = luisa::make_unique<Shader2D<uint>>(device.compile<2>(
+	Compiler.Compile(spacial_filter_shader,
 		[&](UInt step_size) noexcept {
 			auto pixel_coord = dispatch_id().xy();
 			buffer.color_1->write(pixel_coord, buffer.color->read(pixel_coord));
@@ -133,14 +134,14 @@ void svgf::CompileShader(Device& device, bool bDebugInfo)
 
 			auto new_color = atrous_filter(pixel_coord, step_size);
 			buffer.color->write(pixel_coord, make_float4(new_color, 1.f));
-		}, {.enable_debug_info = bDebugInfo, .name = "SpacialFilterShader"}));
+		}, "SpacialFilterShader");
 
-	write_frame_buffer_shader = luisa::make_unique<Shader2D<>>(device.compile<2>(
+	Compiler.Compile(write_frame_buffer_shader,
 		[&]() noexcept {
 			auto pixel_coord = dispatch_id().xy();
 			auto color = buffer.color->read(pixel_coord);
 			frame_buffer->write(pixel_coord, make_float4(color.xyz(), 1.f));
-		}, {.enable_debug_info = bDebugInfo, .name = "SVGFWriteFrameBuffer"}));
+		}, "SVGFWriteFrameBuffer");
 }
 
 void svgf::PostPass(CommandList& command_list) const
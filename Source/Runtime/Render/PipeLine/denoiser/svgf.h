@@ -35,7 +35,7 @@ public:
 
 	virtual void PostPass(CommandList& command_list) const override;
 
-	virtual void CompileShader(Device& device, bool bDebugInfo) override;
+	virtual void CompileShader(ShaderCompiler& Compiler) override;
 protected:
 	ImageView<float> frame_buffer;
 	uint2 WinSize;
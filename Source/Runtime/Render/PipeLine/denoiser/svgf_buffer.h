@@ -5,6 +5,7 @@
 #pragma once
 #include <luisa/luisa-compute.h>
 #include "Render/Core/RayCastHit.h"
+#include "Render/Core/math_function.h"
 namespace MechEngine::Rendering
 {
 	using namespace luisa::compute;
@@ -17,7 +18,8 @@ namespace MechEngine::Rendering
 		Image<float> color; // color xyz and spp w
 		Image<float> color_1; // swap color buffer for filtering
 
-		Image<float> normal; // normal xyz and depth w
+		Image<float> normal; // octahedral normal, unorm16x2
+		Image<float> depth;
 		Image<float> moment; // second raw moment of luminance
 		svgf_buffer() = default;
 
@@ -30,9 +32,26 @@ namespace MechEngine::Rendering
 		{
 			instance_id = device.create_image<uint>(PixelStorage::INT1, size.x, size.y);
 			color = device.create_image<float>(PixelStorage::FLOAT4, size.x, size.y);
-			normal = device.create_image<float>(PixelStorage::FLOAT4, size.x, size.y);
+			normal = device.create_image<float>(PixelStorage::SHORT2, size.x, size.y);
+			depth = device.create_image<float>(PixelStorage::FLOAT1, size.x, size.y);
 			moment = device.create_image<float>(PixelStorage::FLOAT1, size.x, size.y);
 			color_1 = device.create_image<float>(PixelStorage::FLOAT4, size.x, size.y);
 		}
+
+		[[nodiscard]] Float3 read_normal(const UInt2& pixel_coord) const noexcept
+		{
+			return octahedral_decode(normal->read(pixel_coord).xy());
+		}
+
+		[[nodiscard]] Float read_depth(const UInt2& pixel_coord) const noexcept
+		{
+			return depth->read(pixel_coord).x;
+		}
+
+		void write_normal_depth(const UInt2& pixel_coord, const Float3& in_normal, const Float& in_depth) const noexcept
+		{
+			normal->write(pixel_coord, make_float4(octahedral_encode(in_normal), 0.f, 0.f));
+			depth->write(pixel_coord, make_float4(in_depth));
+		}
 	};
 }
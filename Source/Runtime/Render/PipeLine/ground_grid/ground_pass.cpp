@@ -14,22 +14,20 @@ namespace MechEngine::Rendering
 ground_pass::ground_pass(GpuScene* InScene, const uint2& size, const ImageView<float>& in_frame_buffer)
 	: RenderPass(), scene(InScene), frame_buffer(in_frame_buffer), WinSize(size) {}
 
-void ground_pass::CompileShader(Device& Device, bool bDebugInfo)
+void ground_pass::CompileShader(ShaderCompiler& Compiler)
 {
-	ground_shader = luisa::make_unique<decltype(ground_shader)::element_type>(
-		Device.compile<2>([&]() noexcept {
+	Compiler.Compile(ground_shader, [&]() noexcept {
 			auto pixel_coord = dispatch_id().xy();
-			auto color = grid(pixel_coord);
+			auto color = grid(pixel_coord, frame_buffer->read(pixel_coord).xyz());
 			frame_buffer->write(pixel_coord, make_float4(color, 1.f));
-		},
-			{ .enable_debug_info = bDebugInfo, .name = "GroundShader" }));
+		}, "GroundShader");
 }
 void ground_pass::PostPass(CommandList& command_list) const
 {
 	command_list << (*ground_shader)().dispatch(WinSize);
 }
 
-Float3 ground_pass::grid(const UInt2& pixel_coord) const
+Float3 ground_pass::grid(const UInt2& pixel_coord, const Float3& frame_color) const
 {
 	auto view = scene->GetCameraProxy()->get_main_view();
 	auto pixel_pos = make_float2(pixel_coord) + 0.5f;
@@ -60,8 +58,7 @@ Float3 ground_pass::grid(const UInt2& pixel_coord) const
 		auto fade_factor = 1.0f - clamp(t / 100.f, 0.0f, 1.0f);
 		grid_color_ = grid_color * fade_factor;
 	};
-	auto frame_color = frame_buffer->read(pixel_coord);
-	return lerp(frame_color.xyz(), grid_color_, intensity);
+	return lerp(frame_color, grid_color_, intensity);
 }
 
 } // namespace MechEngine::Rendering
\ No newline at end of file
@@ -16,10 +16,15 @@ class ground_pass : public RenderPass
 
 public:
 	ground_pass(GpuScene* InScene, const uint2& size, const ImageView<float>& in_frame_buffer);
-	virtual void CompileShader(Device& Device, bool bDebugInfo) override;
+	virtual void CompileShader(ShaderCompiler& Compiler) override;
 	virtual void PostPass(CommandList& command_list) const override;
-protected:
-	Float3 grid(const UInt2& pixel_coord) const;
+
+	/**
+	 * Blend the ground grid over the frame color, occluded by the G-Buffer depth
+	 * @param pixel_coord the coordination of the pixel
+	 * @param frame_color color of the pixel before the grid
+	 */
+	Float3 grid(const UInt2& pixel_coord, const Float3& frame_color) const;
 
 protected:
 
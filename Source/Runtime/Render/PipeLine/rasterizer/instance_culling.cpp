@@ -0,0 +1,329 @@
+#include "instance_culling.h"
+#include "Misc/Config.h"
+#include "Misc/Profiler.h"
+#include "Render/PipeLine/GpuScene.h"
+#include "Render/SceneProxy/CameraSceneProxy.h"
+#include "Render/SceneProxy/StaticMeshSceneProxy.h"
+#include "Render/SceneProxy/TransformProxy.h"
+
+namespace MechEngine::Rendering
+{
+namespace
+{
+	static_assert(StaticMeshSceneProxy::MaxLODNum == 4, "Candidates keep the sizes of the LODs in a uint4");
+
+	bool SameCandidate(const draw_candidate& A, const draw_candidate& B)
+	{
+		return A.instance_id == B.instance_id && A.mesh_id == B.mesh_id && A.lod_num == B.lod_num
+			&& all(A.vertex_num == B.vertex_num) && all(A.triangle_num == B.triangle_num)
+			&& all(A.bounds_min == B.bounds_min) && all(A.bounds_max == B.bounds_max)
+			&& A.back_face_culling == B.back_face_culling;
+	}
+}
+
+instance_culling::instance_culling(GpuScene* InScene, uint InVertexCapacity, uint InTriangleCapacity)
+: scene(InScene), VertexCapacity(InVertexCapacity), TriangleCapacity(InTriangleCapacity) {}
+
+void instance_culling::LoadRenderSettings()
+{
+	bFrustumCulling = GConfig.Get<bool>("DeferredShading", "FrustumCulling");
+	bOcclusionCulling = GConfig.Get<bool>("DeferredShading", "OcclusionCulling");
+	LODScreenSize = scene->UseMeshLOD() ? GConfig.Get<float>("DeferredShading", "LODScreenSize") : 0.f;
+}
+
+void instance_culling::CompileShader(ShaderCompiler& Compiler)
+{
+	auto& Device = Compiler.GetDevice();
+	candidates = Device.create_buffer<draw_candidate>(scene->MaxInstanceNum);
+	vertex_offsets = Device.create_buffer<uint>(scene->MaxInstanceNum);
+	draw_lods = Device.create_buffer<uint>(scene->MaxInstanceNum);
+	triangle_offsets = Device.create_buffer<uint>(scene->MaxInstanceNum);
+	occlusion_culled = Device.create_buffer<uint>(scene->MaxInstanceNum);
+	counters = Device.create_buffer<uint>(3);
+	vertex_dispatch_buffer = Device.create_indirect_dispatch_buffer(max_batch_draws);
+	triangle_setup_dispatch_buffer = Device.create_indirect_dispatch_buffer(max_batch_draws);
+
+	// Each level halves the previous one rounding up, so every texel of a level is covered by its parent
+	HiZSize = scene->GetWindosSize();
+	HiZLevels.clear();
+	uint Offset = 0;
+	for (uint2 Size = HiZSize;; Size = (Size + 1u) / 2u)
+	{
+		HiZLevels.push_back(make_uint4(Offset, Size.x, Size.y, 0u));
+		Offset += Size.x * Size.y;
+		if (Size.x == 1 && Size.y == 1)
+			break;
+	}
+	HiZLevelNum = static_cast<uint>(HiZLevels.size());
+	hiz = Device.create_buffer<float>(Offset);
+	hiz_levels = Device.create_buffer<uint4>(HiZLevelNum);
+	hiz_view_projection = Device.create_buffer<float4x4>(1);
+
+	Compiler.Compile(ResetCullingShader, [&]() noexcept {
+		counters->write(0u, 0u);
+		counters->write(1u, 0u);
+		counters->write(2u, 0u);
+	}, "InstanceCullingReset");
+
+	Compiler.Compile(CullingShader, [&](const UInt& begin, const UInt& flags, const Float& lod_screen_size) noexcept {
+		cull(begin, flags, lod_screen_size);
+	}, "InstanceCulling");
+
+	Compiler.Compile(SetDispatchCountShader, [&]() noexcept {
+		vertex_dispatch_buffer->set_dispatch_count(counters->read(0u));
+		triangle_setup_dispatch_buffer->set_dispatch_count(counters->read(0u));
+	}, "InstanceCullingDispatchCount");
+
+	Compiler.Compile(HiZCopyShader, [&]() noexcept {
+		auto pixel_coord = dispatch_id().xy();
+		hiz->write(pixel_coord.y * HiZSize.x + pixel_coord.x, scene->get_gbuffer().read_depth(pixel_coord));
+		$if(all(pixel_coord == 0u))
+		{
+			hiz_view_projection->write(0u, scene->GetCameraProxy()->get_main_view()->view_projection_matrix);
+		};
+	}, "HiZCopy");
+
+	Compiler.Compile(HiZDownsampleShader, [&](const UInt& level) noexcept {
+		auto texel = dispatch_id().xy();
+		auto parent = hiz_levels->read(level - 1u);
+		auto parent_max = parent.yz() - 1u;
+		auto t0 = min(texel * 2u, parent_max);
+		auto t1 = min(texel * 2u + 1u, parent_max);
+		auto depth = max(max(read_hiz(level - 1u, t0), read_hiz(level - 1u, make_uint2(t1.x, t0.y))),
+			max(read_hiz(level - 1u, make_uint2(t0.x, t1.y)), read_hiz(level - 1u, t1)));
+		auto current = hiz_levels->read(level);
+		hiz->write(current.x + texel.y * current.y + texel.x, depth);
+	}, "HiZDownsample");
+}
+
+const TArray<std::pair<uint, uint>>& instance_culling::GatherCandidates(CommandList& command_list)
+{
+	auto MeshSceneProxy = scene->GetStaticMeshProxy();
+	TArray<draw_candidate> Gathered;
+	for (const auto& [MeshId, Info] : MeshSceneProxy->MeshInfos)
+	{
+		const uint2 MeshSize = MeshSceneProxy->GetLODSize(MeshId, 0);
+		ASSERTMSG(MeshSize.y <= TriangleCapacity, "Mesh triangle number {} exceeds the triangles of a raster batch", MeshSize.y);
+		ASSERTMSG(MeshSize.x <= VertexCapacity, "Mesh vertex number {} exceeds the rasterizer vertex buffer", MeshSize.x);
+		const Math::FBox3f& Box = Info.Bounds;
+		const uint LODNum = MeshSceneProxy->GetLODNum(MeshId);
+		uint4 LODVertexNum = make_uint4(0u);
+		uint4 LODTriangleNum = make_uint4(0u);
+		for (uint LOD = 0; LOD < LODNum; LOD++)
+		{
+			const uint2 Size = MeshSceneProxy->GetLODSize(MeshId, LOD);
+			LODVertexNum[LOD] = Size.x;
+			LODTriangleNum[LOD] = Size.y;
+		}
+		for (auto instance_id : MeshSceneProxy->MeshInstances[MeshId])
+		{
+			draw_candidate Candidate;
+			Candidate.instance_id = instance_id;
+			Candidate.mesh_id = MeshId;
+			Candidate.lod_num = LODNum;
+			Candidate.vertex_num = LODVertexNum;
+			Candidate.triangle_num = LODTriangleNum;
+			Candidate.bounds_min = make_float3(Box.Min.x(), Box.Min.y(), Box.Min.z());
+			Candidate.bounds_max = make_float3(Box.Max.x(), Box.Max.y(), Box.Max.z());
+			Candidate.back_face_culling = Info.bBackFaceCulling;
+			Gathered.push_back(Candidate);
+		}
+	}
+	ASSERTMSG(Gathered.size() <= scene->MaxInstanceNum, "Instance number {} exceeds {}", Gathered.size(), scene->MaxInstanceNum);
+
+	bool bChanged = Gathered.size() != Candidates.size();
+	for (size_t i = 0; !bChanged && i < Gathered.size(); i++)
+		bChanged = !SameCandidate(Gathered[i], Candidates[i]);
+	if (bChanged)
+	{
+		Candidates = std::move(Gathered);
+		Batches.clear();
+		uint VertexNum = 0, TriangleNum = 0;
+		// Budgeted by LOD0, the LOD is picked on the GPU
+		for (uint i = 0; i < Candidates.size(); i++)
+		{
+			if (Batches.empty() || i - Batches.back().first == max_batch_draws || VertexNum + Candidates[i].vertex_num.x > VertexCapacity
+				|| TriangleNum + Candidates[i].triangle_num.x > TriangleCapacity)
+			{
+				Batches.emplace_back(i, i);
+				VertexNum = 0;
+				TriangleNum = 0;
+			}
+			Batches.back().second = i + 1;
+			VertexNum += Candidates[i].vertex_num.x;
+			TriangleNum += Candidates[i].triangle_num.x;
+		}
+		if (!Candidates.empty())
+		{
+			PROFILE_COUNTER("UploadBytes", Candidates.size() * sizeof(draw_candidate));
+			command_list << candidates.view(0, Candidates.size()).copy_from(Candidates.data());
+		}
+	}
+	PROFILE_COUNTER("RasterCandidates", Candidates.size());
+	return Batches;
+}
+
+void instance_culling::CullingPass(CommandList& command_list, uint begin, uint end, bool bRetest) const
+{
+	uint flags = 0;
+	if (bRetest)
+		flags |= retest | occlusion;
+	else
+	{
+		if (bFrustumCulling)
+			flags |= frustum;
+		if (IsOcclusionTested())
+			flags |= occlusion;
+	}
+	command_list
+		<< (*ResetCullingShader)().dispatch(1)
+		<< (*CullingShader)(begin, flags, LODScreenSize).dispatch(end - begin)
+		<< (*SetDispatchCountShader)().dispatch(1);
+}
+
+void instance_culling::BuildHiZ(CommandList& command_list)
+{
+	if (!bHiZValid)
+		command_list << hiz_levels.copy_from(HiZLevels.data());
+	command_list << (*HiZCopyShader)().dispatch(HiZSize);
+	for (uint Level = 1; Level < HiZLevelNum; Level++)
+		command_list << (*HiZDownsampleShader)(Level).dispatch(HiZLevels[Level].y, HiZLevels[Level].z);
+	bHiZValid = true;
+}
+
+UInt instance_culling::get_lod_mesh_id(const UInt& draw) const
+{
+	return scene->GetStaticMeshProxy()->get_lod_mesh_id(get_candidate(draw).mesh_id, get_lod(draw));
+}
+
+void instance_culling::cull(const UInt& begin, const UInt& flags, const Float& lod_screen_size) const
+{
+	auto index = dispatch_id().x;
+	auto draw = begin + index;
+	auto candidate = get_candidate(draw);
+	auto transform = scene->GetTransformProxy()->get_instance_transform_data(candidate.instance_id).transform_matrix;
+
+	auto visible = def(true);
+	auto retest_draw = (flags & retest) != 0u;
+	$if(retest_draw)
+	{
+		visible = occlusion_culled->read(draw) != 0u;
+	}
+	$elif((flags & frustum) != 0u)
+	{
+		visible = frustum_test(scene->GetCameraProxy()->get_main_view()->view_projection_matrix * transform, candidate);
+	};
+	auto occluded = def(false);
+	$if(visible & (flags & occlusion) != 0u)
+	{
+		occluded = !occlusion_test(hiz_view_projection->read(0u) * transform, candidate);
+		visible = !occluded;
+	};
+	$if(!retest_draw)
+	{
+		occlusion_culled->write(draw, ite(occluded, 1u, 0u));
+	};
+
+	$if(visible)
+	{
+		auto lod = select_lod(transform, candidate, lod_screen_size);
+		auto vertex_num = candidate.vertex_num[lod];
+		auto triangle_num = candidate.triangle_num[lod];
+		auto slot = counters->atomic(0u).fetch_add(1u);
+		draw_lods->write(draw, lod);
+		vertex_offsets->write(draw, counters->atomic(1u).fetch_add(vertex_num));
+		triangle_offsets->write(draw, counters->atomic(2u).fetch_add(triangle_num));
+		vertex_dispatch_buffer->set_kernel(slot, make_uint3(block_size, 1u, 1u), make_uint3(vertex_num, 1u, 1u), draw);
+		triangle_setup_dispatch_buffer->set_kernel(slot, make_uint3(block_size, 1u, 1u), make_uint3(triangle_num, 1u, 1u), draw);
+	}
+	$else
+	{
+		vertex_offsets->write(draw, ~0u);
+	};
+}
+
+Bool instance_culling::frustum_test(const Float4x4& model_view_projection, const Var<draw_candidate>& candidate) const
+{
+	// Bits of the planes all corners are outside of, NDC z is in [0, 1]
+	auto outside = def(0x3fu);
+	for (uint corner = 0; corner < 8; corner++)
+	{
+		auto position = make_float3(corner & 1u ? candidate.bounds_max.x : candidate.bounds_min.x,
+			corner & 2u ? candidate.bounds_max.y : candidate.bounds_min.y,
+			corner & 4u ? candidate.bounds_max.z : candidate.bounds_min.z);
+		auto clip = model_view_projection * make_float4(position, 1.f);
+		auto planes = ite(clip.x < -clip.w, 1u, 0u) | ite(clip.x > clip.w, 2u, 0u)
+			| ite(clip.y < -clip.w, 4u, 0u) | ite(clip.y > clip.w, 8u, 0u)
+			| ite(clip.z < 0.f, 16u, 0u) | ite(clip.z > clip.w, 32u, 0u);
+		outside &= planes;
+	}
+	return outside == 0u;
+}
+
+Bool instance_culling::occlusion_test(const Float4x4& model_view_projection, const Var<draw_candidate>& candidate) const
+{
+	auto size = make_float2(HiZSize);
+	auto rect_min = def(make_float2(std::numeric_limits<float>::max()));
+	auto rect_max = def(make_float2(std::numeric_limits<float>::lowest()));
+	auto min_depth = def(1.f);
+	auto behind_camera = def(false);
+	for (uint corner = 0; corner < 8; corner++)
+	{
+		auto position = make_float3(corner & 1u ? candidate.bounds_max.x : candidate.bounds_min.x,
+			corner & 2u ? candidate.bounds_max.y : candidate.bounds_min.y,
+			corner & 4u ? candidate.bounds_max.z : candidate.bounds_min.z);
+		auto clip = model_view_projection * make_float4(position, 1.f);
+		behind_camera |= clip.w <= 1e-5f;
+		auto ndc = clip.xyz() / clip.w;
+		// Same mapping as view::ndc_to_screen
+		auto screen = make_float2(ndc.x * 0.5f + 0.5f, -ndc.y * 0.5f + 0.5f) * size;
+		rect_min = min(rect_min, screen);
+		rect_max = max(rect_max, screen);
+		min_depth = min(min_depth, ndc.z);
+	}
+
+	// Boxes crossing the camera plane or outside the pyramid's view have no known occluder
+	auto visible = def(true);
+	$if(!behind_camera & all(rect_max >= 0.f) & all(rect_min < size))
+	{
+		// Depth is stored at pixel centers, one pixel of margin keeps the test conservative
+		auto texel_min = make_uint2(clamp(rect_min - 1.f, 0.f, size - 1.f));
+		auto texel_max = make_uint2(clamp(rect_max + 1.f, 0.f, size - 1.f));
+		// The rect spans at most two texels on each axis of this level
+		auto extent = max(texel_max.x - texel_min.x, texel_max.y - texel_min.y);
+		auto level = min(ite(extent > 1u, 32u - clz(extent - 1u), 0u), HiZLevelNum - 1u);
+		texel_min = texel_min >> level;
+		texel_max = texel_max >> level;
+		auto max_depth = max(max(read_hiz(level, texel_min), read_hiz(level, make_uint2(texel_max.x, texel_min.y))),
+			max(read_hiz(level, make_uint2(texel_min.x, texel_max.y)), read_hiz(level, texel_max)));
+		visible = min_depth <= max_depth;
+	};
+	return visible;
+}
+
+UInt instance_culling::select_lod(const Float4x4& transform, const Var<draw_candidate>& candidate, const Float& lod_screen_size) const
+{
+	auto view = scene->GetCameraProxy()->get_main_view();
+	auto center = transform * make_float4((candidate.bounds_min + candidate.bounds_max) * 0.5f, 1.f);
+	auto scale = max(length(transform[0].xyz()), max(length(transform[1].xyz()), length(transform[2].xyz())));
+	auto radius = length(candidate.bounds_max - candidate.bounds_min) * 0.5f * scale;
+	// Clip w is the view depth for perspective and 1 for orthographic, the projection's y scale covers both
+	auto w = (view->view_projection_matrix * center).w;
+	auto screen_size = radius * view->projection_matrix[1][1] / max(w, 1e-5f);
+
+	auto lod = def(0u);
+	$if(candidate.lod_num > 1u & w > radius & screen_size < lod_screen_size)
+	{
+		auto level = UInt(floor(log2(lod_screen_size / max(screen_size, 1e-6f)))) + 1u;
+		lod = min(level, candidate.lod_num - 1u);
+	};
+	return lod;
+}
+
+Float instance_culling::read_hiz(const UInt& level, const UInt2& texel) const
+{
+	auto level_data = hiz_levels->read(level);
+	auto clamped = min(texel, level_data.yz() - 1u);
+	return hiz->read(level_data.x + clamped.y * level_data.y + clamped.x);
+}
+} // namespace MechEngine::Rendering
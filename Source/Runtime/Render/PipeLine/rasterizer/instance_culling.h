@@ -0,0 +1,163 @@
+#pragma once
+#include "Render/PipeLine/RenderPass.h"
+
+namespace MechEngine::Rendering
+{
+/** A mesh instance to be rasterized, with the bounding box of the mesh in local space */
+struct draw_candidate
+{
+	uint instance_id = ~0u;
+	uint mesh_id = ~0u;
+	uint lod_num = 1;
+	// Of each LOD, LOD0 is the mesh itself
+	uint4 vertex_num;
+	uint4 triangle_num;
+	float3 bounds_min;
+	float3 bounds_max;
+	uint back_face_culling = 0;
+};
+}
+
+LUISA_STRUCT(MechEngine::Rendering::draw_candidate,
+	instance_id, mesh_id, lod_num, vertex_num, triangle_num, bounds_min, bounds_max, back_face_culling){};
+
+namespace MechEngine::Rendering
+{
+using namespace luisa::compute;
+class GpuScene;
+
+/**
+ * Instance level culling for the rasterizer, run as one GPU pass before any vertex is transformed.
+ * Candidates are tested against the view frustum, then against a hierarchical-Z pyramid of the previous frame's depth.
+ * Visible candidates are compacted into the indirect arguments of the vertex and triangle setup stages, so each stage is one dispatch,
+ * and get a range of the shared vertex buffer and of the triangles of the batch, sized by their picked LOD.
+ * Instances occluded by last frame's depth are tested again once the pyramid is rebuilt from this frame's first pass,
+ * so an instance disoccluded this frame is rastered by the second pass instead of one frame late.
+ * Visible candidates pick a simplified mesh by their projected size, a level per halving of the screen size.
+ */
+class instance_culling : public RenderPass
+{
+public:
+	enum culling_flag : uint
+	{
+		frustum = 1u << 0,
+		occlusion = 1u << 1,
+		// Only the candidates culled by occlusion in the first pass, against the pyramid of this frame
+		retest = 1u << 2,
+	};
+
+	/**
+	 * @param InScene Scene to cull
+	 * @param InVertexCapacity Vertices of the shared vertex buffer, a batch never exceeds it
+	 * @param InTriangleCapacity Triangles rastered by one batch, a batch never exceeds it
+	 */
+	instance_culling(GpuScene* InScene, uint InVertexCapacity, uint InTriangleCapacity);
+
+	virtual void LoadRenderSettings() override;
+
+	virtual void CompileShader(ShaderCompiler& Compiler) override;
+
+	/**
+	 * Gather the mesh instances of the scene and split them into batches, uploaded only when changed
+	 * @return Batches as [begin, end) of the candidates
+	 */
+	const TArray<std::pair<uint, uint>>& GatherCandidates(CommandList& command_list);
+
+	/**
+	 * Cull the candidates of a batch and write the indirect arguments of its draws
+	 * @param bRetest Second pass, draw the candidates the first pass culled by occlusion that pass the current pyramid
+	 */
+	void CullingPass(CommandList& command_list, uint begin, uint end, bool bRetest = false) const;
+
+	/** Build the Hi-Z pyramid from the rasterized depth, used by the second pass and to cull the next frame */
+	void BuildHiZ(CommandList& command_list);
+
+	/** Whether the next first pass culls by occlusion, then its culled candidates need the second pass */
+	[[nodiscard]] FORCEINLINE bool IsOcclusionTested() const { return bOcclusionCulling && bHiZValid; }
+
+	[[nodiscard]] FORCEINLINE const TArray<draw_candidate>& GetCandidates() const { return Candidates; }
+
+	[[nodiscard]] Var<draw_candidate> get_candidate(const UInt& draw) const { return candidates->read(draw); }
+
+	/** First vertex of the draw in the shared vertex buffer, ~0u if the draw is culled */
+	[[nodiscard]] UInt get_vertex_offset(const UInt& draw) const { return vertex_offsets->read(draw); }
+
+	/** First triangle of the draw among the triangles of the batch, valid once the draw is visible */
+	[[nodiscard]] UInt get_triangle_offset(const UInt& draw) const { return triangle_offsets->read(draw); }
+
+	/** Triangles of the visible draws of the batch at their picked LOD */
+	[[nodiscard]] UInt get_triangle_num() const { return counters->read(2u); }
+
+	/** LOD picked for the draw, valid once the draw is visible */
+	[[nodiscard]] UInt get_lod(const UInt& draw) const { return draw_lods->read(draw); }
+
+	/** Mesh of the LOD picked for the draw */
+	[[nodiscard]] UInt get_lod_mesh_id(const UInt& draw) const;
+
+	// Compacted visible draws of the batch, kernel id is the draw
+	IndirectDispatchBuffer vertex_dispatch_buffer;
+
+	// Triangle setup of the compacted visible draws of the batch, kernel id is the draw
+	IndirectDispatchBuffer triangle_setup_dispatch_buffer;
+
+	// Draws of a batch are limited by the indirect dispatch buffer size on metal
+	static constexpr uint max_batch_draws = 16384;
+	static constexpr uint block_size = 256;
+
+protected:
+	void cull(const UInt& begin, const UInt& flags, const Float& lod_screen_size) const;
+
+	/** Whether the box is not entirely outside one of the clip planes */
+	[[nodiscard]] Bool frustum_test(const Float4x4& model_view_projection, const Var<draw_candidate>& candidate) const;
+
+	/** Whether the box may be in front of the Hi-Z, the box is projected by the view of the pyramid */
+	[[nodiscard]] Bool occlusion_test(const Float4x4& model_view_projection, const Var<draw_candidate>& candidate) const;
+
+	/**
+	 * Level of detail by the projected height of the bounding sphere over the viewport height
+	 * @param lod_screen_size Below this size LOD1 is used, 0 for LOD0 only
+	 */
+	[[nodiscard]] UInt select_lod(const Float4x4& transform, const Var<draw_candidate>& candidate, const Float& lod_screen_size) const;
+
+	/** Max depth of a texel of the pyramid */
+	[[nodiscard]] Float read_hiz(const UInt& level, const UInt2& texel) const;
+
+	GpuScene* scene;
+	uint VertexCapacity;
+	uint TriangleCapacity;
+	uint2 HiZSize;
+	uint HiZLevelNum = 0;
+
+	bool bFrustumCulling = true;
+	bool bOcclusionCulling = true;
+	float LODScreenSize = 0.f;
+	// Pyramid built from a rasterized frame, false until the first one
+	bool bHiZValid = false;
+
+	TArray<draw_candidate> Candidates;
+	TArray<std::pair<uint, uint>> Batches;
+	// Offset, width and height of each level, uploaded with the first pyramid
+	TArray<uint4> HiZLevels;
+
+	Buffer<draw_candidate> candidates;
+	Buffer<uint> vertex_offsets;
+	Buffer<uint> draw_lods;
+	Buffer<uint> triangle_offsets;
+	// 1 if the first pass culled the draw by occlusion only, candidates of the second pass
+	Buffer<uint> occlusion_culled;
+	// Visible draws, allocated vertices and allocated triangles of the batch
+	Buffer<uint> counters;
+
+	// Max depth pyramid, levels flattened row by row
+	Buffer<float> hiz;
+	Buffer<uint4> hiz_levels;
+	// View projection matrix of the frame the pyramid is built from
+	Buffer<float4x4> hiz_view_projection;
+
+	unique_ptr<Shader1D<>> ResetCullingShader;
+	unique_ptr<Shader1D<uint, uint, float>> CullingShader;
+	unique_ptr<Shader1D<>> SetDispatchCountShader;
+	unique_ptr<Shader2D<>> HiZCopyShader;
+	unique_ptr<Shader2D<uint>> HiZDownsampleShader;
+};
+};
@@ -43,6 +43,12 @@ Var<view> rasterizer::get_view() const
 	return scene->GetCameraProxy()->get_main_view();
 }
 
+UInt2 rasterizer::read_triangle_id(const UInt2& pixel_coord) const
+{
+	auto triangle_id = vbuffer.triangle_id->read(pixel_coord).x;
+	return make_uint2(triangle_id & ((1u << visibility_buffer::lod_shift) - 1u), triangle_id >> visibility_buffer::lod_shift);
+}
+
 Bool rasterizer::back_face_culling(const ArrayFloat3<3>& vertex_scree_coords)
 {
 	static Callable func = [](const ArrayFloat3<3>& Vertex) {
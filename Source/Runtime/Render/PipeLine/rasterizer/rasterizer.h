@@ -25,9 +25,9 @@ public:
 	virtual void ClearPass(CommandList& command_list) = 0;
 
 	/**
-	 * Raster visibility pass
+	 * Raster visibility pass of all the mesh instances in the scene
 	 */
-	virtual void VisibilityPass(CommandList& command_list, uint instance_id, uint mesh_id, uint vertex_num, uint triangle_num, bool back_face_culling) = 0;
+	virtual void VisibilityPass(CommandList& command_list) = 0;
 
 	[[nodiscard]] UInt get_mesh_id(const UInt& instance_id) const;
 
@@ -41,6 +41,9 @@ public:
 
 	[[nodiscard]] Var<view> get_view() const;
 
+	/** Triangle id and LOD of the mesh rastered at the pixel */
+	[[nodiscard]] UInt2 read_triangle_id(const UInt2& pixel_coord) const;
+
 	static Bool back_face_culling(const ArrayFloat3<3>& vertex_screen_coords);
 
 	visibility_buffer vbuffer;
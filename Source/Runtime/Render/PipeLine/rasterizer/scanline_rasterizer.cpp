@@ -9,48 +9,63 @@
 
 namespace MechEngine::Rendering
 {
-void scanline_rasterizer::CompileShader(Device& Device, bool bDebugInfo)
+void scanline_rasterizer::CompileShader(ShaderCompiler& Compiler)
 {
+	auto& Device = Compiler.GetDevice();
 	auto WinSize = scene->GetWindosSize();
 
 	vertex_screen_coords = Device.create_buffer<float3>(vertex_max_number);
 	triangle_pixel_offset = Device.create_buffer<uint2>(triangle_max_number);
+	triangle_draws = Device.create_buffer<uint2>(triangle_max_number);
+	pixel_owner = Device.create_buffer<uint>(WinSize.x * WinSize.y);
 
-	// The maximum size of the dispatch buffer is 16384
-	draw_triangle_dispatch_buffer = Device.create_indirect_dispatch_buffer(16384);
+	// The maximum size of the dispatch buffer is 16384, it holds the triangles of a batch
+	draw_triangle_dispatch_buffer = Device.create_indirect_dispatch_buffer(triangle_max_number);
 
 	vbuffer.bary = Device.create_image<float>(PixelStorage::FLOAT2, WinSize.x, WinSize.y);
 	vbuffer.instance_id = Device.create_image<uint>(PixelStorage::INT1, WinSize.x, WinSize.y);
 	vbuffer.triangle_id = Device.create_image<uint>(PixelStorage::INT1, WinSize.x, WinSize.y);
 
-	VertexShader = luisa::make_unique<decltype(VertexShader)::element_type>(
-		Device.compile<1>([&](const UInt& instance_id, const UInt& mesh_id) noexcept {
-			vertex_shader(instance_id, mesh_id);
-		}, {.enable_debug_info = bDebugInfo, .name = "VertexShader"}));
+	culling = make_unique<instance_culling>(scene, vertex_max_number, triangle_max_number);
+	culling->LoadRenderSettings();
+	culling->CompileShader(Compiler);
 
-	CullingTriangleShader = luisa::make_unique<decltype(CullingTriangleShader)::element_type>(
-		Device.compile<1>([&](const UInt& instance_id, const UInt& mesh_id, const Bool& enable_back_face_culling) noexcept {
-			culling_triangle(instance_id, mesh_id, enable_back_face_culling);
-		}, {.enable_debug_info = bDebugInfo, .name = "RasterMeshShader"}));
+	Compiler.Compile(VertexShader, [&]() noexcept {
+			set_block_size(instance_culling::block_size, 1u, 1u);
+			vertex_shader(kernel_id());
+		}, "VertexShader");
 
-	RasterTriangleShader = luisa::make_unique<decltype(RasterTriangleShader)::element_type>(
-		Device.compile<2>([&](const UInt& instance_id, const UInt& mesh_id) noexcept {
+	Compiler.Compile(CullingTriangleShader, [&]() noexcept {
+			set_block_size(instance_culling::block_size, 1u, 1u);
+			culling_triangle(kernel_id());
+		}, "RasterMeshShader");
+
+	Compiler.Compile(RasterDepthShader, [&](const UInt& sequence_base) noexcept {
+			set_block_size(16, 16, 1);
+			raster_triangle(depth_test, sequence_base);
+		}, "RasterTriangleDepthShader");
+
+	Compiler.Compile(RasterClaimShader, [&](const UInt& sequence_base) noexcept {
 			set_block_size(16, 16, 1);
-			raster_triangle(instance_id, mesh_id);
-		}, {.enable_debug_info = bDebugInfo, .name = "RasterTriangleShader"}));
+			raster_triangle(owner_claim, sequence_base);
+		}, "RasterTriangleClaimShader");
 
-	ClearScreenShader = luisa::make_unique<decltype(ClearScreenShader)::element_type>(
-		Device.compile<2>([&]() noexcept {
+	Compiler.Compile(RasterWriteShader, [&](const UInt& sequence_base) noexcept {
+			set_block_size(16, 16, 1);
+			raster_triangle(visibility_write, sequence_base);
+		}, "RasterTriangleWriteShader");
+
+	Compiler.Compile(ClearScreenShader, [&]() noexcept {
 			$comment("Clear visibility buffer and depth buffer");
 			auto& g_buffer = scene->get_gbuffer();
 			g_buffer.depth->write(g_buffer.flattend_index(dispatch_id().xy()), 1.f);
+			pixel_owner->write(g_buffer.flattend_index(dispatch_id().xy()), 0u);
 			vbuffer.instance_id->write(dispatch_id().xy(), make_uint4(~0u));
-		}, {.enable_debug_info = bDebugInfo, .name = "RasterClearScreenShader"}));
+		}, "RasterClearScreenShader");
 
-	ResetDispatchBufferShader = luisa::make_unique<decltype(ResetDispatchBufferShader)::element_type>(
-		Device.compile<1>([&](const UInt& dispatch_count) noexcept {
-			draw_triangle_dispatch_buffer->set_dispatch_count(dispatch_count);
-		}, {.enable_debug_info = bDebugInfo, .name = "ScanlineResetDispatchBuffer"}));
+	Compiler.Compile(ResetDispatchBufferShader, [&]() noexcept {
+			draw_triangle_dispatch_buffer->set_dispatch_count(culling->get_triangle_num());
+		}, "ScanlineResetDispatchBuffer");
 }
 
 void scanline_rasterizer::ClearPass(CommandList& command_list)
@@ -58,42 +73,69 @@ void scanline_rasterizer::ClearPass(CommandList& command_list)
 	command_list << (*ClearScreenShader)().dispatch(scene->GetWindosSize());
 }
 
-void scanline_rasterizer::VisibilityPass(CommandList& command_list, uint instance_id, uint mesh_id, uint vertex_num, uint triangle_num, bool back_face_culling)
+void scanline_rasterizer::VisibilityPass(CommandList& command_list)
 {
-	static vector<float4> triangle_boxes(triangle_max_number);
+	// Every stage runs over the visible draws compacted by the culling, the LOD and the culling are picked on the GPU
+	const auto& Batches = culling->GatherCandidates(command_list);
+	const uint BatchNum = static_cast<uint>(Batches.size());
+	const bool bRetest = culling->IsOcclusionTested();
+	for (uint Batch = 0; Batch < BatchNum; Batch++)
+		RasterBatch(command_list, Batches[Batch], 1u + Batch * triangle_max_number, false);
+	if (bRetest)
+	{
+		// Second pass, the instances occluded by last frame's depth are tested against this frame's first pass
+		culling->BuildHiZ(command_list);
+		for (uint Batch = 0; Batch < BatchNum; Batch++)
+			RasterBatch(command_list, Batches[Batch], 1u + (BatchNum + Batch) * triangle_max_number, true);
+	}
+	culling->BuildHiZ(command_list);
+}
 
-	ASSERTMSG(triangle_num <= 16384, "The maximum size of the dispatch buffer is 16384 due to metal limitation");
+void scanline_rasterizer::RasterBatch(CommandList& command_list, const std::pair<uint, uint>& Batch, uint SequenceBase, bool bRetest)
+{
+	culling->CullingPass(command_list, Batch.first, Batch.second, bRetest);
 	command_list
-		<< (*VertexShader)(instance_id, mesh_id).dispatch(vertex_num)
-		<< (*ResetDispatchBufferShader)(triangle_num).dispatch(1) // set dispatch count
-		<< (*CullingTriangleShader)(instance_id, mesh_id, back_face_culling).dispatch(triangle_num);
-	for(int i = 0; i < triangle_num; i ++)
-		command_list << (*RasterTriangleShader)(instance_id, mesh_id).dispatch(draw_triangle_dispatch_buffer, i, 1);
+		<< (*VertexShader)().dispatch(culling->vertex_dispatch_buffer)
+		<< (*ResetDispatchBufferShader)().dispatch(1) // set dispatch count
+		<< (*CullingTriangleShader)().dispatch(culling->triangle_setup_dispatch_buffer)
+		<< (*RasterDepthShader)(SequenceBase).dispatch(draw_triangle_dispatch_buffer)
+		<< (*RasterClaimShader)(SequenceBase).dispatch(draw_triangle_dispatch_buffer)
+		<< (*RasterWriteShader)(SequenceBase).dispatch(draw_triangle_dispatch_buffer);
 }
 
-void scanline_rasterizer::vertex_shader(const UInt& instance_id, const UInt& mesh_id) const
+void scanline_rasterizer::vertex_shader(const UInt& draw) const
 {
 	auto vertex_id = dispatch_id().x;
 	auto view = get_view();
 	$comment("Vertex shader");
-	auto model_transform = get_instance_transform_mat(instance_id);
-	auto vertex = get_vertex(mesh_id, vertex_id);
+	auto candidate = culling->get_candidate(draw);
+	auto model_transform = get_instance_transform_mat(candidate.instance_id);
+	auto vertex = get_vertex(culling->get_lod_mesh_id(draw), vertex_id);
 	auto world_pos = model_transform * Float4(vertex.px, vertex.py, vertex.pz, 1.0f);
-	vertex_screen_coords->write(vertex_id,
+	vertex_screen_coords->write(culling->get_vertex_offset(draw) + vertex_id,
 		view->world_to_screen(world_pos.xyz()));
 }
 
-void scanline_rasterizer::culling_triangle(const UInt& instance_id, const UInt& mesh_id, Bool enable_back_face_culling) const
+Float3 scanline_rasterizer::read_screen_coord(const UInt& vertex_offset, const UInt& vertex_index) const
+{
+	return vertex_screen_coords->read(vertex_offset + vertex_index);
+}
+
+void scanline_rasterizer::culling_triangle(const UInt& draw) const
 {
 	auto WinSize = scene->GetWindosSize();
 	auto triangle_id = dispatch_id().x;
+	auto slot = culling->get_triangle_offset(draw) + triangle_id;
+	auto candidate = culling->get_candidate(draw);
+	auto vertex_offset = culling->get_vertex_offset(draw);
+	auto enable_back_face_culling = candidate.back_face_culling != 0u;
 
 	$comment("Read vertex screen position");
-	auto Indices = get_triangle(mesh_id, triangle_id);
+	auto Indices = get_triangle(culling->get_lod_mesh_id(draw), triangle_id);
 	ArrayFloat3<3> screen_coords;
-	screen_coords[0] = vertex_screen_coords->read(Indices.i0);
-	screen_coords[1] = vertex_screen_coords->read(Indices.i1);
-	screen_coords[2] = vertex_screen_coords->read(Indices.i2);
+	screen_coords[0] = read_screen_coord(vertex_offset, Indices.i0);
+	screen_coords[1] = read_screen_coord(vertex_offset, Indices.i1);
+	screen_coords[2] = read_screen_coord(vertex_offset, Indices.i2);
 
 	$comment("Calulate triangle bounding box");
 	auto minX = min(screen_coords[0].x, min(screen_coords[1].x, screen_coords[2].x));
@@ -106,10 +148,10 @@ void scanline_rasterizer::culling_triangle(const UInt& instance_id, const UInt&
 	{
 		$comment("Triangle is out of screen");
 		draw_triangle_dispatch_buffer->set_kernel(
-			triangle_id,
+			slot,
 			make_uint3(16, 16, 1),
 			make_uint3(0u, 1u, 1u),
-			triangle_id);
+			slot);
 	}
 	$else
 	{
@@ -122,33 +164,38 @@ void scanline_rasterizer::culling_triangle(const UInt& instance_id, const UInt&
 		minX = floor(minX); maxX = ceil(maxX);
 		minY = floor(minY); maxY = ceil(maxY);
 
-		triangle_pixel_offset->write(triangle_id, make_uint2(UInt(minX), UInt(minY)));
+		triangle_pixel_offset->write(slot, make_uint2(UInt(minX), UInt(minY)));
+		triangle_draws->write(slot, make_uint2(draw, triangle_id));
 
 		$comment("Set draw triangle dispatch buffer");
 		draw_triangle_dispatch_buffer->set_kernel(
-			triangle_id,
+			slot,
 			make_uint3(16, 16, 1),
 			make_uint3(UInt(Int(maxX - minX) + 1), UInt(Int(maxY - minY) + 1), 1u),
-			triangle_id);
+			slot);
 	};
 }
 
-void scanline_rasterizer::raster_triangle(const UInt& instance_id, const UInt& mesh_id) const
+void scanline_rasterizer::raster_triangle(raster_stage stage, const UInt& sequence_base) const
 {
 	$comment_with_location("raster triangle");
 	auto& g_buffer = scene->get_gbuffer();
-	auto triangle_id = kernel_id();
-	auto pixel_delta = triangle_pixel_offset->read(triangle_id).xy();
+	auto slot = kernel_id();
+	auto triangle_draw = triangle_draws->read(slot);
+	auto draw = triangle_draw.x;
+	auto triangle_id = triangle_draw.y;
+	auto vertex_offset = culling->get_vertex_offset(draw);
+	auto pixel_delta = triangle_pixel_offset->read(slot).xy();
 	auto pixel = dispatch_id().xy() + pixel_delta;
 	auto pixel_coord = make_float2(pixel) + 0.5f;
 
 	$comment("Read vertex screen position");
 	// TODO move screen_coords as input
 	ArrayFloat3<3> screen_coords;
-	auto Indices = get_triangle(mesh_id, triangle_id);
-	screen_coords[0] = vertex_screen_coords->read(Indices.i0);
-	screen_coords[1] = vertex_screen_coords->read(Indices.i1);
-	screen_coords[2] = vertex_screen_coords->read(Indices.i2);
+	auto Indices = get_triangle(culling->get_lod_mesh_id(draw), triangle_id);
+	screen_coords[0] = read_screen_coord(vertex_offset, Indices.i0);
+	screen_coords[1] = read_screen_coord(vertex_offset, Indices.i1);
+	screen_coords[2] = read_screen_coord(vertex_offset, Indices.i2);
 	$comment_with_location("interpolate barycentric coordinate");
 
 	auto bary = barycentric(pixel_coord, screen_coords[0].xy(), screen_coords[1].xy(), screen_coords[2].xy());
@@ -157,18 +204,38 @@ void scanline_rasterizer::raster_triangle(const UInt& instance_id, const UInt& m
 		// Z test
 		auto z = triangle_interpolate(bary, screen_coords[0].z, screen_coords[1].z, screen_coords[2].z);
 		auto flat_index = g_buffer.flattend_index(pixel);
+		auto sequence = sequence_base + slot;
 
-		$comment("depth test");
-		// auto pre_z = g_buffer.depth->atomic(flat_index).fetch_min(z);
-		auto pre_z = g_buffer.depth->read(flat_index);
-		$if (pre_z > z)
+		switch (stage)
 		{
-			$comment("write back visibility buffer");
-			g_buffer.depth->write(flat_index, z);
-			vbuffer.instance_id->write(pixel, make_uint4(instance_id));
-			vbuffer.triangle_id->write(pixel, make_uint4(triangle_id));
-			vbuffer.bary->write(pixel, make_float4(bary, 0.0f, 0.0f));
-		};
+			case depth_test:
+			{
+				$comment("depth test");
+				g_buffer.depth->atomic(flat_index).fetch_min(z);
+				break;
+			}
+			case owner_claim:
+			{
+				$comment("claim the pixel, triangles at the same depth are ordered by their sequence");
+				$if (g_buffer.depth->read(flat_index) == z)
+				{
+					pixel_owner->atomic(flat_index).fetch_max(sequence);
+				};
+				break;
+			}
+			case visibility_write:
+			{
+				$if (pixel_owner->read(flat_index) == sequence)
+				{
+					$comment("write back visibility buffer");
+					auto lod = culling->get_lod(draw);
+					vbuffer.instance_id->write(pixel, make_uint4(culling->get_candidate(draw).instance_id));
+					vbuffer.triangle_id->write(pixel, make_uint4(triangle_id | (lod << visibility_buffer::lod_shift)));
+					vbuffer.bary->write(pixel, make_float4(bary, 0.0f, 0.0f));
+				};
+				break;
+			}
+		}
 	};
 }
 
@@ -4,6 +4,7 @@
 
 #pragma once
 #include "rasterizer.h"
+#include "instance_culling.h"
 
 namespace MechEngine::Rendering
 {
@@ -12,60 +13,91 @@ class scanline_rasterizer : public rasterizer
 	using rasterizer::rasterizer;
 
 public:
-	virtual void CompileShader(Device& Device, bool bDebugInfo) override;
+	virtual void CompileShader(ShaderCompiler& Compiler) override;
 
 	virtual void ClearPass(CommandList& command_list) override;
 
-	virtual void VisibilityPass(CommandList& command_list,
-		uint instance_id, uint mesh_id, uint vertex_num, uint triangle_num, bool back_face_culling) override;
+	/**
+	 * Cull the instances, then raster the visible ones.
+	 * Each stage of a batch is one indirect dispatch over its visible draws, at the triangles of their picked LOD.
+	 * With occlusion culling the batches are culled and rastered twice, the second pass draws the instances
+	 * hidden in the previous frame that this frame's first pass uncovered.
+	 */
+	virtual void VisibilityPass(CommandList& command_list) override;
 
 protected:
+	/**
+	 * Cull a batch and raster its visible draws
+	 * @param SequenceBase Owner id of the first triangle slot, later batches and the second pass win equal depths
+	 * @param bRetest Second pass of the occlusion culling
+	 */
+	void RasterBatch(CommandList& command_list, const std::pair<uint, uint>& Batch, uint SequenceBase, bool bRetest);
+
+	/**
+	 * Triangles of a batch are rastered together, so the depth test is resolved by atomics in three dispatches:
+	 * keep the nearest depth, let the triangles at that depth claim the pixel, then the owner writes the visibility buffer
+	 */
+	enum raster_stage : uint
+	{
+		depth_test,
+		owner_claim,
+		visibility_write
+	};
+
 	/**
 	 * Vertex shader
-	 * @param instance_id instance id
-	 * @param mesh_id mesh id
+	 * @param draw index of the draw candidate
 	 */
-	void vertex_shader(const UInt& instance_id, const UInt& mesh_id) const;
+	void vertex_shader(const UInt& draw) const;
 
 	/**
-	 * Raster a mesh
-	 * @param instance_id instance id
-	 * @param mesh_id mesh id
-	 * @param enable_back_face_culling
+	 * Set up the raster kernels of the triangles of a draw, at the range of the draw in the batch
+	 * @param draw index of the draw candidate
 	 */
-	void culling_triangle(const UInt& instance_id, const UInt& mesh_id, Bool enable_back_face_culling) const;
+	void culling_triangle(const UInt& draw) const;
 
 	/**
-	 * Raster a triangle
-	 * @param instance_id instance id
-	 * @param mesh_id mesh id
+	 * Raster a triangle of the batch, the kernel id is its slot in the batch
+	 * @param stage Part of the depth test run by this dispatch
+	 * @param sequence_base Owner id of the first slot of the batch, later batches win equal depths
 	 */
-	void raster_triangle(const UInt& instance_id, const UInt& mesh_id) const;
+	void raster_triangle(raster_stage stage, const UInt& sequence_base) const;
+
+	/** Screen position of a vertex of the draw, vertices of all visible draws share one buffer */
+	[[nodiscard]] Float3 read_screen_coord(const UInt& vertex_offset, const UInt& vertex_index) const;
 
 protected:
 	static constexpr uint triangle_max_number = 16384;
 	static constexpr uint vertex_max_number = (1<<20); // Should be dynamic
 
+	unique_ptr<instance_culling> culling;
+
 	IndirectDispatchBuffer draw_triangle_dispatch_buffer;
 
 	// lx, rx, ly, ry for triangle bounding box in screen space
 	Buffer<uint2> triangle_pixel_offset;
+	// Draw and triangle id of each slot of the batch
+	Buffer<uint2> triangle_draws;
 	Buffer<float3> vertex_screen_coords;
+	// Owner id of the triangle nearest at each pixel, 0 before any triangle
+	Buffer<uint> pixel_owner;
 
-	// Indirect dispatch buffer, set dispatch count to mesh triangle number
-	unique_ptr<Shader1D<uint>> ResetDispatchBufferShader;
+	// Indirect dispatch buffer, set dispatch count to the triangles of the visible draws of the batch
+	unique_ptr<Shader1D<>> ResetDispatchBufferShader;
 
 	// Clear visibility buffer and depth buffer
 	unique_ptr<Shader2D<>> ClearScreenShader;
 
-	// Vertex shader
-	unique_ptr<Shader1D<uint, uint>> VertexShader;
+	// Vertex shader of all visible draws, indirect
+	unique_ptr<Shader1D<>> VertexShader;
 
-	// Raster mesh and dispatch draw triangle kernel
-	unique_ptr<Shader1D<uint, uint, bool>> CullingTriangleShader;
+	// Raster mesh and dispatch draw triangle kernel, indirect
+	unique_ptr<Shader1D<>> CullingTriangleShader;
 
-	// Raster triangle to pixel shader
-	unique_ptr<Shader2D<uint, uint>> RasterTriangleShader;
+	// Raster triangle to pixel shaders, one per raster_stage
+	unique_ptr<Shader2D<uint>> RasterDepthShader;
+	unique_ptr<Shader2D<uint>> RasterClaimShader;
+	unique_ptr<Shader2D<uint>> RasterWriteShader;
 
 };
 };
@@ -15,11 +15,13 @@ struct visibility_buffer
 	// Buffer of geometry instance id
 	Image<uint> instance_id;
 
-	// Buffer of geometry triangle id
+	// Buffer of geometry triangle id, the LOD of the rastered mesh in the top bits
 	Image<uint> triangle_id;
 
 	// Buffer of geometry barycentric coordinates
 	Image<float> bary;
+
+	static constexpr uint lod_shift = 30u;
 };
 
 
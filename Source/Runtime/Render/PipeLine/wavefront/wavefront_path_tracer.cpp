@@ -0,0 +1,294 @@
+#include "wavefront_path_tracer.h"
+#include "Misc/Config.h"
+#include "Render/Core/frame.h"
+#include "Render/Core/math_function.h"
+#include "Render/Core/sample.h"
+#include "Render/Core/shadow_terminator.h"
+#include "Render/PipeLine/PathTracingScene.h"
+#include "Render/SceneProxy/CameraSceneProxy.h"
+#include "Render/SceneProxy/LightSceneProxy.h"
+#include "Render/SceneProxy/MaterialSceneProxy.h"
+#include "Render/sampler/sampler_base.h"
+
+namespace MechEngine::Rendering
+{
+wavefront_path_tracer::wavefront_path_tracer(PathTracingScene* InScene)
+: scene(InScene) {}
+
+void wavefront_path_tracer::LoadRenderSettings()
+{
+	MaxDepth = std::max(GConfig.Get<int>("PathTracing", "WavefrontMaxDepth"), 1);
+	SamplePerPixel = std::max(GConfig.Get<int>("Render", "SamplePerPixel"), 1);
+}
+
+void wavefront_path_tracer::CompileShader(ShaderCompiler& Compiler)
+{
+	auto& Device = Compiler.GetDevice();
+	auto WinSize = scene->GetWindosSize();
+	// Shaders are fixed once the scene compiles, as for the polymorphic dispatch of the megakernel
+	ShaderNum = static_cast<uint>(scene->GetMaterialProxy()->shader_call.size());
+	PathNum = WinSize.x * WinSize.y * SamplePerPixel;
+
+	paths = Device.create_buffer<path_state>(PathNum);
+	rays = Device.create_buffer<Ray>(PathNum);
+	hits = Device.create_buffer<RayCastHit>(PathNum);
+	first_hits = Device.create_buffer<RayCastHit>(PathNum);
+	shadow_rays = Device.create_buffer<shadow_ray>(PathNum);
+	queues = Device.create_buffer<uint>(static_cast<size_t>(PathNum) * (material_queue + ShaderNum));
+	queue_sizes = Device.create_buffer<uint>(material_queue + ShaderNum);
+	queue_dispatch_buffer = Device.create_indirect_dispatch_buffer(material_queue + ShaderNum);
+
+	Compiler.Compile(GeneratePathsShader, [&](const UInt& time) noexcept {
+		set_block_size(block_size, 1u, 1u);
+		generate_paths(time);
+	}, "WavefrontGeneratePaths");
+
+	Compiler.Compile(PrepareIntersectShader, [&]() noexcept {
+		queue_dispatch_buffer->set_dispatch_count(material_queue + ShaderNum);
+		queue_dispatch_buffer->set_kernel(ray_queue, make_uint3(block_size, 1u, 1u), make_uint3(queue_sizes->read(ray_queue), 1u, 1u), ray_queue);
+		for (uint i = 0; i < ShaderNum; i++)
+			queue_sizes->write(material_queue + i, 0u);
+	}, "WavefrontPrepareIntersect");
+
+	Compiler.Compile(IntersectShader, [&](const UInt& depth) noexcept {
+		set_block_size(block_size, 1u, 1u);
+		intersect_paths(depth);
+	}, "WavefrontIntersect");
+
+	Compiler.Compile(PrepareShadingShader, [&]() noexcept {
+		for (uint i = 0; i < ShaderNum; i++)
+		{
+			queue_dispatch_buffer->set_kernel(material_queue + i, make_uint3(block_size, 1u, 1u),
+				make_uint3(queue_sizes->read(material_queue + i), 1u, 1u), material_queue + i);
+		}
+		queue_sizes->write(ray_queue, 0u);
+		queue_sizes->write(shadow_queue, 0u);
+	}, "WavefrontPrepareShading");
+
+	ShadeShaders.resize(ShaderNum);
+	for (uint i = 0; i < ShaderNum; i++)
+	{
+		Compiler.Compile(ShadeShaders[i], [&, i](const UInt& depth, const UInt& time) noexcept {
+			set_block_size(block_size, 1u, 1u);
+			shade_paths(i, depth, time);
+		}, luisa::format("WavefrontShade_{}", i));
+	}
+
+	Compiler.Compile(PrepareShadowShader, [&]() noexcept {
+		queue_dispatch_buffer->set_kernel(shadow_queue, make_uint3(block_size, 1u, 1u), make_uint3(queue_sizes->read(shadow_queue), 1u, 1u), shadow_queue);
+	}, "WavefrontPrepareShadow");
+
+	Compiler.Compile(ShadowShader, [&]() noexcept {
+		set_block_size(block_size, 1u, 1u);
+		trace_shadow_rays();
+	}, "WavefrontShadowRays");
+
+	Compiler.Compile(ResolveShader, [&]() noexcept {
+		resolve_pixels();
+	}, "WavefrontResolve");
+}
+
+void wavefront_path_tracer::TracePass(CommandList& command_list, uint time) const
+{
+	command_list << (*GeneratePathsShader)(time).dispatch(PathNum);
+	for (uint depth = 0; depth < MaxDepth; depth++)
+	{
+		command_list
+			<< (*PrepareIntersectShader)().dispatch(1)
+			<< (*IntersectShader)(depth).dispatch(queue_dispatch_buffer, ray_queue, 1)
+			<< (*PrepareShadingShader)().dispatch(1);
+		for (uint i = 0; i < ShaderNum; i++)
+			command_list << (*ShadeShaders[i])(depth, time).dispatch(queue_dispatch_buffer, material_queue + i, 1);
+		command_list
+			<< (*PrepareShadowShader)().dispatch(1)
+			<< (*ShadowShader)().dispatch(queue_dispatch_buffer, shadow_queue, 1);
+	}
+	command_list << (*ResolveShader)().dispatch(scene->GetWindosSize());
+}
+
+void wavefront_path_tracer::generate_paths(const UInt& time) const
+{
+	auto path_id = dispatch_id().x;
+	auto view = scene->GetCameraProxy()->get_main_view();
+	// Same camera ray for every sample of the pixel as the megakernel
+	rays->write(path_id, view->generate_ray(make_float2(get_pixel_coord(path_id)) + 0.5f));
+
+	Var<path_state> path;
+	path.beta = make_float3(1.f);
+	path.radiance = make_float3(0.f);
+	path.albedo = make_float3(0.f);
+	path.pdf_bsdf = 1e16f;
+	paths->write(path_id, path);
+
+	// Every path starts in the ray queue
+	queues->write(ray_queue * PathNum + path_id, path_id);
+	$if(path_id == 0u)
+	{
+		queue_sizes->write(ray_queue, PathNum);
+	};
+}
+
+void wavefront_path_tracer::intersect_paths(const UInt& depth) const
+{
+	auto path_id = queues->read(ray_queue * PathNum + dispatch_id().x);
+	auto pixel_coord = get_pixel_coord(path_id);
+	auto ray = rays->read(path_id);
+	auto intersection = scene->intersect_bias(pixel_coord, ray, depth == 0u);
+	Var<RayCastHit> hit{intersection.instance_id, intersection.primitive_id, intersection.barycentric};
+	$if(depth == 0u)
+	{
+		first_hits->write(path_id, hit);
+	};
+
+	$if(intersection.valid())
+	{
+		$if(intersection.shape->has_light())
+		{
+			auto path = paths->read(path_id);
+			$if(depth == 0u)
+			{
+				auto light = scene->GetLightProxy()->get_light_data(intersection.shape.light_id);
+				path.radiance = light->light_color * light->intensity;
+			}
+			$else
+			{
+				auto [li, pdf] = scene->GetLightProxy()->l_i(intersection.shape.light_id, ray->origin(), intersection.position_world);
+				path.radiance += path.beta * li * balance_heuristic(path.pdf_bsdf, pdf);
+			};
+			paths->write(path_id, path);
+		}
+		$elif(intersection.shape->has_surface())
+		{
+			hits->write(path_id, hit);
+			auto shader_id = scene->GetMaterialProxy()->get_material_data(intersection.material_id).shader_id;
+			$switch(shader_id)
+			{
+				for (uint i = 0; i < ShaderNum; i++)
+				{
+					$case(i)
+					{
+						push(material_queue + i, path_id);
+					};
+				}
+			};
+		};
+	};
+}
+
+void wavefront_path_tracer::shade_paths(uint shader_id, const UInt& depth, const UInt& time) const
+{
+	auto path_id = queues->read((material_queue + shader_id) * PathNum + dispatch_id().x);
+	auto pixel_coord = get_pixel_coord(path_id);
+	auto ray = rays->read(path_id);
+	auto path = paths->read(path_id);
+	auto sampler = scene->get_sampler();
+	sampler->init(pixel_coord, xxhash32(make_uint3(time, path_id % SamplePerPixel, depth)));
+
+	auto intersection = resolve_hit(pixel_coord, ray, hits->read(path_id), depth);
+	auto material_data = scene->GetMaterialProxy()->get_material_data(intersection.material_id);
+	auto material = scene->GetMaterialProxy()->GetShader(shader_id);
+	auto bxdf_parameters = material->calc_material_parameters({intersection, material_data});
+
+	const auto& x = intersection.position_world;
+	auto normal = bxdf_parameters.normal;
+	auto w_o = normalize(-ray->direction());
+	auto frame = frame::make(intersection.corner_normal_world);
+	auto local_wo = frame.world_to_local(w_o);
+
+	$comment("Sample light, visibility is tested by the shadow ray kernel");
+	{
+		auto light_sample = scene->GetLightProxy()->sample_li(0u, x, sampler->generate_2d());
+		light_sample.w_i = normalize(light_sample.w_i);
+		auto cos = dot(light_sample.w_i, normal);
+		$if(cos > 0.01f & light_sample.pdf > 0.f)
+		{
+			auto local_wi = frame.world_to_local(light_sample.w_i);
+			auto brdf = material->bxdf(bxdf_parameters, local_wo, local_wi);
+			auto pdf = material->pdf(bxdf_parameters, local_wo, local_wi);
+			auto w = balance_heuristic(light_sample.pdf, pdf) / light_sample.pdf;
+			Var<shadow_ray> shadow;
+			shadow.ray = make_ray(x, light_sample.w_i, 0.01f, distance(light_sample.p_l, x) * 0.99f);
+			shadow.contribution = w * path.beta * brdf * light_sample.l_i;
+			shadow_rays->write(path_id, shadow);
+			push(shadow_queue, path_id);
+		};
+	}
+
+	$comment("Sample brdf");
+	{
+		auto [local_wi, pdf] = material->sample(bxdf_parameters, local_wo, sampler->generate_2d());
+		auto brdf = material->bxdf(bxdf_parameters, local_wo, local_wi);
+		path.pdf_bsdf = pdf;
+		path.beta *= ite(pdf > 0.f, 1.f / pdf, 0.f) * brdf;
+		$if(depth == 0u)
+		{
+			path.albedo = bxdf_parameters.base_color;
+		};
+		paths->write(path_id, path);
+
+		// The last bounce only samples the light
+		$if(depth + 1u < MaxDepth & any(path.beta > 0.f))
+		{
+			rays->write(path_id, make_ray(offset_ray_origin(x, normal), frame.local_to_world(local_wi)));
+			push(ray_queue, path_id);
+		};
+	}
+}
+
+void wavefront_path_tracer::trace_shadow_rays() const
+{
+	auto path_id = queues->read(shadow_queue * PathNum + dispatch_id().x);
+	auto shadow = shadow_rays->read(path_id);
+	$if(!scene->has_hit(shadow.ray))
+	{
+		auto path = paths->read(path_id);
+		path.radiance += shadow.contribution;
+		paths->write(path_id, path);
+	};
+}
+
+void wavefront_path_tracer::resolve_pixels() const
+{
+	auto pixel_coord = dispatch_id().xy();
+	auto first_path = (pixel_coord.x + pixel_coord.y * scene->GetWindosSize().x) * SamplePerPixel;
+	auto radiance = def(make_float3(0.f));
+	for (uint i = 0; i < SamplePerPixel; i++)
+		radiance += paths->read(first_path + i).radiance;
+
+	auto view = scene->GetCameraProxy()->get_main_view();
+	auto ray = view->generate_ray(make_float2(pixel_coord) + 0.5f);
+	auto first_intersection = resolve_hit(pixel_coord, ray, first_hits->read(first_path), 0u);
+	first_intersection.albedo = paths->read(first_path).albedo;
+	auto color = scene->resolve_path(pixel_coord, first_intersection, radiance / static_cast<float>(SamplePerPixel), true);
+	scene->frame_buffer()->write(pixel_coord, make_float4(color, 1.f));
+}
+
+ray_intersection wavefront_path_tracer::resolve_hit(const UInt2& pixel_coord, const Var<Ray>& ray, const Var<RayCastHit>& hit, const UInt& depth) const
+{
+	if (!scene->UseRasterizer())
+		return scene->intersect(hit, ray);
+	ray_intersection intersection;
+	$if(depth == 0u)
+	{
+		intersection = scene->intersect_bias(pixel_coord, ray, true);
+	}
+	$else
+	{
+		intersection = scene->intersect(hit, ray);
+	};
+	return intersection;
+}
+
+UInt2 wavefront_path_tracer::get_pixel_coord(const UInt& path_id) const
+{
+	auto pixel_index = path_id / SamplePerPixel;
+	auto width = scene->GetWindosSize().x;
+	return make_uint2(pixel_index % width, pixel_index / width);
+}
+
+void wavefront_path_tracer::push(uint queue_id, const UInt& path_id) const
+{
+	auto slot = queue_sizes->atomic(queue_id).fetch_add(1u);
+	queues->write(queue_id * PathNum + slot, path_id);
+}
+} // namespace MechEngine::Rendering
@@ -0,0 +1,113 @@
+#pragma once
+#include "Render/Core/RayCastHit.h"
+#include "Render/PipeLine/RenderPass.h"
+
+namespace MechEngine::Rendering
+{
+/** State of a path between the wavefront kernels */
+struct path_state
+{
+	float3 beta;
+	float3 radiance;
+	// Base color of the first hit, written to the G-Buffer
+	float3 albedo;
+	// Pdf of the bsdf sample that spawned the current ray, for MIS on light hits
+	float pdf_bsdf;
+};
+
+/** Light sample of a path waiting for its visibility test */
+struct shadow_ray
+{
+	Ray ray;
+	float3 contribution;
+};
+}
+
+LUISA_STRUCT(MechEngine::Rendering::path_state, beta, radiance, albedo, pdf_bsdf){};
+LUISA_STRUCT(MechEngine::Rendering::shadow_ray, ray, contribution){};
+
+namespace MechEngine::Rendering
+{
+using namespace luisa::compute;
+class PathTracingScene;
+struct ray_intersection;
+
+/**
+ * Wavefront path tracer, the megakernel of PathTracingScene split into one kernel per stage.
+ * Paths are generated once, then each bounce intersects the ray queue, shades each material queue with the kernel of its shader,
+ * and traces the shadow rays of the light samples. Queues are compacted by atomics and dispatched indirectly,
+ * so a kernel only runs over the paths that reached its stage and a bounce costs no registers of the previous one.
+ */
+class wavefront_path_tracer : public RenderPass
+{
+public:
+	explicit wavefront_path_tracer(PathTracingScene* InScene);
+
+	virtual void LoadRenderSettings() override;
+
+	virtual void CompileShader(ShaderCompiler& Compiler) override;
+
+	/**
+	 * Trace all the paths of the frame and write the frame buffer and the G-Buffer
+	 * @param time the sampler seed of the frame
+	 */
+	void TracePass(CommandList& command_list, uint time) const;
+
+	[[nodiscard]] FORCEINLINE uint GetMaxDepth() const noexcept { return MaxDepth; }
+
+	// Kernels of each bounce read the queue sizes from the indirect arguments
+	static constexpr uint block_size = 256;
+
+protected:
+	enum queue : uint
+	{
+		ray_queue = 0,
+		shadow_queue = 1,
+		// One material queue per shader from here
+		material_queue = 2,
+	};
+
+	void generate_paths(const UInt& time) const;
+
+	void intersect_paths(const UInt& depth) const;
+
+	void shade_paths(uint shader_id, const UInt& depth, const UInt& time) const;
+
+	void trace_shadow_rays() const;
+
+	void resolve_pixels() const;
+
+	/** Surface of a queued path, the first hit comes from the visibility buffer when rasterized */
+	[[nodiscard]] ray_intersection resolve_hit(const UInt2& pixel_coord, const Var<Ray>& ray, const Var<RayCastHit>& hit, const UInt& depth) const;
+
+	[[nodiscard]] UInt2 get_pixel_coord(const UInt& path_id) const;
+
+	/** Append a path to a queue */
+	void push(uint queue_id, const UInt& path_id) const;
+
+	PathTracingScene* scene;
+	uint MaxDepth = 2;
+	uint ShaderNum = 0;
+	uint PathNum = 0;
+	uint SamplePerPixel = 1;
+
+	Buffer<path_state> paths;
+	Buffer<Ray> rays;
+	Buffer<RayCastHit> hits;
+	Buffer<RayCastHit> first_hits;
+	Buffer<shadow_ray> shadow_rays;
+	// PathNum entries for each queue
+	Buffer<uint> queues;
+	Buffer<uint> queue_sizes;
+	IndirectDispatchBuffer queue_dispatch_buffer;
+
+	unique_ptr<Shader1D<uint>> GeneratePathsShader;
+	unique_ptr<Shader1D<>> PrepareIntersectShader;
+	unique_ptr<Shader1D<uint>> IntersectShader;
+	unique_ptr<Shader1D<>> PrepareShadingShader;
+	vector<unique_ptr<Shader1D<uint, uint>>> ShadeShaders;
+	unique_ptr<Shader1D<>> PrepareShadowShader;
+	unique_ptr<Shader1D<>> ShadowShader;
+	unique_ptr<Shader2D<>> ResolveShader;
+};
+};
@@ -14,16 +14,19 @@ namespace MechEngine::Rendering
 {
 wireframe_pass::wireframe_pass(GpuScene& InScene): Scene(InScene) {}
 
-void wireframe_pass::CompileShader(Device& device, bool bDebugInfo)
+void wireframe_pass::CompileShader(ShaderCompiler& Compiler)
 {
-	WireFrameShader = luisa::make_unique<Shader2D<>>(device.compile<2>(
+	Compiler.Compile(WireFrameShader,
 		[&]() noexcept {
 		auto pixel = dispatch_id().xy();
-		auto intensity = wireframe_intensity(pixel);
-		auto frame_color = Scene.frame_buffer()->read(pixel).xyz();
-		frame_color = lerp(frame_color, wireframe_color, intensity);
+		auto frame_color = blend(pixel, Scene.frame_buffer()->read(pixel).xyz());
 		Scene.frame_buffer()->write(pixel, make_float4(frame_color, 1.f));
-	}, ShaderOption{.enable_debug_info = bDebugInfo, .name = "WireFramePass"}));
+	}, "WireFramePass");
+}
+
+Float3 wireframe_pass::blend(const UInt2& pixel_coord, const Float3& frame_color) const
+{
+	return lerp(frame_color, wireframe_color, wireframe_intensity(pixel_coord));
 }
 
 void wireframe_pass::PostPass(CommandList& command_list) const
@@ -41,10 +44,11 @@ Float wireframe_pass::wireframe_intensity
 	//@see https://www2.imm.dtu.dk/pubdb/edoc/imm4884.pdf
 
 	auto wireframe_intensity = def(0.f);
-	auto instance_id = Scene.get_gbuffer().instance_id->read(pixel_coord).x;
+	auto visibility = Scene.get_gbuffer().read_visibility(pixel_coord);
+	auto instance_id = visibility.x;
 	$if(instance_id != ~0u)
 	{
-		auto primitive_id = Scene.get_gbuffer().primitive_id->read(pixel_coord).x;
+		auto primitive_id = visibility.y;
 		auto pixel_pos = make_float2(pixel_coord) + 0.5f;
 		auto shape = Scene.GetShapeProxy()->get_instance_shape(instance_id);
 		$if(shape->is_mesh())
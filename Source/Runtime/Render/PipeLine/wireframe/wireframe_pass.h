@@ -14,13 +14,12 @@ class wireframe_pass : public RenderPass
 public:
 	wireframe_pass(GpuScene& InScene);
 
-	virtual void CompileShader(luisa::compute::Device& Device, bool bDebugInfo) override;
+	virtual void CompileShader(ShaderCompiler& Compiler) override;
 	virtual void PostPass(luisa::compute::CommandList& command_list) const override;
 
-protected:
-	luisa::float3 wireframe_color = luisa::make_float3(0.f);
+	/** Blend the wireframe of the first intersection over the frame color */
+	[[nodiscard]] luisa::compute::Float3 blend(const luisa::compute::UInt2& pixel_coord, const luisa::compute::Float3& frame_color) const;
 
-	GpuScene& Scene;
 	/**
 	 * Draw wireframe pass, blend  with the pixel color as Anti-aliasing
 	 * Currently, we only draw the first intersection with the wireframe, which means
@@ -30,6 +29,11 @@ protected:
 	 */
 	luisa::compute::Float wireframe_intensity(luisa::compute::UInt2 pixel_coord) const;
 
+protected:
+	luisa::float3 wireframe_color = luisa::make_float3(0.f);
+
+	GpuScene& Scene;
+
 	eastl::unique_ptr<luisa::compute::Shader2D<>> WireFrameShader;
 
 };
@@ -6,6 +6,7 @@
 #include "Components/CameraComponent.h"
 #include "Render/Core/TypeConvertion.h"
 #include "Render/PipeLine/GpuScene.h"
+#include "Misc/Profiler.h"
 
 namespace MechEngine::Rendering
 {
@@ -65,7 +66,7 @@ FMatrix4 CameraSceneProxy::GetProjectionMatrix(uint Index) const
 	return MainCameraComponent->GetProjectionMatrix();
 }
 
-void CameraSceneProxy::UploadDirtyData(Stream& stream)
+void CameraSceneProxy::CollectDirtyData()
 {
 	if(!MainCameraComponent)
 	{
@@ -73,21 +74,28 @@ void CameraSceneProxy::UploadDirtyData(Stream& stream)
 		exit(0);
 		return;
 	}
+	if (!bDirty)
+		return;
+	CollectedView = GetCurrentViewData();
+	bViewCollected = true;
+	bCollectedFirstFrame = bFirstFrame;
+	bFirstFrame = false;
+	bDirty = false;
+}
+
+void CameraSceneProxy::UploadDirtyData(Stream& stream)
+{
 	CurrentView.last_view_projection_matrix = CurrentView.view_projection_matrix;
-	if (bDirty)
+	if (bViewCollected)
 	{
 		auto last_vp = CurrentView.view_projection_matrix;
-		CurrentView = GetCurrentViewData();
-		CurrentView.last_view_projection_matrix = last_vp;
-		if(bFirstFrame)
-		{
-			CurrentView.last_view_projection_matrix = CurrentView.view_projection_matrix;
-			bFirstFrame = false;
-		}
+		CurrentView = CollectedView;
+		CurrentView.last_view_projection_matrix = bCollectedFirstFrame ? CurrentView.view_projection_matrix : last_vp;
+		bViewCollected = false;
 		Scene.ResetFrameCounter();
 	}
+	PROFILE_COUNTER("UploadBytes", sizeof(CurrentView));
 	stream << view_buffer.copy_from(&CurrentView);
-	bDirty = false;
 }
 
 }
\ No newline at end of file
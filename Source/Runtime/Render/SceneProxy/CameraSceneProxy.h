@@ -25,8 +25,14 @@ public:
 
 	~CameraSceneProxy() override = default;
 
+	bool IsDirty() override { return bDirty; }
+
+	void CollectDirtyData() override;
+
 	void UploadDirtyData(Stream& stream) override;
 
+	size_t GetGpuMemoryBytes() const override { return view_buffer.size_bytes(); }
+
 	/**
 	 * Add a new camera to the scene and bind the corresponding transform
 	 * @param InCameraComponent CameraComponent to add
@@ -75,6 +81,11 @@ protected:
 	uint TransformID = 0;
 	CameraComponent* MainCameraComponent = nullptr;
 
+	// View read from the camera under the world lock, applied by the upload
+	bool bViewCollected = false;
+	bool bCollectedFirstFrame = false;
+	view CollectedView;
+
 	view CurrentView;
 };
 }
\ No newline at end of file
@@ -11,6 +11,7 @@
 #include "Render/Core/TypeConvertion.h"
 #include "Render/light/lights.h"
 #include "Render/PipeLine/GpuScene.h"
+#include "Misc/Profiler.h"
 
 namespace MechEngine::Rendering
 {
@@ -74,12 +75,22 @@ void LightSceneProxy::UpdateLight(LightComponent* InLight, uint LightId, uint In
 }
 
 
-void LightSceneProxy::UploadDirtyData(Stream& stream)
+void LightSceneProxy::CollectDirtyData()
 {
 	if (!bDirty)
 		return;
 	bDirty = false;
-	stream << light_buffer.copy_from(LightDatas.data());
+	bLightsCollected = true;
+	CollectedLightDatas.assign(LightDatas.begin(), LightDatas.begin() + IdCounter);
+}
+
+void LightSceneProxy::UploadDirtyData(Stream& stream)
+{
+	if (!bLightsCollected || CollectedLightDatas.empty())
+		return;
+	bLightsCollected = false;
+	PROFILE_COUNTER("UploadBytes", CollectedLightDatas.size() * sizeof(light_data));
+	stream << light_buffer.subview(0, CollectedLightDatas.size()).copy_from(CollectedLightDatas.data());
 }
 
 light_li_sample LightSceneProxy::sample_li(const UInt& light_id, const Float3& x, const Float2& u) const
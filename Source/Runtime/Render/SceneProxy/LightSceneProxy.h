@@ -42,8 +42,14 @@ public:
 	 */
 	uint GetLightTypeTag(LightComponent* InLight) const;
 
+	virtual bool IsDirty() override { return bDirty; }
+
+	virtual void CollectDirtyData() override;
+
 	virtual void UploadDirtyData(Stream& stream) override;
 
+	virtual size_t GetGpuMemoryBytes() const override { return light_buffer.size_bytes(); }
+
 	[[nodiscard]] FORCEINLINE uint LightCount() const
 	{
 		return IdCounter;
@@ -82,5 +88,9 @@ protected:
 	uint rectangle_light_tag;
 
 	bool bDirty = false;
+
+	// Collected for the upload
+	bool bLightsCollected = false;
+	vector<light_data> CollectedLightDatas;
 };
 }
\ No newline at end of file
@@ -9,6 +9,7 @@
 #include "Render/Core/view.h"
 #include "Render/Core/math_function.h"
 #include "Render/PipeLine/GpuScene.h"
+#include "Misc/Profiler.h"
 
 namespace MechEngine::Rendering
 {
@@ -29,35 +30,55 @@ namespace MechEngine::Rendering
     	return Points.size() - 1;
 	}
 
-	void LineSceneProxy::UploadDirtyData(Stream& stream)
+	void LineSceneProxy::CollectDirtyData()
 	{
 		if (bPointsUpdated)
 		{
-			if (Points.size() > points_data_buffer.size())
+			RenderPoints = Points;
+			bRenderPointsUpdated = true;
+			bPointsUpdated = false;
+		}
+		if (bLinesUpdated)
+		{
+			RenderLines = Lines;
+			bRenderLinesUpdated = true;
+			bLinesUpdated = false;
+		}
+	}
+
+	void LineSceneProxy::UploadDirtyData(Stream& stream)
+	{
+		if (bRenderPointsUpdated)
+		{
+			if (RenderPoints.size() > points_data_buffer.size())
 			{
-				points_data_buffer = Scene.RegisterBuffer<point_data>(Points.capacity());
+				const size_t PointCapacity = std::max<size_t>(RenderPoints.size(), points_data_buffer.size() * 2);
+				Scene.DeferredDestroy(points_data_buffer);
+				points_data_buffer = Scene.RegisterBuffer<point_data>(PointCapacity);
 				Scene.GetBindlessArray().emplace_on_update(points_data_bindless_id, points_data_buffer);
-				ASSERT(points_data_buffer.size() == Points.capacity());
-				LOG_WARNING("Point render buffer is full, resize to {0}", Points.capacity());
+				LOG_WARNING("Point render buffer is full, resize to {0}", PointCapacity);
 				LOG_WARNING("Current point  data buffer size: {0} MB", points_data_buffer.size_bytes() / 1024. / 1024.);
 			}
 
-			stream << points_data_buffer.subview(0, Points.size()).copy_from(Points.data());
-			bPointsUpdated = false;
+			PROFILE_COUNTER("UploadBytes", RenderPoints.size() * sizeof(point_data));
+			stream << points_data_buffer.subview(0, RenderPoints.size()).copy_from(RenderPoints.data());
+			bRenderPointsUpdated = false;
 		}
-    	if (bLinesUpdated)
+    	if (bRenderLinesUpdated)
 		{
-    		if (Lines.size() > lines_data_buffer.size())
+    		if (RenderLines.size() > lines_data_buffer.size())
     		{
-    			lines_data_buffer = Scene.RegisterBuffer<lines_data>(Lines.capacity());
+    			const size_t LineCapacity = std::max<size_t>(RenderLines.size(), lines_data_buffer.size() * 2);
+    			Scene.DeferredDestroy(lines_data_buffer);
+    			lines_data_buffer = Scene.RegisterBuffer<lines_data>(LineCapacity);
     			Scene.GetBindlessArray().emplace_on_update(lines_data_bindless_id, lines_data_buffer);
-    			ASSERT(lines_data_buffer.size() == Lines.capacity());
-    			LOG_WARNING("Line render buffer is full, resize to {0}", Lines.capacity());
+    			LOG_WARNING("Line render buffer is full, resize to {0}", LineCapacity);
     			LOG_WARNING("Current line data buffer size: {0} MB", lines_data_buffer.size_bytes() / 1024. / 1024.);
     		}
 
-			stream << lines_data_buffer.subview(0, Lines.size()).copy_from(Lines.data()) << synchronize();
-			bLinesUpdated = false;
+			PROFILE_COUNTER("UploadBytes", RenderLines.size() * sizeof(lines_data));
+			stream << lines_data_buffer.subview(0, RenderLines.size()).copy_from(RenderLines.data()) << synchronize();
+			bRenderLinesUpdated = false;
 		}
 	}
 
@@ -149,7 +170,7 @@ namespace MechEngine::Rendering
     		};
     	};
 
-		DrawPointsShader = luisa::make_unique<Shader1D<>>(Scene.RegisterShader<1>(
+		Scene.GetShaderCompiler().Compile(DrawPointsShader,
 			[&]() {
 				$comment("DrawPointsShader");
 				auto view = Scene.GetCameraProxy()->get_main_view();
@@ -159,9 +180,9 @@ namespace MechEngine::Rendering
 				auto ndc_position = view->world_to_ndc(world_position);
 				auto screen_position = view->ndc_to_pixel(ndc_position);
 				raster_point(view, make_float3(screen_position, ndc_position.z), point.radius, point.color);
-			}, "DrawPointShader"));
+			}, "DrawPointShader");
 
-    	DrawLineShader = luisa::make_unique<Shader2D<>>(Scene.RegisterShader<2>(
+    	Scene.GetShaderCompiler().Compile(DrawLineShader,
 			[&]() {
 				$comment("DrawLineShader");
 				auto view = Scene.GetCameraProxy()->get_main_view();
@@ -183,19 +204,19 @@ namespace MechEngine::Rendering
 					auto segment_end = lerp(ndc_start, ndc_end, Float(segment_id + 1) / segments);
 					raster_line(view, segment_start, segment_end, line.thickness, line.color);
 				};
-			}, "DrawLineShader"));
+			}, "DrawLineShader");
 	}
 
 	void LineSceneProxy::PostRenderPass(CommandList& CmdList)
 	{
     	static int NThreadPerLine = 16; // for each line, how many thread should be used
-    	if (!Points.empty())
+    	if (!RenderPoints.empty())
     	{
-    		CmdList << (*DrawPointsShader)().dispatch(Points.size());
+    		CmdList << (*DrawPointsShader)().dispatch(RenderPoints.size());
     	}
-    	if (!Lines.empty())
+    	if (!RenderLines.empty())
 		{
-			CmdList << (*DrawLineShader)().dispatch(Lines.size(), NThreadPerLine);
+			CmdList << (*DrawLineShader)().dispatch(RenderLines.size(), NThreadPerLine);
 		}
 	}
 }
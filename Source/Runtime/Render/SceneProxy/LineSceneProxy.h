@@ -56,8 +56,12 @@ namespace MechEngine::Rendering
     public:
         explicit LineSceneProxy(GpuScene& InScene) noexcept;
 
+        virtual void CollectDirtyData() override;
+
         virtual void UploadDirtyData(Stream& stream) override;
 
+        virtual size_t GetGpuMemoryBytes() const override { return lines_data_buffer.size_bytes() + points_data_buffer.size_bytes(); }
+
 		uint AddLine(float3 WorldStart, float3 WorldEnd, float Thickness, float3 Color);
         //
         // void RemoveLines();
@@ -96,6 +100,12 @@ namespace MechEngine::Rendering
     	vector<lines_data> Lines;
     	map<uint, uint> PointIdToIndex;
 
+    	// Copies of the points and lines for the upload and the draw passes
+    	bool bRenderPointsUpdated = false;
+    	bool bRenderLinesUpdated = false;
+    	vector<point_data> RenderPoints;
+    	vector<lines_data> RenderLines;
+
 
     };
 }
\ No newline at end of file
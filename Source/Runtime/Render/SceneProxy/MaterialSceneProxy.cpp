@@ -7,6 +7,7 @@
 #include "Render/material/blinn_phong_material.h"
 #include "Render/material/disney_material.h"
 #include "Render/PipeLine/GpuScene.h"
+#include "Misc/Profiler.h"
 
 namespace MechEngine::Rendering
 {
@@ -50,13 +51,25 @@ void MaterialSceneProxy::UpdateMaterial(Material* InMaterial)
 	MaterialDataVector[ID] = material_data(ShaderID, InMaterial);
 }
 
-void MaterialSceneProxy::UploadDirtyData(Stream& stream)
+void MaterialSceneProxy::CollectDirtyData()
 {
 	if (!bNeedUpdate)
 		return;
 	bNeedUpdate = false;
-	stream << material_data_buffer.subview(0, MaterialDataVector.size())
-				  .copy_from(MaterialDataVector.data());
+	bMaterialsCollected = true;
+	CollectedMaterials = MaterialDataVector;
+	bHasWireframeMaterial = std::ranges::any_of(CollectedMaterials,
+		[](const material_data& Data) { return Data.show_wireframe != 0; });
+}
+
+void MaterialSceneProxy::UploadDirtyData(Stream& stream)
+{
+	if (!bMaterialsCollected)
+		return;
+	bMaterialsCollected = false;
+	PROFILE_COUNTER("UploadBytes", CollectedMaterials.size() * sizeof(material_data));
+	stream << material_data_buffer.subview(0, CollectedMaterials.size())
+				  .copy_from(CollectedMaterials.data());
 }
 
 uint MaterialSceneProxy::RegisterShader(luisa::unique_ptr<shader_base>&& Shader)
@@ -47,8 +47,17 @@ public:
 	 */
 	FORCEINLINE bool ShaderValid(uint ShaderId) const;
 
+	virtual bool IsDirty() override { return bNeedUpdate; }
+
+	virtual void CollectDirtyData() override;
+
 	virtual void UploadDirtyData(Stream& stream) override;
 
+	virtual size_t GetGpuMemoryBytes() const override { return material_data_buffer.size_bytes(); }
+
+	/** Whether any uploaded material shows its wireframe, the wireframe pass can be skipped otherwise */
+	[[nodiscard]] FORCEINLINE bool HasWireframeMaterial() const { return bHasWireframeMaterial; }
+
 public:
 	/**
 	 * Create a shader and return the pointer to the shader
@@ -121,6 +130,11 @@ protected:
 
 	THashMap<class Material*, uint>	MaterialIDMap;
 	bool bNeedUpdate = false;
+
+	// Collected for the upload, the world keeps editing MaterialDataVector
+	bool bMaterialsCollected = false;
+	vector<material_data> CollectedMaterials;
+	bool bHasWireframeMaterial = false;
 };
 
 template <class T, class... Args>
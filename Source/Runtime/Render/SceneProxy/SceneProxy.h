@@ -25,6 +25,8 @@ namespace MechEngine::Rendering
 // A scene proxy is a data structure that holds the data for collection of a specific type of scene object, like a light or a camera.
 // Usually should provide a AddXXX and UpdateXXX function to add or update to the proxy;
 // It is used to upload the data to the GPU, and to keep track of what data has changed.
+// AddXXX and UpdateXXX are called by the world, CollectDirtyData copies their changes into render owned data under the world lock,
+// UploadDirtyData and the passes only read the collected data so they can run while the world ticks.
 class ENGINE_API SceneProxy
 {
 public:
@@ -35,9 +37,13 @@ public:
 	virtual void Init() {}
 	virtual bool IsDirty() { return false; }
 	virtual void CompileShader() {}
+	/** Copy what the world changed since the last frame into render owned data, called under the world lock */
+	virtual void CollectDirtyData() {}
 	virtual void UploadDirtyData(luisa::compute::Stream& stream) = 0;
 	virtual void PreRenderPass(luisa::compute::CommandList& CmdList) {}
 	virtual void PostRenderPass(luisa::compute::CommandList& CmdList) {}
+	/** Bytes of the GPU buffers owned by the proxy, BLAS memory is not included */
+	[[nodiscard]] virtual size_t GetGpuMemoryBytes() const { return 0; }
 
 protected:
 	template<typename T, typename I>
@@ -4,6 +4,7 @@
 
 #include "ShapeSceneProxy.h"
 #include "Render/PipeLine/GpuScene.h"
+#include "Misc/Profiler.h"
 
 namespace MechEngine::Rendering
 {
@@ -15,12 +16,32 @@ ShapeSceneProxy::ShapeSceneProxy(GpuScene& InScene)
 	std::tie(instance_shape, buffer_bindless_id) = InScene.RegisterBindlessBuffer<shape>(InScene.MaxInstanceNum);
 }
 
-void ShapeSceneProxy::UploadDirtyData(Stream& stream)
+void ShapeSceneProxy::CollectDirtyData()
 {
+	CollectedAccelOps.insert(CollectedAccelOps.end(), AccelOps.begin(), AccelOps.end());
+	AccelOps.clear();
 	if (!bDirty) return;
 	bDirty = false;
+	bShapesCollected = true;
+	CollectedShapes.assign(InstanceShapes.begin(), InstanceShapes.begin() + InstanceNum);
+}
+
+void ShapeSceneProxy::UploadDirtyData(Stream& stream)
+{
+	for (const AccelOp& Op : CollectedAccelOps)
+	{
+		if (Op.bEmplace)
+			accel.emplace_back_handle(0, {}, {}, Op.bVisible, 0);
+		else
+			accel.set_visibility_on_update(Op.InstanceID, Op.bVisible);
+	}
+	CollectedAccelOps.clear();
+
+	if (!bShapesCollected || CollectedShapes.empty()) return;
+	bShapesCollected = false;
 
-	stream << instance_shape.copy_from(InstanceShapes.data());
+	PROFILE_COUNTER("UploadBytes", CollectedShapes.size() * sizeof(shape));
+	stream << instance_shape.subview(0, CollectedShapes.size()).copy_from(CollectedShapes.data());
 }
 
 void ShapeSceneProxy::SetInstanceLightID(uint InstanceID, uint LightID)
@@ -35,32 +56,32 @@ void ShapeSceneProxy::SetInstanceMeshID(uint InstanceID, uint MeshID)
 	bDirty = true;
 }
 
-uint ShapeSceneProxy::RegisterInstance() const
+uint ShapeSceneProxy::RegisterInstance()
 {
-	accel.emplace_back_handle(0, {}, {}, false, 0);
-	auto instance_id = accel.size() - 1;
-	ASSERTMSG(instance_id < Scene.MaxInstanceNum, "Instance number exceeds the maximum limit.");
-	return instance_id;
+	ASSERTMSG(InstanceNum < Scene.MaxInstanceNum, "Instance number exceeds the maximum limit.");
+	const uint InstanceID = InstanceNum++;
+	AccelOps.push_back({InstanceID, false, true});
+	return InstanceID;
 }
 
-void ShapeSceneProxy::RemoveInstance(uint InstanceID) const
+void ShapeSceneProxy::RemoveInstance(uint InstanceID)
 {
-	if (InstanceID >= accel.size())
+	if (InstanceID >= InstanceNum)
 	{
-		LOG_ERROR("Trying to remove an instance that does not exist. ID {} >= {}", InstanceID, accel.size());
+		LOG_ERROR("Trying to remove an instance that does not exist. ID {} >= {}", InstanceID, InstanceNum);
 		return;
 	}
-	accel.set_visibility_on_update(InstanceID, false);
+	AccelOps.push_back({InstanceID, false, false});
 }
 
 void ShapeSceneProxy::SetInstanceVisibility(uint InstanceID, bool bVisible)
 {
-	if (InstanceID >= accel.size())
+	if (InstanceID >= InstanceNum)
 	{
-		LOG_ERROR("Trying to remove an instance that does not exist. ID {} >= {}", InstanceID, accel.size());
+		LOG_ERROR("Trying to remove an instance that does not exist. ID {} >= {}", InstanceID, InstanceNum);
 		return;
 	}
-	accel.set_visibility_on_update(InstanceID, bVisible);
+	AccelOps.push_back({InstanceID, bVisible, false});
 }
 
 } // namespace MechEngine::Rendering
\ No newline at end of file
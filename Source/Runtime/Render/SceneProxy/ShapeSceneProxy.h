@@ -15,8 +15,14 @@ class ENGINE_API ShapeSceneProxy : public SceneProxy
 public:
 	ShapeSceneProxy(GpuScene& InScene);
 
+	bool IsDirty() override { return bDirty || !AccelOps.empty(); }
+
+	void CollectDirtyData() override;
+
 	void UploadDirtyData(Stream& stream) override;
 
+	size_t GetGpuMemoryBytes() const override { return instance_shape.size_bytes(); }
+
 	/**
 	 * Set an instance as a light
 	 * @param InstanceID instance id
@@ -32,16 +38,20 @@ public:
 	void SetInstanceMeshID(uint InstanceID, uint MeshID);
 
 	/**
-	 * Register a new instance, need to set shape information later
+	 * Register a new instance, need to set shape information later.
+	 * The instance is added to the accel when the frame is uploaded
 	 * @return the instance id
 	 */
-	[[nodiscard]] uint RegisterInstance() const;
+	[[nodiscard]] uint RegisterInstance();
 
 	/**
 	 * Remove an instance
 	 * @param InstanceID instance id
 	 */
-	void RemoveInstance(uint InstanceID) const;
+	void RemoveInstance(uint InstanceID);
+
+	/** Number of registered instances, including the ones not uploaded yet */
+	[[nodiscard]] FORCEINLINE uint GetInstanceNum() const noexcept { return InstanceNum; }
 
 	/**
 	 * Set the visibility of the instance
@@ -58,9 +68,24 @@ public:
 	}
 
 protected:
+	/** Instance added to or shown and hidden in the accel, deferred to the upload so the world never touches the accel */
+	struct AccelOp
+	{
+		uint InstanceID;
+		bool bVisible;
+		bool bEmplace;
+	};
+
 	bool bDirty = true;
 	uint buffer_bindless_id;
 	BufferView<shape> instance_shape;
+	uint InstanceNum = 0;
 	vector<shape> InstanceShapes;
+	vector<AccelOp> AccelOps;
+
+	// Collected for the upload
+	bool bShapesCollected = false;
+	vector<shape> CollectedShapes;
+	vector<AccelOp> CollectedAccelOps;
 };
 }
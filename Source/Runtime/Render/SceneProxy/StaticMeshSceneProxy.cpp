@@ -3,23 +3,61 @@
 //
 
 #include "StaticMeshSceneProxy.h"
+#include <cstring>
 #include "MaterialSceneProxy.h"
 #include "ShapeSceneProxy.h"
 #include "TransformProxy.h"
 #include "Components/StaticMeshComponent.h"
 #include "Mesh/BasicShapesLibrary.h"
 #include "Render/PipeLine/GpuScene.h"
+#include "Misc/Config.h"
+#include "Misc/Profiler.h"
 #include "Core/Mesh/StaticMesh.h"
+#include "Core/Mesh/MeshSimplification.h"
 
 namespace MechEngine::Rendering
 {
 
+namespace
+{
+	/** Streaming hash of geometry bytes, FNV-1a over words along with std::hash */
+	struct GeometryHasher
+	{
+		uint64_t Fnv = 0xcbf29ce484222325ull;
+		uint64_t Mix = 0x9e3779b97f4a7c15ull;
+
+		void Update(const void* Data, size_t Size)
+		{
+			auto Bytes = static_cast<const char*>(Data);
+			size_t i = 0;
+			for (; i + sizeof(uint64_t) <= Size; i += sizeof(uint64_t))
+			{
+				uint64_t Word;
+				std::memcpy(&Word, Bytes + i, sizeof(uint64_t));
+				Fnv = (Fnv ^ Word) * 0x100000001b3ull;
+			}
+			for (; i < Size; i++)
+				Fnv = (Fnv ^ static_cast<uint8_t>(Bytes[i])) * 0x100000001b3ull;
+			const uint64_t Hash = std::hash<std::string_view>{}(std::string_view(Bytes, Size));
+			Mix ^= Hash + 0x9e3779b97f4a7c15ull + (Mix << 6) + (Mix >> 2);
+			// Sizes are part of the content, a vertex buffer must not continue into the triangle buffer
+			Fnv = (Fnv ^ Size) * 0x100000001b3ull;
+		}
+	};
+
+	// Meshes below this are cheap enough to raster at full detail
+	constexpr int MinLODFaceNum = 256;
+}
+
 StaticMeshSceneProxy::StaticMeshSceneProxy(GpuScene& InScene)
-	: SceneProxy(InScene)
+	: SceneProxy(InScene), MaxStaticMeshNum(InScene.MaxStaticMeshNum)
 {
-	StaticMeshData.resize(InScene.MaxStaticMeshNum);
+	LODBuildDelay = std::max(GConfig.Get<int>("DeferredShading", "LODBuildDelay"), 0);
+	ASSERTMSG(MaxLODNum * MaxStaticMeshNum <= InScene.MaxInstanceNum, "Static mesh data buffer can not hold {} LODs", MaxLODNum);
+	StaticMeshData.resize(MaxLODNum * MaxStaticMeshNum);
 	MeshResources.resize(InScene.MaxStaticMeshNum);
 	MeshInstances.resize(InScene.MaxStaticMeshNum);
+	MeshGeometry.resize(InScene.MaxStaticMeshNum);
 	std::tie(data_buffer, data_buffer_id) = Scene.RegisterBindlessBuffer<static_mesh_data>(InScene.MaxInstanceNum);
 
 	{
@@ -42,7 +80,20 @@ uint StaticMeshSceneProxy::AddStaticMesh(StaticMesh* InMesh)
 		LOG_WARNING("Trying to add a null mesh to the scene.");
 		return ~0u;
 	}
-	auto Id = ++MeshIdCounter;
+	uint Id;
+	if (!FreeMeshIds.empty())
+	{
+		Id = FreeMeshIds.back();
+		FreeMeshIds.pop_back();
+	}
+	else if (MeshIdCounter + 1 < Scene.MaxStaticMeshNum)
+		Id = ++MeshIdCounter;
+	else
+	{
+		LOG_ERROR("Static mesh number exceeds the limit {}.", Scene.MaxStaticMeshNum);
+		return ~0u;
+	}
+	LiveMeshIds.insert(Id);
 	CommandQueue.emplace_back(Create, Id, 0, InMesh);
 	return Id;
 }
@@ -69,12 +120,49 @@ void StaticMeshSceneProxy::BindInstance(uint MeshID, uint InstanceID)
 
 void StaticMeshSceneProxy::RemoveStaticMesh(uint MeshId)
 {
+	// Components without geometry never got an id
+	if (MeshId == ~0u)
+		return;
+	if (MeshId > MeshIdCounter)
+	{
+		LOG_WARNING("Trying to remove a mesh that does not exist. ID {}", MeshId);
+		return;
+	}
 	CommandQueue.emplace_back(Delete, MeshId, 0, nullptr);
 }
 
+void StaticMeshSceneProxy::CollectDirtyData()
+{
+	for (auto& [Type, Id1, Id2, MeshPtr] : CommandQueue)
+	{
+		RenderCommand Command{Type, Id1, Id2};
+		if (Type == Create || Type == Update)
+		{
+			if (!MeshPtr || MeshPtr->IsEmpty())
+			{
+				LOG_ERROR("{} an empty mesh to scene: {}", Type == Create ? "Add" : "Update", MeshPtr ? MeshPtr->GetName() : "");
+				continue;
+			}
+			Command.MaterialId = Scene.GetMaterialProxy()->AddMaterial(MeshPtr->GetMaterial());
+			Command.Info = {Math::FBox3f(MeshPtr->GetBoundingBox()), MeshPtr->IsBackFaceCulling()};
+			Command.Geometry = GetFlattenMeshData(MeshPtr);
+			if (Scene.UseMeshLOD())
+				Command.LODSource = MakeShared<LODSourceData>(LODSourceData{MeshPtr->verM, MeshPtr->triM,
+					MeshPtr->HasValidUV() ? MeshPtr->GetUV() : MatrixX2d()});
+		}
+		// The id is free once its delete is queued, commands queued before still refer to the old mesh
+		else if (Type == Delete && LiveMeshIds.erase(Id1) > 0)
+			FreeMeshIds.push_back(Id1);
+		RenderCommands.push_back(std::move(Command));
+	}
+	CommandQueue.clear();
+	CollectedMeshIdCounter = MeshIdCounter;
+}
+
 void StaticMeshSceneProxy::UploadDirtyData(Stream& stream)
 {
 	bFrameUpdated = false;
+	UploadFrame++;
 
 	static std::once_flag init_null_mesh_flag;
 	std::call_once(init_null_mesh_flag, [&]()
@@ -82,115 +170,58 @@ void StaticMeshSceneProxy::UploadDirtyData(Stream& stream)
 		stream << NullMesh->build();
 	});
 
-	for (auto& Command : CommandQueue)
+	// Meshes whose geometry changed, their LODs are pointed to the new geometry after the commands
+	vector<std::pair<uint, SharedPtr<const LODSourceData>>> LODMeshes;
+	for (auto& Command : RenderCommands)
 	{
-		auto Type = std::get<0>(Command);
-		auto Id1 = std::get<1>(Command);
-		auto Id2 = std::get<2>(Command);
-		auto MeshPtr = std::get<3>(Command);
-		switch (Type)
+		const uint Id1 = Command.Id1;
+		const uint Id2 = Command.Id2;
+		switch (Command.Type)
 		{
 			case Create:
 			{
-				if (!MeshPtr || MeshPtr->IsEmpty())
-				{
-					LOG_ERROR("Add an empty mesh to scene: {}", MeshPtr->GetName());
-					continue;
-				}
 				bFrameUpdated = true;
-				MeshIdToPtr[Id1] = MeshPtr;
-				auto [Vertices, Triangles, CornerNormals] = GetFlattenMeshData(MeshPtr);
-				auto VBuffer = Scene.create<Buffer<Vertex>>(Vertices.size());
-				auto TBuffer = Scene.create<Buffer<Triangle>>(Triangles.size());
-				auto CornerlNormalBuffer = Scene.create<Buffer<float3>>(CornerNormals.size());
-				auto AccelMesh = Scene.create<Mesh>(*VBuffer, *TBuffer, AccelOption{});
-
-				stream << VBuffer->copy_from(Vertices.data())
-					   << TBuffer->copy_from(Triangles.data())
-					   << CornerlNormalBuffer->copy_from(CornerNormals.data())
-					   << commit()
-					   << AccelMesh->build();
-
-				auto VBindlessid = Scene.RegisterBindless(VBuffer->view());
-				auto TBindlessid = Scene.RegisterBindless(TBuffer->view());
-				auto CNBindlessid = Scene.RegisterBindless(CornerlNormalBuffer->view());
-				auto MaterialID = Scene.GetMaterialProxy()->AddMaterial(MeshPtr->GetMaterial());
-				StaticMeshData[Id1] = { VBindlessid, TBindlessid, CNBindlessid, MaterialID, 0 };
-				MeshResources[Id1] = { AccelMesh, VBuffer, TBuffer, CornerlNormalBuffer };
+				MeshInfos[Id1] = Command.Info;
+				AssignGeometry(Id1, AcquireGeometry(Command.Geometry, stream), Command.MaterialId);
+				LODMeshes.emplace_back(Id1, std::move(Command.LODSource));
 				break;
 			}
 			case Update:
 			{
-				if (!MeshPtr || MeshPtr->IsEmpty())
-				{
-					LOG_ERROR("Update an empty mesh to scene: {}", MeshPtr->GetName());
-					continue;
-				}
 				bFrameUpdated = true;
-				MeshIdToPtr[Id1] = MeshPtr;
-				auto [Vertices, Triangles, CornerNormals] = GetFlattenMeshData(MeshPtr);
-
-				// Register and upload new data buffer
-				auto VBuffer = Scene.create<Buffer<Vertex>>(Vertices.size());
-				auto TBuffer = Scene.create<Buffer<Triangle>>(Triangles.size());
-				auto CornerNormalBuffer = Scene.create<Buffer<float3>>(CornerNormals.size());
-				auto AccelMesh = Scene.create<Mesh>(*VBuffer, *TBuffer, AccelOption{});
-				stream << VBuffer->copy_from(Vertices.data())
-					   << TBuffer->copy_from(Triangles.data())
-					   << CornerNormalBuffer->copy_from(CornerNormals.data())
-					   << commit()
-					   << AccelMesh->build();
-
-				auto VBindlessid = StaticMeshData[Id1].vertex_buffer_id;
-				auto TBindlessid = StaticMeshData[Id1].triangle_buffer_id;
-				auto CNBindlessid = StaticMeshData[Id1].corner_normal_buffer_id;
-				auto MaterialID = Scene.GetMaterialProxy()->AddMaterial(MeshPtr->GetMaterial());
-
-				ASSERTMSG(VBindlessid != ~0u && TBindlessid != ~0u && CNBindlessid != ~0u,
-					"Trying to update a mesh that does not exist. ID {}", Id1);
-				bindlessArray.emplace_on_update(VBindlessid, VBuffer->view());
-				bindlessArray.emplace_on_update(TBindlessid, TBuffer->view());
-				bindlessArray.emplace_on_update(CNBindlessid, CornerNormalBuffer->view());
+				MeshInfos[Id1] = Command.Info;
 
-				for (auto Instance : MeshInstances[Id1])
-				{
-					accel.set_mesh(Instance, *AccelMesh);
-					Scene.GetShapeProxy()->SetInstanceMeshID(Instance, Id1);
-				}
+				// Acquire before releasing, an unchanged geometry keeps its buffers
+				const bool bHadGeometry = MeshResources[Id1].AccelMesh != nullptr;
+				const GeometryHash PreGeometry = MeshGeometry[Id1];
+				AssignGeometry(Id1, AcquireGeometry(Command.Geometry, stream), Command.MaterialId);
 
-				auto PreVBuffer = MeshResources[Id1].VertexBuffer;
-				auto PreTBuffer = MeshResources[Id1].TriangleBuffer;
-				auto PreCNBuffer = MeshResources[Id1].CornerNormalBuffer;
-				auto PreMesh = MeshResources[Id1].AccelMesh;
-				Scene.destroy(PreVBuffer);
-				Scene.destroy(PreTBuffer);
-				Scene.destroy(PreCNBuffer);
-				Scene.destroy(PreMesh);
-
-				StaticMeshData[Id1] = { VBindlessid, TBindlessid, CNBindlessid, MaterialID, 0};
-				MeshResources[Id1] = { AccelMesh, VBuffer, TBuffer, CornerNormalBuffer };
+				for (auto Instance : MeshInstances[Id1])
+					accel.set_mesh(Instance, *MeshResources[Id1].AccelMesh);
+				if (bHadGeometry)
+					ReleaseGeometry(PreGeometry);
+				LODMeshes.emplace_back(Id1, std::move(Command.LODSource));
 				break;
 			}
 			case Delete:
 			{
+				// Instances keep their slots in the accel, hide them and detach the shared BLAS
 				for (auto Instance : MeshInstances[Id1])
 				{
 					accel.set_visibility_on_update(Instance, false);
-					// accel.set_mesh(Instance, *NullMesh);
+					accel.set_mesh(Instance, *NullMesh);
 				}
-				// stream << accel.build();
-
-				// bindlessArray.remove_buffer_on_update(StaticMeshData[Id1].vertex_buffer_id);
-				// bindlessArray.remove_buffer_on_update(StaticMeshData[Id1].triangle_buffer_id);
-				// bindlessArray.remove_buffer_on_update(StaticMeshData[Id1].corner_normal_buffer_id);
-				// stream << bindlessArray.update();
-
-				// Scene.destroy(MeshResources[Id1].AccelMesh);
-				// Scene.destroy(MeshResources[Id1].VertexBuffer);
-				// Scene.destroy(MeshResources[Id1].TriangleBuffer);
-				// Scene.destroy(MeshResources[Id1].CornerNormalBuffer);
+				for (auto Instance : MeshInstances[Id1])
+					InstanceMesh.erase(Instance);
+				MeshInstances[Id1].clear();
+				if (MeshResources[Id1].AccelMesh)
+					ReleaseGeometry(MeshGeometry[Id1]);
+				bFrameUpdated = true;
+				for (uint LOD = 0; LOD < MaxLODNum; LOD++)
+					StaticMeshData[LOD * MaxStaticMeshNum + Id1] = {};
 				MeshResources[Id1] = {};
-				MeshIdToPtr.erase(Id1);
+				MeshInfos.erase(Id1);
+				LODRequests.erase(Id1);
 				break;
 			}
 			case Bind:
@@ -200,19 +231,288 @@ void StaticMeshSceneProxy::UploadDirtyData(Stream& stream)
 					LOG_ERROR("Trying to bind a mesh that does not exist. ID {}", Id1);
 					continue;
 				}
-				for (auto Meshes : MeshInstances)
-					if (Meshes.count(Id2)) Meshes.erase(Id2);
+				if (auto [It, bInserted] = InstanceMesh.try_emplace(Id2, Id1); !bInserted)
+				{
+					MeshInstances[It->second].erase(Id2);
+					It->second = Id1;
+				}
 				MeshInstances[Id1].insert(Id2);
 				accel.set_mesh(Id2, *MeshResources[Id1].AccelMesh);
 			}
 		}
 	}
-	CommandQueue.clear();
+	RenderCommands.clear();
+
+	if (!LODMeshes.empty())
+		RequestLODs(LODMeshes);
+	UpdateLODBuilds(stream);
 
 	if (bFrameUpdated)
-		stream << data_buffer.subview(0, StaticMeshData.size()).copy_from(StaticMeshData.data());
+	{
+		// Only ids below the counter are used in each LOD range
+		const uint RangeSize = CollectedMeshIdCounter + 1;
+		PROFILE_COUNTER("UploadBytes", MaxLODNum * RangeSize * sizeof(static_mesh_data));
+		for (uint LOD = 0; LOD < MaxLODNum; LOD++)
+			stream << data_buffer.subview(LOD * MaxStaticMeshNum, RangeSize).copy_from(StaticMeshData.data() + LOD * MaxStaticMeshNum);
+	}
+}
+
+uint StaticMeshSceneProxy::GetLODNum(uint MeshId) const
+{
+	uint LODNum = 1;
+	while (LODNum < MaxLODNum && StaticMeshData[LODNum * MaxStaticMeshNum + MeshId].valid())
+		LODNum++;
+	return LODNum;
+}
+
+uint2 StaticMeshSceneProxy::GetLODSize(uint MeshId, uint LOD) const
+{
+	if (MeshId >= MeshResources.size() || !MeshResources[MeshId].VertexBuffer)
+		return make_uint2(0u);
+	auto SourceIt = Geometries.find(MeshGeometry[MeshId]);
+	if (SourceIt == Geometries.end())
+		return make_uint2(0u);
+	const SharedGeometry& Source = SourceIt->second;
+	auto It = LOD > 0 && LOD <= Source.LODs.size() ? Geometries.find(Source.LODs[LOD - 1]) : Geometries.end();
+	const SharedGeometry& Geometry = It != Geometries.end() ? It->second : Source;
+	return make_uint2(Geometry.VertexNum, Geometry.TriangleNum);
+}
+
+void StaticMeshSceneProxy::RequestLODs(const vector<std::pair<uint, SharedPtr<const LODSourceData>>>& Meshes)
+{
+	for (const auto& [MeshId, LODSource] : Meshes)
+	{
+		if (!MeshInfos.contains(MeshId))
+			continue;
+		// Meshes sharing a geometry are simplified once, a geometry keeps its LODs until it is destroyed
+		AssignLODs(MeshId);
+		if (LODSource && !Geometries.find(MeshGeometry[MeshId])->second.bLODGenerated)
+			LODRequests[MeshId] = {LODSource, UploadFrame};
+		else
+			LODRequests.erase(MeshId);
+	}
+	bFrameUpdated = true;
 }
-std::tuple<vector<Vertex>, vector<Triangle>, vector<float3>> StaticMeshSceneProxy::GetFlattenMeshData(StaticMesh* MeshData)
+
+void StaticMeshSceneProxy::UpdateLODBuilds(Stream& stream)
+{
+	vector<GeometryHash> Sources;
+	vector<SharedPtr<const LODSourceData>> SourceMeshes;
+	for (auto It = LODRequests.begin(); It != LODRequests.end();)
+	{
+		if (UploadFrame - It->second.second < LODBuildDelay)
+		{
+			++It;
+			continue;
+		}
+		SharedGeometry& Geometry = Geometries.find(MeshGeometry[It->first])->second;
+		if (!Geometry.bLODGenerated)
+		{
+			Geometry.bLODGenerated = true;
+			Sources.push_back(MeshGeometry[It->first]);
+			SourceMeshes.push_back(std::move(It->second.first));
+		}
+		It = LODRequests.erase(It);
+	}
+	if (!Sources.empty())
+	{
+		LODBuilds.push_back({std::move(Sources), std::async(std::launch::async, [SourceMeshes = std::move(SourceMeshes)] {
+			vector<vector<FlattenMeshData>> Chains(SourceMeshes.size());
+			ParallelFor(SourceMeshes.size(), [&](int i) { Chains[i] = BuildLODChain(*SourceMeshes[i]); });
+			return Chains;
+		})});
+	}
+
+	for (auto It = LODBuilds.begin(); It != LODBuilds.end();)
+	{
+		if (It->Chains.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			++It;
+			continue;
+		}
+		const vector<vector<FlattenMeshData>> Chains = It->Chains.get();
+		for (size_t i = 0; i < It->Sources.size(); i++)
+		{
+			// The geometry may be destroyed, or destroyed and simplified again, while it was built
+			auto SourceIt = Geometries.find(It->Sources[i]);
+			if (SourceIt == Geometries.end() || !SourceIt->second.LODs.empty())
+				continue;
+			vector<GeometryHash> LODs;
+			for (const FlattenMeshData& Level : Chains[i])
+				LODs.push_back(AcquireGeometry(Level, stream, false));
+			PROFILE_COUNTER("MeshLODs", LODs.size());
+			Geometries.find(It->Sources[i])->second.LODs = std::move(LODs);
+			for (const auto& [MeshId, Info] : MeshInfos)
+			{
+				if (MeshGeometry[MeshId] == It->Sources[i])
+					AssignLODs(MeshId);
+			}
+			bFrameUpdated = true;
+		}
+		It = LODBuilds.erase(It);
+	}
+}
+
+void StaticMeshSceneProxy::AssignLODs(uint MeshId)
+{
+	const SharedGeometry& Source = Geometries.find(MeshGeometry[MeshId])->second;
+	for (uint LOD = 1; LOD < MaxLODNum; LOD++)
+	{
+		auto& Data = StaticMeshData[LOD * MaxStaticMeshNum + MeshId];
+		if (LOD > Source.LODs.size())
+		{
+			Data = {};
+			continue;
+		}
+		const SharedGeometry& Geometry = Geometries.find(Source.LODs[LOD - 1])->second;
+		Data = { Geometry.VertexBindlessId, Geometry.TriangleBindlessId, Geometry.CornerNormalBindlessId,
+			StaticMeshData[MeshId].material_id, StaticMeshData[MeshId].mesh_tag };
+	}
+}
+
+vector<StaticMeshSceneProxy::FlattenMeshData> StaticMeshSceneProxy::BuildLODChain(const LODSourceData& Mesh)
+{
+	vector<FlattenMeshData> Chain;
+	MatrixX3d V = Mesh.Vertices;
+	MatrixX3i F = Mesh.Faces;
+	MatrixX2d UV = Mesh.UV;
+	for (uint LOD = 1; LOD < MaxLODNum && F.rows() / 4 >= MinLODFaceNum; LOD++)
+	{
+		MatrixX3d OutV;
+		MatrixX3i OutF;
+		MatrixX2d OutUV;
+		// Boundaries and folds can stop the collapses early, a level that barely shrinks is not worth its memory
+		if (!MeshSimplification::Simplify(V, F, UV, static_cast<int>(F.rows() / 4), OutV, OutF, OutUV)
+			|| OutF.rows() * 4 > F.rows() * 3)
+			break;
+		V = std::move(OutV);
+		F = std::move(OutF);
+		UV = std::move(OutUV);
+		// Meshes compute their normals on construction
+		auto LODMesh = NewObject<StaticMesh>(MatrixX3d(V), MatrixX3i(F));
+		if (UV.rows() > 0)
+			LODMesh->SetUV(MatrixX2d(UV));
+		Chain.push_back(GetFlattenMeshData(LODMesh.get()));
+	}
+	return Chain;
+}
+
+size_t StaticMeshSceneProxy::GetGpuMemoryBytes() const
+{
+	size_t Bytes = data_buffer.size_bytes();
+	for (const auto& [Hash, Geometry] : Geometries)
+	{
+		Bytes += Geometry.Resource.VertexBuffer->size_bytes()
+			+ Geometry.Resource.TriangleBuffer->size_bytes()
+			+ Geometry.Resource.CornerNormalBuffer->size_bytes();
+	}
+	return Bytes;
+}
+
+StaticMeshSceneProxy::GeometryHash StaticMeshSceneProxy::AcquireGeometry(const FlattenMeshData& InMesh, Stream& stream, bool bBuildBLAS)
+{
+	const auto& [Vertices, Triangles, CornerNormals] = InMesh;
+
+	// float3 is padded to 16 bytes, hash the packed components only
+	vector<float> PackedCornerNormals(CornerNormals.size() * 3);
+	for (size_t i = 0; i < CornerNormals.size(); i++)
+	{
+		PackedCornerNormals[i * 3 + 0] = CornerNormals[i].x;
+		PackedCornerNormals[i * 3 + 1] = CornerNormals[i].y;
+		PackedCornerNormals[i * 3 + 2] = CornerNormals[i].z;
+	}
+	GeometryHasher Hasher;
+	Hasher.Update(Vertices.data(), Vertices.size() * sizeof(Vertex));
+	Hasher.Update(Triangles.data(), Triangles.size() * sizeof(Triangle));
+	Hasher.Update(PackedCornerNormals.data(), PackedCornerNormals.size() * sizeof(float));
+	// A mesh must not share a geometry built without BLAS
+	Hasher.Update(&bBuildBLAS, sizeof(bool));
+	const GeometryHash Hash{Hasher.Fnv, Hasher.Mix};
+
+	if (auto It = Geometries.find(Hash); It != Geometries.end())
+	{
+		It->second.RefCount++;
+		return Hash;
+	}
+
+	auto VBuffer = Scene.create<Buffer<Vertex>>(Vertices.size());
+	auto TBuffer = Scene.create<Buffer<Triangle>>(Triangles.size());
+	auto CornerNormalBuffer = Scene.create<Buffer<float3>>(CornerNormals.size());
+	PROFILE_COUNTER("UploadBytes", VBuffer->size_bytes() + TBuffer->size_bytes() + CornerNormalBuffer->size_bytes());
+	stream << VBuffer->copy_from(Vertices.data())
+		   << TBuffer->copy_from(Triangles.data())
+		   << CornerNormalBuffer->copy_from(CornerNormals.data());
+	Mesh* AccelMesh = nullptr;
+	if (bBuildBLAS)
+	{
+		AccelMesh = Scene.create<Mesh>(*VBuffer, *TBuffer, AccelOption{});
+		PROFILE_COUNTER("BLASBuilds", 1);
+		stream << commit() << AccelMesh->build();
+	}
+
+	SharedGeometry Geometry{{AccelMesh, VBuffer, TBuffer, CornerNormalBuffer}};
+	Geometry.VertexNum = static_cast<uint>(Vertices.size());
+	Geometry.TriangleNum = static_cast<uint>(Triangles.size());
+	if (!FreeBindlessSlots.empty())
+	{
+		const auto [VSlot, TSlot, CNSlot] = FreeBindlessSlots.back();
+		FreeBindlessSlots.pop_back();
+		bindlessArray.emplace_on_update(VSlot, VBuffer->view());
+		bindlessArray.emplace_on_update(TSlot, TBuffer->view());
+		bindlessArray.emplace_on_update(CNSlot, CornerNormalBuffer->view());
+		Geometry.VertexBindlessId = VSlot;
+		Geometry.TriangleBindlessId = TSlot;
+		Geometry.CornerNormalBindlessId = CNSlot;
+	}
+	else
+	{
+		Geometry.VertexBindlessId = Scene.RegisterBindless(VBuffer->view());
+		Geometry.TriangleBindlessId = Scene.RegisterBindless(TBuffer->view());
+		Geometry.CornerNormalBindlessId = Scene.RegisterBindless(CornerNormalBuffer->view());
+	}
+	Geometry.RefCount = 1;
+	Geometries.emplace(Hash, Geometry);
+	return Hash;
+}
+
+void StaticMeshSceneProxy::ReleaseGeometry(const GeometryHash& Hash)
+{
+	auto It = Geometries.find(Hash);
+	if (It == Geometries.end())
+	{
+		LOG_ERROR("Trying to release a geometry that does not exist.");
+		return;
+	}
+	SharedGeometry& Geometry = It->second;
+	if (--Geometry.RefCount > 0)
+		return;
+
+	bindlessArray.remove_buffer_on_update(Geometry.VertexBindlessId);
+	bindlessArray.remove_buffer_on_update(Geometry.TriangleBindlessId);
+	bindlessArray.remove_buffer_on_update(Geometry.CornerNormalBindlessId);
+	FreeBindlessSlots.push_back({Geometry.VertexBindlessId, Geometry.TriangleBindlessId, Geometry.CornerNormalBindlessId});
+
+	// Frames in flight may still read the buffers or trace the BLAS
+	if (Geometry.Resource.AccelMesh)
+		Scene.DeferredDestroy(Geometry.Resource.AccelMesh);
+	Scene.DeferredDestroy(Geometry.Resource.VertexBuffer);
+	Scene.DeferredDestroy(Geometry.Resource.TriangleBuffer);
+	Scene.DeferredDestroy(Geometry.Resource.CornerNormalBuffer);
+	const vector<GeometryHash> LODs = std::move(Geometry.LODs);
+	Geometries.erase(It);
+	for (const auto& LOD : LODs)
+		ReleaseGeometry(LOD);
+}
+
+void StaticMeshSceneProxy::AssignGeometry(uint MeshId, const GeometryHash& Hash, uint MaterialId)
+{
+	const SharedGeometry& Geometry = Geometries.find(Hash)->second;
+	MeshGeometry[MeshId] = Hash;
+	MeshResources[MeshId] = Geometry.Resource;
+	StaticMeshData[MeshId] = { Geometry.VertexBindlessId, Geometry.TriangleBindlessId, Geometry.CornerNormalBindlessId, MaterialId, 0 };
+}
+
+StaticMeshSceneProxy::FlattenMeshData StaticMeshSceneProxy::GetFlattenMeshData(const StaticMesh* MeshData)
 {
 	int VertexNum = MeshData->GetVertexNum();
 	int TriangleNum = MeshData->GetFaceNum();
@@ -254,7 +554,7 @@ std::tuple<vector<Vertex>, vector<Triangle>, vector<float3>> StaticMeshSceneProx
 		CornerNormals[i].y = MeshData->CornerNormal.row(i).y();
 		CornerNormals[i].z = MeshData->CornerNormal.row(i).z();
 	}
-	return std::tuple{Vertices, Triangles, CornerNormals};
+	return {std::move(Vertices), std::move(Triangles), std::move(CornerNormals)};
 }
 
 } // namespace MechEngine::Rendering
\ No newline at end of file
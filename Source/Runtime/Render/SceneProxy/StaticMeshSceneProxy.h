@@ -3,8 +3,11 @@
 //
 
 #pragma once
+#include <array>
+#include <future>
 #include "SceneProxy.h"
 #include "Render/Core/VertexData.h"
+#include "Math/Box.h"
 
 class StaticMesh;
 
@@ -63,12 +66,16 @@ public:
 
 	virtual bool IsDirty() override;
 
+	virtual void CollectDirtyData() override;
+
 	virtual void UploadDirtyData(Stream& stream) override;
 
+	virtual size_t GetGpuMemoryBytes() const override;
+
 	/**
-	* Upload a new mesh to the scene
+	* Upload a new mesh to the scene, ids of removed meshes are reused
 	* @param InMesh Static mesh to upload
-	* @return mesh id of the mesh
+	* @return mesh id of the mesh, ~0u if the mesh is empty or the mesh number exceeds MaxStaticMeshNum
 	*/
 	uint AddStaticMesh(StaticMesh* InMesh);
 
@@ -92,6 +99,18 @@ public:
 	 */
 	void RemoveStaticMesh(uint MeshId);
 
+	/** Number of distinct geometries on the GPU, meshes with identical content share one */
+	[[nodiscard]] FORCEINLINE uint GetGeometryNum() const noexcept { return static_cast<uint>(Geometries.size()); }
+
+	/** Number of LODs of the mesh, 1 if it has no simplified geometry */
+	[[nodiscard]] uint GetLODNum(uint MeshId) const;
+
+	/** Vertex and triangle number of a LOD of the mesh, LOD0 if the LOD is missing and zero if the mesh has no geometry */
+	[[nodiscard]] uint2 GetLODSize(uint MeshId, uint LOD) const;
+
+	// LOD0 is the mesh itself, each level keeps a quarter of the previous one's triangles
+	static constexpr uint MaxLODNum = 4;
+
 
 	/***********************************************************************************************
 	 * 								            GPU CODE						                   *
@@ -102,6 +121,12 @@ public:
 		return bindelss_buffer<static_mesh_data>(data_buffer_id)->read(mesh_id);
 	}
 
+	/** Mesh id of a simplified mesh, LODs live past the static meshes in the data buffer, one range per level */
+	[[nodiscard]] UInt get_lod_mesh_id(const UInt& mesh_id, const UInt& lod) const
+	{
+		return mesh_id + lod * MaxStaticMeshNum;
+	}
+
 	UInt get_mesh_tag(const UInt& mesh_id) const
 	{
 		return get_static_mesh_data(mesh_id)->mesh_tag;
@@ -147,29 +172,117 @@ public:
 			bindelss_buffer<float3>(mesh_data.corner_normal_buffer_id)->read(triangle_index * 3 + 2)};
 	}
 
-	// Mesh pointer to mesh id, used for iterating
-	map<uint, StaticMesh*> MeshIdToPtr;
+	/** What the passes need of a mesh, copied from the world when the mesh is collected */
+	struct StaticMeshInfo
+	{
+		Math::FBox3f Bounds;
+		bool bBackFaceCulling = true;
+	};
+
+	// Render data of each uploaded mesh id, used for iterating
+	map<uint, StaticMeshInfo> MeshInfos;
 
 	// MeshId corresponding instances' id
 	vector<set<uint>> MeshInstances;
 
+	// Mesh bound to each instance, so rebinding only touches the previous mesh
+	map<uint, uint> InstanceMesh;
+
 protected:
+	/** Mesh data in GPU format */
+	struct FlattenMeshData
+	{
+		vector<Vertex> Vertices;
+		vector<Triangle> Triangles;
+		vector<float3> CornerNormals;
+	};
+
+	/** Geometry of a mesh to simplify into LODs */
+	struct LODSourceData
+	{
+		MatrixX3d Vertices;
+		MatrixX3i Faces;
+		MatrixX2d UV;
+	};
 
 	/**
 	 * Get the flatten mesh data from mesh data, used for uploading mesh data to GPU
 	 * @param MeshData Mesh data to flatten
 	 * @return Flattened mesh data, vertices, triangles, corner normals in GPU format
 	 */
-	static std::tuple<vector<Vertex>, vector<Triangle>, vector<float3>> GetFlattenMeshData(StaticMesh* MeshData);
+	static FlattenMeshData GetFlattenMeshData(const StaticMesh* MeshData);
+
+	// Two unrelated 64-bit hashes of the flattened vertices, triangles and corner normals
+	using GeometryHash = std::pair<uint64_t, uint64_t>;
+
+	/** GPU buffers and BLAS shared by all the meshes with identical flattened content */
+	struct SharedGeometry
+	{
+		StaticMeshResource Resource;
+		uint VertexBindlessId = ~0u;
+		uint TriangleBindlessId = ~0u;
+		uint CornerNormalBindlessId = ~0u;
+		uint RefCount = 0;
+		uint VertexNum = 0;
+		uint TriangleNum = 0;
+		// Simplified geometries from LOD1, owned by this one, the content hash makes them a cache across meshes
+		vector<GeometryHash> LODs;
+		bool bLODGenerated = false;
+	};
+
+	/**
+	 * Find the geometry with the same content or upload a new one, and add a reference to it
+	 * @param bBuildBLAS False for geometries only rasterized, LODs are never traced
+	 * @return Hash of the geometry
+	 */
+	GeometryHash AcquireGeometry(const FlattenMeshData& InMesh, Stream& stream, bool bBuildBLAS = true);
+
+	/**
+	 * Remove a reference, once unused the bindless slots are recycled
+	 * and the buffers are destroyed after the GPU finishes the submitted frames
+	 */
+	void ReleaseGeometry(const GeometryHash& Hash);
+
+	/** Point the mesh data and resources of a mesh id to a shared geometry */
+	void AssignGeometry(uint MeshId, const GeometryHash& Hash, uint MaterialId);
+
+	/**
+	 * Point the LOD ranges of the changed meshes to the LODs their geometry already has,
+	 * and queue the simplification of the geometries that have none, they render LOD0 until it is done
+	 * @param Meshes Mesh ids with their geometry, the source is null when LODs are disabled
+	 */
+	void RequestLODs(const vector<std::pair<uint, SharedPtr<const LODSourceData>>>& Meshes);
+
+	/**
+	 * Simplify on a worker the queued geometries unchanged for LODBuildDelay frames,
+	 * and upload the LODs of the finished builds
+	 */
+	void UpdateLODBuilds(Stream& stream);
+
+	/** Point the LOD ranges of the data buffer of a mesh to the LODs of its geometry, empty if it has none */
+	void AssignLODs(uint MeshId);
+
+	/** Simplified levels of a mesh in GPU format, LOD1 first */
+	static vector<FlattenMeshData> BuildLODChain(const LODSourceData& Mesh);
 
 protected:
 	bool bFrameUpdated = false;
 
 	BufferView<static_mesh_data> data_buffer;
+	// MaxLODNum ranges of MaxStaticMeshNum, the first one holds the meshes themselves
 	vector<static_mesh_data> StaticMeshData;
 
+	uint MaxStaticMeshNum;
+
 	vector<StaticMeshResource> MeshResources;
 
+	// Geometry of each mesh id, valid when the mesh has resources
+	vector<GeometryHash> MeshGeometry;
+
+	map<GeometryHash, SharedGeometry> Geometries;
+
+	// Bindless slots of destroyed geometries, vertex, triangle and corner normal
+	vector<std::array<uint, 3>> FreeBindlessSlots;
 
 
 	uint data_buffer_id; // bindless array id of data buffer, this id will never change
@@ -177,6 +290,29 @@ protected:
 	// ID is index in the MeshResources/StaticMeshData
 	uint MeshIdCounter = 0;
 
+	// Ids of deleted meshes, reused before growing MeshIdCounter
+	vector<uint> FreeMeshIds;
+
+	// Ids handed to the world and not deleted yet
+	set<uint> LiveMeshIds;
+
+	// MeshIdCounter when the commands were collected, bounds the uploaded ranges
+	uint CollectedMeshIdCounter = 0;
+
+	/** Simplification of geometries running on a worker, one chain per source */
+	struct LODBuild
+	{
+		vector<GeometryHash> Sources;
+		std::future<vector<vector<FlattenMeshData>>> Chains;
+	};
+
+	// Latest geometry of each mesh waiting for its LODs, with the upload it changed in
+	map<uint, std::pair<SharedPtr<const LODSourceData>, uint64_t>> LODRequests;
+	vector<LODBuild> LODBuilds;
+	uint64_t UploadFrame = 0;
+	// Uploads a geometry must stay unchanged before it is simplified, meshes edited every frame never stall the upload
+	uint LODBuildDelay = 0;
+
 	Mesh* NullMesh = nullptr;
 
 	enum CommandType
@@ -187,6 +323,19 @@ protected:
 		Bind
 	};
 	vector<std::tuple<CommandType, uint, uint, StaticMesh*>> CommandQueue;
+
+	/** A command with the mesh data copied from the world */
+	struct RenderCommand
+	{
+		CommandType Type;
+		uint Id1;
+		uint Id2;
+		uint MaterialId = ~0u;
+		StaticMeshInfo Info;
+		FlattenMeshData Geometry;
+		SharedPtr<const LODSourceData> LODSource;
+	};
+	vector<RenderCommand> RenderCommands;
 };
 
 }
@@ -5,9 +5,11 @@
 #pragma once
 #include "TransformProxy.h"
 #include "StaticMeshSceneProxy.h"
+#include "ShapeSceneProxy.h"
 #include "Components/SceneComponent.h"
 #include "Render/Core/TypeConvertion.h"
 #include "Render/PipeLine/GpuScene.h"
+#include "Misc/Profiler.h"
 
 namespace MechEngine::Rendering
 {
@@ -15,56 +17,159 @@ TransformSceneProxy::TransformSceneProxy(GpuScene& InScene)
 	: SceneProxy(InScene)
 {
 	TransformDatas.resize(InScene.MaxTransformNum);
+	UploadedFlags.resize(InScene.MaxTransformNum);
 	std::tie(transform_buffer, transform_data_bid) = Scene.RegisterBindlessBuffer<transform_data>(InScene.MaxTransformNum);
 
 	Instance2Transformid.resize(InScene.MaxInstanceNum);
 	std::tie(instance_to_transform_buffer, instance_to_transform_bid) = Scene.RegisterBindlessBuffer<uint>(InScene.MaxInstanceNum);
 }
 
-void TransformSceneProxy::UploadDirtyData(Stream& stream)
+void TransformSceneProxy::CollectTransform(uint TransformId, const FMatrix4& WorldMatrix, const FTransform& LocalTransform, bool bNew)
 {
-	for (int i = 0; i < Id;i ++)
-	{
-		transform_data& data = TransformDatas[i];
+	CollectedUpdates.push_back({TransformId, WorldMatrix, WorldMatrix.inverse(), LocalTransform, bNew});
+}
+
+void TransformSceneProxy::WriteTransformData(const TransformUpdate& Update)
+{
+	transform_data& data = TransformDatas[Update.TransformId];
+	data.last_transform_matrix = data.transform_matrix;
+	data.transform_matrix = ToLuisaMatrix(Update.WorldMatrix);
+	if (Update.bNew) // New transform, last frame's transform matrix the same as the current frame
 		data.last_transform_matrix = data.transform_matrix;
-	}
 
-	for (SceneComponent* Component : NewTransforms)
+	data.inverse_transform_matrix = ToLuisaMatrix(Update.InverseWorldMatrix);
+	data.scale = ToLuisaVector(Update.Local.GetScale());
+	data.rotation_quaternion = ToLuisaVector(Update.Local.GetRotation().coeffs());
+	if (TransformToInstanceId.count(Update.TransformId))
 	{
-		auto TransformId = TransformIdMap[Component];
-		transform_data& data = TransformDatas[TransformId];
+		accel.set_transform_on_update(TransformToInstanceId[Update.TransformId], data.transform_matrix);
+	}
+}
 
-		data.transform_matrix = ToLuisaMatrix(Component->GetWorldMatrix());
-		data.last_transform_matrix = data.transform_matrix; // New transform, last frame's transform matrix the same as the current frame
+void TransformSceneProxy::CollectDirtyData()
+{
+	CollectedBinds.insert(CollectedBinds.end(), PendingBinds.begin(), PendingBinds.end());
+	PendingBinds.clear();
 
-		data.inverse_transform_matrix = ToLuisaMatrix(Component->GetWorldMatrix().inverse().eval());
-		data.scale = ToLuisaVector(Component->GetTransform().GetScale());
-		data.rotation_quaternion = ToLuisaVector(Component->GetTransform().GetRotation().coeffs());
-		if (TransformToInstanceId.count(TransformId))
+	if (!bSimulationState)
+	{
+		for (uint TransformId : DirtyTransformIds)
 		{
-			accel.set_transform_on_update(TransformToInstanceId[TransformId], data.transform_matrix);
+			SceneComponent* Component = TransformComponents[TransformId];
+			CollectedUpdates.push_back({TransformId, Component->GetWorldMatrix(), Component->GetInverseWorldMatrix(),
+				Component->GetLocalTransform(), bool(TransformFlags[TransformId] & TransformNew)});
+			TransformFlags[TransformId] = TransformClean;
 		}
+		DirtyTransformIds.clear();
+		return;
 	}
 
-	for (SceneComponent* Component : DirtyTransforms)
+	// Published simulation states, blended between the last two steps
+	for (uint TransformId : InterpolatingTransformIds)
 	{
-		auto TransformId = TransformIdMap[Component];
+		SimulationTransform& State = SimulationStates[TransformId];
+		CollectTransform(TransformId, FTransform::Lerp(State.Previous, State.Current, InterpolationAlpha).GetMatrix(), State.Local, State.bNew);
+		State.bNew = false;
+	}
+	for (uint TransformId : SettlingTransformIds)
+	{
+		TransformFlags[TransformId] &= ~TransformSettling;
+		if (TransformFlags[TransformId] & TransformInterpolating) continue;
+		SimulationTransform& State = SimulationStates[TransformId];
+		CollectTransform(TransformId, State.Current.GetMatrix(), State.Local, State.bNew);
+		State.bNew = false;
+	}
+	SettlingTransformIds.clear();
+}
+
+void TransformSceneProxy::UploadDirtyData(Stream& stream)
+{
+	uint RangeBegin = ~0u, RangeEnd = 0;
+	auto Touch = [&](uint TransformId) {
+		RangeBegin = std::min(RangeBegin, TransformId);
+		RangeEnd = std::max(RangeEnd, TransformId + 1);
+	};
+
+	// Bind before writing, so the accel gets the latest transform of a new instance
+	for (auto [InstanceID, TransformID] : CollectedBinds)
+	{
+		TransformToInstanceId[TransformID] = InstanceID;
+		Instance2Transformid[InstanceID] = TransformID;
+		bInstanceMappingDirty = true;
+		accel.set_transform_on_update(InstanceID, TransformDatas[TransformID].transform_matrix);
+	}
+	CollectedBinds.clear();
+
+	UploadedTransformIds.clear();
+	for (const TransformUpdate& Update : CollectedUpdates)
+	{
+		WriteTransformData(Update);
+		if (!UploadedFlags[Update.TransformId])
+			UploadedTransformIds.push_back(Update.TransformId);
+		UploadedFlags[Update.TransformId] = 1;
+		Touch(Update.TransformId);
+	}
+	CollectedUpdates.clear();
+
+	// Transforms that moved last frame but not in this one, the motion vector should become zero
+	for (uint TransformId : LastDirtyTransformIds)
+	{
+		if (UploadedFlags[TransformId]) continue;
 		transform_data& data = TransformDatas[TransformId];
 		data.last_transform_matrix = data.transform_matrix;
-		data.transform_matrix = ToLuisaMatrix(Component->GetWorldMatrix());
-		data.inverse_transform_matrix = ToLuisaMatrix(Component->GetWorldMatrix().inverse().eval());
-		data.scale = ToLuisaVector(Component->GetTransform().GetScale());
-		data.rotation_quaternion = ToLuisaVector(Component->GetTransform().GetRotation().coeffs());
-		if (TransformToInstanceId.count(TransformId))
-		{
-			accel.set_transform_on_update(TransformToInstanceId[TransformId], data.transform_matrix);
-		}
+		Touch(TransformId);
 	}
-	stream << transform_buffer.subview(0, GetTransformCount()).copy_from(TransformDatas.data());
-	if(!DirtyTransforms.empty() || !NewTransforms.empty())
+	for (uint TransformId : UploadedTransformIds)
+		UploadedFlags[TransformId] = 0;
+
+	if (RangeBegin < RangeEnd)
+	{
+		PROFILE_COUNTER("UploadBytes", (RangeEnd - RangeBegin) * sizeof(transform_data));
+		stream << transform_buffer.subview(RangeBegin, RangeEnd - RangeBegin).copy_from(TransformDatas.data() + RangeBegin);
+	}
+	if (bInstanceMappingDirty)
+	{
+		PROFILE_COUNTER("UploadBytes", instance_to_transform_buffer.size_bytes());
 		stream << instance_to_transform_buffer.copy_from(Instance2Transformid.data());
-	DirtyTransforms.clear();
-	NewTransforms.clear();
+	}
+	bInstanceMappingDirty = false;
+	std::swap(LastDirtyTransformIds, UploadedTransformIds);
+}
+
+void TransformSceneProxy::PublishSimulationState()
+{
+	bSimulationState = true;
+	if (SimulationStates.size() < TransformComponents.size())
+		SimulationStates.resize(TransformComponents.size());
+
+	// Transforms that moved in the previous step but not in this one come to rest on their latest state
+	for (uint TransformId : InterpolatingTransformIds)
+	{
+		uint8_t& Flag = TransformFlags[TransformId];
+		Flag &= ~TransformInterpolating;
+		if (Flag & (TransformDirty | TransformSettling)) continue;
+		SimulationStates[TransformId].Previous = SimulationStates[TransformId].Current;
+		Flag |= TransformSettling;
+		SettlingTransformIds.push_back(TransformId);
+	}
+	InterpolatingTransformIds.clear();
+
+	for (uint TransformId : DirtyTransformIds)
+	{
+		SceneComponent* Component = TransformComponents[TransformId];
+		SimulationTransform& State = SimulationStates[TransformId];
+		uint8_t& Flag = TransformFlags[TransformId];
+		const bool bNew = Flag & TransformNew;
+
+		State.Previous = bNew || !State.bPublished ? Component->GetWorldTransform() : State.Current;
+		State.Current = Component->GetWorldTransform();
+		State.bPublished = true;
+		State.Local = Component->GetLocalTransform();
+		State.bNew |= bNew;
+		Flag = (Flag & TransformSettling) | TransformInterpolating;
+		InterpolatingTransformIds.push_back(TransformId);
+	}
+	DirtyTransformIds.clear();
 }
 
 uint TransformSceneProxy::AddTransform(SceneComponent* InTransform)
@@ -78,7 +183,9 @@ uint TransformSceneProxy::AddTransform(SceneComponent* InTransform)
 		return TransformIdMap[InTransform];
 	uint NewId = Id++;
 	TransformIdMap[InTransform] = NewId;
-	NewTransforms.insert(InTransform);
+	TransformComponents.push_back(InTransform);
+	TransformFlags.push_back(TransformDirty | TransformNew);
+	DirtyTransformIds.push_back(NewId);
 	return NewId;
 }
 void TransformSceneProxy::BindTransform(uint InstanceID, uint TransformID)
@@ -88,14 +195,12 @@ void TransformSceneProxy::BindTransform(uint InstanceID, uint TransformID)
 		LOG_ERROR("Trying to bind a transform with id: {} that does not exist in the scene.", TransformID);
 		return;
 	}
-	if (accel.size() <= InstanceID)
+	if (Scene.GetShapeProxy()->GetInstanceNum() <= InstanceID)
 	{
 		LOG_ERROR("Trying to bind a transform to an instance with id: {} that does not exist in the scene.", InstanceID);
 		return;
 	}
-	TransformToInstanceId[TransformID] = InstanceID;
-	Instance2Transformid[InstanceID] = TransformID;
-	accel.set_transform_on_update(InstanceID, TransformDatas[TransformID].transform_matrix);
+	PendingBinds.emplace_back(InstanceID, TransformID);
 }
 
 bool TransformSceneProxy::IsExist(SceneComponent* InTransform) const
@@ -105,13 +210,16 @@ bool TransformSceneProxy::IsExist(SceneComponent* InTransform) const
 
 bool TransformSceneProxy::IsExist(const uint TransformID) const
 {
-	return std::ranges::any_of(TransformIdMap, [TransformID](const auto& Pair) { return Pair.second == TransformID; });
+	return TransformID < Id;
 }
 
 void TransformSceneProxy::UpdateTransform(SceneComponent* InTransform)
 {
-	if(TransformIdMap.count(InTransform))
-		DirtyTransforms.insert(InTransform);
+	auto It = TransformIdMap.find(InTransform);
+	if (It == TransformIdMap.end() || TransformFlags[It->second] & TransformDirty)
+		return;
+	TransformFlags[It->second] |= TransformDirty;
+	DirtyTransformIds.push_back(It->second);
 }
 
 }
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include "luisa/luisa-compute.h"
 #include "Misc/Platform.h"
 #include "Render/Core/transform_data.h"
+#include "Math/FTransform.h"
 
 class SceneComponent;
 namespace MechEngine::Rendering
@@ -19,8 +20,14 @@ namespace MechEngine::Rendering
 	public:
 		explicit TransformSceneProxy(GpuScene& InScene);
 
+		virtual bool IsDirty() override { return !DirtyTransformIds.empty() || !InterpolatingTransformIds.empty() || !SettlingTransformIds.empty() || !PendingBinds.empty(); }
+
+		virtual void CollectDirtyData() override;
+
 		virtual void UploadDirtyData(luisa::compute::Stream& stream) override;
 
+		virtual size_t GetGpuMemoryBytes() const override { return transform_buffer.size_bytes() + instance_to_transform_buffer.size_bytes(); }
+
 		/**
 		 * Try to add a new transform to the scene, if the transform already exists, return the existing id
 		 * @param InTransform SceneComponent to add
@@ -50,6 +57,19 @@ namespace MechEngine::Rendering
 		*/
 		void UpdateTransform(SceneComponent* InTransform);
 
+		/**
+		 * Snapshot the transforms changed since the last call, called by the simulation thread after each step.
+		 * Once called, uploads render the published states instead of reading components,
+		 * blending between the last two steps by the interpolation alpha.
+		 */
+		void PublishSimulationState();
+
+		/**
+		 * Set the blend factor between the last two published simulation states used by the next upload
+		 * @param Alpha 0 renders the previous step, 1 the latest one
+		 */
+		FORCEINLINE void SetInterpolationAlpha(float Alpha) noexcept { InterpolationAlpha = Alpha; }
+
 		[[nodiscard]] FORCEINLINE uint GetTransformCount() const noexcept;
 
 		[[nodiscard]] UInt get_instance_transform_id(Expr<uint> instance_id) const
@@ -69,13 +89,70 @@ namespace MechEngine::Rendering
 		}
 
 	protected:
+		enum ETransformFlag : uint8_t
+		{
+			TransformClean = 0,
+			TransformDirty = 1,
+			TransformNew = 2,
+			// Changed in the latest published step, rendered between the last two states
+			TransformInterpolating = 4,
+			// Stopped moving, uploaded once more at its latest state
+			TransformSettling = 8
+		};
+
+		/** The last two simulation states of a transform, double buffered for the render thread */
+		struct SimulationTransform
+		{
+			FTransform Previous;
+			FTransform Current;
+			FTransform Local;
+			bool bNew = false;
+			bool bPublished = false;
+		};
+
+		/** A transform read from the world, written to the render data by the upload */
+		struct TransformUpdate
+		{
+			uint TransformId;
+			FMatrix4 WorldMatrix;
+			FMatrix4 InverseWorldMatrix;
+			FTransform Local;
+			bool bNew;
+		};
+
+		void CollectTransform(uint TransformId, const FMatrix4& WorldMatrix, const FTransform& LocalTransform, bool bNew);
+
+		void WriteTransformData(const TransformUpdate& Update);
+
 		uint Id = 0;
-		vector<uint> Instance2Transformid;
-		vector<transform_data> TransformDatas;
 		map<SceneComponent*, uint> TransformIdMap;
+		vector<SceneComponent*> TransformComponents;
+
+		// Dirty list consumed by the collect pass, flags deduplicate repeated updates in one frame
+		vector<uint8_t> TransformFlags;
+		vector<uint> DirtyTransformIds;
+		// Instance bindings made by the world since the last collect, as (instance, transform)
+		vector<std::pair<uint, uint>> PendingBinds;
+
+		// Collected under the world lock, consumed by the upload
+		vector<TransformUpdate> CollectedUpdates;
+		vector<std::pair<uint, uint>> CollectedBinds;
 
-		set<SceneComponent*> DirtyTransforms;
-		set<SceneComponent*> NewTransforms;
+		// Render data, only touched by the upload
+		vector<uint> Instance2Transformid;
+		vector<transform_data> TransformDatas;
+		// Transforms uploaded last frame, their last_transform_matrix needs to catch up
+		vector<uint> LastDirtyTransformIds;
+		vector<uint> UploadedTransformIds;
+		vector<uint8_t> UploadedFlags;
+		bool bInstanceMappingDirty = false;
+
+		// Published simulation states, only used once the world is ticked on the simulation thread
+		bool bSimulationState = false;
+		float InterpolationAlpha = 1.f;
+		vector<SimulationTransform> SimulationStates;
+		vector<uint> InterpolatingTransformIds;
+		vector<uint> SettlingTransformIds;
 
 		map<uint, uint> TransformToInstanceId;// should be one to many
 